@@ -0,0 +1,61 @@
+local stats = TalkAction("/stats")
+
+-- Counters seen by the previous check, the rates cover the time between two checks
+local previous = nil
+
+local function perSecond(current, last, seconds)
+	return (current - last) / seconds
+end
+
+function stats.onSay(player, words, param)
+	-- create log
+	logCommand(player, words, param)
+
+	local now = os.time()
+	local network = Game.getNetworkStats()
+	local database = Game.getDatabaseStats()
+
+	local text
+	local seconds = previous and now - previous.time or 0
+	if seconds > 0 then
+		text = string.format("Rates over the last %d seconds:", seconds)
+		text = text .. string.format("\nNetwork: %.1f writes/s, %.1f messages/s, %.1f KB/s", perSecond(network.writes, previous.writes, seconds), perSecond(network.messages, previous.messages, seconds), perSecond(network.bytes, previous.bytes, seconds) / 1024)
+		text = text .. string.format("\nDatabase: %.1f queries/s", perSecond(database.queries, previous.queries, seconds))
+	else
+		text = "Rates are shown from the next check on."
+	end
+	previous = { time = now, writes = network.writes, messages = network.messages, bytes = network.bytes, queries = database.queries }
+
+	local spectators = Game.getSpectatorsCacheStats()
+	local lookups = spectators.hits + spectators.misses
+	text = text .. string.format("\n\nSpectators cache: %d hits, %d misses (%.1f%% hit rate), %d invalidations, %d cached positions", spectators.hits, spectators.misses, lookups > 0 and spectators.hits * 100 / lookups or 0, spectators.invalidations, spectators.positions)
+
+	text = text .. string.format("\nNetwork: %d writes, %d messages, %d bytes sent", network.writes, network.messages, network.bytes)
+
+	local depth = network.queueDepth
+	text = text .. string.format("\nSend queues: %d congestions, %d coalesced updates, %d slow clients dropped, queued bytes up to 4KB %d, 16KB %d, 64KB %d, 256KB %d, 1MB %d, above %d", network.congestions, network.coalescedUpdates, network.slowDisconnects, depth[1], depth[2], depth[3], depth[4], depth[5], depth[6])
+
+	local compression = Game.getCompressionStats()
+	text = text .. string.format("\nCompression (level %d): %d compressed, %d skipped of %d messages, %.1f%% of the original size, %.2f ms total", compression.level, compression.compressed, compression.skipped, compression.messages, compression.bytesIn > 0 and compression.bytesOut * 100 / compression.bytesIn or 0, compression.cpuTime)
+
+	local status = Game.getStatusUpdateStats()
+	text = text .. string.format("\nStatus updates: %d sent of %d requested, %d merged before being sent, %d unchanged", status.sent, status.requested, status.coalesced, status.unchanged)
+
+	text = text .. string.format("\nDatabase: %d queries, %d of %d connections in use, %d waits for a connection, %.2f ms total, %.2f ms max", database.queries, database.inUse, database.poolSize, database.waits, database.waitTime, database.maxWaitTime)
+
+	local kv = Game.getKVStats()
+	text = text .. string.format("\nKV store: %d cached (%d dirty), %d hits, %d misses, %d evictions, %d written, last write-back %.2f ms", kv.size, kv.dirty, kv.hits, kv.misses, kv.evictions, kv.written, kv.lastWriteBackTime)
+
+	local journal = Game.getPersistenceJournalStats()
+	if journal.enabled then
+		text = text .. string.format("\nPersistence journal: %d records appended, %d flushed, %d rejected, %d pending (%d bytes), last flush %.2f ms", journal.appended, journal.flushed, journal.rejected, journal.pending, journal.pendingBytes, journal.lastFlushTime)
+	end
+
+	player:showTextDialog(2019, text)
+	logger.info("[Stats] " .. text)
+	return true
+end
+
+stats:separator(" ")
+stats:groupType("god")
+stats:register()
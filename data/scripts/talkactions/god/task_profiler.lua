@@ -0,0 +1,32 @@
+local taskProfiler = TalkAction("/profiler")
+
+function taskProfiler.onSay(player, words, param)
+	-- create log
+	logCommand(player, words, param)
+
+	if param == "reset" then
+		Game.resetTaskProfile()
+		player:sendTextMessage(MESSAGE_ADMINISTRATOR, "Task profiler has been reset.")
+		return true
+	end
+
+	local limit = tonumber(param) or 10
+	local profiles = Game.getTaskProfile(limit)
+	if #profiles == 0 then
+		player:sendTextMessage(MESSAGE_ADMINISTRATOR, "No task has been profiled yet.")
+		return true
+	end
+
+	local text = string.format("Top %d task contexts by total time:\n", #profiles)
+	for index, profile in ipairs(profiles) do
+		text = text .. string.format("\n%d. %s\n   %d calls, %.2f ms total, %.3f ms avg, %.2f ms max", index, profile.context, profile.count, profile.total, profile.average, profile.max)
+	end
+
+	player:showTextDialog(2019, text)
+	logger.info("[TaskProfiler] " .. text)
+	return true
+end
+
+taskProfiler:separator(" ")
+taskProfiler:groupType("god")
+taskProfiler:register()
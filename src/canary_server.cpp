@@ -16,6 +16,7 @@
 #include "creatures/players/imbuements/imbuements.hpp"
 #include "creatures/players/storages/storages.hpp"
 #include "database/databasemanager.hpp"
+#include "database/persistence_journal.hpp"
 #include "declarations.hpp"
 #include "game/game.hpp"
 #include "game/scheduling/dispatcher.hpp"
@@ -24,11 +25,13 @@
 #include "io/io_bosstiary.hpp"
 #include "io/iomarket.hpp"
 #include "io/ioprey.hpp"
+#include "kv/kv.hpp"
 #include "lib/thread/thread_pool.hpp"
 #include "lua/creature/events.hpp"
 #include "lua/modules/modules.hpp"
 #include "lua/scripts/lua_environment.hpp"
 #include "lua/scripts/scripts.hpp"
+#include "server/network/connection/packet_recorder.hpp"
 #include "server/network/protocol/protocollogin.hpp"
 #include "server/network/protocol/protocolstatus.hpp"
 #include "server/network/webhook/webhook.hpp"
@@ -170,6 +173,10 @@ int CanaryServer::run() {
 	logger.info("{} {}", g_configManager().getString(SERVER_NAME), "server online!");
 	g_logger().setLevel(g_configManager().getString(LOGLEVEL));
 
+	if (const auto &recorderFile = g_configManager().getString(PACKET_RECORDER_FILE); !recorderFile.empty()) {
+		g_packetRecorder().start(recorderFile);
+	}
+
 	serviceManager.run();
 
 	shutdown();
@@ -365,6 +372,12 @@ void CanaryServer::initializeDatabase() {
 
 	DatabaseManager::updateDatabase();
 
+	// Saves left in the journal by a crash must be in the database before anything is loaded
+	if (!g_persistenceJournal().open()) {
+		throw FailedToInitializeCanary("Failed to replay the persistence journal!");
+	}
+	g_kv().startWriteBack(std::chrono::seconds(g_configManager().getNumber(KV_WRITE_BACK_INTERVAL)));
+
 	if (g_configManager().getBoolean(OPTIMIZE_DATABASE)
 	    && !DatabaseManager::optimizeTables()) {
 		logger.debug("No tables were optimized");
@@ -431,4 +444,5 @@ void CanaryServer::shutdown() {
 	g_dispatcher().shutdown();
 	g_metrics().shutdown();
 	g_threadPool().shutdown();
+	g_packetRecorder().stop();
 }
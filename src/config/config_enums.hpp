@@ -46,6 +46,7 @@ enum ConfigKey_t : uint16_t {
 	COMBAT_CHAIN_SKILL_FORMULA_CLUB,
 	COMBAT_CHAIN_SKILL_FORMULA_SWORD,
 	COMBAT_CHAIN_TARGETS,
+	COMPRESSION_CPU_BUDGET,
 	COMPRESSION_LEVEL,
 	CONVERT_UNSAFE_SCRIPTS,
 	CORE_DIRECTORY,
@@ -65,6 +66,7 @@ enum ConfigKey_t : uint16_t {
 	DISCORD_SEND_FOOTER,
 	DISCORD_WEBHOOK_DELAY_MS,
 	DISCORD_WEBHOOK_URL,
+	DISPATCHER_SLOW_TICK_BUDGET,
 	EMOTE_SPELLS,
 	ENABLE_PLAYER_PUT_ITEM_IN_AMMO_SLOT,
 	ENABLE_SUPPORT_OUTFIT,
@@ -127,6 +129,7 @@ enum ConfigKey_t : uint16_t {
 	INVENTORY_GLOW,
 	IP,
 	KICK_AFTER_MINUTES,
+	KV_WRITE_BACK_INTERVAL,
 	LEAVE_PARTY_ON_DEATH,
 	LOCATION,
 	LOGIN_PORT,
@@ -176,8 +179,10 @@ enum ConfigKey_t : uint16_t {
 	MYSQL_DB_BACKUP,
 	MYSQL_HOST,
 	MYSQL_PASS,
+	MYSQL_POOL_SIZE,
 	MYSQL_SOCK,
 	MYSQL_USER,
+	NETWORK_THREADS,
 	OLD_PROTOCOL,
 	ONE_PLAYER_ON_ACCOUNT,
 	ONLY_INVITED_CAN_MOVE_HOUSE_ITEMS,
@@ -190,12 +195,15 @@ enum ConfigKey_t : uint16_t {
 	LOGIN_PROTECTION_TIME,
 	OWNER_EMAIL,
 	OWNER_NAME,
+	PACKET_RECORDER_FILE,
 	PARALLELISM,
 	PARTY_AUTO_SHARE_EXPERIENCE,
 	PARTY_SHARE_RANGE_MULTIPLIER,
 	PARTY_LIST_MAX_DISTANCE,
 	PARTY_SHARE_LOOT_BOOSTS_DIMINISHING_FACTOR,
 	PARTY_SHARE_LOOT_BOOSTS,
+	PERSISTENCE_JOURNAL,
+	PERSISTENCE_JOURNAL_FILE,
 	PREMIUM_DEPOT_LIMIT,
 	PREY_BONUS_REROLL_PRICE,
 	PREY_BONUS_TIME,
@@ -254,6 +262,10 @@ enum ConfigKey_t : uint16_t {
 	SAVE_INTERVAL_TIME,
 	SAVE_INTERVAL_TYPE,
 	SCRIPTS_CONSOLE_LOGS,
+	SEND_QUEUE_HIGH_WATERMARK,
+	SEND_QUEUE_LOW_WATERMARK,
+	SEND_QUEUE_MAX_SIZE,
+	SEND_QUEUE_SLOW_TIMEOUT,
 	SERVER_MOTD,
 	SERVER_NAME,
 	SHOW_LOOTS_IN_BESTIARY,
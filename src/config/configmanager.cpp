@@ -44,6 +44,7 @@ bool ConfigManager::load() {
 		loadBoolConfig(L, DISABLE_LEGACY_RAIDS, "disableLegacyRaids", false);
 		loadBoolConfig(L, OLD_PROTOCOL, "allowOldProtocol", true);
 		loadBoolConfig(L, OPTIMIZE_DATABASE, "startupDatabaseOptimization", true);
+		loadBoolConfig(L, PERSISTENCE_JOURNAL, "persistenceJournal", false);
 		loadBoolConfig(L, RANDOM_MONSTER_SPAWN, "randomMonsterSpawn", false);
 		loadBoolConfig(L, RESET_SESSIONS_ON_STARTUP, "resetSessionsOnStartup", false);
 		loadBoolConfig(L, TOGGLE_MAINTAIN_MODE, "toggleMaintainMode", false);
@@ -58,6 +59,8 @@ bool ConfigManager::load() {
 		loadIntConfig(L, LOGIN_PORT, "loginProtocolPort", 7171);
 		loadIntConfig(L, MARKET_OFFER_DURATION, "marketOfferDuration", 30 * 24 * 60 * 60);
 		loadIntConfig(L, MARKET_REFRESH_PRICES, "marketRefreshPricesInterval", 30);
+		loadIntConfig(L, MYSQL_POOL_SIZE, "mysqlPoolSize", 4);
+		loadIntConfig(L, NETWORK_THREADS, "networkThreads", 1);
 		loadIntConfig(L, PREMIUM_DEPOT_LIMIT, "premiumDepotLimit", 8000);
 		loadIntConfig(L, SQL_PORT, "mysqlPort", 3306);
 		loadIntConfig(L, STATUS_PORT, "statusProtocolPort", 7171);
@@ -75,6 +78,8 @@ bool ConfigManager::load() {
 		loadStringConfig(L, MYSQL_PASS, "mysqlPass", "");
 		loadStringConfig(L, MYSQL_SOCK, "mysqlSock", "");
 		loadStringConfig(L, MYSQL_USER, "mysqlUser", "root");
+		loadStringConfig(L, PACKET_RECORDER_FILE, "packetRecorderFile", "");
+		loadStringConfig(L, PERSISTENCE_JOURNAL_FILE, "persistenceJournalFile", "persistence.journal");
 	}
 
 	loadBoolConfig(L, AIMBOT_HOTKEY_ENABLED, "hotkeyAimbotEnabled", true);
@@ -222,6 +227,7 @@ bool ConfigManager::load() {
 	loadIntConfig(L, CHECK_EXPIRED_MARKET_OFFERS_EACH_MINUTES, "checkExpiredMarketOffersEachMinutes", 60);
 	loadIntConfig(L, COMBAT_CHAIN_DELAY, "combatChainDelay", 50);
 	loadIntConfig(L, COMBAT_CHAIN_TARGETS, "combatChainTargets", 5);
+	loadIntConfig(L, COMPRESSION_CPU_BUDGET, "packetCompressionCpuBudget", 0);
 	loadIntConfig(L, COMPRESSION_LEVEL, "packetCompressionLevel", 6);
 	loadIntConfig(L, CRITICALCHANCE, "criticalChance", 10);
 	loadIntConfig(L, DAY_KILLS_TO_RED, "dayKillsToRedSkull", 3);
@@ -230,6 +236,7 @@ bool ConfigManager::load() {
 	loadIntConfig(L, DEFAULT_DESPAWNRADIUS, "deSpawnRadius", 50);
 	loadIntConfig(L, DEFAULT_DESPAWNRANGE, "deSpawnRange", 2);
 	loadIntConfig(L, DEPOTCHEST, "depotChest", 4);
+	loadIntConfig(L, DISPATCHER_SLOW_TICK_BUDGET, "dispatcherSlowTickBudget", 100);
 	loadIntConfig(L, DISCORD_WEBHOOK_DELAY_MS, "discordWebhookDelayMs", Webhook::DEFAULT_DELAY_MS);
 	loadIntConfig(L, EX_ACTIONS_DELAY_INTERVAL, "timeBetweenExActions", 1000);
 	loadIntConfig(L, EXP_FROM_PLAYERS_LEVEL_RANGE, "expFromPlayersLevelRange", 75);
@@ -270,6 +277,7 @@ bool ConfigManager::load() {
 	loadIntConfig(L, HOUSE_LOSE_AFTER_INACTIVITY, "houseLoseAfterInactivity", 0);
 	loadIntConfig(L, HOUSE_PRICE_PER_SQM, "housePriceEachSQM", 1000);
 	loadIntConfig(L, KICK_AFTER_MINUTES, "kickIdlePlayerAfterMinutes", 15);
+	loadIntConfig(L, KV_WRITE_BACK_INTERVAL, "kvWriteBackInterval", 60);
 	loadIntConfig(L, LOOTPOUCH_MAXLIMIT, "lootPouchMaxLimit", 2000);
 	loadIntConfig(L, LOW_LEVEL_BONUS_EXP, "lowLevelBonusExp", 50);
 	loadIntConfig(L, LOYALTY_POINTS_PER_CREATION_DAY, "loyaltyPointsPerCreationDay", 1);
@@ -318,6 +326,10 @@ bool ConfigManager::load() {
 	loadIntConfig(L, RED_SKULL_DURATION, "redSkullDuration", 30);
 	loadIntConfig(L, REWARD_CHEST_MAX_COLLECT_ITEMS, "rewardChestMaxCollectItems", 200);
 	loadIntConfig(L, SAVE_INTERVAL_TIME, "saveIntervalTime", 1);
+	loadIntConfig(L, SEND_QUEUE_HIGH_WATERMARK, "sendQueueHighWatermark", 256);
+	loadIntConfig(L, SEND_QUEUE_LOW_WATERMARK, "sendQueueLowWatermark", 64);
+	loadIntConfig(L, SEND_QUEUE_MAX_SIZE, "sendQueueMaxSize", 4096);
+	loadIntConfig(L, SEND_QUEUE_SLOW_TIMEOUT, "sendQueueSlowTimeout", 15);
 	loadIntConfig(L, STAIRHOP_DELAY, "stairJumpExhaustion", 2000);
 	loadIntConfig(L, STAMINA_GREEN_DELAY, "staminaGreenDelay", 5);
 	loadIntConfig(L, STAMINA_ORANGE_DELAY, "staminaOrangeDelay", 1);
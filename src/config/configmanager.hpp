@@ -27,6 +27,10 @@ public:
 	bool load();
 	bool reload();
 
+	[[nodiscard]] bool isLoaded() const {
+		return loaded;
+	}
+
 	void missingConfigWarning(const char* identifier);
 
 	const std::string &setConfigFileLua(const std::string &what) {
@@ -524,7 +524,7 @@ public:
 	virtual void onAttackedCreatureDisappear(bool) { }
 	virtual void onFollowCreatureDisappear(bool) { }
 
-	virtual void onCreatureSay(const std::shared_ptr<Creature> &, SpeakClasses, const std::string &) { }
+	virtual void onCreatureSay(const std::shared_ptr<Creature> &, SpeakClasses, std::string_view) { }
 
 	virtual void onPlacedCreature() { }
 
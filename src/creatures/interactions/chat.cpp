@@ -195,7 +195,7 @@ bool ChatChannel::isPublicChannel() const {
 	return publicChannel;
 }
 
-bool ChatChannel::talk(const std::shared_ptr<Player> &fromPlayer, SpeakClasses type, const std::string &text) const {
+bool ChatChannel::talk(const std::shared_ptr<Player> &fromPlayer, SpeakClasses type, std::string_view text) const {
 	if (!users.contains(fromPlayer->getID())) {
 		return false;
 	}
@@ -288,7 +288,7 @@ bool ChatChannel::executeOnLeaveEvent(const std::shared_ptr<Player> &player) con
 	return scriptInterface->callFunction(1);
 }
 
-bool ChatChannel::executeOnSpeakEvent(const std::shared_ptr<Player> &player, SpeakClasses &type, const std::string &message) const {
+bool ChatChannel::executeOnSpeakEvent(const std::shared_ptr<Player> &player, SpeakClasses &type, std::string_view message) const {
 	if (onSpeakEvent == -1) {
 		return true;
 	}
@@ -312,7 +312,7 @@ bool ChatChannel::executeOnSpeakEvent(const std::shared_ptr<Player> &player, Spe
 	LuaScriptInterface::setMetatable(L, -1, "Player");
 
 	lua_pushnumber(L, type);
-	LuaScriptInterface::pushString(L, message);
+	LuaScriptInterface::pushString(L, std::string(message));
 
 	bool result = false;
 	int size0 = lua_gettop(L);
@@ -567,7 +567,7 @@ void Chat::removeUserFromAllChannels(const std::shared_ptr<Player> &player) {
 	}
 }
 
-bool Chat::talkToChannel(const std::shared_ptr<Player> &player, SpeakClasses type, const std::string &text, uint16_t channelId) {
+bool Chat::talkToChannel(const std::shared_ptr<Player> &player, SpeakClasses type, std::string_view text, uint16_t channelId) {
 	const auto &channel = getChannel(player, channelId);
 	if (channel == nullptr) {
 		return false;
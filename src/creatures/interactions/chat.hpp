@@ -30,7 +30,7 @@ public:
 	bool removeUser(const std::shared_ptr<Player> &player);
 	bool hasUser(const std::shared_ptr<Player> &player) const;
 
-	bool talk(const std::shared_ptr<Player> &fromPlayer, SpeakClasses type, const std::string &text) const;
+	bool talk(const std::shared_ptr<Player> &fromPlayer, SpeakClasses type, std::string_view text) const;
 	void sendToAll(const std::string &message, SpeakClasses type) const;
 
 	const std::string &getName() const;
@@ -45,7 +45,7 @@ public:
 	bool executeOnJoinEvent(const std::shared_ptr<Player> &player) const;
 	bool executeCanJoinEvent(const std::shared_ptr<Player> &player) const;
 	bool executeOnLeaveEvent(const std::shared_ptr<Player> &player) const;
-	bool executeOnSpeakEvent(const std::shared_ptr<Player> &player, SpeakClasses &type, const std::string &message) const;
+	bool executeOnSpeakEvent(const std::shared_ptr<Player> &player, SpeakClasses &type, std::string_view message) const;
 
 protected:
 	UsersMap users;
@@ -107,7 +107,7 @@ public:
 	bool removeUserFromChannel(const std::shared_ptr<Player> &player, uint16_t channelId);
 	void removeUserFromAllChannels(const std::shared_ptr<Player> &player);
 
-	bool talkToChannel(const std::shared_ptr<Player> &player, SpeakClasses type, const std::string &text, uint16_t channelId);
+	bool talkToChannel(const std::shared_ptr<Player> &player, SpeakClasses type, std::string_view text, uint16_t channelId);
 
 	ChannelList getChannelList(const std::shared_ptr<Player> &player);
 
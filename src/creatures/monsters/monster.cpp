@@ -457,7 +457,7 @@ void Monster::onCreatureMove(const std::shared_ptr<Creature> &creature, const st
 	}
 }
 
-void Monster::onCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text) {
+void Monster::onCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, std::string_view text) {
 	Creature::onCreatureSay(creature, type, text);
 
 	if (m_monsterType->info.creatureSayEvent != -1) {
@@ -483,7 +483,7 @@ void Monster::onCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClas
 		LuaScriptInterface::setCreatureMetatable(L, -1, creature);
 
 		lua_pushnumber(L, type);
-		LuaScriptInterface::pushString(L, text);
+		LuaScriptInterface::pushString(L, std::string(text));
 
 		scriptInterface->callVoidFunction(4);
 	}
@@ -92,7 +92,7 @@ public:
 	void onCreatureAppear(const std::shared_ptr<Creature> &creature, bool isLogin) override;
 	void onRemoveCreature(const std::shared_ptr<Creature> &creature, bool isLogout) override;
 	void onCreatureMove(const std::shared_ptr<Creature> &creature, const std::shared_ptr<Tile> &newTile, const Position &newPos, const std::shared_ptr<Tile> &oldTile, const Position &oldPos, bool teleport) override;
-	void onCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text) override;
+	void onCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, std::string_view text) override;
 	void onAttackedByPlayer(const std::shared_ptr<Player> &attackerPlayer);
 	void onSpawn(const Position &position);
 
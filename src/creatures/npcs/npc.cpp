@@ -287,7 +287,7 @@ void Npc::onPlayerDisappear(const std::shared_ptr<Player> &player) {
 	}
 }
 
-void Npc::onCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text) {
+void Npc::onCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, std::string_view text) {
 	Creature::onCreatureSay(creature, type, text);
 
 	if (!creature->getPlayer()) {
@@ -300,7 +300,7 @@ void Npc::onCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses
 		callback.pushSpecificCreature(static_self_cast<Npc>());
 		callback.pushCreature(creature);
 		callback.pushNumber(type);
-		callback.pushString(text);
+		callback.pushString(std::string(text));
 	}
 
 	if (callback.persistLuaState()) {
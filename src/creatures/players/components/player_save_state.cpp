@@ -0,0 +1,178 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "creatures/players/components/player_save_state.hpp"
+
+namespace {
+	// Indexes of the longest strictly increasing run of sids, the ones that can keep their sid
+	std::vector<size_t> longestIncreasing(const std::vector<int32_t> &sids) {
+		// tails[k] is the index of the smallest sid ending a run of length k + 1
+		std::vector<size_t> tails;
+		std::vector<size_t> previous(sids.size(), SIZE_MAX);
+		for (size_t i = 0; i < sids.size(); ++i) {
+			const auto it = std::ranges::lower_bound(tails, sids[i], std::ranges::less {}, [&sids](size_t j) { return sids[j]; });
+			if (it != tails.begin()) {
+				previous[i] = *(it - 1);
+			}
+			if (it == tails.end()) {
+				tails.emplace_back(i);
+			} else {
+				*it = i;
+			}
+		}
+
+		std::vector<size_t> run(tails.size());
+		for (size_t k = tails.size(), i = tails.empty() ? SIZE_MAX : tails.back(); k > 0; --k, i = previous[i]) {
+			run[k - 1] = i;
+		}
+		return run;
+	}
+
+	bool keepSids(const std::vector<const void*> &items, const std::vector<std::pair<size_t, size_t>> &lists, const PlayerSaveState::Sids &persisted, std::vector<int32_t> &sids) {
+		// Every kept sid is known before the new ones are picked, they must not take one of them
+		phmap::flat_hash_set<int32_t> used;
+		for (const auto &[begin, end] : lists) {
+			std::vector<size_t> positions;
+			std::vector<int32_t> known;
+			for (size_t i = begin; i < end; ++i) {
+				if (const auto it = persisted.find(items[i]); it != persisted.end()) {
+					positions.emplace_back(i);
+					known.emplace_back(it->second);
+				}
+			}
+
+			for (const auto k : longestIncreasing(known)) {
+				sids[positions[k]] = known[k];
+				used.emplace(known[k]);
+			}
+		}
+
+		constexpr int64_t UNBOUNDED = static_cast<int64_t>(std::numeric_limits<int32_t>::max()) + 1;
+		std::vector<int64_t> next;
+		for (const auto &[begin, end] : lists) {
+			// Sid of the next kept sibling, the new ones must stay below it
+			next.assign(end - begin, UNBOUNDED);
+			for (size_t i = end - begin; i-- > 1;) {
+				next[i - 1] = sids[begin + i] != 0 ? sids[begin + i] : next[i];
+			}
+
+			int64_t low = PlayerSaveState::FIRST_SID - 1;
+			for (size_t i = begin; i < end; ++i) {
+				if (sids[i] != 0) {
+					low = sids[i];
+					continue;
+				}
+
+				const auto high = next[i - begin];
+				const auto candidate = std::max(low + 1, high == UNBOUNDED ? std::min(low + PlayerSaveState::SID_GAP, high - 1) : low + (high - low) / 2);
+				int64_t sid = 0;
+				for (auto probe = candidate; probe < high && sid == 0; ++probe) {
+					sid = used.contains(static_cast<int32_t>(probe)) ? 0 : probe;
+				}
+				for (auto probe = candidate - 1; probe > low && sid == 0; --probe) {
+					sid = used.contains(static_cast<int32_t>(probe)) ? 0 : probe;
+				}
+				if (sid == 0) {
+					return false;
+				}
+
+				sids[i] = static_cast<int32_t>(sid);
+				used.emplace(sids[i]);
+				low = sid;
+			}
+		}
+		return true;
+	}
+}
+
+size_t PlayerSaveReport::bytes() const {
+	size_t total = 0;
+	for (const auto &section : sections) {
+		total += section.bytes;
+	}
+	return total;
+}
+
+uint32_t PlayerSaveReport::rows() const {
+	uint32_t total = 0;
+	for (const auto &section : sections) {
+		total += section.rows;
+	}
+	return total;
+}
+
+uint32_t PlayerSaveReport::skipped() const {
+	uint32_t total = 0;
+	for (const auto &section : sections) {
+		total += section.written ? 0 : 1;
+	}
+	return total;
+}
+
+const PlayerSaveState::Snapshot* PlayerSaveState::getPersisted(PlayerSaveSection section) const {
+	const auto &snapshot = m_persisted[static_cast<size_t>(section)];
+	return snapshot ? &*snapshot : nullptr;
+}
+
+bool PlayerSaveState::isUnchanged(PlayerSaveSection section, uint64_t fingerprint) const {
+	const auto* snapshot = getPersisted(section);
+	return snapshot && snapshot->fingerprint == fingerprint;
+}
+
+void PlayerSaveState::stage(PlayerSaveSection section, Snapshot snapshot) {
+	m_staged[static_cast<size_t>(section)] = std::move(snapshot);
+}
+
+void PlayerSaveState::begin() {
+	m_report = {};
+	for (auto &staged : m_staged) {
+		staged.reset();
+	}
+}
+
+void PlayerSaveState::commit(double durationMs) {
+	for (size_t i = 0; i < SECTIONS; ++i) {
+		if (m_staged[i]) {
+			m_persisted[i] = std::move(m_staged[i]);
+			m_staged[i].reset();
+		}
+	}
+	m_report.durationMs = durationMs;
+	m_lastReport = m_report;
+}
+
+void PlayerSaveState::discard(double durationMs) {
+	for (size_t i = 0; i < SECTIONS; ++i) {
+		m_persisted[i].reset();
+		m_staged[i].reset();
+	}
+	m_report.durationMs = durationMs;
+	m_lastReport = m_report;
+}
+
+void PlayerSaveState::invalidate() {
+	for (auto &persisted : m_persisted) {
+		persisted.reset();
+	}
+}
+
+std::vector<int32_t> PlayerSaveState::assignSids(const std::vector<const void*> &items, const std::vector<std::pair<size_t, size_t>> &lists, const Sids* persisted) {
+	std::vector<int32_t> sids(items.size(), 0);
+	if (persisted && keepSids(items, lists, *persisted, sids)) {
+		return sids;
+	}
+
+	// Traversal order keeps the siblings in their order, the room starts before the first one
+	const auto count = static_cast<int64_t>(items.size());
+	const int64_t gap = std::clamp<int64_t>((std::numeric_limits<int32_t>::max() - FIRST_SID) / (count + 1), 1, SID_GAP);
+	for (int64_t i = 0; i < count; ++i) {
+		sids[i] = static_cast<int32_t>(FIRST_SID - 1 + (i + 1) * gap);
+	}
+	return sids;
+}
@@ -0,0 +1,161 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#ifndef USE_PRECOMPILED_HEADERS
+	#include <array>
+	#include <cstdint>
+	#include <optional>
+	#include <vector>
+	#include <parallel_hashmap/phmap.h>
+#endif
+
+/**
+ * @brief Tables of a player save that can be skipped or diffed.
+ */
+enum class PlayerSaveSection : uint8_t {
+	Items,
+	DepotItems,
+	RewardItems,
+	InboxItems,
+	Stash,
+	Spells,
+	Kills,
+	ForgeHistory,
+	Bosstiary,
+	Count
+};
+
+/**
+ * @brief What a save did with one section.
+ */
+struct PlayerSaveSectionReport {
+	// False when the section was unchanged and no query was sent
+	bool written = false;
+	// Rows inserted or updated
+	uint32_t rows = 0;
+	// Rows deleted, a full rewrite counts as one
+	uint32_t deletes = 0;
+	// Size of the row values sent
+	size_t bytes = 0;
+};
+
+/**
+ * @brief Size and time of the last save of a player.
+ */
+struct PlayerSaveReport {
+	std::array<PlayerSaveSectionReport, static_cast<size_t>(PlayerSaveSection::Count)> sections {};
+	double durationMs = 0;
+
+	PlayerSaveSectionReport &operator[](PlayerSaveSection section) {
+		return sections[static_cast<size_t>(section)];
+	}
+
+	size_t bytes() const;
+	uint32_t rows() const;
+	uint32_t skipped() const;
+};
+
+/**
+ * @brief Remembers what the last save of each section wrote to the database.
+ *
+ * A section is described by a fingerprint of its content and, for the tables
+ * that are diffed row by row, a hash per row key. A save compares the new
+ * snapshot against the persisted one: an unchanged fingerprint skips the
+ * section, otherwise only the rows whose hash differs are written.
+ *
+ * Snapshots produced during a save are staged and only become the persisted
+ * ones once its transaction committed, a failed save forgets everything so the
+ * next one rewrites the sections in full.
+ */
+class PlayerSaveState {
+public:
+	// Row key (sid, item id...) > hash of the row content
+	using Rows = phmap::flat_hash_map<int64_t, uint64_t>;
+	// Identity of a saved item (its address) > sid it was written with
+	using Sids = phmap::flat_hash_map<const void*, int32_t>;
+
+	struct Snapshot {
+		uint64_t fingerprint = 0;
+		Rows rows;
+		// Item tables only, the items still there keep their sid on the next save
+		Sids sids;
+	};
+
+	// Lower sids are the slots and depot ids the top-level items are stored under
+	static constexpr int32_t FIRST_SID = 101;
+	// Room left between siblings numbered from scratch, for the items added later
+	static constexpr int32_t SID_GAP = 1024;
+
+	/**
+	 * @brief Sid of each item of an item table, stable across the saves of a session.
+	 *
+	 * Sids order the siblings when the items are loaded back. The items of the last
+	 * save still in the same relative order keep their sid and the others get a free
+	 * one between their neighbours, so adding, removing or moving an item rewrites its
+	 * own row only. Everything is numbered again when there is no room left.
+	 * @param items Identities of the items in traversal order.
+	 * @param lists [begin, end) ranges of siblings within items, in their order.
+	 * @param persisted Sids of the last committed save, nullptr numbers everything.
+	 */
+	static std::vector<int32_t> assignSids(const std::vector<const void*> &items, const std::vector<std::pair<size_t, size_t>> &lists, const Sids* persisted);
+
+	/**
+	 * @brief Snapshot of the last committed save of a section.
+	 * @return nullptr if the section was not saved since the player was loaded.
+	 */
+	const Snapshot* getPersisted(PlayerSaveSection section) const;
+
+	/**
+	 * @brief Whether the last committed save wrote exactly this content.
+	 */
+	bool isUnchanged(PlayerSaveSection section, uint64_t fingerprint) const;
+
+	/**
+	 * @brief Keeps the snapshot written by the running save until it commits.
+	 */
+	void stage(PlayerSaveSection section, Snapshot snapshot);
+
+	/**
+	 * @brief Starts a new save, resetting the report and any staged snapshot.
+	 */
+	void begin();
+
+	/**
+	 * @brief Promotes the staged snapshots after the save transaction committed.
+	 */
+	void commit(double durationMs);
+
+	/**
+	 * @brief Forgets every snapshot, the database content is unknown after a failed save.
+	 */
+	void discard(double durationMs);
+
+	/**
+	 * @brief Forgets the persisted snapshots so the next save rewrites every section.
+	 */
+	void invalidate();
+
+	PlayerSaveReport &report() {
+		return m_report;
+	}
+
+	const PlayerSaveReport &getLastReport() const {
+		return m_lastReport;
+	}
+
+private:
+	static constexpr size_t SECTIONS = static_cast<size_t>(PlayerSaveSection::Count);
+
+	std::array<std::optional<Snapshot>, SECTIONS> m_persisted;
+	std::array<std::optional<Snapshot>, SECTIONS> m_staged;
+	PlayerSaveReport m_report;
+	PlayerSaveReport m_lastReport;
+};
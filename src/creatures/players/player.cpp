@@ -146,7 +146,7 @@ bool Player::isPushable() {
 	return Creature::isPushable();
 }
 
-std::shared_ptr<Task> Player::createPlayerTask(uint32_t delay, std::function<void(void)> f, const std::string &context) {
+std::shared_ptr<Task> Player::createPlayerTask(uint32_t delay, std::function<void(void)> f, std::string_view context) {
 	return std::make_shared<Task>(std::move(f), context, delay);
 }
 
@@ -2035,6 +2035,12 @@ void Player::sendCreatureHealth(const std::shared_ptr<Creature> &creature) const
 	}
 }
 
+void Player::sendCreatureHealth(const std::shared_ptr<Creature> &creature, ProtocolBroadcast &broadcast) const {
+	if (client) {
+		client->sendCreatureHealth(creature, broadcast);
+	}
+}
+
 void Player::sendPartyCreatureUpdate(const std::shared_ptr<Creature> &creature) const {
 	if (client) {
 		client->sendPartyCreatureUpdate(creature);
@@ -2089,6 +2095,12 @@ void Player::sendDistanceShoot(const Position &from, const Position &to, uint16_
 	}
 }
 
+void Player::sendDistanceShoot(const Position &from, const Position &to, uint16_t type, ProtocolBroadcast &broadcast) const {
+	if (client) {
+		client->sendDistanceShoot(from, to, type, broadcast);
+	}
+}
+
 void Player::sendHouseWindow(const std::shared_ptr<House> &house, uint32_t listId) const {
 	if (!client) {
 		return;
@@ -2184,6 +2196,18 @@ void Player::sendMagicEffect(const Position &pos, uint16_t type) const {
 	}
 }
 
+void Player::sendMagicEffect(const Position &pos, uint16_t type, ProtocolBroadcast &broadcast) const {
+	if (client) {
+		client->sendMagicEffect(pos, type, broadcast);
+	}
+}
+
+void Player::sendBroadcast(ProtocolBroadcast &broadcast) const {
+	if (client) {
+		client->sendBroadcast(broadcast);
+	}
+}
+
 void Player::removeMagicEffect(const Position &pos, uint16_t type) const {
 	if (client) {
 		client->removeMagicEffect(pos, type);
@@ -2278,7 +2302,7 @@ void Player::sendTextWindow(const std::shared_ptr<Item> &item, uint16_t maxlen,
 	}
 }
 
-void Player::sendToChannel(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, uint16_t channelId) const {
+void Player::sendToChannel(const std::shared_ptr<Creature> &creature, SpeakClasses type, std::string_view text, uint16_t channelId) const {
 	if (client) {
 		client->sendToChannel(creature, type, text, channelId);
 	}
@@ -8115,7 +8139,25 @@ void Player::sendCreatureTurn(const std::shared_ptr<Creature> &creature) {
 	}
 }
 
-void Player::sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos) const {
+void Player::sendCreatureTurn(const std::shared_ptr<Creature> &creature, ProtocolBroadcast &broadcast) {
+	if (!creature) {
+		return;
+	}
+
+	const auto &tile = creature->getTile();
+	if (!tile) {
+		return;
+	}
+
+	if (client && canSeeCreature(creature)) {
+		const int32_t stackpos = tile->getStackposOfCreature(static_self_cast<Player>(), creature);
+		if (stackpos != -1) {
+			client->sendCreatureTurn(creature, stackpos, broadcast);
+		}
+	}
+}
+
+void Player::sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, std::string_view text, const Position* pos) const {
 	if (client) {
 		client->sendCreatureSay(creature, type, text, pos);
 	}
@@ -8127,7 +8169,7 @@ void Player::sendCreatureReload(const std::shared_ptr<Creature> &creature) const
 	}
 }
 
-void Player::sendPrivateMessage(const std::shared_ptr<Player> &speaker, SpeakClasses type, const std::string &text) const {
+void Player::sendPrivateMessage(const std::shared_ptr<Player> &speaker, SpeakClasses type, std::string_view text) const {
 	if (client) {
 		client->sendPrivateMessage(speaker, type, text);
 	}
@@ -11154,6 +11196,15 @@ const PlayerStorage &Player::storage() const {
 	return m_storage;
 }
 
+// Save state interface
+PlayerSaveState &Player::saveState() {
+	return m_saveState;
+}
+
+const PlayerSaveState &Player::saveState() const {
+	return m_saveState;
+}
+
 void Player::sendLootMessage(const std::string &message) const {
 	const auto &party = getParty();
 	if (!party) {
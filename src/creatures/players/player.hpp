@@ -22,6 +22,7 @@
 #include "creatures/players/components/player_achievement.hpp"
 #include "creatures/players/components/player_badge.hpp"
 #include "creatures/players/components/player_cyclopedia.hpp"
+#include "creatures/players/components/player_save_state.hpp"
 #include "creatures/players/components/player_storage.hpp"
 #include "creatures/players/components/player_title.hpp"
 #include "creatures/players/components/wheel/player_wheel.hpp"
@@ -35,6 +36,7 @@ class House;
 class NetworkMessage;
 class Weapon;
 class ProtocolGame;
+class ProtocolBroadcast;
 class Party;
 class Task;
 class Guild;
@@ -179,7 +181,7 @@ public:
 		return static_self_cast<Player>();
 	}
 
-	static std::shared_ptr<Task> createPlayerTask(uint32_t delay, std::function<void(void)> f, const std::string &context);
+	static std::shared_ptr<Task> createPlayerTask(uint32_t delay, std::function<void(void)> f, std::string_view context);
 
 	void setID() override;
 
@@ -827,9 +829,10 @@ public:
 	void sendCreatureAppear(const std::shared_ptr<Creature> &creature, const Position &pos, bool isLogin);
 	void sendCreatureMove(const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport) const;
 	void sendCreatureTurn(const std::shared_ptr<Creature> &creature);
-	void sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos = nullptr) const;
+	void sendCreatureTurn(const std::shared_ptr<Creature> &creature, ProtocolBroadcast &broadcast);
+	void sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, std::string_view text, const Position* pos = nullptr) const;
 	void sendCreatureReload(const std::shared_ptr<Creature> &creature) const;
-	void sendPrivateMessage(const std::shared_ptr<Player> &speaker, SpeakClasses type, const std::string &text) const;
+	void sendPrivateMessage(const std::shared_ptr<Player> &speaker, SpeakClasses type, std::string_view text) const;
 	void sendCreatureSquare(const std::shared_ptr<Creature> &creature, SquareColor_t color) const;
 	void sendCreatureChangeOutfit(const std::shared_ptr<Creature> &creature, const Outfit_t &outfit) const;
 	void sendCreatureChangeVisible(const std::shared_ptr<Creature> &creature, bool visible);
@@ -909,6 +912,7 @@ public:
 	void sendCancelWalk() const;
 	void sendChangeSpeed(const std::shared_ptr<Creature> &creature, uint16_t newSpeed) const;
 	void sendCreatureHealth(const std::shared_ptr<Creature> &creature) const;
+	void sendCreatureHealth(const std::shared_ptr<Creature> &creature, ProtocolBroadcast &broadcast) const;
 	void sendPartyCreatureUpdate(const std::shared_ptr<Creature> &creature) const;
 	void sendPartyCreatureShield(const std::shared_ptr<Creature> &creature) const;
 	void sendPartyCreatureSkull(const std::shared_ptr<Creature> &creature) const;
@@ -918,6 +922,7 @@ public:
 	void sendPartyPlayerVocation(const std::shared_ptr<Player> &player) const;
 	void sendPlayerVocation(const std::shared_ptr<Player> &player) const;
 	void sendDistanceShoot(const Position &from, const Position &to, uint16_t type) const;
+	void sendDistanceShoot(const Position &from, const Position &to, uint16_t type, ProtocolBroadcast &broadcast) const;
 	void sendHouseWindow(const std::shared_ptr<House> &house, uint32_t listId) const;
 	void sendCreatePrivateChannel(uint16_t channelId, const std::string &channelName) const;
 	void sendClosePrivate(uint16_t channelId);
@@ -928,6 +933,8 @@ public:
 	void sendClientCheck() const;
 	void sendGameNews() const;
 	void sendMagicEffect(const Position &pos, uint16_t type) const;
+	void sendMagicEffect(const Position &pos, uint16_t type, ProtocolBroadcast &broadcast) const;
+	void sendBroadcast(ProtocolBroadcast &broadcast) const;
 	void removeMagicEffect(const Position &pos, uint16_t type) const;
 	void sendPing();
 	void sendPingBack() const;
@@ -939,7 +946,7 @@ public:
 	void sendTextMessage(const TextMessage &message) const;
 	void sendReLoginWindow(uint8_t unfairFightReduction) const;
 	void sendTextWindow(const std::shared_ptr<Item> &item, uint16_t maxlen, bool canWrite) const;
-	void sendToChannel(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, uint16_t channelId) const;
+	void sendToChannel(const std::shared_ptr<Creature> &creature, SpeakClasses type, std::string_view text, uint16_t channelId) const;
 	void sendShop(const std::shared_ptr<Npc> &npc) const;
 	void sendSaleItemList(const std::map<uint16_t, uint16_t> &inventoryMap) const;
 	void sendCloseShop() const;
@@ -1372,6 +1379,9 @@ public:
 	PlayerStorage &storage();
 	const PlayerStorage &storage() const;
 
+	PlayerSaveState &saveState();
+	const PlayerSaveState &saveState() const;
+
 	void sendLootMessage(const std::string &message) const;
 
 	std::shared_ptr<Container> getLootPouch();
@@ -1747,6 +1757,7 @@ private:
 	AnimusMastery m_animusMastery;
 	PlayerAttachedEffects m_playerAttachedEffects;
 	PlayerStorage m_storage;
+	PlayerSaveState m_saveState;
 	Uchiha::StrainSystem m_strainSystem;
 	Uchiha::SharinganSystem m_sharinganSystem;
 
@@ -14,9 +14,22 @@
 #include "lib/metrics/metrics.hpp"
 #include "utils/tools.hpp"
 
+thread_local MYSQL* Database::transactionHandle = nullptr;
+thread_local uint32_t Database::transactionDepth = 0;
+thread_local bool Database::transactionRollbackOnly = false;
+thread_local uint64_t Database::lastInsertId = 0;
+thread_local std::vector<std::string>* Database::capturedQueries = nullptr;
+thread_local bool Database::captureRolledBack = false;
+
 Database::~Database() {
-	if (handle != nullptr) {
-		mysql_close(handle);
+	for (const auto &[connection, cache] : statements) {
+		for (const auto &[query, statement] : cache) {
+			mysql_stmt_close(statement);
+		}
+	}
+
+	for (MYSQL* connection : connections) {
+		mysql_close(connection);
 	}
 }
 
@@ -25,34 +38,47 @@ Database &Database::getInstance() {
 }
 
 bool Database::connect() {
-	return connect(&g_configManager().getString(MYSQL_HOST), &g_configManager().getString(MYSQL_USER), &g_configManager().getString(MYSQL_PASS), &g_configManager().getString(MYSQL_DB), g_configManager().getNumber(SQL_PORT), &g_configManager().getString(MYSQL_SOCK));
+	const auto poolSize = static_cast<size_t>(std::max<int32_t>(g_configManager().getNumber(MYSQL_POOL_SIZE), 1));
+	return connect(&g_configManager().getString(MYSQL_HOST), &g_configManager().getString(MYSQL_USER), &g_configManager().getString(MYSQL_PASS), &g_configManager().getString(MYSQL_DB), g_configManager().getNumber(SQL_PORT), &g_configManager().getString(MYSQL_SOCK), poolSize);
 }
 
-bool Database::connect(const std::string* host, const std::string* user, const std::string* password, const std::string* database, uint32_t port, const std::string* sock) {
-	// connection handle initialization
-	handle = mysql_init(nullptr);
-	if (!handle) {
-		g_logger().error("Failed to initialize MySQL connection handle.");
-		return false;
-	}
-
+bool Database::connect(const std::string* host, const std::string* user, const std::string* password, const std::string* database, uint32_t port, const std::string* sock, size_t poolSize /* = 1*/) {
 	if (host->empty() || user->empty() || password->empty() || database->empty() || port <= 0) {
 		g_logger().warn("MySQL host, user, password, database or port not provided");
 	}
 
-	// automatic reconnect
-	bool reconnect = true;
-	mysql_options(handle, MYSQL_OPT_RECONNECT, &reconnect);
+	poolSize = std::max<size_t>(poolSize, 1);
+	connections.reserve(poolSize);
+	while (connections.size() < poolSize) {
+		// connection handle initialization
+		MYSQL* handle = mysql_init(nullptr);
+		if (!handle) {
+			g_logger().error("Failed to initialize MySQL connection handle.");
+			return false;
+		}
+		connections.push_back(handle);
+		statements.try_emplace(handle);
+
+		// automatic reconnect
+		bool reconnect = true;
+		mysql_options(handle, MYSQL_OPT_RECONNECT, &reconnect);
 
-	// Remove ssl verification
-	bool ssl_enabled = false;
-	mysql_options(handle, MYSQL_OPT_SSL_VERIFY_SERVER_CERT, &ssl_enabled);
+		// Remove ssl verification
+		bool ssl_enabled = false;
+		mysql_options(handle, MYSQL_OPT_SSL_VERIFY_SERVER_CERT, &ssl_enabled);
 
-	// connects to database
-	if (!mysql_real_connect(handle, host->c_str(), user->c_str(), password->c_str(), database->c_str(), port, sock->c_str(), 0)) {
-		g_logger().error("MySQL Error Message: {}", mysql_error(handle));
-		return false;
+		// connects to database
+		if (!mysql_real_connect(handle, host->c_str(), user->c_str(), password->c_str(), database->c_str(), port, sock->c_str(), 0)) {
+			g_logger().error("MySQL Error Message: {}", mysql_error(handle));
+			return false;
+		}
+	}
+
+	{
+		std::scoped_lock lock(poolMutex);
+		freeConnections = connections;
 	}
+	g_logger().debug("MySQL connection pool opened with {} connections", connections.size());
 
 	DBResult_ptr result = storeQuery("SHOW VARIABLES LIKE 'max_allowed_packet'");
 	if (result) {
@@ -61,6 +87,66 @@ bool Database::connect(const std::string* host, const std::string* user, const s
 	return true;
 }
 
+Database::ConnectionLease::ConnectionLease(Database &db) :
+	db(db), handle(transactionHandle) {
+	if (!handle) {
+		handle = db.acquireConnection();
+		pooled = handle != nullptr;
+	}
+}
+
+Database::ConnectionLease::~ConnectionLease() {
+	if (pooled) {
+		db.releaseConnection(handle);
+	}
+}
+
+MYSQL* Database::acquireConnection() {
+	std::unique_lock lock(poolMutex);
+	if (connections.empty()) {
+		return nullptr;
+	}
+
+	if (freeConnections.empty()) {
+		metrics::lock_latency measureLock("database");
+		const auto start = std::chrono::steady_clock::now();
+		poolCondition.wait(lock, [this] { return !freeConnections.empty(); });
+		measureLock.stop();
+
+		const auto waited = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+		waits.fetch_add(1, std::memory_order_relaxed);
+		waitTimeUs.fetch_add(waited, std::memory_order_relaxed);
+		if (waited > maxWaitTimeUs.load(std::memory_order_relaxed)) {
+			maxWaitTimeUs.store(waited, std::memory_order_relaxed);
+		}
+	}
+
+	MYSQL* handle = freeConnections.back();
+	freeConnections.pop_back();
+	return handle;
+}
+
+void Database::releaseConnection(MYSQL* connection) {
+	{
+		std::scoped_lock lock(poolMutex);
+		freeConnections.push_back(connection);
+	}
+	poolCondition.notify_one();
+}
+
+DatabaseStats Database::getStats() {
+	DatabaseStats stats;
+	stats.queries = queries.load(std::memory_order_relaxed);
+	stats.waits = waits.load(std::memory_order_relaxed);
+	stats.waitTimeUs = waitTimeUs.load(std::memory_order_relaxed);
+	stats.maxWaitTimeUs = maxWaitTimeUs.load(std::memory_order_relaxed);
+
+	std::scoped_lock lock(poolMutex);
+	stats.poolSize = connections.size();
+	stats.inUse = connections.size() - freeConnections.size();
+	return stats;
+}
+
 void Database::createDatabaseBackup(bool compress) const {
 	if (!g_configManager().getBoolean(MYSQL_DB_BACKUP)) {
 		return;
@@ -159,52 +245,107 @@ void Database::createDatabaseBackup(bool compress) const {
 }
 
 bool Database::beginTransaction() {
-	if (!executeQuery("BEGIN")) {
-		return false;
+	if (capturedQueries) {
+		return true;
 	}
-	metrics::lock_latency measureLock("database");
-	databaseLock.lock();
-	measureLock.stop();
 
-	return true;
-}
+	// Nested transactions are flattened into the outermost one, which decides whether to commit
+	if (transactionHandle) {
+		++transactionDepth;
+		return true;
+	}
 
-bool Database::rollback() {
+	MYSQL* handle = acquireConnection();
 	if (!handle) {
 		g_logger().error("Database not initialized!");
 		return false;
 	}
 
-	if (mysql_rollback(handle) != 0) {
-		g_logger().error("Message: {}", mysql_error(handle));
-		databaseLock.unlock();
+	transactionHandle = handle;
+	transactionDepth = 1;
+	transactionRollbackOnly = false;
+	if (!executeQuery("BEGIN")) {
+		transactionHandle = nullptr;
+		transactionDepth = 0;
+		releaseConnection(handle);
 		return false;
 	}
 
-	databaseLock.unlock();
 	return true;
 }
 
+bool Database::rollback() {
+	return endTransaction(false);
+}
+
 bool Database::commit() {
-	if (!handle) {
-		g_logger().error("Database not initialized!");
+	return endTransaction(true);
+}
+
+bool Database::endTransaction(bool success) {
+	if (capturedQueries) {
+		captureRolledBack = captureRolledBack || !success;
+		return true;
+	}
+
+	if (!transactionHandle) {
+		g_logger().error("Database transaction not started!");
 		return false;
 	}
-	if (mysql_commit(handle) != 0) {
+
+	// A nested rollback can't undo only its own writes, the outermost transaction is rolled back instead
+	if (!success) {
+		transactionRollbackOnly = true;
+	}
+	if (--transactionDepth > 0) {
+		return true;
+	}
+
+	MYSQL* handle = std::exchange(transactionHandle, nullptr);
+	const bool commit = !std::exchange(transactionRollbackOnly, false);
+	if (success && !commit) {
+		g_logger().error("[{}] A nested transaction was rolled back, rolling back the whole transaction", __FUNCTION__);
+	}
+
+	const bool ended = (commit ? mysql_commit(handle) : mysql_rollback(handle)) == 0;
+	if (!ended) {
 		g_logger().error("Message: {}", mysql_error(handle));
-		databaseLock.unlock();
+	}
+
+	releaseConnection(handle);
+	return ended && (commit || !success);
+}
+
+uint64_t Database::getLastInsertId() const {
+	if (capturedQueries) {
+		// The captured inserts run later, the id of an earlier one would be used instead
+		g_logger().error("[{}] The last insert id is not known while the queries are captured, the captured save is dropped", __FUNCTION__);
+		captureRolledBack = true;
+		return 0;
+	}
+	return lastInsertId;
+}
+
+bool Database::beginCapture(std::vector<std::string> &queries) {
+	if (transactionHandle || capturedQueries) {
 		return false;
 	}
 
-	databaseLock.unlock();
+	capturedQueries = &queries;
+	captureRolledBack = false;
 	return true;
 }
 
+bool Database::endCapture() {
+	capturedQueries = nullptr;
+	return !std::exchange(captureRolledBack, false);
+}
+
 bool Database::isRecoverableError(unsigned int error) {
 	return error == CR_SERVER_LOST || error == CR_SERVER_GONE_ERROR || error == CR_CONN_HOST_ERROR || error == 1053 /*ER_SERVER_SHUTDOWN*/ || error == CR_CONNECTION_ERROR;
 }
 
-bool Database::retryQuery(std::string_view query, int retries) {
+bool Database::retryQuery(MYSQL* handle, std::string_view query, int retries) {
 	while (retries > 0 && mysql_query(handle, query.data()) != 0) {
 		g_logger().error("Query: {}", query.substr(0, 256));
 		g_logger().error("MySQL error [{}]: {}", mysql_errno(handle), mysql_error(handle));
@@ -223,34 +364,39 @@ bool Database::retryQuery(std::string_view query, int retries) {
 }
 
 bool Database::executeQuery(std::string_view query) {
-	if (!handle) {
-		g_logger().error("Database not initialized!");
-		return false;
+	if (capturedQueries) {
+		capturedQueries->emplace_back(query);
+		return true;
 	}
 
 	g_logger().trace("Executing Query: {}", query);
 
-	metrics::lock_latency measureLock("database");
-	std::scoped_lock lock { databaseLock };
-	measureLock.stop();
+	ConnectionLease connection(*this);
+	MYSQL* handle = connection.get();
+	if (!handle) {
+		g_logger().error("Database not initialized!");
+		return false;
+	}
+	queries.fetch_add(1, std::memory_order_relaxed);
 
 	metrics::query_latency measure(query.substr(0, 50));
-	bool success = retryQuery(query, 10);
+	bool success = retryQuery(handle, query, 10);
+	lastInsertId = static_cast<uint64_t>(mysql_insert_id(handle));
 	mysql_free_result(mysql_store_result(handle));
 
 	return success;
 }
 
 DBResult_ptr Database::storeQuery(std::string_view query) {
+	g_logger().trace("Storing Query: {}", query);
+
+	ConnectionLease connection(*this);
+	MYSQL* handle = connection.get();
 	if (!handle) {
 		g_logger().error("Database not initialized!");
 		return nullptr;
 	}
-	g_logger().trace("Storing Query: {}", query);
-
-	metrics::lock_latency measureLock("database");
-	std::scoped_lock lock { databaseLock };
-	measureLock.stop();
+	queries.fetch_add(1, std::memory_order_relaxed);
 
 	metrics::query_latency measure(query.substr(0, 50));
 retry:
@@ -264,7 +410,7 @@ retry:
 		goto retry;
 	}
 
-	// Retrieving results of query
+	// Retrieving results of query, the whole set is buffered on the client so the connection can go back to the pool
 	MYSQL_RES* res = mysql_store_result(handle);
 	if (res != nullptr) {
 		DBResult_ptr result = std::make_shared<DBResult>(res);
@@ -276,6 +422,137 @@ retry:
 	return nullptr;
 }
 
+bool Database::executeStatement(const DBStatement &statement) {
+	if (capturedQueries) {
+		capturedQueries->emplace_back(statement.toQuery());
+		return true;
+	}
+
+	g_logger().trace("Executing Statement: {}", statement.query);
+
+	ConnectionLease connection(*this);
+	MYSQL* handle = connection.get();
+	if (!handle) {
+		g_logger().error("Database not initialized!");
+		return false;
+	}
+	queries.fetch_add(1, std::memory_order_relaxed);
+
+	metrics::query_latency measure(std::string_view(statement.query).substr(0, 50));
+	MYSQL_STMT* stmt = runStatement(handle, statement, false);
+	if (!stmt) {
+		return false;
+	}
+
+	lastInsertId = static_cast<uint64_t>(mysql_stmt_insert_id(stmt));
+	mysql_stmt_free_result(stmt);
+	return true;
+}
+
+DBResult_ptr Database::storeStatement(const DBStatement &statement) {
+	g_logger().trace("Storing Statement: {}", statement.query);
+
+	ConnectionLease connection(*this);
+	MYSQL* handle = connection.get();
+	if (!handle) {
+		g_logger().error("Database not initialized!");
+		return nullptr;
+	}
+	queries.fetch_add(1, std::memory_order_relaxed);
+
+	metrics::query_latency measure(std::string_view(statement.query).substr(0, 50));
+	MYSQL_STMT* stmt = runStatement(handle, statement, true);
+	if (!stmt) {
+		return nullptr;
+	}
+
+	MYSQL_RES* metadata = mysql_stmt_result_metadata(stmt);
+	if (!metadata) {
+		mysql_stmt_free_result(stmt);
+		return nullptr;
+	}
+
+	// Reads every row, so the statement is free for the next query of the connection
+	auto result = std::make_shared<DBResult>(stmt, metadata);
+	if (!result->hasNext()) {
+		return nullptr;
+	}
+	return result;
+}
+
+MYSQL_STMT* Database::runStatement(MYSQL* handle, const DBStatement &statement, bool storeResult) {
+	auto binds = statement.makeBinds();
+	for (int retries = 10; retries > 0; --retries) {
+		unsigned int error = 0;
+		MYSQL_STMT* stmt = prepareStatement(handle, statement.query);
+		if (!stmt) {
+			error = mysql_errno(handle);
+		} else if (mysql_stmt_bind_param(stmt, binds.data()) != 0 || mysql_stmt_execute(stmt) != 0 || (storeResult && mysql_stmt_store_result(stmt) != 0)) {
+			error = mysql_stmt_errno(stmt);
+			g_logger().error("Query: {}", std::string_view(statement.query).substr(0, 256));
+			g_logger().error("MySQL error [{}]: {}", error, mysql_stmt_error(stmt));
+		} else {
+			return stmt;
+		}
+
+		// A reconnect drops the statements prepared on the connection, prepare it again
+		const bool recoverable = isRecoverableError(error);
+		if (!recoverable && error != 1243 /*ER_UNKNOWN_STMT_HANDLER*/ && error != 1615 /*ER_NEED_REPREPARE*/) {
+			return nullptr;
+		}
+
+		discardStatement(handle, statement.query);
+		if (recoverable) {
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+		}
+	}
+
+	g_logger().error("Statement {} failed after {} retries.", statement.query, 10);
+	return nullptr;
+}
+
+MYSQL_STMT* Database::prepareStatement(MYSQL* handle, const std::string &query) {
+	auto &cache = statements[handle];
+	if (const auto it = cache.find(query); it != cache.end()) {
+		return it->second;
+	}
+
+	MYSQL_STMT* stmt = mysql_stmt_init(handle);
+	if (!stmt) {
+		g_logger().error("Failed to initialize MySQL statement handle.");
+		return nullptr;
+	}
+
+	// Lets DBResult size its column buffers from the stored result
+	std::remove_pointer_t<decltype(MYSQL_BIND::is_null)> updateMaxLength = true;
+	mysql_stmt_attr_set(stmt, STMT_ATTR_UPDATE_MAX_LENGTH, &updateMaxLength);
+	if (mysql_stmt_prepare(stmt, query.data(), static_cast<unsigned long>(query.size())) != 0) {
+		g_logger().error("Query: {}", std::string_view(query).substr(0, 256));
+		g_logger().error("MySQL error [{}]: {}", mysql_stmt_errno(stmt), mysql_stmt_error(stmt));
+		mysql_stmt_close(stmt);
+		return nullptr;
+	}
+
+	if (cache.size() >= MAX_CACHED_STATEMENTS) {
+		g_logger().warn("More than {} prepared statements on a database connection, are values embedded in the query?", MAX_CACHED_STATEMENTS);
+		for (const auto &[cachedQuery, cachedStatement] : cache) {
+			mysql_stmt_close(cachedStatement);
+		}
+		cache.clear();
+	}
+
+	cache.emplace(query, stmt);
+	return stmt;
+}
+
+void Database::discardStatement(MYSQL* handle, const std::string &query) {
+	auto &cache = statements[handle];
+	if (const auto it = cache.find(query); it != cache.end()) {
+		mysql_stmt_close(it->second);
+		cache.erase(it);
+	}
+}
+
 std::string Database::escapeString(const std::string &s) const {
 	std::string::size_type len = s.length();
 	auto length = static_cast<uint32_t>(len);
@@ -295,7 +572,8 @@ std::string Database::escapeBlob(const char* s, uint32_t length) const {
 
 	if (length != 0) {
 		std::string output(maxLength, '\0');
-		size_t escapedLength = mysql_real_escape_string(handle, &output[0], s, length);
+		// Only reads the connection character set, which is the same for the whole pool
+		size_t escapedLength = mysql_real_escape_string(connections.front(), &output[0], s, length);
 		output.resize(escapedLength);
 		escaped.append(output);
 	}
@@ -312,41 +590,189 @@ DBResult::DBResult(MYSQL_RES* res) {
 	const MYSQL_FIELD* fields = mysql_fetch_fields(handle);
 	for (size_t i = 0; i < num_fields; i++) {
 		listNames[fields[i].name] = i;
+		columnNames.emplace_back(fields[i].name);
 	}
 	row = mysql_fetch_row(handle);
 }
 
+DBResult::DBResult(MYSQL_STMT* stmt, MYSQL_RES* metadata) :
+	handle(metadata), binary(true) {
+	using BindFlag = std::remove_pointer_t<decltype(MYSQL_BIND::is_null)>;
+	struct Output {
+		int64_t number = 0;
+		double real = 0;
+		std::string buffer;
+		unsigned long length = 0;
+		BindFlag isNull = false;
+		BindFlag error = false;
+	};
+
+	const size_t numFields = mysql_num_fields(handle);
+	const MYSQL_FIELD* fields = mysql_fetch_fields(handle);
+	std::vector<MYSQL_BIND> binds(numFields);
+	std::vector<Output> outputs(numFields);
+	for (size_t i = 0; i < numFields; i++) {
+		listNames[fields[i].name] = i;
+		columnNames.emplace_back(fields[i].name);
+
+		auto &bind = binds[i];
+		auto &output = outputs[i];
+		switch (fields[i].type) {
+			case MYSQL_TYPE_TINY:
+			case MYSQL_TYPE_SHORT:
+			case MYSQL_TYPE_INT24:
+			case MYSQL_TYPE_LONG:
+			case MYSQL_TYPE_LONGLONG:
+			case MYSQL_TYPE_YEAR:
+				bind.buffer_type = MYSQL_TYPE_LONGLONG;
+				bind.buffer = &output.number;
+				bind.is_unsigned = (fields[i].flags & UNSIGNED_FLAG) != 0;
+				break;
+			case MYSQL_TYPE_FLOAT:
+			case MYSQL_TYPE_DOUBLE:
+				bind.buffer_type = MYSQL_TYPE_DOUBLE;
+				bind.buffer = &output.real;
+				break;
+			default:
+				// Strings, blobs, decimals and dates, max_length is the longest value of the stored result
+				output.buffer.resize(std::max<unsigned long>(fields[i].max_length, 1));
+				bind.buffer_type = MYSQL_TYPE_STRING;
+				bind.buffer = output.buffer.data();
+				bind.buffer_length = static_cast<unsigned long>(output.buffer.size());
+				break;
+		}
+		bind.length = &output.length;
+		bind.is_null = &output.isNull;
+		bind.error = &output.error;
+	}
+
+	if (mysql_stmt_bind_result(stmt, binds.data()) != 0) {
+		g_logger().error("MySQL error [{}]: {}", mysql_stmt_errno(stmt), mysql_stmt_error(stmt));
+		mysql_stmt_free_result(stmt);
+		return;
+	}
+
+	cells.reserve(static_cast<size_t>(mysql_stmt_num_rows(stmt)) * numFields);
+	int status;
+	while ((status = mysql_stmt_fetch(stmt)) == 0 || status == MYSQL_DATA_TRUNCATED) {
+		for (size_t i = 0; i < numFields; i++) {
+			const auto &bind = binds[i];
+			const auto &output = outputs[i];
+			auto &cell = cells.emplace_back();
+			if (output.isNull) {
+				continue;
+			}
+
+			if (bind.buffer_type == MYSQL_TYPE_LONGLONG) {
+				cell.type = bind.is_unsigned ? BinaryCell::Type::Unsigned : BinaryCell::Type::Signed;
+				cell.number = output.number;
+			} else if (bind.buffer_type == MYSQL_TYPE_DOUBLE) {
+				cell.type = BinaryCell::Type::Double;
+				cell.real = output.real;
+			} else {
+				cell.type = BinaryCell::Type::Bytes;
+				cell.offset = bytes.size();
+				cell.length = output.length;
+				if (output.length <= output.buffer.size()) {
+					bytes.append(output.buffer.data(), output.length);
+				} else {
+					// Should not happen thanks to max_length, fetch the whole value on its own
+					std::string value(output.length, '\0');
+					MYSQL_BIND column {};
+					column.buffer_type = MYSQL_TYPE_STRING;
+					column.buffer = value.data();
+					column.buffer_length = output.length;
+					mysql_stmt_fetch_column(stmt, &column, static_cast<unsigned int>(i), 0);
+					bytes.append(value);
+				}
+				bytes.push_back('\0');
+			}
+		}
+		++rowCount;
+	}
+
+	if (status == 1) {
+		g_logger().error("MySQL error [{}]: {}", mysql_stmt_errno(stmt), mysql_stmt_error(stmt));
+	}
+	mysql_stmt_free_result(stmt);
+}
+
 DBResult::~DBResult() {
 	mysql_free_result(handle);
 }
 
-std::string DBResult::getString(const std::string &s) const {
+int32_t DBResult::findColumn(const std::string &s) const {
 	auto it = listNames.find(s);
 	if (it == listNames.end()) {
+		return -1;
+	}
+	return static_cast<int32_t>(it->second);
+}
+
+std::string DBResult::getString(const std::string &s) const {
+	const auto column = findColumn(s);
+	if (column < 0) {
 		g_logger().error("Column '{}' does not exist in result set", s);
 		return {};
 	}
-	if (row[it->second] == nullptr) {
-		return {};
+	return getString(static_cast<size_t>(column));
+}
+
+std::string DBResult::getString(size_t column) const {
+	if (!binary) {
+		if (row[column] == nullptr) {
+			return {};
+		}
+		return std::string(row[column]);
+	}
+
+	const auto &cell = cells[rowIndex * columnNames.size() + column];
+	switch (cell.type) {
+		case BinaryCell::Type::Signed:
+			return std::to_string(cell.number);
+		case BinaryCell::Type::Unsigned:
+			return std::to_string(static_cast<uint64_t>(cell.number));
+		case BinaryCell::Type::Double:
+			return fmt::format("{}", cell.real);
+		case BinaryCell::Type::Bytes:
+			return std::string(bytes.data() + cell.offset, cell.length);
+		default:
+			return {};
 	}
-	return std::string(row[it->second]);
 }
 
 const char* DBResult::getStream(const std::string &s, unsigned long &size) const {
-	auto it = listNames.find(s);
-	if (it == listNames.end()) {
+	const auto column = findColumn(s);
+	if (column < 0) {
 		g_logger().error("Column '{}' doesn't exist in the result set", s);
 		size = 0;
 		return nullptr;
 	}
+	return getStream(static_cast<size_t>(column), size);
+}
 
-	if (row[it->second] == nullptr) {
+const char* DBResult::getStream(size_t column, unsigned long &size) const {
+	if (!binary) {
+		if (row[column] == nullptr) {
+			size = 0;
+			return nullptr;
+		}
+
+		size = mysql_fetch_lengths(handle)[column];
+		return row[column];
+	}
+
+	const auto &cell = cells[rowIndex * columnNames.size() + column];
+	if (cell.type != BinaryCell::Type::Bytes) {
+		if (cell.type != BinaryCell::Type::Null) {
+			g_logger().error("Column '{}' is a number, it can't be read as a stream", columnNames[column]);
+		}
 		size = 0;
 		return nullptr;
 	}
 
-	size = mysql_fetch_lengths(handle)[it->second];
-	return row[it->second];
+	size = cell.length;
+	return bytes.data() + cell.offset;
 }
 
 uint8_t DBResult::getU8FromString(const std::string &string, const std::string &function) {
@@ -370,10 +796,16 @@ int8_t DBResult::getInt8FromString(const std::string &string, const std::string
 }
 
 size_t DBResult::countResults() const {
+	if (binary) {
+		return rowCount;
+	}
 	return static_cast<size_t>(mysql_num_rows(handle));
 }
 
 bool DBResult::hasNext() const {
+	if (binary) {
+		return rowIndex < rowCount;
+	}
 	return row != nullptr;
 }
 
@@ -382,6 +814,14 @@ bool DBResult::next() {
 		g_logger().error("Database not initialized!");
 		return false;
 	}
+
+	if (binary) {
+		if (rowIndex < rowCount) {
+			++rowIndex;
+		}
+		return rowIndex < rowCount;
+	}
+
 	row = mysql_fetch_row(handle);
 	return row != nullptr;
 }
@@ -473,3 +913,95 @@ bool DBInsert::execute() {
 
 	return true;
 }
+
+DBStatement::DBStatement(std::string query) :
+	query(std::move(query)) { }
+
+DBStatement &DBStatement::bind(std::string_view value) {
+	auto &param = params.emplace_back();
+	param.type = MYSQL_TYPE_STRING;
+	param.bytes = value;
+	return *this;
+}
+
+DBStatement &DBStatement::bindBlob(const char* data, size_t size) {
+	auto &param = params.emplace_back();
+	param.type = MYSQL_TYPE_BLOB;
+	param.bytes.assign(data, size);
+	return *this;
+}
+
+DBStatement &DBStatement::bindNull() {
+	params.emplace_back();
+	return *this;
+}
+
+bool DBStatement::execute() const {
+	return Database::getInstance().executeStatement(*this);
+}
+
+DBResult_ptr DBStatement::store() const {
+	return Database::getInstance().storeStatement(*this);
+}
+
+std::vector<MYSQL_BIND> DBStatement::makeBinds() const {
+	std::vector<MYSQL_BIND> binds(params.size());
+	for (size_t i = 0; i < params.size(); ++i) {
+		const auto &param = params[i];
+		auto &bind = binds[i];
+		bind.buffer_type = param.type;
+		switch (param.type) {
+			case MYSQL_TYPE_LONGLONG:
+				bind.buffer = const_cast<int64_t*>(&param.number);
+				bind.is_unsigned = param.isUnsigned;
+				break;
+			case MYSQL_TYPE_DOUBLE:
+				bind.buffer = const_cast<double*>(&param.real);
+				break;
+			case MYSQL_TYPE_STRING:
+			case MYSQL_TYPE_BLOB:
+				// Without a length pointer the client sends buffer_length bytes
+				bind.buffer = const_cast<char*>(param.bytes.data());
+				bind.buffer_length = static_cast<unsigned long>(param.bytes.size());
+				break;
+			default:
+				break;
+		}
+	}
+	return binds;
+}
+
+std::string DBStatement::toQuery() const {
+	const auto &db = Database::getInstance();
+	std::string text;
+	text.reserve(query.size());
+
+	size_t param = 0;
+	char quote = 0;
+	for (const char c : query) {
+		if (quote != 0) {
+			quote = c == quote ? 0 : quote;
+		} else if (c == '\'' || c == '"' || c == '`') {
+			quote = c;
+		} else if (c == '?' && param < params.size()) {
+			const auto &value = params[param++];
+			switch (value.type) {
+				case MYSQL_TYPE_LONGLONG:
+					text += value.isUnsigned ? std::to_string(static_cast<uint64_t>(value.number)) : std::to_string(value.number);
+					break;
+				case MYSQL_TYPE_DOUBLE:
+					text += fmt::format("{}", value.real);
+					break;
+				case MYSQL_TYPE_NULL:
+					text += "NULL";
+					break;
+				default:
+					text += db.escapeBlob(value.bytes.data(), static_cast<uint32_t>(value.bytes.size()));
+					break;
+			}
+			continue;
+		}
+		text.push_back(c);
+	}
+	return text;
+}
@@ -13,13 +13,26 @@
 
 #ifndef USE_PRECOMPILED_HEADERS
 	#include <mysql/mysql.h>
+	#include <condition_variable>
 	#include <mutex>
 	#include <utility>
 #endif
 
 class DBResult;
+class DBStatement;
 using DBResult_ptr = std::shared_ptr<DBResult>;
 
+struct DatabaseStats {
+	// Queries run through executeQuery and storeQuery
+	uint64_t queries = 0;
+	// Queries that found every connection of the pool busy, and how long they waited for one
+	uint64_t waits = 0;
+	uint64_t waitTimeUs = 0;
+	uint64_t maxWaitTimeUs = 0;
+	size_t inUse = 0;
+	size_t poolSize = 0;
+};
+
 class Database {
 public:
 	static const size_t MAX_QUERY_SIZE = 8 * 1024 * 1024; // 8 Mb -- half the default MySQL max_allowed_packet size
@@ -35,7 +48,14 @@ public:
 
 	bool connect();
 
-	bool connect(const std::string* host, const std::string* user, const std::string* password, const std::string* database, uint32_t port, const std::string* sock);
+	/**
+	 * @brief Opens the connection pool.
+	 *
+	 * Queries check a connection out of the pool for their duration, so up to `poolSize`
+	 * of them run in parallel. A transaction keeps its connection pinned to the calling
+	 * thread from begin until commit or rollback.
+	 */
+	bool connect(const std::string* host, const std::string* user, const std::string* password, const std::string* database, uint32_t port, const std::string* sock, size_t poolSize = 1);
 
 	/**
 	 * @brief Creates a backup of the database.
@@ -54,7 +74,6 @@ public:
 	 */
 	void createDatabaseBackup(bool compress) const;
 
-	bool retryQuery(std::string_view query, int retries);
 	bool executeQuery(std::string_view query);
 
 	DBResult_ptr storeQuery(std::string_view query);
@@ -63,9 +82,8 @@ public:
 
 	std::string escapeBlob(const char* s, uint32_t length) const;
 
-	uint64_t getLastInsertId() const {
-		return static_cast<uint64_t>(mysql_insert_id(handle));
-	}
+	// Id generated by the last executeQuery of the calling thread, unknown while its queries are captured
+	uint64_t getLastInsertId() const;
 
 	static const char* getClientVersion() {
 		return mysql_get_client_info();
@@ -75,18 +93,87 @@ public:
 		return maxPacketSize;
 	}
 
+	// Totals since startup, callers derive rates from the difference between two calls
+	DatabaseStats getStats();
+
+	/**
+	 * @brief Collects the write queries of the calling thread instead of running them.
+	 *
+	 * Used by PersistenceJournal to turn a save into a journal record. executeQuery and
+	 * DBStatement::execute append to `queries`, reads still go to the database, and
+	 * transactions opened meanwhile only record whether they were rolled back.
+	 * @return false if the thread is already inside a transaction, its writes can't be deferred.
+	 */
+	bool beginCapture(std::vector<std::string> &queries);
+
+	/**
+	 * @return false if a transaction was rolled back while capturing.
+	 */
+	bool endCapture();
+
 private:
+	// Connection of the calling thread for the duration of a query: the one pinned by
+	// its transaction, otherwise a free one from the pool
+	class ConnectionLease {
+	public:
+		explicit ConnectionLease(Database &db);
+		~ConnectionLease();
+
+		ConnectionLease(const ConnectionLease &) = delete;
+		ConnectionLease &operator=(const ConnectionLease &) = delete;
+
+		MYSQL* get() const {
+			return handle;
+		}
+
+	private:
+		Database &db;
+		MYSQL* handle = nullptr;
+		bool pooled = false;
+	};
+
 	bool beginTransaction();
 	bool rollback();
 	bool commit();
+	bool endTransaction(bool success);
+
+	MYSQL* acquireConnection();
+	void releaseConnection(MYSQL* connection);
 
+	bool executeStatement(const DBStatement &statement);
+	DBResult_ptr storeStatement(const DBStatement &statement);
+	MYSQL_STMT* runStatement(MYSQL* handle, const DBStatement &statement, bool storeResult);
+	MYSQL_STMT* prepareStatement(MYSQL* handle, const std::string &query);
+	void discardStatement(MYSQL* handle, const std::string &query);
+
+	static bool retryQuery(MYSQL* handle, std::string_view query, int retries);
 	static bool isRecoverableError(unsigned int error);
 
-	MYSQL* handle = nullptr;
-	std::recursive_mutex databaseLock;
+	std::vector<MYSQL*> connections;
+	std::vector<MYSQL*> freeConnections;
+	std::mutex poolMutex;
+	std::condition_variable poolCondition;
+
+	// Prepared statements of each connection by query, only touched by the thread holding the connection
+	static constexpr size_t MAX_CACHED_STATEMENTS = 256;
+	std::unordered_map<MYSQL*, std::unordered_map<std::string, MYSQL_STMT*>> statements;
 	uint64_t maxPacketSize = 1048576;
 
+	static thread_local MYSQL* transactionHandle;
+	static thread_local uint32_t transactionDepth;
+	// Set by a nested rollback, the outermost commit then rolls back
+	static thread_local bool transactionRollbackOnly;
+	static thread_local uint64_t lastInsertId;
+	static thread_local std::vector<std::string>* capturedQueries;
+	static thread_local bool captureRolledBack;
+
+	std::atomic_uint64_t queries = 0;
+	std::atomic_uint64_t waits = 0;
+	std::atomic_uint64_t waitTimeUs = 0;
+	std::atomic_uint64_t maxWaitTimeUs = 0;
+
 	friend class DBTransaction;
+	friend class DBStatement;
 };
 
 constexpr auto g_database = Database::getInstance;
@@ -94,6 +181,8 @@ constexpr auto g_database = Database::getInstance;
 class DBResult {
 public:
 	explicit DBResult(MYSQL_RES* res);
+	// Rows of an executed prepared statement, decoded from the binary protocol
+	DBResult(MYSQL_STMT* stmt, MYSQL_RES* metadata);
 	~DBResult();
 
 	// Non copyable
@@ -107,11 +196,77 @@ public:
 			g_logger().error("[DBResult::getNumber] - Column '{}' doesn't exist in the result set", s);
 			return T();
 		}
+		return getNumber<T>(it->second);
+	}
 
-		if (row[it->second] == nullptr) {
-			return T();
+	// Column by position, see DBColumns
+	template <typename T>
+	T getNumber(size_t column) const {
+		if (!binary) {
+			if (row[column] == nullptr) {
+				return T();
+			}
+			return parseNumber<T>(row[column], column);
+		}
+
+		const auto &cell = cells[rowIndex * columnNames.size() + column];
+		switch (cell.type) {
+			case BinaryCell::Type::Signed:
+				return castNumber<T>(cell.number);
+			case BinaryCell::Type::Unsigned:
+				return castNumber<T>(static_cast<uint64_t>(cell.number));
+			case BinaryCell::Type::Double:
+				return castNumber<T>(cell.real);
+			case BinaryCell::Type::Bytes:
+				// DECIMAL and other columns the server sends as text
+				return parseNumber<T>(bytes.data() + cell.offset, column);
+			default:
+				return T();
 		}
+	}
+
+	std::string getString(const std::string &s) const;
+	std::string getString(size_t column) const;
+	const char* getStream(const std::string &s, unsigned long &size) const;
+	const char* getStream(size_t column, unsigned long &size) const;
+	static uint8_t getU8FromString(const std::string &string, const std::string &function);
+	static int8_t getInt8FromString(const std::string &string, const std::string &function);
+
+	size_t countResults() const;
+	bool hasNext() const;
+	bool next();
+
+private:
+	struct BinaryCell {
+		enum class Type : uint8_t {
+			Null,
+			Signed,
+			Unsigned,
+			Double,
+			Bytes,
+		};
+
+		Type type = Type::Null;
+		int64_t number = 0;
+		double real = 0;
+		// Into bytes, each value is followed by a null terminator
+		size_t offset = 0;
+		unsigned long length = 0;
+	};
+
+	template <typename T, typename V>
+	static T castNumber(V value) {
+		if constexpr (std::is_enum_v<T>) {
+			return static_cast<T>(static_cast<std::underlying_type_t<T>>(value));
+		} else if constexpr (std::is_same_v<T, bool>) {
+			return value != 0;
+		} else {
+			return static_cast<T>(value);
+		}
+	}
 
+	template <typename T>
+	T parseNumber(const char* text, size_t column) const {
 		T data {};
 		try {
 			// Check if the type T is a enum
@@ -119,9 +274,9 @@ public:
 				using underlying_type = std::underlying_type_t<T>;
 				underlying_type value = 0;
 				if constexpr (std::is_signed_v<underlying_type>) {
-					value = static_cast<underlying_type>(std::stoll(row[it->second]));
+					value = static_cast<underlying_type>(std::stoll(text));
 				} else {
-					value = static_cast<underlying_type>(std::stoull(row[it->second]));
+					value = static_cast<underlying_type>(std::stoull(text));
 				}
 				return static_cast<T>(value);
 			}
@@ -130,70 +285,173 @@ public:
 				// Check if the type T is int8_t or int16_t
 				if constexpr (std::is_same_v<T, int8_t> || std::is_same_v<T, int16_t>) {
 					// Use std::stoi to convert string to int8_t
-					data = static_cast<T>(std::stoi(row[it->second]));
+					data = static_cast<T>(std::stoi(text));
 				}
 				// Check if the type T is int32_t
 				else if constexpr (std::is_same_v<T, int32_t>) {
 					// Use std::stol to convert string to int32_t
-					data = static_cast<T>(std::stol(row[it->second]));
+					data = static_cast<T>(std::stol(text));
 				}
 				// Check if the type T is int64_t
 				else if constexpr (std::is_same_v<T, int64_t>) {
 					// Use std::stoll to convert string to int64_t
-					data = static_cast<T>(std::stoll(row[it->second]));
+					data = static_cast<T>(std::stoll(text));
 				}
 				// Check if the type T is time_t
 				else if constexpr (std::is_same_v<T, time_t>) {
 					// Use std::stoll to convert string to time_t (usually long long)
-					data = static_cast<T>(std::stoll(row[it->second]));
+					data = static_cast<T>(std::stoll(text));
 				} else {
 					// Throws exception indicating that type T is invalid
 					g_logger().error("Invalid signed type T");
 				}
 			} else if (std::is_same<T, bool>::value) {
-				data = static_cast<T>(std::stoi(row[it->second]));
+				data = static_cast<T>(std::stoi(text));
 			} else {
 				// Check if the type T is uint8_t or uint16_t or uint32_t
 				if constexpr (std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t> || std::is_same_v<T, uint32_t>) {
 					// Use std::stoul to convert string to uint8_t
-					data = static_cast<T>(std::stoul(row[it->second]));
+					data = static_cast<T>(std::stoul(text));
 				}
 				// Check if the type T is uint64_t
 				else if constexpr (std::is_same_v<T, uint64_t>) {
 					// Use std::stoull to convert string to uint64_t
-					data = static_cast<T>(std::stoull(row[it->second]));
+					data = static_cast<T>(std::stoull(text));
 				} else {
 					// Send log indicating that type T is invalid
-					g_logger().error("Column '{}' has an invalid unsigned T is invalid", s);
+					g_logger().error("Column '{}' has an invalid unsigned T is invalid", columnNames[column]);
 				}
 			}
 		} catch (std::invalid_argument &e) {
 			// Value of string is invalid
-			g_logger().error("Column '{}' has an invalid value set, error code: {}", s, e.what());
+			g_logger().error("Column '{}' has an invalid value set, error code: {}", columnNames[column], e.what());
 			data = T();
 		} catch (std::out_of_range &e) {
 			// Value of string is too large to fit the range allowed by type T
-			g_logger().error("Column '{}' has a value out of range, error code: {}", s, e.what());
+			g_logger().error("Column '{}' has a value out of range, error code: {}", columnNames[column], e.what());
 			data = T();
 		}
 
 		return data;
 	}
 
-	std::string getString(const std::string &s) const;
-	const char* getStream(const std::string &s, unsigned long &size) const;
-	static uint8_t getU8FromString(const std::string &string, const std::string &function);
-	static int8_t getInt8FromString(const std::string &string, const std::string &function);
-
-	size_t countResults() const;
-	bool hasNext() const;
-	bool next();
+	int32_t findColumn(const std::string &s) const;
 
-private:
 	MYSQL_RES* handle;
-	MYSQL_ROW row;
+	MYSQL_ROW row = nullptr;
 
 	std::map<std::string_view, size_t> listNames;
+	std::vector<std::string_view> columnNames;
+
+	bool binary = false;
+	std::vector<BinaryCell> cells;
+	std::string bytes;
+	size_t rowCount = 0;
+	size_t rowIndex = 0;
+
+	friend class Database;
+};
+
+/**
+ * Name usable as a template argument, see DBColumns.
+ */
+template <size_t N>
+struct DBColumnName {
+	constexpr DBColumnName(const char (&name)[N]) {
+		std::copy_n(name, N, value);
+	}
+
+	constexpr std::string_view view() const {
+		return { value, N - 1 };
+	}
+
+	char value[N] {};
+};
+
+/**
+ * Columns selected by a query, in order, so that rows are read by position instead of
+ * looking every column up by name. A name missing from the list does not compile.
+ *
+ *   using ItemColumns = DBColumns<"pid", "sid", "itemtype">;
+ *   DBStatement statement(fmt::format("SELECT {} FROM `player_items` WHERE `player_id` = ?", ItemColumns::list()));
+ *   auto pid = result->getNumber<int32_t>(ItemColumns::index<"pid">());
+ */
+template <DBColumnName... Names>
+struct DBColumns {
+	template <DBColumnName Name>
+	static consteval size_t index() {
+		constexpr std::array<std::string_view, sizeof...(Names)> names { Names.view()... };
+		constexpr auto position = static_cast<size_t>(std::ranges::find(names, Name.view()) - names.begin());
+		static_assert(position < names.size(), "Column is not part of the list");
+		return position;
+	}
+
+	// "`pid`, `sid`, `itemtype`", to build the SELECT with the same order
+	static const std::string &list() {
+		static const std::string columns = [] {
+			std::string joined;
+			((joined += fmt::format("{}`{}`", joined.empty() ? "" : ", ", Names.view())), ...);
+			return joined;
+		}();
+		return columns;
+	}
+};
+
+/**
+ * Prepared statement. Values are bound with their type and sent in the binary protocol,
+ * so they are neither formatted into the query nor escaped, and the rows come back typed.
+ * Each pooled connection prepares the query once and reuses it, the query text is the
+ * cache key so it must not embed values.
+ */
+class DBStatement {
+public:
+	explicit DBStatement(std::string query);
+
+	template <typename T>
+		requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+	DBStatement &bind(T value) {
+		if constexpr (std::is_enum_v<T>) {
+			return bind(static_cast<std::underlying_type_t<T>>(value));
+		}
+
+		auto &param = params.emplace_back();
+		if constexpr (std::is_floating_point_v<T>) {
+			param.type = MYSQL_TYPE_DOUBLE;
+			param.real = static_cast<double>(value);
+		} else {
+			param.type = MYSQL_TYPE_LONGLONG;
+			param.isUnsigned = std::is_unsigned_v<T>;
+			param.number = static_cast<int64_t>(value);
+		}
+		return *this;
+	}
+
+	DBStatement &bind(std::string_view value);
+	DBStatement &bindBlob(const char* data, size_t size);
+	DBStatement &bindNull();
+
+	bool execute() const;
+	DBResult_ptr store() const;
+
+	const std::string &getQuery() const {
+		return query;
+	}
+
+private:
+	struct Param {
+		enum_field_types type = MYSQL_TYPE_NULL;
+		bool isUnsigned = false;
+		int64_t number = 0;
+		double real = 0;
+		std::string bytes;
+	};
+
+	std::vector<MYSQL_BIND> makeBinds() const;
+	// The query with its parameters escaped into it, for a capturing thread
+	std::string toQuery() const;
+
+	std::string query;
+	std::vector<Param> params;
 
 	friend class Database;
 };
@@ -230,23 +488,34 @@ public:
 	DBTransaction(const DBTransaction &&) = delete;
 	DBTransaction &operator=(const DBTransaction &&) = delete;
 
+	/**
+	 * @brief Runs `toBeExecuted` inside a transaction on a single pinned connection.
+	 *
+	 * `toBeExecuted` returns whether it succeeded: true commits its changes, false
+	 * rolls them back. Exceptions thrown by it roll the transaction back and are rethrown.
+	 * @return false if the transaction could not be started, was rolled back or could not be committed.
+	 */
 	template <typename Func>
 	static bool executeWithinTransaction(const Func &toBeExecuted) {
-		bool changesExpected = toBeExecuted();
-		if (changesExpected) {
-			DBTransaction transaction;
-			try {
-				transaction.begin();
-				transaction.commit();
-				return changesExpected;
-			} catch (const std::exception &exception) {
-				transaction.rollback();
-				g_logger().error("[{}] Error occurred during transaction, error: {}", __FUNCTION__, exception.what());
-				return false;
-			}
-		} else {
-			return true;
+		DBTransaction transaction;
+		if (!transaction.begin()) {
+			g_logger().error("[{}] Failed to start the transaction", __FUNCTION__);
+			return false;
+		}
+
+		bool changesExpected = false;
+		try {
+			changesExpected = toBeExecuted();
+		} catch (...) {
+			transaction.rollback();
+			throw;
+		}
+
+		if (!changesExpected) {
+			transaction.rollback();
+			return false;
 		}
+		return transaction.commit();
 	}
 
 private:
@@ -258,8 +527,11 @@ private:
 
 		try {
 			// Start the transaction
+			if (!Database::getInstance().beginTransaction()) {
+				return false;
+			}
 			state = STATE_START;
-			return Database::getInstance().beginTransaction();
+			return true;
 		} catch (const std::exception &exception) {
 			// An error occurred while starting the transaction
 			state = STATE_NO_START;
@@ -284,21 +556,22 @@ private:
 		}
 	}
 
-	void commit() {
+	bool commit() {
 		// Ensure that the transaction has been started
 		if (state != STATE_START) {
 			g_logger().error("Transaction not started");
-			return;
+			return false;
 		}
 
 		try {
 			// Commit the transaction
 			state = STATE_COMMIT;
-			Database::getInstance().commit();
+			return Database::getInstance().commit();
 		} catch (const std::exception &exception) {
 			// An error occurred while committing the transaction
 			state = STATE_NO_START;
 			g_logger().error("[{}] An error occurred while committing the transaction, error: {}", __FUNCTION__, exception.what());
+			return false;
 		}
 	}
 
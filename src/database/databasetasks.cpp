@@ -38,3 +38,21 @@ void DatabaseTasks::store(const std::string &query, const std::function<void(DBR
 		}
 	});
 }
+
+void DatabaseTasks::execute(DBStatement statement, const std::function<void(DBResult_ptr, bool)> &callback /* nullptr */) {
+	threadPool.detach_task([statement = std::move(statement), callback]() {
+		bool success = statement.execute();
+		if (callback != nullptr) {
+			g_dispatcher().addEvent([callback, success]() { callback(nullptr, success); }, __FUNCTION__);
+		}
+	});
+}
+
+void DatabaseTasks::store(DBStatement statement, const std::function<void(DBResult_ptr, bool)> &callback /* nullptr */) {
+	threadPool.detach_task([statement = std::move(statement), callback]() {
+		DBResult_ptr result = statement.store();
+		if (callback != nullptr) {
+			g_dispatcher().addEvent([callback, result]() { callback(result, true); }, __FUNCTION__);
+		}
+	});
+}
@@ -24,6 +24,8 @@ public:
 
 	void execute(const std::string &query, const std::function<void(DBResult_ptr, bool)> &callback = nullptr);
 	void store(const std::string &query, const std::function<void(DBResult_ptr, bool)> &callback = nullptr);
+	void execute(DBStatement statement, const std::function<void(DBResult_ptr, bool)> &callback = nullptr);
+	void store(DBStatement statement, const std::function<void(DBResult_ptr, bool)> &callback = nullptr);
 
 private:
 	Database &db;
@@ -0,0 +1,431 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "database/persistence_journal.hpp"
+
+#include "config/configmanager.hpp"
+#include "lib/di/container.hpp"
+
+#ifndef USE_PRECOMPILED_HEADERS
+	#include <filesystem>
+	#include <fstream>
+	#include <zlib.h>
+#endif
+
+namespace {
+	// Pushes the appended record to the disk, a crash after write() returned must not lose it
+	bool syncFile(FILE* file) {
+#ifdef _WIN32
+		return _commit(_fileno(file)) == 0;
+#elif defined(__APPLE__)
+		return fsync(fileno(file)) == 0;
+#else
+		return fdatasync(fileno(file)) == 0;
+#endif
+	}
+
+	template <typename T>
+	void put(std::string &bytes, T value) {
+		bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool get(std::string_view data, size_t &offset, T &value) {
+		if (data.size() - offset < sizeof(T)) {
+			return false;
+		}
+		std::memcpy(&value, data.data() + offset, sizeof(T));
+		offset += sizeof(T);
+		return true;
+	}
+
+	uint32_t checksum(std::string_view data) {
+		return static_cast<uint32_t>(crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(data.data()), static_cast<uInt>(data.size())));
+	}
+}
+
+PersistenceJournal::~PersistenceJournal() {
+	close();
+}
+
+PersistenceJournal &PersistenceJournal::getInstance() {
+	return inject<PersistenceJournal>();
+}
+
+bool PersistenceJournal::open() {
+	return open(g_configManager().getString(PERSISTENCE_JOURNAL_FILE), g_configManager().getBoolean(PERSISTENCE_JOURNAL));
+}
+
+bool PersistenceJournal::open(const std::string &journalPath, bool enable) {
+	path = journalPath;
+	if (!replay()) {
+		return false;
+	}
+
+	if (!enable) {
+		return true;
+	}
+
+	file = std::fopen(path.c_str(), "wb");
+	if (!file) {
+		g_logger().error("[{}] Failed to open the persistence journal {}, saves go straight to the database", __FUNCTION__, path);
+		return true;
+	}
+
+	{
+		std::scoped_lock lock(mutex);
+		stopping = false;
+		flusherRunning = true;
+	}
+	flusher = std::thread([this] { flushLoop(); });
+	enabled = true;
+	g_logger().info("Persistence journal enabled at {}", path);
+	return true;
+}
+
+void PersistenceJournal::close() {
+	if (!flusher.joinable()) {
+		return;
+	}
+
+	// The flusher applies what is left and exits, saves from then on go to the database
+	{
+		std::scoped_lock lock(mutex);
+		stopping = true;
+	}
+	pendingCondition.notify_all();
+	flusher.join();
+
+	std::scoped_lock lock(mutex);
+	enabled = false;
+	if (file) {
+		std::fclose(file);
+		file = nullptr;
+	}
+
+	if (!pending.empty()) {
+		g_logger().warn("[{}] {} records of the persistence journal could not be applied, they will be replayed on the next startup", __FUNCTION__, pending.size());
+		pending.clear();
+		pendingKeys.clear();
+	} else {
+		std::error_code error;
+		std::filesystem::remove(path, error);
+	}
+	flushedCondition.notify_all();
+}
+
+bool PersistenceJournal::waitFlushed(const std::string &key) {
+	std::unique_lock lock(mutex);
+	if (!pendingKeys.contains(key)) {
+		return false;
+	}
+
+	flushedCondition.wait(lock, [this, &key] {
+		return !pendingKeys.contains(key) || !flusherRunning;
+	});
+	return true;
+}
+
+void PersistenceJournal::flush() {
+	std::unique_lock lock(mutex);
+	flushedCondition.wait(lock, [this] {
+		return pending.empty() || !flusherRunning;
+	});
+}
+
+bool PersistenceJournal::takeRejected(const std::string &key) {
+	std::scoped_lock lock(mutex);
+	return rejectedKeys.erase(key) > 0;
+}
+
+PersistenceJournalStats PersistenceJournal::getStats() {
+	std::scoped_lock lock(mutex);
+	auto result = stats;
+	result.pending = pending.size();
+	return result;
+}
+
+std::string PersistenceJournal::encode(RecordType type, uint64_t sequence, const std::string &key, const std::vector<std::string> &queries) {
+	std::string payload;
+	put(payload, static_cast<uint16_t>(key.size()));
+	payload += key;
+	put(payload, static_cast<uint32_t>(queries.size()));
+	for (const auto &query : queries) {
+		put(payload, static_cast<uint32_t>(query.size()));
+		payload += query;
+	}
+
+	std::string bytes;
+	bytes.reserve(HEADER_SIZE + payload.size());
+	put(bytes, RECORD_MAGIC);
+	put(bytes, uint32_t { 0 });
+	put(bytes, static_cast<uint8_t>(type));
+	put(bytes, sequence);
+	put(bytes, static_cast<uint32_t>(payload.size()));
+	bytes += payload;
+
+	// Covers everything after the checksum itself
+	const uint32_t crc = checksum(std::string_view(bytes).substr(8));
+	std::memcpy(bytes.data() + 4, &crc, sizeof(crc));
+	return bytes;
+}
+
+bool PersistenceJournal::decode(std::string_view data, size_t &offset, RecordType &type, Record &record) {
+	size_t position = offset;
+	uint32_t magic;
+	uint32_t crc;
+	uint8_t rawType;
+	uint32_t payloadSize;
+	if (!get(data, position, magic) || magic != RECORD_MAGIC || !get(data, position, crc) || !get(data, position, rawType) || !get(data, position, record.sequence) || !get(data, position, payloadSize)) {
+		return false;
+	}
+
+	if (data.size() - position < payloadSize || checksum(data.substr(offset + 8, HEADER_SIZE - 8 + payloadSize)) != crc) {
+		return false;
+	}
+
+	type = static_cast<RecordType>(rawType);
+	const auto payload = data.substr(position, payloadSize);
+	offset = position + payloadSize;
+	record.size = HEADER_SIZE + payloadSize;
+	if (type != RecordType::Data) {
+		return false;
+	}
+
+	size_t cursor = 0;
+	uint16_t keySize;
+	uint32_t count;
+	if (!get(payload, cursor, keySize) || payload.size() - cursor < keySize) {
+		return false;
+	}
+	record.key = payload.substr(cursor, keySize);
+	cursor += keySize;
+
+	if (!get(payload, cursor, count)) {
+		return false;
+	}
+	for (uint32_t i = 0; i < count; ++i) {
+		uint32_t size;
+		if (!get(payload, cursor, size) || payload.size() - cursor < size) {
+			return false;
+		}
+		record.queries.emplace_back(payload.substr(cursor, size));
+		cursor += size;
+	}
+	return true;
+}
+
+bool PersistenceJournal::apply(const std::vector<const Record*> &records, bool storeSequence) {
+	auto &db = Database::getInstance();
+	return DBTransaction::executeWithinTransaction([&db, &records, storeSequence] {
+		for (const auto* record : records) {
+			for (const auto &query : record->queries) {
+				if (!db.executeQuery(query)) {
+					return false;
+				}
+			}
+		}
+		// Committed with the records, the replay never applies them twice
+		return !storeSequence || storeAppliedSequence(records.back()->sequence);
+	});
+}
+
+uint64_t PersistenceJournal::loadAppliedSequence() {
+	const auto result = Database::getInstance().storeQuery(fmt::format("SELECT `value` FROM `server_config` WHERE `config` = '{}'", SEQUENCE_CONFIG));
+	return result ? result->getNumber<uint64_t>("value") : 0;
+}
+
+bool PersistenceJournal::storeAppliedSequence(uint64_t sequence) {
+	return Database::getInstance().executeQuery(fmt::format("INSERT INTO `server_config` (`config`, `value`) VALUES ('{}', '{}') ON DUPLICATE KEY UPDATE `value` = VALUES(`value`)", SEQUENCE_CONFIG, sequence));
+}
+
+bool PersistenceJournal::append(const std::string &key, std::vector<std::string> queries) {
+	std::unique_lock lock(mutex);
+	const auto sequence = nextSequence++;
+	const auto bytes = encode(RecordType::Data, sequence, key, queries);
+	if (!enabled || !writeToFile(bytes)) {
+		lock.unlock();
+		// The save must not be lost, it waits for the database like without the journal,
+		// after the older records of the same key so that it isn't overwritten by them
+		g_logger().error("[{}] The persistence journal {} is unavailable, applying the save of {} directly", __FUNCTION__, path, key);
+		waitFlushed(key);
+		Record record { sequence, key, std::move(queries), bytes.size() };
+		return apply({ &record }, false);
+	}
+
+	pending.emplace_back(sequence, key, std::move(queries), bytes.size());
+	++pendingKeys[key];
+	++stats.appended;
+	stats.pendingBytes += bytes.size();
+	lock.unlock();
+
+	pendingCondition.notify_one();
+	return true;
+}
+
+bool PersistenceJournal::writeToFile(const std::string &bytes) {
+	if (file && std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size() && std::fflush(file) == 0 && syncFile(file)) {
+		return true;
+	}
+
+	// A partial write would hide the records appended after it from the replay
+	g_logger().error("[{}] Failed to write to the persistence journal {}, saves go straight to the database", __FUNCTION__, path);
+	enabled = false;
+	return false;
+}
+
+void PersistenceJournal::truncateFile() {
+	if (file) {
+		file = std::freopen(path.c_str(), "wb", file);
+	}
+	if (!file) {
+		g_logger().error("[{}] Failed to reopen the persistence journal {}, saves go straight to the database", __FUNCTION__, path);
+		enabled = false;
+	}
+}
+
+void PersistenceJournal::reject(const Record &record) {
+	g_logger().error("[{}] Giving up on the save of {} after {} attempts, it was moved to {}.rejected", __FUNCTION__, record.key, record.attempts, path);
+	std::ofstream rejected(path + ".rejected", std::ios::binary | std::ios::app);
+	rejected << encode(RecordType::Data, record.sequence, record.key, record.queries);
+	// The next save of the key rewrites what the following records assumed was stored
+	rejectedKeys.emplace(record.key);
+	++stats.rejected;
+}
+
+bool PersistenceJournal::replay() {
+	const auto applied = loadAppliedSequence();
+	nextSequence = applied + 1;
+
+	std::ifstream input(path, std::ios::binary);
+	if (!input) {
+		return true;
+	}
+
+	const std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+	input.close();
+
+	std::vector<Record> records;
+	size_t offset = 0;
+	while (offset < data.size()) {
+		RecordType type;
+		Record record;
+		if (!decode(data, offset, type, record)) {
+			// Torn by a crash while appending, its save had not returned
+			g_logger().warn("[{}] Ignoring {} bytes at the end of the persistence journal {}", __FUNCTION__, data.size() - offset, path);
+			break;
+		}
+		nextSequence = std::max(nextSequence, record.sequence + 1);
+		records.emplace_back(std::move(record));
+	}
+
+	size_t replayed = 0;
+	for (const auto &record : records) {
+		if (record.sequence <= applied) {
+			continue;
+		}
+
+		if (!apply({ &record }, true)) {
+			g_logger().error("[{}] Failed to replay the save of {} from the persistence journal {}, fix the database or move the file away to start without it", __FUNCTION__, record.key, path);
+			return false;
+		}
+		++replayed;
+	}
+
+	std::error_code error;
+	std::filesystem::remove(path, error);
+	if (replayed > 0) {
+		g_logger().info("Replayed {} saves from the persistence journal {}", replayed, path);
+	}
+	return true;
+}
+
+void PersistenceJournal::flushLoop() {
+	auto retryDelay = std::chrono::milliseconds(0);
+	std::unique_lock lock(mutex);
+	while (true) {
+		if (retryDelay.count() > 0) {
+			pendingCondition.wait_for(lock, retryDelay, [this] { return stopping; });
+		} else {
+			pendingCondition.wait(lock, [this] { return stopping || !pending.empty(); });
+		}
+
+		if (pending.empty()) {
+			break;
+		}
+
+		// Records stay in the queue until applied so that waitFlushed sees them, appends don't move them
+		std::vector<const Record*> batch;
+		size_t batchBytes = 0;
+		for (const auto &record : pending) {
+			if (batch.size() >= MAX_BATCH_RECORDS || (!batch.empty() && batchBytes + record.size > MAX_BATCH_BYTES)) {
+				break;
+			}
+			batch.emplace_back(&record);
+			batchBytes += record.size;
+		}
+		lock.unlock();
+
+		Benchmark bm_flush;
+		size_t done = batch.size();
+		bool reachable = true;
+		if (!apply(batch, true)) {
+			// Find the record at fault, the ones before it are applied on their own
+			done = 0;
+			for (const auto* record : batch) {
+				if (!apply({ record }, true)) {
+					break;
+				}
+				++done;
+			}
+			// An outage fails every record, only a record the database refuses counts as an attempt
+			reachable = done < batch.size() && Database::getInstance().storeQuery("SELECT 1") != nullptr;
+		}
+		const auto duration = bm_flush.duration();
+
+		lock.lock();
+		if (done < batch.size() && reachable) {
+			auto &failing = pending[done];
+			if (++failing.attempts >= MAX_ATTEMPTS) {
+				// Best effort, a replay would reject it again
+				storeAppliedSequence(failing.sequence);
+				reject(failing);
+				++done;
+			}
+		}
+
+		for (size_t i = 0; i < done; ++i) {
+			const auto &record = pending.front();
+			if (const auto it = pendingKeys.find(record.key); it != pendingKeys.end() && --it->second == 0) {
+				pendingKeys.erase(it);
+			}
+			stats.pendingBytes -= record.size;
+			pending.pop_front();
+		}
+		stats.flushed += done;
+		stats.lastFlushMs = duration;
+
+		if (done > 0) {
+			// Applied records are skipped by the replay, the file is only kept from growing
+			if (pending.empty()) {
+				truncateFile();
+			}
+			flushedCondition.notify_all();
+		}
+
+		const bool failed = done < batch.size();
+		if (failed && stopping) {
+			break;
+		}
+		retryDelay = failed ? std::min(std::max(retryDelay * 2, std::chrono::milliseconds(500)), std::chrono::milliseconds(30000)) : std::chrono::milliseconds(0);
+	}
+
+	flusherRunning = false;
+	flushedCondition.notify_all();
+}
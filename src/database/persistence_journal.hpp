@@ -0,0 +1,194 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include "database/database.hpp"
+
+#include <condition_variable>
+#include <deque>
+
+struct PersistenceJournalStats {
+	// Records appended since startup, applied to the database, and given up on
+	uint64_t appended = 0;
+	uint64_t flushed = 0;
+	uint64_t rejected = 0;
+	// Records waiting for the flusher
+	size_t pending = 0;
+	uint64_t pendingBytes = 0;
+	double lastFlushMs = 0;
+};
+
+/**
+ * @brief Write-behind journal in front of the database.
+ *
+ * A save run through write() has its write queries collected instead of executed
+ * (see Database::beginCapture), the resulting record is appended to a local file
+ * and the save returns. A background thread applies the records to the database in
+ * order, a batch per transaction, and empties the file once everything is applied.
+ *
+ * Each record is checksummed, at startup the records of a previous run that were not
+ * applied are replayed before anything is loaded. A torn record at the end of the
+ * file, left by a crash while appending, is ignored: its save never returned.
+ *
+ * Records are not idempotent (plain inserts, balance increments), so the sequence of the
+ * last applied record is stored in `server_config` by the transaction applying it, the
+ * replay skips the records up to it.
+ */
+class PersistenceJournal {
+public:
+	PersistenceJournal() = default;
+	~PersistenceJournal();
+
+	// Singleton - ensures we don't accidentally copy it.
+	PersistenceJournal(const PersistenceJournal &) = delete;
+	PersistenceJournal &operator=(const PersistenceJournal &) = delete;
+
+	static PersistenceJournal &getInstance();
+
+	/**
+	 * @brief Replays the records left by a previous run, then starts journaling if enabled in the config.
+	 * @return false if a record could not be replayed, the database is missing saves.
+	 */
+	bool open();
+	bool open(const std::string &path, bool enable);
+
+	/**
+	 * @brief Applies the pending records and stops the flusher, what can't be applied stays in the file.
+	 */
+	void close();
+
+	bool isEnabled() const {
+		return enabled;
+	}
+
+	/**
+	 * @brief Runs a save with the same contract as DBTransaction::executeWithinTransaction.
+	 *
+	 * With the journal enabled the writes of `toBeCaptured` are appended as one record
+	 * instead of being executed, reads still hit the database. If the record can't be
+	 * written to the file it is applied to the database right away. The captured writes
+	 * can't use getLastInsertId, asking for it fails the save.
+	 * Every write to the rows a key saves has to go through here, a pending record
+	 * applied after a direct write would overwrite it.
+	 * @param key Identifies what is saved (see playerKey), so its loads can wait for the record.
+	 */
+	template <typename Func>
+	bool write(const std::string &key, const Func &toBeCaptured) {
+		auto &db = Database::getInstance();
+		std::vector<std::string> queries;
+		if (!enabled || !db.beginCapture(queries)) {
+			// Records of the key still queued would overwrite this save when applied
+			waitFlushed(key);
+			return DBTransaction::executeWithinTransaction(toBeCaptured);
+		}
+
+		bool changesExpected = false;
+		try {
+			changesExpected = toBeCaptured();
+		} catch (...) {
+			db.endCapture();
+			throw;
+		}
+
+		// Rolled back, nothing to keep
+		if (!db.endCapture() || !changesExpected) {
+			return false;
+		}
+		if (queries.empty()) {
+			return true;
+		}
+		return append(key, std::move(queries));
+	}
+
+	/**
+	 * @brief Blocks until the records of `key` are in the database.
+	 * @return true if there were records to wait for.
+	 */
+	bool waitFlushed(const std::string &key);
+
+	/**
+	 * @brief Blocks until every record appended so far is in the database.
+	 */
+	void flush();
+
+	/**
+	 * @brief Whether a record of `key` was moved to the .rejected file since the last call.
+	 *
+	 * The saves that followed it may assume rows the database never received.
+	 */
+	bool takeRejected(const std::string &key);
+
+	static constexpr auto HOUSES_KEY = "houses";
+
+	static std::string playerKey(uint32_t guid) {
+		return fmt::format("player:{}", guid);
+	}
+
+	PersistenceJournalStats getStats();
+
+private:
+	enum class RecordType : uint8_t {
+		Data = 1,
+	};
+
+	struct Record {
+		uint64_t sequence = 0;
+		std::string key;
+		std::vector<std::string> queries;
+		size_t size = 0;
+		uint32_t attempts = 0;
+	};
+
+	static constexpr uint32_t RECORD_MAGIC = 0x4C4E524A; // "JRNL"
+	// Header: magic, checksum, type, sequence, payload size
+	static constexpr size_t HEADER_SIZE = 4 + 4 + 1 + 8 + 4;
+	static constexpr size_t MAX_BATCH_RECORDS = 64;
+	static constexpr size_t MAX_BATCH_BYTES = Database::MAX_QUERY_SIZE;
+	// A record failing this many times alone, with the database reachable, is moved to the .rejected file
+	static constexpr uint32_t MAX_ATTEMPTS = 5;
+	// server_config entry holding the sequence of the last applied record
+	static constexpr auto SEQUENCE_CONFIG = "persistence_journal_sequence";
+
+	static std::string encode(RecordType type, uint64_t sequence, const std::string &key, const std::vector<std::string> &queries);
+	static bool decode(std::string_view data, size_t &offset, RecordType &type, Record &record);
+	/**
+	 * @brief Applies the records in one transaction.
+	 * @param storeSequence Also stores the sequence of the last one, false for records that are not in the file.
+	 */
+	static bool apply(const std::vector<const Record*> &records, bool storeSequence);
+	static uint64_t loadAppliedSequence();
+	static bool storeAppliedSequence(uint64_t sequence);
+
+	bool append(const std::string &key, std::vector<std::string> queries);
+	bool replay();
+	bool writeToFile(const std::string &bytes);
+	void truncateFile();
+	void reject(const Record &record);
+	void flushLoop();
+
+	std::string path;
+	std::FILE* file = nullptr;
+	std::atomic_bool enabled = false;
+
+	std::mutex mutex;
+	std::condition_variable pendingCondition;
+	std::condition_variable flushedCondition;
+	std::deque<Record> pending;
+	std::unordered_map<std::string, uint32_t> pendingKeys;
+	std::unordered_set<std::string> rejectedKeys;
+	uint64_t nextSequence = 1;
+	bool stopping = false;
+	bool flusherRunning = false;
+	std::thread flusher;
+
+	PersistenceJournalStats stats;
+};
+
+constexpr auto g_persistenceJournal = PersistenceJournal::getInstance;
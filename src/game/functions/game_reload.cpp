@@ -23,6 +23,8 @@
 #include "lua/scripts/lua_environment.hpp"
 #include "lua/scripts/scripts.hpp"
 #include "creatures/players/vocations/vocation.hpp"
+#include "server/network/connection/connection.hpp"
+#include "server/network/protocol/compression_policy.hpp"
 
 GameReload::GameReload() = default;
 GameReload::~GameReload() = default;
@@ -114,6 +116,10 @@ bool GameReload::reloadChat() {
 
 bool GameReload::reloadConfig() {
 	const bool result = g_configManager().reload();
+	if (result) {
+		g_compressionPolicy().reload();
+		ConnectionManager::getInstance().reloadSendQueueLimits();
+	}
 	logReloadStatus("Config", result);
 	return result;
 }
@@ -26,6 +26,7 @@
 #include "creatures/players/player.hpp"
 #include "enums/player_wheel.hpp"
 #include "database/databasetasks.hpp"
+#include "database/persistence_journal.hpp"
 #include "game/scheduling/dispatcher.hpp"
 #include "game/scheduling/save_manager.hpp"
 #include "game/zones/zone.hpp"
@@ -42,6 +43,7 @@
 #include "items/containers/rewards/rewardchest.hpp"
 #include "items/items.hpp"
 #include "items/items_classification.hpp"
+#include "kv/kv.hpp"
 #include "lua/callbacks/event_callback.hpp"
 #include "lua/callbacks/events_callbacks.hpp"
 #include "lua/creature/actions.hpp"
@@ -555,6 +557,9 @@ void Game::start(ServiceManager* manager) {
 	g_dispatcher().cycleEvent(
 		EVENT_LUA_GARBAGE_COLLECTION, [this] { g_luaEnvironment().collectGarbage(); }, "Calling GC"
 	);
+	g_dispatcher().cycleEvent(
+		EVENT_RETIRED_TILES_INTERVAL, [this] { map.reclaimRetiredTiles(); }, "Map::reclaimRetiredTiles"
+	);
 	auto marketItemsPriceIntervalMinutes = g_configManager().getNumber(MARKET_REFRESH_PRICES);
 	if (marketItemsPriceIntervalMinutes > 0) {
 		auto marketItemsPriceIntervalMS = marketItemsPriceIntervalMinutes * 60000;
@@ -3559,7 +3564,7 @@ void Game::forcePlayerMove(uint32_t playerId, Direction direction) {
 	player->startAutoWalk(std::vector<Direction> { direction }, true);
 }
 
-bool Game::playerBroadcastMessage(const std::shared_ptr<Player> &player, const std::string &text) const {
+bool Game::playerBroadcastMessage(const std::shared_ptr<Player> &player, std::string_view text) const {
 	if (!player->hasFlag(PlayerFlags_t::CanBroadcast)) {
 		return false;
 	}
@@ -4502,6 +4507,7 @@ void Game::playerSetShowOffSocket(uint32_t playerId, Outfit_t &outfit, const Pos
 	}
 
 	// Send to client
+	tile->invalidateDescriptionCache();
 	for (const auto &spectator : Spectators().find<Player>(pos, true)) {
 		spectator->getPlayer()->sendUpdateTileItem(tile, pos, item);
 	}
@@ -6311,7 +6317,7 @@ void Game::playerShowQuestLine(uint32_t playerId, uint16_t questId) {
 	g_callbacks().executeCallback(EventCallback_t::playerOnRequestQuestLine, &EventCallback::playerOnRequestQuestLine, player, questId);
 }
 
-void Game::playerSay(uint32_t playerId, uint16_t channelId, SpeakClasses type, const std::string &receiver, const std::string &text) {
+void Game::playerSay(uint32_t playerId, uint16_t channelId, SpeakClasses type, std::string_view receiver, std::string_view text) {
 	const auto &player = getPlayerByID(playerId);
 	if (!player) {
 		return;
@@ -6340,6 +6346,7 @@ void Game::playerSay(uint32_t playerId, uint16_t channelId, SpeakClasses type, c
 		player->removeMessageBuffer();
 	}
 
+	// The text still points into the packet buffer, only the Lua events copy it
 	switch (type) {
 		case TALKTYPE_SAY:
 			internalCreatureSay(player, TALKTYPE_SAY, text, false);
@@ -6377,12 +6384,12 @@ void Game::playerSay(uint32_t playerId, uint16_t channelId, SpeakClasses type, c
 	}
 }
 
-bool Game::playerSaySpell(const std::shared_ptr<Player> &player, SpeakClasses type, const std::string &text) {
+bool Game::playerSaySpell(const std::shared_ptr<Player> &player, SpeakClasses type, std::string_view text) {
 	if (player->walkExhausted()) {
 		return true;
 	}
 
-	std::string words = text;
+	std::string words(text);
 	TalkActionResult_t result = g_talkActions().checkPlayerCanSayTalkAction(player, type, words);
 	if (result == TALKACTION_BREAK) {
 		return true;
@@ -6401,7 +6408,7 @@ bool Game::playerSaySpell(const std::shared_ptr<Player> &player, SpeakClasses ty
 	return false;
 }
 
-void Game::playerWhisper(const std::shared_ptr<Player> &player, const std::string &text) {
+void Game::playerWhisper(const std::shared_ptr<Player> &player, std::string_view text) {
 	auto spectators = Spectators().find<Player>(player->getPosition(), false, MAP_MAX_CLIENT_VIEW_PORT_X, MAP_MAX_CLIENT_VIEW_PORT_X, MAP_MAX_CLIENT_VIEW_PORT_Y, MAP_MAX_CLIENT_VIEW_PORT_Y);
 
 	// Send to client
@@ -6421,7 +6428,7 @@ void Game::playerWhisper(const std::shared_ptr<Player> &player, const std::strin
 	}
 }
 
-bool Game::playerYell(const std::shared_ptr<Player> &player, const std::string &text) {
+bool Game::playerYell(const std::shared_ptr<Player> &player, std::string_view text) {
 	if (player->getLevel() == 1) {
 		player->sendTextMessage(MESSAGE_FAILURE, "You may not yell as long as you are on level 1.");
 		return false;
@@ -6437,12 +6444,12 @@ bool Game::playerYell(const std::shared_ptr<Player> &player, const std::string &
 		player->addCondition(condition);
 	}
 
-	internalCreatureSay(player, TALKTYPE_YELL, asUpperCaseString(text), false);
+	internalCreatureSay(player, TALKTYPE_YELL, asUpperCaseString(std::string(text)), false);
 	return true;
 }
 
-bool Game::playerSpeakTo(const std::shared_ptr<Player> &player, SpeakClasses type, const std::string &receiver, const std::string &text) {
-	std::shared_ptr<Player> toPlayer = getPlayerByName(receiver);
+bool Game::playerSpeakTo(const std::shared_ptr<Player> &player, SpeakClasses type, std::string_view receiver, std::string_view text) {
+	std::shared_ptr<Player> toPlayer = getPlayerByName(std::string(receiver));
 	if (!toPlayer) {
 		player->sendTextMessage(MESSAGE_FAILURE, "A player with this name is not online.");
 		return false;
@@ -6467,7 +6474,7 @@ bool Game::playerSpeakTo(const std::shared_ptr<Player> &player, SpeakClasses typ
 	return true;
 }
 
-void Game::playerSpeakToNpc(const std::shared_ptr<Player> &player, const std::string &text) {
+void Game::playerSpeakToNpc(const std::shared_ptr<Player> &player, std::string_view text) {
 	if (player == nullptr) {
 		g_logger().error("[Game::playerSpeakToNpc] - Player is nullptr");
 		return;
@@ -6490,7 +6497,7 @@ void Game::playerSpeakToNpc(const std::shared_ptr<Player> &player, const std::st
 	player->updateUIExhausted();
 }
 
-std::shared_ptr<Task> Game::createPlayerTask(uint32_t delay, std::function<void(void)> f, const std::string &context) const {
+std::shared_ptr<Task> Game::createPlayerTask(uint32_t delay, std::function<void(void)> f, std::string_view context) const {
 	return Player::createPlayerTask(delay, std::move(f), context);
 }
 
@@ -6516,13 +6523,14 @@ bool Game::internalCreatureTurn(const std::shared_ptr<Creature> &creature, Direc
 		creature->setDirection(dir);
 	}
 
+	auto broadcast = ProtocolGame::broadcastCreatureTurn(creature);
 	for (const auto &spectator : Spectators().find<Player>(creature->getPosition(), true)) {
-		spectator->getPlayer()->sendCreatureTurn(creature);
+		spectator->getPlayer()->sendCreatureTurn(creature, broadcast);
 	}
 	return true;
 }
 
-bool Game::internalCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, bool ghostMode, Spectators* spectatorsPtr /* = nullptr*/, const Position* pos /* = nullptr*/) {
+bool Game::internalCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, std::string_view text, bool ghostMode, Spectators* spectatorsPtr /* = nullptr*/, const Position* pos /* = nullptr*/) {
 	if (text.empty()) {
 		return false;
 	}
@@ -6627,8 +6635,9 @@ void Game::changeSpeed(const std::shared_ptr<Creature> &creature, int32_t varSpe
 	creature->setSpeed(varSpeed);
 
 	// Send to clients
+	auto broadcast = ProtocolGame::broadcastChangeSpeed(creature, creature->getStepSpeed());
 	for (const auto &spectator : Spectators().find<Player>(creature->getPosition())) {
-		spectator->getPlayer()->sendChangeSpeed(creature, creature->getStepSpeed());
+		spectator->getPlayer()->sendBroadcast(broadcast);
 	}
 }
 
@@ -6636,8 +6645,9 @@ void Game::setCreatureSpeed(const std::shared_ptr<Creature> &creature, int32_t s
 	creature->setBaseSpeed(static_cast<uint16_t>(speed));
 
 	// Send creature speed to client
+	auto broadcast = ProtocolGame::broadcastChangeSpeed(creature, creature->getStepSpeed());
 	for (const auto &spectator : Spectators().find<Player>(creature->getPosition())) {
-		spectator->getPlayer()->sendChangeSpeed(creature, creature->getStepSpeed());
+		spectator->getPlayer()->sendBroadcast(broadcast);
 	}
 }
 
@@ -6648,8 +6658,9 @@ void Game::changePlayerSpeed(const std::shared_ptr<Player> &player, int32_t varS
 	player->setSpeed(varSpeed);
 
 	// Send new player speed to the spectators
+	auto broadcast = ProtocolGame::broadcastChangeSpeed(player, player->getStepSpeed());
 	for (const auto &creatureSpectator : Spectators().find<Player>(player->getPosition())) {
-		creatureSpectator->getPlayer()->sendChangeSpeed(player, player->getStepSpeed());
+		creatureSpectator->getPlayer()->sendBroadcast(broadcast);
 	}
 }
 
@@ -8180,9 +8191,10 @@ void Game::addCreatureHealth(const CreatureVector &spectators, const std::shared
 			}
 		}
 	}
+	auto broadcast = ProtocolGame::broadcastCreatureHealth(target);
 	for (const auto &spectator : spectators) {
 		if (const auto &tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendCreatureHealth(target);
+			tmpPlayer->sendCreatureHealth(target, broadcast);
 		}
 	}
 }
@@ -8210,9 +8222,10 @@ void Game::addMagicEffect(const Position &pos, uint16_t effect) {
 }
 
 void Game::addMagicEffect(const CreatureVector &spectators, const Position &pos, uint16_t effect) {
+	auto broadcast = ProtocolGame::broadcastMagicEffect(pos, effect);
 	for (const auto &spectator : spectators) {
 		if (const auto &tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendMagicEffect(pos, effect);
+			tmpPlayer->sendMagicEffect(pos, effect, broadcast);
 		}
 	}
 }
@@ -8236,9 +8249,10 @@ void Game::addDistanceEffect(const Position &fromPos, const Position &toPos, uin
 }
 
 void Game::addDistanceEffect(const CreatureVector &spectators, const Position &fromPos, const Position &toPos, uint16_t effect) {
+	auto broadcast = ProtocolGame::broadcastDistanceShoot(fromPos, toPos, effect);
 	for (const auto &spectator : spectators) {
 		if (const auto &tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendDistanceShoot(fromPos, toPos, effect);
+			tmpPlayer->sendDistanceShoot(fromPos, toPos, effect, broadcast);
 		}
 	}
 }
@@ -8363,6 +8377,9 @@ void Game::shutdown() {
 
 	ConnectionManager::getInstance().closeAll();
 
+	g_kv().stopWriteBack();
+	g_persistenceJournal().close();
+
 	g_luaEnvironment().collectGarbage();
 
 	g_logger().info("Done!");
@@ -8741,17 +8758,7 @@ void Game::playerCyclopediaCharacterInfo(const std::shared_ptr<Player> &player,
 	}
 }
 
-std::string Game::generateHighscoreQuery(
-	const std::string &categoryName,
-	uint32_t page,
-	uint8_t entriesPerPage,
-	uint32_t vocation,
-	uint32_t playerGUID /*= 0*/
-) {
-	uint32_t startPage = (page - 1) * static_cast<uint32_t>(entriesPerPage);
-	uint32_t endPage = startPage + static_cast<uint32_t>(entriesPerPage);
-	std::string entriesStr = std::to_string(entriesPerPage);
-
+std::string Game::generateHighscoreQuery(const std::string &categoryName, uint32_t vocation, bool ourRank) {
 	if (categoryName.empty()) {
 		g_logger().error("Category name cannot be empty.");
 		return "";
@@ -8761,10 +8768,10 @@ std::string Game::generateHighscoreQuery(
 		"SELECT `id`, `name`, `level`, `vocation`, `points`, `rank`, `rn` AS `entries`, "
 	);
 
-	if (playerGUID != 0) {
-		query += fmt::format("(@ourRow DIV {0}) + 1 AS `page` FROM (", entriesStr);
+	if (ourRank) {
+		query += "(@ourRow DIV ?) + 1 AS `page` FROM (";
 	} else {
-		query += fmt::format("{} AS `page` FROM (", page);
+		query += "? AS `page` FROM (";
 	}
 
 	query += fmt::format(
@@ -8774,8 +8781,8 @@ std::string Game::generateHighscoreQuery(
 		categoryName, categoryName, categoryName
 	);
 
-	if (playerGUID != 0) {
-		query += fmt::format(", @ourRow := IF(`id` = {}, @row - 1, @ourRow) AS `rw`", playerGUID);
+	if (ourRank) {
+		query += ", @ourRow := IF(`id` = ?, @row - 1, @ourRow) AS `rw`";
 	}
 
 	query += fmt::format(
@@ -8791,13 +8798,10 @@ std::string Game::generateHighscoreQuery(
 
 	query += ") `T` WHERE ";
 
-	if (playerGUID != 0) {
-		query += fmt::format(
-			"`rn` > ((@ourRow DIV {0}) * {0}) AND `rn` <= (((@ourRow DIV {0}) * {0}) + {0})",
-			entriesStr
-		);
+	if (ourRank) {
+		query += "`rn` > ((@ourRow DIV ?) * ?) AND `rn` <= (((@ourRow DIV ?) * ?) + ?)";
 	} else {
-		query += fmt::format("`rn` > {} AND `rn` <= {}", startPage, endPage);
+		query += "`rn` > ? AND `rn` <= ?";
 	}
 
 	return query;
@@ -8871,45 +8875,47 @@ void Game::processHighscoreResults(const DBResult_ptr &result, uint32_t playerID
 	}
 }
 
-void Game::cacheQueryHighscore(const std::string &key, const std::string &query, uint32_t page, uint8_t entriesPerPage) {
-	QueryHighscoreCacheEntry queryEntry { query, page, entriesPerPage, std::chrono::steady_clock::now() };
+void Game::cacheQueryHighscore(const std::string &key, const std::string &query) {
+	QueryHighscoreCacheEntry queryEntry { query, std::chrono::steady_clock::now() };
 	queryCache[key] = queryEntry;
 }
 
-std::string Game::generateHighscoreOrGetCachedQueryForEntries(const std::string &categoryName, uint32_t page, uint8_t entriesPerPage, uint32_t vocation) {
+DBStatement Game::generateHighscoreOrGetCachedQueryForEntries(const std::string &categoryName, uint32_t page, uint8_t entriesPerPage, uint32_t vocation) {
 	std::ostringstream cacheKeyStream;
-	cacheKeyStream << "Entries_" << categoryName << "_" << page << "_" << static_cast<int>(entriesPerPage) << "_" << vocation;
+	cacheKeyStream << "Entries_" << categoryName << "_" << vocation;
 	std::string cacheKey = cacheKeyStream.str();
 
-	if (queryCache.find(cacheKey) != queryCache.end()) {
-		const QueryHighscoreCacheEntry &cachedEntry = queryCache[cacheKey];
-		if (cachedEntry.page == page) {
-			return cachedEntry.query;
-		}
+	auto it = queryCache.find(cacheKey);
+	if (it == queryCache.end()) {
+		cacheQueryHighscore(cacheKey, generateHighscoreQuery(categoryName, vocation, false));
+		it = queryCache.find(cacheKey);
 	}
 
-	std::string newQuery = generateHighscoreQuery(categoryName, page, entriesPerPage, vocation);
-	cacheQueryHighscore(cacheKey, newQuery, page, entriesPerPage);
+	uint32_t startPage = (page - 1) * static_cast<uint32_t>(entriesPerPage);
+	uint32_t endPage = startPage + static_cast<uint32_t>(entriesPerPage);
 
-	return newQuery;
+	DBStatement statement(it->second.query);
+	statement.bind(page).bind(startPage).bind(endPage);
+	return statement;
 }
 
-std::string Game::generateHighscoreOrGetCachedQueryForOurRank(const std::string &categoryName, uint8_t entriesPerPage, uint32_t playerGUID, uint32_t vocation) {
+DBStatement Game::generateHighscoreOrGetCachedQueryForOurRank(const std::string &categoryName, uint8_t entriesPerPage, uint32_t playerGUID, uint32_t vocation) {
 	std::ostringstream cacheKeyStream;
-	cacheKeyStream << "OurRank_" << categoryName << "_" << static_cast<int>(entriesPerPage) << "_" << playerGUID << "_" << vocation;
+	cacheKeyStream << "OurRank_" << categoryName << "_" << vocation;
 	std::string cacheKey = cacheKeyStream.str();
 
-	if (queryCache.find(cacheKey) != queryCache.end()) {
-		const QueryHighscoreCacheEntry &cachedEntry = queryCache[cacheKey];
-		if (cachedEntry.page == entriesPerPage) {
-			return cachedEntry.query;
-		}
+	auto it = queryCache.find(cacheKey);
+	if (it == queryCache.end()) {
+		cacheQueryHighscore(cacheKey, generateHighscoreQuery(categoryName, vocation, true));
+		it = queryCache.find(cacheKey);
 	}
 
-	std::string newQuery = generateHighscoreQuery(categoryName, 0, entriesPerPage, vocation, playerGUID);
-	cacheQueryHighscore(cacheKey, newQuery, entriesPerPage, entriesPerPage);
-
-	return newQuery;
+	DBStatement statement(it->second.query);
+	statement.bind(entriesPerPage).bind(playerGUID);
+	for (int i = 0; i < 5; ++i) {
+		statement.bind(entriesPerPage);
+	}
+	return statement;
 }
 
 void Game::playerHighscores(const std::shared_ptr<Player> &player, HighscoreType_t type, uint8_t category, uint32_t vocation, const std::string &, uint16_t page, uint8_t entriesPerPage) {
@@ -8919,11 +8925,14 @@ void Game::playerHighscores(const std::shared_ptr<Player> &player, HighscoreType
 
 	std::string categoryName = getSkillNameById(category);
 
-	std::string query;
+	std::optional<DBStatement> statement;
 	if (type == HIGHSCORE_GETENTRIES) {
-		query = generateHighscoreOrGetCachedQueryForEntries(categoryName, page, entriesPerPage, vocation);
+		statement = generateHighscoreOrGetCachedQueryForEntries(categoryName, page, entriesPerPage, vocation);
 	} else if (type == HIGHSCORE_OURRANK) {
-		query = generateHighscoreOrGetCachedQueryForOurRank(categoryName, entriesPerPage, player->getGUID(), vocation);
+		statement = generateHighscoreOrGetCachedQueryForOurRank(categoryName, entriesPerPage, player->getGUID(), vocation);
+	}
+	if (!statement) {
+		return;
 	}
 
 	uint32_t playerID = player->getID();
@@ -8931,7 +8940,7 @@ void Game::playerHighscores(const std::shared_ptr<Player> &player, HighscoreType
 		processHighscoreResults(result, playerID, category, vocation, entriesPerPage);
 	};
 
-	g_databaseTasks().store(query, callback);
+	g_databaseTasks().store(std::move(*statement), callback);
 	player->addAsyncOngoingTask(PlayerAsyncTask_Highscore);
 }
 
@@ -9644,7 +9653,7 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 	g_saveManager().savePlayer(player);
 }
 
-void Game::parsePlayerExtendedOpcode(uint32_t playerId, uint8_t opcode, const std::string &buffer) {
+void Game::parsePlayerExtendedOpcode(uint32_t playerId, uint8_t opcode, std::string_view buffer) {
 	const auto &player = getPlayerByID(playerId);
 	if (!player) {
 		return;
@@ -9911,6 +9920,7 @@ void Game::playerSetMonsterPodium(uint32_t playerId, uint32_t monsterRaceId, con
 		item->removeAttribute(ItemAttribute_t::NAME);
 	}
 
+	tile->invalidateDescriptionCache();
 	for (const auto &spectator : Spectators().find<Player>(pos, true)) {
 		spectator->getPlayer()->sendUpdateTileItem(tile, pos, item);
 	}
@@ -11091,7 +11101,6 @@ void Game::updatePlayersOnline() const {
 	// Function to be executed within the transaction
 	auto updateOperation = [this]() {
 		const auto &m_players = getPlayers();
-		bool changesMade = false;
 
 		// g_metrics().addUpDownCounter("players_online", 1);
 		// g_metrics().addUpDownCounter("players_online", -1);
@@ -11102,7 +11111,6 @@ void Game::updatePlayersOnline() const {
 			int count = result->getNumber<int>("count");
 			if (count > 0) {
 				g_database().executeQuery("DELETE FROM `players_online`;");
-				changesMade = true;
 			}
 		} else {
 			// Insert the current players
@@ -11113,7 +11121,6 @@ void Game::updatePlayersOnline() const {
 				stmt.addRow(playerQuery.str());
 			}
 			stmt.execute();
-			changesMade = true;
 
 			// Remove players who are no longer online
 			std::ostringstream cleanupQuery;
@@ -11126,7 +11133,8 @@ void Game::updatePlayersOnline() const {
 			g_database().executeQuery(cleanupQuery.str());
 		}
 
-		return changesMade;
+		// Nothing to do is not a failure, a rolled back transaction is
+		return true;
 	};
 
 	const bool success = DBTransaction::executeWithinTransaction(updateOperation);
@@ -11210,6 +11218,7 @@ void Game::refreshItem(const std::shared_ptr<Item> &item) {
 		return;
 	}
 	if (const auto &tile = parent->getTile()) {
+		tile->invalidateDescriptionCache();
 		const auto spectators = Spectators().find<Player>(tile->getPosition(), true);
 		// send to client
 		for (const auto &spectator : spectators) {
@@ -67,6 +67,7 @@ static constexpr int32_t EVENT_DECAYINTERVAL = 250;
 static constexpr int32_t EVENT_DECAY_BUCKETS = 4;
 static constexpr int32_t EVENT_FORGEABLEMONSTERCHECKINTERVAL = 300000;
 static constexpr int32_t EVENT_LUA_GARBAGE_COLLECTION = 60000 * 10; // 10min
+static constexpr int32_t EVENT_RETIRED_TILES_INTERVAL = 10000;
 
 static constexpr std::chrono::minutes CACHE_EXPIRATION_TIME { 10 }; // 10min
 static constexpr std::chrono::minutes HIGHSCORE_CACHE_EXPIRATION_TIME { 10 }; // 10min
@@ -74,8 +75,6 @@ static constexpr int32_t UPDATE_PLAYERS_ONLINE_DB = 60000 * 10; // 10min
 
 struct QueryHighscoreCacheEntry {
 	std::string query;
-	uint32_t page;
-	uint8_t entriesPerPage;
 	std::chrono::time_point<std::chrono::steady_clock> timestamp;
 };
 
@@ -229,7 +228,7 @@ public:
 
 	bool internalCreatureTurn(const std::shared_ptr<Creature> &creature, Direction dir);
 
-	bool internalCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, bool ghostMode, Spectators* spectatorsPtr = nullptr, const Position* pos = nullptr);
+	bool internalCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, std::string_view text, bool ghostMode, Spectators* spectatorsPtr = nullptr, const Position* pos = nullptr);
 
 	ObjectCategory_t getObjectCategory(const std::shared_ptr<Item> &item);
 	ObjectCategory_t getObjectCategory(const ItemType &it);
@@ -305,7 +304,7 @@ public:
 
 	bool internalStartTrade(const std::shared_ptr<Player> &player, const std::shared_ptr<Player> &partner, const std::shared_ptr<Item> &tradeItem);
 	void internalCloseTrade(const std::shared_ptr<Player> &player);
-	bool playerBroadcastMessage(const std::shared_ptr<Player> &player, const std::string &text) const;
+	bool playerBroadcastMessage(const std::shared_ptr<Player> &player, std::string_view text) const;
 	void broadcastMessage(const std::string &text, MessageClasses type) const;
 
 	// Implementation of player invoked events
@@ -386,7 +385,7 @@ public:
 	void playerRequestOutfit(uint32_t playerId);
 	void playerShowQuestLog(uint32_t playerId);
 	void playerShowQuestLine(uint32_t playerId, uint16_t questId);
-	void playerSay(uint32_t playerId, uint16_t channelId, SpeakClasses type, const std::string &receiver, const std::string &text);
+	void playerSay(uint32_t playerId, uint16_t channelId, SpeakClasses type, std::string_view receiver, std::string_view text);
 	void playerChangeOutfit(uint32_t playerId, Outfit_t outfit, bool setMount, uint8_t isMountRandomized = 0);
 	void playerInviteToParty(uint32_t playerId, uint32_t invitedId);
 	void playerJoinParty(uint32_t playerId, uint32_t leaderId);
@@ -403,7 +402,7 @@ public:
 	void playerCancelMarketOffer(uint32_t playerId, uint32_t timestamp, uint16_t counter);
 	void playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16_t counter, uint16_t amount);
 
-	void parsePlayerExtendedOpcode(uint32_t playerId, uint8_t opcode, const std::string &buffer);
+	void parsePlayerExtendedOpcode(uint32_t playerId, uint8_t opcode, std::string_view buffer);
 
 	void playerOpenWheel(uint32_t playerId, uint32_t ownerId);
 	void playerSaveWheel(uint32_t playerId, NetworkMessage &msg);
@@ -726,12 +725,12 @@ private:
 	std::unordered_set<uint32_t> fiendishMonsters;
 	std::unordered_set<uint32_t> influencedMonsters;
 	void checkImbuements() const;
-	bool playerSaySpell(const std::shared_ptr<Player> &player, SpeakClasses type, const std::string &text);
-	void playerWhisper(const std::shared_ptr<Player> &player, const std::string &text);
-	bool playerYell(const std::shared_ptr<Player> &player, const std::string &text);
-	bool playerSpeakTo(const std::shared_ptr<Player> &player, SpeakClasses type, const std::string &receiver, const std::string &text);
-	void playerSpeakToNpc(const std::shared_ptr<Player> &player, const std::string &text);
-	std::shared_ptr<Task> createPlayerTask(uint32_t delay, std::function<void(void)> f, const std::string &context) const;
+	bool playerSaySpell(const std::shared_ptr<Player> &player, SpeakClasses type, std::string_view text);
+	void playerWhisper(const std::shared_ptr<Player> &player, std::string_view text);
+	bool playerYell(const std::shared_ptr<Player> &player, std::string_view text);
+	bool playerSpeakTo(const std::shared_ptr<Player> &player, SpeakClasses type, std::string_view receiver, std::string_view text);
+	void playerSpeakToNpc(const std::shared_ptr<Player> &player, std::string_view text);
+	std::shared_ptr<Task> createPlayerTask(uint32_t delay, std::function<void(void)> f, std::string_view context) const;
 
 	/**
 	 * @brief Finds the next available sub-container within a container.
@@ -929,19 +928,14 @@ private:
 
 	std::unique_ptr<AttachedEffects> m_attachedEffects;
 
-	void cacheQueryHighscore(const std::string &key, const std::string &query, uint32_t page, uint8_t entriesPerPage);
+	void cacheQueryHighscore(const std::string &key, const std::string &query);
 	void processHighscoreResults(const DBResult_ptr &result, uint32_t playerID, uint8_t category, uint32_t vocation, uint8_t entriesPerPage);
 
 	std::string generateVocationConditionHighscore(uint32_t vocation);
-	std::string generateHighscoreQuery(
-		const std::string &categoryName,
-		uint32_t page,
-		uint8_t entriesPerPage,
-		uint32_t vocation,
-		uint32_t playerGUID = 0
-	);
-	std::string generateHighscoreOrGetCachedQueryForEntries(const std::string &categoryName, uint32_t page, uint8_t entriesPerPage, uint32_t vocation);
-	std::string generateHighscoreOrGetCachedQueryForOurRank(const std::string &categoryName, uint8_t entriesPerPage, uint32_t playerGUID, uint32_t vocation);
+	// Prepared statement text, the page, the entries per page and the player are bound on execution
+	std::string generateHighscoreQuery(const std::string &categoryName, uint32_t vocation, bool ourRank);
+	DBStatement generateHighscoreOrGetCachedQueryForEntries(const std::string &categoryName, uint32_t page, uint8_t entriesPerPage, uint32_t vocation);
+	DBStatement generateHighscoreOrGetCachedQueryForOurRank(const std::string &categoryName, uint8_t entriesPerPage, uint32_t playerGUID, uint32_t vocation);
 
 	void updatePlayersOnline() const;
 };
@@ -9,6 +9,7 @@
 
 #include "game/scheduling/dispatcher.hpp"
 
+#include "config/configmanager.hpp"
 #include "lib/thread/thread_pool.hpp"
 #include "lib/di/container.hpp"
 #include "utils/tools.hpp"
@@ -25,18 +26,26 @@ void Dispatcher::init() {
 	auto dispatcherStarted = std::make_shared<std::promise<void>>();
 	auto futureStarted = dispatcherStarted->get_future();
 
+	scheduledTasks.setCurrentTime(OTSYS_TIME());
+
 	threadPool.detach_task([this, dispatcherStarted]() mutable {
 		std::unique_lock asyncLock(dummyMutex);
+		dispatcherThreadId = ThreadPool::getThreadId();
 
 		dispatcherStarted->set_value();
 
 		while (!threadPool.isStopped()) {
 			UPDATE_OTSYS_TIME();
+			taskProfiler.beginTick();
 
 			executeEvents();
 			executeScheduledEvents();
 			mergeEvents();
 
+			// The config is loaded by the first task, there is no budget before that
+			const auto &config = g_configManager();
+			taskProfiler.endTick(config.isLoaded() ? std::max(config.getNumber(DISPATCHER_SLOW_TICK_BUDGET), 0) : 0);
+
 			if (!hasPendingTasks) {
 				signalSchedule.wait_for(asyncLock, timeUntilNextScheduledTask());
 			}
@@ -59,8 +68,10 @@ void Dispatcher::executeSerialEvents(const uint8_t groupId) {
 
 	for (const auto &task : tasks) {
 		dispacherContext.taskName = task.getContext();
+		const auto start = TaskProfiler::Clock::now();
 		if (task.execute()) {
 			++dispatcherCycle;
+			taskProfiler.addTickTask(task.getContextId(), taskProfiler.record(task.getContextId(), start));
 		}
 	}
 	tasks.clear();
@@ -74,51 +85,25 @@ void Dispatcher::executeParallelEvents(const uint8_t groupId) {
 		return;
 	}
 
-	asyncWait(tasks.size(), [groupId, &tasks](size_t i) {
+	// Parallel tasks show up in the slow cycle report as the wall time of the whole group
+	static const auto parallelContext = Task::internContext(__FUNCTION__);
+	const auto groupStart = TaskProfiler::Clock::now();
+
+	asyncWait(tasks.size(), [this, groupId, &tasks](size_t i) {
 		dispacherContext.type = DispatcherType::AsyncEvent;
 		dispacherContext.group = static_cast<TaskGroup>(groupId);
-		tasks[i].execute();
+		const auto &task = tasks[i];
+		const auto start = TaskProfiler::Clock::now();
+		if (task.execute()) {
+			taskProfiler.record(task.getContextId(), start);
+		}
 
 		dispacherContext.reset();
 	});
 
-	tasks.clear();
-}
+	taskProfiler.addTickTask(parallelContext.id, taskProfiler.record(parallelContext.id, groupStart));
 
-void Dispatcher::asyncWait(size_t requestSize, std::function<void(size_t i)> &&f) {
-	if (requestSize == 0) {
-		return;
-	}
-
-	// This prevents an async call from running inside another async call.
-	if (asyncWaitDisabled) {
-		for (uint_fast64_t i = 0; i < requestSize; ++i) {
-			f(i);
-		}
-		return;
-	}
-
-	const auto &partitions = generatePartition(requestSize);
-	const auto pSize = partitions.size();
-
-	BS::multi_future<void> retFuture;
-
-	if (pSize > 1) {
-		asyncWaitDisabled = true;
-		const auto min = partitions[1].first;
-		const auto max = partitions[partitions.size() - 1].second;
-		retFuture = threadPool.submit_loop(min, max, [&f](const unsigned int i) { f(i); });
-	}
-
-	const auto &[min, max] = partitions[0];
-	for (uint_fast64_t i = min; i < max; ++i) {
-		f(i);
-	}
-
-	if (pSize > 1) {
-		retFuture.wait();
-		asyncWaitDisabled = false;
-	}
+	tasks.clear();
 }
 
 void Dispatcher::executeEvents(const TaskGroup startGroup) {
@@ -136,32 +121,33 @@ void Dispatcher::executeEvents(const TaskGroup startGroup) {
 }
 
 void Dispatcher::executeScheduledEvents() {
-	auto &threadScheduledTasks = getThreadTask()->scheduledTasks;
-
-	auto it = scheduledTasks.begin();
-	while (it != scheduledTasks.end()) {
-		const auto &task = *it;
-		if (task->getTime() > OTSYS_TIME()) {
-			break;
-		}
+	// A due event stopped by another thread must not fire once more before its cancellation is merged
+	mergeScheduledEvents();
 
-		dispacherContext.type = task->isCycle() ? DispatcherType::CycleEvent : DispatcherType::ScheduledEvent;
+	scheduledTasks.advance(OTSYS_TIME(), [this](Task &task, uint32_t) -> int64_t {
+		dispacherContext.type = task.isCycle() ? DispatcherType::CycleEvent : DispatcherType::ScheduledEvent;
 		dispacherContext.group = TaskGroup::Serial;
-		dispacherContext.taskName = task->getContext();
+		dispacherContext.taskName = task.getContext();
 
-		if (task->execute() && task->isCycle()) {
-			task->updateTime();
-			threadScheduledTasks.emplace_back(task);
-		} else {
-			scheduledTasksRef.erase(task->getId());
+		const auto eventId = task.getId();
+		const auto start = TaskProfiler::Clock::now();
+		const bool executed = task.execute();
+		if (executed) {
+			taskProfiler.addTickTask(task.getContextId(), taskProfiler.record(task.getContextId(), start));
 		}
 
-		++it;
-	}
+		if (executed && task.isCycle()) {
+			// The event may have been stopped by itself
+			if (scheduledTasksRef.contains(eventId)) {
+				task.updateTime();
+				return task.getTime();
+			}
+		} else {
+			scheduledTasksRef.erase(eventId);
+		}
 
-	if (it != scheduledTasks.begin()) {
-		scheduledTasks.erase(scheduledTasks.begin(), it);
-	}
+		return -1;
+	});
 
 	dispacherContext.reset();
 
@@ -186,11 +172,53 @@ void Dispatcher::__mergeEvents(const std::array<uint8_t, 2> &groups, const bool
 			}
 		}
 
-		if (mergeScheduledEvents && !thread->scheduledTasks.empty()) {
-			scheduledTasks.insert(make_move_iterator(thread->scheduledTasks.begin()), make_move_iterator(thread->scheduledTasks.end()));
-			thread->scheduledTasks.clear();
+		if (mergeScheduledEvents) {
+			mergeThreadScheduledEvents(*thread);
 		}
 	}
+
+	if (mergeScheduledEvents) {
+		mergeCanceledEvents();
+	}
+}
+
+// Merge only the events scheduled and stopped by other threads
+void Dispatcher::mergeScheduledEvents() {
+	for (const auto &thread : threads) {
+		std::scoped_lock lock(thread->mutex);
+		mergeThreadScheduledEvents(*thread);
+	}
+
+	mergeCanceledEvents();
+}
+
+// The caller must hold the thread mutex
+void Dispatcher::mergeThreadScheduledEvents(ThreadTask &thread) {
+	for (auto &task : thread.scheduledTasks) {
+		addScheduledTask(std::move(task));
+	}
+	thread.scheduledTasks.clear();
+
+	if (!thread.canceledTasks.empty()) {
+		canceledTasks.insert(canceledTasks.end(), thread.canceledTasks.begin(), thread.canceledTasks.end());
+		thread.canceledTasks.clear();
+	}
+}
+
+// Applies the cancellations requested outside the dispatcher thread (or before their task was merged).
+// A cancellation whose task is not found yet is kept for one more merge, since the task can be sitting
+// in the queue of a thread that was already merged when the cancellation arrived.
+void Dispatcher::mergeCanceledEvents() {
+	size_t retry = 0;
+	for (size_t i = 0; i < canceledTasks.size(); ++i) {
+		const auto eventId = canceledTasks[i];
+		if (!cancelScheduledTask(eventId) && i >= canceledTasksRetry) {
+			canceledTasks[retry++] = eventId;
+		}
+	}
+
+	canceledTasks.resize(retry);
+	canceledTasksRetry = retry;
 }
 
 // Merge only async thread events with main dispatch events
@@ -214,12 +242,11 @@ std::chrono::milliseconds Dispatcher::timeUntilNextScheduledTask() const {
 		return CHRONO_MILI_MAX;
 	}
 
-	const auto &task = *scheduledTasks.begin();
-	const auto timeRemaining = std::chrono::milliseconds(task->getTime() - OTSYS_TIME());
+	const auto timeRemaining = std::chrono::milliseconds(scheduledTasks.nextExpiration() - OTSYS_TIME());
 	return std::max<std::chrono::milliseconds>(timeRemaining, CHRONO_0);
 }
 
-void Dispatcher::addEvent(std::function<void(void)> &&f, std::string_view context, uint32_t expiresAfterMs) {
+void Dispatcher::addEvent(TaskFunction &&f, std::string_view context, uint32_t expiresAfterMs) {
 	if (shuttingDown) {
 		return;
 	}
@@ -230,7 +257,7 @@ void Dispatcher::addEvent(std::function<void(void)> &&f, std::string_view contex
 	notify();
 }
 
-void Dispatcher::addWalkEvent(std::function<void(void)> &&f, uint32_t expiresAfterMs) {
+void Dispatcher::addWalkEvent(TaskFunction &&f, uint32_t expiresAfterMs) {
 	if (shuttingDown) {
 		return;
 	}
@@ -242,22 +269,35 @@ void Dispatcher::addWalkEvent(std::function<void(void)> &&f, uint32_t expiresAft
 }
 
 uint64_t Dispatcher::scheduleEvent(const std::shared_ptr<Task> &task) {
+	return scheduleEvent(std::move(*task));
+}
+
+uint64_t Dispatcher::scheduleEvent(Task &&task) {
 	if (shuttingDown) {
 		return 0;
 	}
 
+	const auto eventId = task.getId();
+	if (isDispatcherThread()) {
+		addScheduledTask(std::move(task));
+		return eventId;
+	}
+
 	const auto &thread = getThreadTask();
 	std::scoped_lock lock(thread->mutex);
-
-	auto eventId = scheduledTasksRef
-					   .emplace(task->getId(), thread->scheduledTasks.emplace_back(task))
-					   .first->first;
+	thread->scheduledTasks.emplace_back(std::move(task));
 
 	notify();
 	return eventId;
 }
 
-void Dispatcher::asyncEvent(std::function<void(void)> &&f, TaskGroup group) {
+void Dispatcher::addScheduledTask(Task &&task) {
+	const auto eventId = task.getId();
+	const auto time = task.getTime();
+	scheduledTasksRef.emplace(eventId, scheduledTasks.insert(time, std::move(task)));
+}
+
+void Dispatcher::asyncEvent(TaskFunction &&f, TaskGroup group) {
 	if (shuttingDown) {
 		return;
 	}
@@ -269,14 +309,32 @@ void Dispatcher::asyncEvent(std::function<void(void)> &&f, TaskGroup group) {
 }
 
 void Dispatcher::stopEvent(uint64_t eventId) {
-	auto it = scheduledTasksRef.find(eventId);
-	if (it != scheduledTasksRef.end()) {
-		it->second->cancel();
-		scheduledTasksRef.erase(it);
+	if (!isDispatcherThread()) {
+		const auto &thread = getThreadTask();
+		std::scoped_lock lock(thread->mutex);
+		thread->canceledTasks.emplace_back(eventId);
+		return;
+	}
+
+	// Not merged yet, it will be canceled on the next merge
+	if (!cancelScheduledTask(eventId)) {
+		canceledTasks.emplace_back(eventId);
 	}
 }
 
-void Dispatcher::safeCall(std::function<void(void)> &&f) {
+bool Dispatcher::cancelScheduledTask(uint64_t eventId) {
+	const auto it = scheduledTasksRef.find(eventId);
+	if (it == scheduledTasksRef.end()) {
+		return false;
+	}
+
+	// A running task is not linked to the wheel, it will be released once it returns
+	scheduledTasks.erase(it->second);
+	scheduledTasksRef.erase(it);
+	return true;
+}
+
+void Dispatcher::safeCall(TaskFunction &&f) {
 	if (dispacherContext.isAsync()) {
 		addEvent(std::move(f), dispacherContext.taskName);
 	} else {
@@ -10,6 +10,9 @@
 #pragma once
 
 #include "task.hpp"
+#include "task_profiler.hpp"
+#include "timer_wheel.hpp"
+#include "lib/thread/parallel_executor.hpp"
 #include "lib/thread/thread_pool.hpp"
 
 static constexpr uint16_t DISPATCHER_TASK_EXPIRATION = 2000;
@@ -32,6 +35,14 @@ enum class DispatcherType : uint8_t {
 	CycleEvent
 };
 
+struct DispatcherStats {
+	// Task callables that did not fit the inline buffer nor a pooled block
+	uint64_t taskHeapAllocations = 0;
+	// Distinct task context names interned so far, at most Task::MAX_CONTEXTS - 1
+	uint64_t internedContexts = 0;
+	ParallelExecutorStats parallel;
+};
+
 struct DispatcherContext {
 	static bool isOn();
 
@@ -77,13 +88,14 @@ private:
 class Dispatcher {
 public:
 	explicit Dispatcher(ThreadPool &threadPool) :
-		threadPool(threadPool) {
+		threadPool(threadPool), parallelExecutor(threadPool), taskProfiler(threadPool.get_thread_count() + 1) {
 		threads.reserve(threadPool.get_thread_count() + 1);
 		for (uint_fast16_t i = 0; i < threads.capacity(); ++i) {
 			threads.emplace_back(std::make_unique<ThreadTask>());
 		}
 
 		scheduledTasksRef.reserve(2000);
+		canceledTasks.reserve(2000);
 	}
 
 	// Ensures that we don't accidentally copy it
@@ -92,76 +104,109 @@ public:
 
 	static Dispatcher &getInstance();
 
-	void addEvent(std::function<void(void)> &&f, std::string_view context, uint32_t expiresAfterMs = 0);
-	void addWalkEvent(std::function<void(void)> &&f, uint32_t expiresAfterMs = 0); // No need context name
+	void init();
+	void shutdown() {
+		signalSchedule.notify_all();
+		shuttingDown = true;
+	}
+
+	void addEvent(TaskFunction &&f, std::string_view context, uint32_t expiresAfterMs = 0);
+	void addWalkEvent(TaskFunction &&f, uint32_t expiresAfterMs = 0); // No need context name
 
-	uint64_t cycleEvent(uint32_t delay, std::function<void(void)> &&f, std::string_view context) {
+	uint64_t cycleEvent(uint32_t delay, TaskFunction &&f, std::string_view context) {
 		return scheduleEvent(delay, std::move(f), context, true);
 	}
 
+	// The task is moved into the dispatcher, it must not be scheduled again
 	uint64_t scheduleEvent(const std::shared_ptr<Task> &task);
-	uint64_t scheduleEvent(uint32_t delay, std::function<void(void)> &&f, std::string_view context) {
+	uint64_t scheduleEvent(uint32_t delay, TaskFunction &&f, std::string_view context) {
 		return scheduleEvent(delay, std::move(f), context, false);
 	}
 
-	void asyncEvent(std::function<void(void)> &&f, TaskGroup group = TaskGroup::GenericParallel);
-	void asyncWait(size_t size, std::function<void(size_t i)> &&f);
+	void asyncEvent(TaskFunction &&f, TaskGroup group = TaskGroup::GenericParallel);
 
-	uint64_t asyncCycleEvent(uint32_t delay, std::function<void(void)> &&f, TaskGroup group = TaskGroup::GenericParallel) {
+	/**
+	 * @brief Calls f(i) for every i in [0, size) in parallel and waits for all of them.
+	 * Can be nested: a call made from inside f shares its work with the idle threads.
+	 */
+	template <typename F>
+	void asyncWait(size_t size, F &&f) {
+		parallelExecutor.parallelFor(size, std::forward<F>(f));
+	}
+
+	uint64_t asyncCycleEvent(uint32_t delay, TaskFunction &&f, TaskGroup group = TaskGroup::GenericParallel) {
+		// Shared, since every cycle posts a new async event calling it
 		return scheduleEvent(
-			delay, [this, f = std::move(f), group] { asyncEvent([f] { f(); }, group); }, dispacherContext.taskName, true, false
+			delay, [this, f = std::make_shared<TaskFunction>(std::move(f)), group] { asyncEvent([f] { (*f)(); }, group); }, dispacherContext.taskName, true, false
 		);
 	}
 
-	uint64_t asyncScheduleEvent(uint32_t delay, std::function<void(void)> &&f, TaskGroup group = TaskGroup::GenericParallel) {
+	uint64_t asyncScheduleEvent(uint32_t delay, TaskFunction &&f, TaskGroup group = TaskGroup::GenericParallel) {
 		return scheduleEvent(
-			delay, [this, f = std::move(f), group] { asyncEvent([f] { f(); }, group); }, dispacherContext.taskName, false, false
+			delay, [this, f = std::move(f), group]() mutable { asyncEvent(std::move(f), group); }, dispacherContext.taskName, false, false
 		);
 	}
 
 	/**
-	 * @brief Executes an action wrapped in a std::function safely on the dispatcher thread.
+	 * @brief Executes an action wrapped in a TaskFunction safely on the dispatcher thread.
 	 *
 	 * This method ensures that the given function is executed on the correct thread (the dispatcher thread).
 	 * If this method is called from a different thread, it will redirect execution to the dispatcher thread,
 	 * using appropriate mechanisms (such as message queues or event loops).
 	 * If called directly from the dispatcher thread, it will execute the function immediately.
 	 *
-	 * @param action The function wrapped in a std::function<void(void)> that should be executed.
+	 * @param action The function wrapped in a TaskFunction that should be executed.
 	 *
 	 * @note This method is useful in multi-threaded applications to avoid race conditions or thread context violations.
 	 */
-	void safeCall(std::function<void(void)> &&f);
+	void safeCall(TaskFunction &&f);
 
 	[[nodiscard]] uint64_t getDispatcherCycle() const {
 		return dispatcherCycle;
 	}
 
+	[[nodiscard]] DispatcherStats getStats() const {
+		return { InlineFunctionBlock::heapAllocations(), Task::getInternedContexts(), parallelExecutor.getStats() };
+	}
+
 	void stopEvent(uint64_t eventId);
 
+	[[nodiscard]] TaskProfiler &profiler() {
+		return taskProfiler;
+	}
+
 	const auto &context() const {
 		return dispacherContext;
 	}
 
 private:
+	struct ThreadTask;
+
 	thread_local static DispatcherContext dispacherContext;
 
+	// The network threads are outside the pool and share the queues, which are all locked
 	const auto &getThreadTask() const {
-		return threads[ThreadPool::getThreadId()];
+		return threads[static_cast<size_t>(ThreadPool::getThreadId()) % threads.size()];
 	}
 
-	uint64_t scheduleEvent(uint32_t delay, std::function<void(void)> &&f, std::string_view context, bool cycle, bool log = true) {
-		return scheduleEvent(std::make_shared<Task>(std::move(f), context, delay, cycle, log));
+	uint64_t scheduleEvent(uint32_t delay, TaskFunction &&f, std::string_view context, bool cycle, bool log = true) {
+		return scheduleEvent(Task(std::move(f), context, delay, cycle, log));
 	}
 
-	void init();
-	void shutdown() {
-		signalSchedule.notify_all();
-		shuttingDown = true;
+	uint64_t scheduleEvent(Task &&task);
+
+	bool isDispatcherThread() const {
+		return ThreadPool::getThreadId() == dispatcherThreadId.load(std::memory_order_relaxed);
 	}
 
+	inline void addScheduledTask(Task &&task);
+	inline bool cancelScheduledTask(uint64_t eventId);
+	inline void mergeCanceledEvents();
+
 	inline void mergeAsyncEvents();
 	inline void mergeEvents();
+	inline void mergeScheduledEvents();
+	inline void mergeThreadScheduledEvents(ThreadTask &thread);
 	inline void __mergeEvents(const std::array<uint8_t, 2> &groups, const bool mergeScheduledEvents);
 
 	inline void executeEvents(const TaskGroup startGroup = TaskGroup::Walk);
@@ -188,25 +233,11 @@ private:
 		}
 	}
 
-	std::vector<std::pair<uint64_t, uint64_t>> generatePartition(size_t size) const {
-		if (size == 0) {
-			return {};
-		}
-
-		std::vector<std::pair<uint64_t, uint64_t>> list;
-		list.reserve(threadPool.get_thread_count());
-
-		const auto size_per_block = std::ceil(size / static_cast<float>(threadPool.get_thread_count()));
-		for (uint_fast64_t i = 0; i < size; i += size_per_block) {
-			list.emplace_back(i, std::min<uint64_t>(size, i + size_per_block));
-		}
-
-		return list;
-	}
-
 	uint_fast64_t dispatcherCycle = 0;
 
 	ThreadPool &threadPool;
+	ParallelExecutor parallelExecutor;
+	TaskProfiler taskProfiler;
 	std::condition_variable signalSchedule;
 	std::atomic_bool hasPendingTasks = false;
 	std::mutex dummyMutex; // This is only used for signaling the condition variable and not as an actual lock.
@@ -221,7 +252,9 @@ private:
 		}
 
 		std::array<std::vector<Task>, static_cast<uint8_t>(TaskGroup::Last)> tasks;
-		std::vector<std::shared_ptr<Task>> scheduledTasks;
+		// Scheduled tasks and cancellations requested outside the dispatcher thread
+		std::vector<Task> scheduledTasks;
+		std::vector<uint64_t> canceledTasks;
 		std::mutex mutex;
 	};
 
@@ -229,10 +262,14 @@ private:
 
 	// Main Events
 	std::array<std::vector<Task>, static_cast<uint8_t>(TaskGroup::Last)> m_tasks;
-	phmap::btree_multiset<std::shared_ptr<Task>, Task::Compare> scheduledTasks {};
-	phmap::parallel_flat_hash_map_m<uint64_t, std::shared_ptr<Task>> scheduledTasksRef {};
-
-	bool asyncWaitDisabled = false;
+	// Scheduled Events, only touched by the dispatcher thread
+	TimerWheel<Task> scheduledTasks;
+	phmap::flat_hash_map<uint64_t, uint32_t> scheduledTasksRef {};
+	// Cancellations waiting for their task to be merged, the first `canceledTasksRetry` ones are on their last try
+	std::vector<uint64_t> canceledTasks;
+	size_t canceledTasksRetry = 0;
+
+	std::atomic_int16_t dispatcherThreadId = -1;
 
 	bool shuttingDown = false;
 
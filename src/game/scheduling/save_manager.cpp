@@ -152,7 +152,8 @@ bool SaveManager::doSavePlayer(std::shared_ptr<Player> player) {
 	}
 
 	auto duration = bm_savePlayer.duration();
-	logger.debug("Saving player {} took {} milliseconds.", player->getName(), duration);
+	const auto &report = player->saveState().getLastReport();
+	logger.debug("Saving player {} took {} milliseconds, {} ms in the database: {} rows, {} bytes, {} sections unchanged.", player->getName(), duration, report.durationMs, report.rows(), report.bytes(), report.skipped());
 	return saveSuccess;
 }
 
@@ -12,29 +12,38 @@
 #include "lib/metrics/metrics.hpp"
 
 #include "utils/tools.hpp"
+#include "utils/transparent_string_hash.hpp"
+
+#include <shared_mutex>
 
 std::atomic_uint_fast64_t Task::LAST_EVENT_ID = 0;
+std::atomic_uint64_t Task::internedContexts = 0;
+std::array<std::string_view, Task::MAX_CONTEXTS> Task::contextNames { [] {
+	std::array<std::string_view, Task::MAX_CONTEXTS> names {};
+	names[Task::OVERFLOW_CONTEXT_ID] = "<other contexts>";
+	return names;
+}() };
 
-Task::Task(uint32_t expiresAfterMs, std::function<void(void)> &&f, std::string_view context) :
-	func(std::move(f)), context(context), utime(OTSYS_TIME()),
+Task::Task(uint32_t expiresAfterMs, TaskFunction &&f, std::string_view context) :
+	func(std::move(f)), context(internContext(context)), utime(OTSYS_TIME()),
 	expiration(expiresAfterMs > 0 ? OTSYS_TIME() + expiresAfterMs : 0) {
-	if (this->context.empty()) {
+	if (this->context.name.empty()) {
 		g_logger().error("[{}]: task context cannot be empty!", __FUNCTION__);
 		return;
 	}
 
-	assert(!this->context.empty() && "Context cannot be empty!");
+	assert(!this->context.name.empty() && "Context cannot be empty!");
 }
 
-Task::Task(std::function<void(void)> &&f, std::string_view context, uint32_t delay, bool cycle /* = false*/, bool log /*= true*/) :
-	func(std::move(f)), context(context), utime(OTSYS_TIME() + delay), delay(delay),
+Task::Task(TaskFunction &&f, std::string_view context, uint32_t delay, bool cycle /* = false*/, bool log /*= true*/) :
+	func(std::move(f)), context(internContext(context)), utime(OTSYS_TIME() + delay), delay(delay),
 	cycle(cycle), log(log) {
-	if (this->context.empty()) {
+	if (this->context.name.empty()) {
 		g_logger().error("[{}]: task context cannot be empty!", __FUNCTION__);
 		return;
 	}
 
-	assert(!this->context.empty() && "Context cannot be empty!");
+	assert(!this->context.name.empty() && "Context cannot be empty!");
 }
 
 [[nodiscard]] bool Task::hasExpired() const {
@@ -42,7 +51,7 @@ Task::Task(std::function<void(void)> &&f, std::string_view context, uint32_t del
 }
 
 bool Task::execute() const {
-	metrics::task_latency measure(context);
+	metrics::task_latency measure(context.name);
 	if (isCanceled()) {
 		return false;
 	}
@@ -64,6 +73,63 @@ bool Task::execute() const {
 	return true;
 }
 
+TaskContext Task::internContext(std::string_view context) {
+	// Contexts are almost always string literals, so the per-thread cache is keyed by
+	// address and only has to confirm the content before reusing the interned name.
+	// Runtime formatted names get a new address every time, the cache starts over once
+	// it holds as many entries as there can be contexts.
+	thread_local phmap::flat_hash_map<const char*, TaskContext> cache;
+
+	if (const auto it = cache.find(context.data()); it != cache.end() && it->second.name == context) {
+		return it->second;
+	}
+	if (cache.size() >= MAX_CONTEXTS) {
+		cache.clear();
+	}
+
+	static std::unordered_map<std::string, uint16_t, TransparentStringHasher, std::equal_to<>> contexts;
+	static std::shared_mutex mutex;
+
+	std::optional<TaskContext> interned;
+	{
+		std::shared_lock lock(mutex);
+		if (const auto it = contexts.find(context); it != contexts.end()) {
+			interned = TaskContext { it->first, it->second };
+		}
+	}
+
+	if (!interned) {
+		std::unique_lock lock(mutex);
+		if (const auto it = contexts.find(context); it != contexts.end()) {
+			interned = TaskContext { it->first, it->second };
+		} else if (contexts.size() < OVERFLOW_CONTEXT_ID) {
+			const auto nextId = static_cast<uint16_t>(contexts.size());
+			const auto inserted = contexts.try_emplace(std::string(context), nextId).first;
+			contextNames[nextId] = inserted->first;
+			// Publishes the name to getContextName readers
+			internedContexts.fetch_add(1, std::memory_order_release);
+			interned = TaskContext { inserted->first, nextId };
+		} else {
+			// The table is full, the name is not kept and the context is reported with the others
+			interned = TaskContext { contextNames[OVERFLOW_CONTEXT_ID], OVERFLOW_CONTEXT_ID };
+		}
+	}
+
+	cache.insert_or_assign(context.data(), *interned);
+	return *interned;
+}
+
+std::string_view Task::getContextName(uint16_t contextId) {
+	if (contextId == OVERFLOW_CONTEXT_ID) {
+		return contextNames[OVERFLOW_CONTEXT_ID];
+	}
+
+	if (contextId >= MAX_CONTEXTS || contextId >= internedContexts.load(std::memory_order_acquire)) {
+		return {};
+	}
+	return contextNames[contextId];
+}
+
 void Task::updateTime() {
 	utime = OTSYS_TIME() + delay;
 }
@@ -9,16 +9,34 @@
 
 #pragma once
 
+#include "utils/inline_function.hpp"
+
 class Dispatcher;
 
+// Lambdas capturing up to 64 bytes are stored inside the task itself
+using TaskFunction = InlineFunction<void(void), 64>;
+
+struct TaskContext {
+	std::string_view name;
+	// Dense id used to index per-context statistics (see TaskProfiler)
+	uint16_t id = 0;
+};
+
 class Task {
 public:
-	Task(uint32_t expiresAfterMs, std::function<void(void)> &&f, std::string_view context);
+	static constexpr uint16_t MAX_CONTEXTS = 1024;
+	// Contexts seen after the first MAX_CONTEXTS - 1 ones share this id and its name
+	static constexpr uint16_t OVERFLOW_CONTEXT_ID = MAX_CONTEXTS - 1;
+
+	Task(uint32_t expiresAfterMs, TaskFunction &&f, std::string_view context);
 
-	Task(std::function<void(void)> &&f, std::string_view context, uint32_t delay, bool cycle = false, bool log = true);
+	Task(TaskFunction &&f, std::string_view context, uint32_t delay, bool cycle = false, bool log = true);
 
 	~Task() = default;
 
+	Task(Task &&) noexcept = default;
+	Task &operator=(Task &&) noexcept = default;
+
 	uint64_t getId() {
 		if (id == 0) {
 			if (++LAST_EVENT_ID == 0) {
@@ -34,7 +52,11 @@ public:
 	}
 
 	[[nodiscard]] std::string_view getContext() const {
-		return context;
+		return context.name;
+	}
+
+	[[nodiscard]] uint16_t getContextId() const {
+		return context.id;
 	}
 
 	[[nodiscard]] auto getTime() const {
@@ -57,8 +79,28 @@ public:
 
 	bool execute() const;
 
+	/**
+	 * @brief Returns a view of the context name that lives for the whole program,
+	 * so tasks can keep it as a string_view without owning a copy, along with its id.
+	 *
+	 * At most MAX_CONTEXTS - 1 names are kept, the later ones share OVERFLOW_CONTEXT_ID
+	 * and its name.
+	 */
+	static TaskContext internContext(std::string_view context);
+
+	/**
+	 * @brief Name registered for a context id, empty if the id was not assigned yet.
+	 */
+	static std::string_view getContextName(uint16_t contextId);
+
+	static uint64_t getInternedContexts() {
+		return internedContexts.load(std::memory_order_relaxed);
+	}
+
 private:
 	static std::atomic_uint_fast64_t LAST_EVENT_ID;
+	static std::atomic_uint64_t internedContexts;
+	static std::array<std::string_view, MAX_CONTEXTS> contextNames;
 
 	void updateTime();
 
@@ -91,17 +133,11 @@ private:
 			"Player::addInFightTicks"
 		};
 
-		return tasksContext.contains(context);
+		return tasksContext.contains(context.name);
 	}
 
-	struct Compare {
-		bool operator()(const std::shared_ptr<Task> &a, const std::shared_ptr<Task> &b) const {
-			return a->getTime() < b->getTime();
-		}
-	};
-
-	std::function<void(void)> func;
-	std::string context;
+	TaskFunction func;
+	TaskContext context;
 
 	int64_t utime = 0;
 	int64_t expiration = 0;
@@ -0,0 +1,183 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "game/scheduling/task_profiler.hpp"
+
+#include "lib/thread/thread_pool.hpp"
+
+namespace {
+	// Keeps a server that is slow on every cycle from flooding the log
+	constexpr auto SLOW_TICK_REPORT_INTERVAL = std::chrono::seconds(1);
+
+	double toMs(uint64_t ns) {
+		return static_cast<double>(ns) / 1'000'000.0;
+	}
+}
+
+TaskProfiler::TaskProfiler(size_t threadCount) {
+	threads.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i) {
+		threads.emplace_back(std::make_unique<ThreadStats>());
+	}
+	tickTasks.reserve(2000);
+}
+
+TaskProfiler::~TaskProfiler() {
+	for (const auto &thread : threads) {
+		for (auto &context : thread->contexts) {
+			delete context.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+uint8_t TaskProfiler::getHistogramBucket(uint64_t elapsedNs) {
+	const auto bucket = std::bit_width(elapsedNs / 1000);
+	return static_cast<uint8_t>(std::min<int>(bucket, TASK_PROFILER_HISTOGRAM_BUCKETS - 1));
+}
+
+uint64_t TaskProfiler::record(uint16_t contextId, Clock::time_point start) {
+	const auto elapsedNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+
+	const auto threadId = static_cast<size_t>(ThreadPool::getThreadId());
+	if (threadId >= threads.size() || contextId >= Task::MAX_CONTEXTS) {
+		return elapsedNs;
+	}
+
+	auto &slot = threads[threadId]->contexts[contextId];
+	auto* stats = slot.load(std::memory_order_acquire);
+	if (!stats) {
+		stats = new ContextStats();
+		slot.store(stats, std::memory_order_release);
+	}
+
+	// Only the owning thread writes here, the atomics are what make concurrent snapshots and resets safe
+	stats->count.fetch_add(1, std::memory_order_relaxed);
+	stats->totalNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+	stats->histogram[getHistogramBucket(elapsedNs)].fetch_add(1, std::memory_order_relaxed);
+
+	auto currentMax = stats->maxNs.load(std::memory_order_relaxed);
+	while (elapsedNs > currentMax && !stats->maxNs.compare_exchange_weak(currentMax, elapsedNs, std::memory_order_relaxed)) { }
+
+	return elapsedNs;
+}
+
+std::vector<TaskProfile> TaskProfiler::getTopContexts(size_t limit) const {
+	std::vector<TaskProfile> profiles(Task::MAX_CONTEXTS);
+	for (const auto &thread : threads) {
+		for (uint16_t contextId = 0; contextId < Task::MAX_CONTEXTS; ++contextId) {
+			const auto* stats = thread->contexts[contextId].load(std::memory_order_acquire);
+			if (!stats) {
+				continue;
+			}
+
+			auto &profile = profiles[contextId];
+			profile.count += stats->count.load(std::memory_order_relaxed);
+			profile.totalNs += stats->totalNs.load(std::memory_order_relaxed);
+			profile.maxNs = std::max(profile.maxNs, stats->maxNs.load(std::memory_order_relaxed));
+			for (uint8_t bucket = 0; bucket < TASK_PROFILER_HISTOGRAM_BUCKETS; ++bucket) {
+				profile.histogram[bucket] += stats->histogram[bucket].load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	for (uint16_t contextId = 0; contextId < Task::MAX_CONTEXTS; ++contextId) {
+		profiles[contextId].context = Task::getContextName(contextId);
+	}
+
+	std::erase_if(profiles, [](const TaskProfile &profile) { return profile.count == 0; });
+	std::ranges::sort(profiles, std::ranges::greater {}, &TaskProfile::totalNs);
+	if (limit > 0 && profiles.size() > limit) {
+		profiles.resize(limit);
+	}
+
+	return profiles;
+}
+
+void TaskProfiler::reset() {
+	for (const auto &thread : threads) {
+		for (auto &context : thread->contexts) {
+			auto* stats = context.load(std::memory_order_acquire);
+			if (!stats) {
+				continue;
+			}
+
+			stats->count.store(0, std::memory_order_relaxed);
+			stats->totalNs.store(0, std::memory_order_relaxed);
+			stats->maxNs.store(0, std::memory_order_relaxed);
+			for (auto &bucket : stats->histogram) {
+				bucket.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+}
+
+void TaskProfiler::beginTick() {
+	tickTasks.clear();
+	tickStart = Clock::now();
+}
+
+void TaskProfiler::endTick(uint32_t budgetMs) {
+	if (budgetMs == 0 || tickTasks.empty()) {
+		return;
+	}
+
+	const auto elapsedNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - tickStart).count());
+	if (elapsedNs <= budgetMs * 1'000'000ULL) {
+		return;
+	}
+
+	const auto now = Clock::now();
+	if (now - lastSlowTickReport < SLOW_TICK_REPORT_INTERVAL) {
+		++suppressedSlowTicks;
+		return;
+	}
+
+	lastSlowTickReport = now;
+	reportSlowTick(elapsedNs, budgetMs);
+	suppressedSlowTicks = 0;
+}
+
+void TaskProfiler::reportSlowTick(uint64_t elapsedNs, uint32_t budgetMs) {
+	struct TickContext {
+		uint16_t contextId = 0;
+		uint32_t count = 0;
+		uint64_t totalNs = 0;
+		uint64_t maxNs = 0;
+	};
+
+	// Groups the tasks of the cycle by context, a slow cycle usually holds thousands of packet tasks
+	std::ranges::sort(tickTasks, {}, &std::pair<uint16_t, uint64_t>::first);
+	std::vector<TickContext> contexts;
+	for (const auto &[contextId, taskNs] : tickTasks) {
+		if (contexts.empty() || contexts.back().contextId != contextId) {
+			contexts.emplace_back(TickContext { contextId });
+		}
+
+		auto &context = contexts.back();
+		++context.count;
+		context.totalNs += taskNs;
+		context.maxNs = std::max(context.maxNs, taskNs);
+	}
+	std::ranges::sort(contexts, std::ranges::greater {}, &TickContext::totalNs);
+
+	std::string report;
+	for (const auto &context : contexts) {
+		fmt::format_to(
+			std::back_inserter(report), "\n\t{}: {} task(s), {:.3f} ms total, {:.3f} ms max",
+			Task::getContextName(context.contextId), context.count, toMs(context.totalNs), toMs(context.maxNs)
+		);
+	}
+
+	g_logger().warn(
+		"[TaskProfiler] Dispatcher cycle took {:.2f} ms (budget: {} ms), {} task(s) executed{}:{}",
+		toMs(elapsedNs), budgetMs, tickTasks.size(),
+		suppressedSlowTicks > 0 ? fmt::format(", {} slow cycle(s) not reported since the last report", suppressedSlowTicks) : "",
+		report
+	);
+}
@@ -0,0 +1,91 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include "game/scheduling/task.hpp"
+
+static constexpr uint8_t TASK_PROFILER_HISTOGRAM_BUCKETS = 24;
+
+struct TaskProfile {
+	std::string_view context;
+	uint64_t count = 0;
+	uint64_t totalNs = 0;
+	uint64_t maxNs = 0;
+	// Bucket 0 holds tasks under 1us, bucket N the ones in [2^(N-1), 2^N) us, the last one everything above
+	std::array<uint64_t, TASK_PROFILER_HISTOGRAM_BUCKETS> histogram {};
+};
+
+/**
+ * Per task context execution statistics of the dispatcher.
+ *
+ * Every thread that executes tasks writes into its own buckets, indexed by the
+ * interned context id, using relaxed atomics only, so recording never takes a
+ * lock and readers (talkactions, Lua) can aggregate a snapshot at any time.
+ *
+ * It also keeps the tasks executed during the current dispatcher cycle, and
+ * logs them when the cycle takes longer than the configured budget.
+ */
+class TaskProfiler {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	explicit TaskProfiler(size_t threadCount);
+	~TaskProfiler();
+
+	// Ensures that we don't accidentally copy it
+	TaskProfiler(const TaskProfiler &) = delete;
+	TaskProfiler &operator=(const TaskProfiler &) = delete;
+
+	/**
+	 * @brief Records a task of the given context that started at `start` on the calling thread.
+	 * @return Elapsed time in nanoseconds.
+	 */
+	uint64_t record(uint16_t contextId, Clock::time_point start);
+
+	/**
+	 * @brief Aggregates the buckets of every thread.
+	 * @param limit Maximum number of contexts returned, 0 returns all of them.
+	 * @return Contexts sorted by total execution time, highest first.
+	 */
+	[[nodiscard]] std::vector<TaskProfile> getTopContexts(size_t limit = 0) const;
+
+	void reset();
+
+	static uint8_t getHistogramBucket(uint64_t elapsedNs);
+
+	// Slow tick report, only called by the dispatcher thread
+	void beginTick();
+	void addTickTask(uint16_t contextId, uint64_t elapsedNs) {
+		tickTasks.emplace_back(contextId, elapsedNs);
+	}
+	void endTick(uint32_t budgetMs);
+
+private:
+	struct ContextStats {
+		std::atomic_uint64_t count = 0;
+		std::atomic_uint64_t totalNs = 0;
+		std::atomic_uint64_t maxNs = 0;
+		std::array<std::atomic_uint64_t, TASK_PROFILER_HISTOGRAM_BUCKETS> histogram {};
+	};
+
+	struct ThreadStats {
+		// Allocated by the owning thread the first time it runs a context
+		std::array<std::atomic<ContextStats*>, Task::MAX_CONTEXTS> contexts {};
+	};
+
+	void reportSlowTick(uint64_t elapsedNs, uint32_t budgetMs);
+
+	std::vector<std::unique_ptr<ThreadStats>> threads;
+
+	Clock::time_point tickStart;
+	Clock::time_point lastSlowTickReport;
+	std::vector<std::pair<uint16_t, uint64_t>> tickTasks;
+	uint32_t suppressedSlowTicks = 0;
+};
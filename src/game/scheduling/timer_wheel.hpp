@@ -0,0 +1,351 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
+
+/**
+ * Hierarchical timing wheel with millisecond resolution.
+ *
+ * Four levels of 256 slots cover 2^32 ms (~49 days); anything further away is
+ * parked on the last level and re-evaluated when that level cascades.
+ * Nodes live in fixed-size chunks, so handles and references to stored values
+ * stay valid while the wheel grows, and released nodes are recycled through a
+ * free list, which keeps insert/erase free of allocations in steady state.
+ *
+ * Not thread-safe: the owner must serialize all access.
+ */
+template <typename T>
+class TimerWheel {
+public:
+	static constexpr uint32_t INVALID_HANDLE = std::numeric_limits<uint32_t>::max();
+
+	explicit TimerWheel(int64_t now = 0) :
+		currentTime(now) { }
+
+	// Ensures that we don't accidentally copy it
+	TimerWheel(const TimerWheel &) = delete;
+	TimerWheel &operator=(const TimerWheel &) = delete;
+
+	/**
+	 * @brief Moves the wheel clock, only allowed while the wheel is empty.
+	 */
+	void setCurrentTime(int64_t now) {
+		if (count == 0) {
+			currentTime = now;
+		}
+	}
+
+	[[nodiscard]] int64_t getCurrentTime() const {
+		return currentTime;
+	}
+
+	[[nodiscard]] size_t size() const {
+		return count;
+	}
+
+	[[nodiscard]] bool empty() const {
+		return count == 0;
+	}
+
+	/**
+	 * @brief Stores a value that expires at the given time.
+	 * Times that are already due are fired on the next tick.
+	 * @return Handle used by get/erase; stable until the node is released.
+	 */
+	uint32_t insert(int64_t time, T &&value) {
+		const uint32_t handle = acquire();
+		auto &node = getNode(handle);
+		node.value.emplace(std::move(value));
+		node.time = time;
+		link(handle, currentTime + 1);
+		++count;
+		return handle;
+	}
+
+	[[nodiscard]] T* get(uint32_t handle) {
+		if (handle >= nodeCount) {
+			return nullptr;
+		}
+
+		auto &node = getNode(handle);
+		return node.value ? &*node.value : nullptr;
+	}
+
+	/**
+	 * @brief Whether the node is waiting in a slot (false while it is being fired).
+	 */
+	[[nodiscard]] bool isLinked(uint32_t handle) const {
+		return handle < nodeCount && getNode(handle).slot != NO_SLOT;
+	}
+
+	/**
+	 * @brief Removes a pending node in O(1).
+	 * Nodes that are currently being fired are released by advance() instead.
+	 */
+	bool erase(uint32_t handle) {
+		if (!isLinked(handle)) {
+			return false;
+		}
+
+		unlink(handle);
+		release(handle);
+		--count;
+		return true;
+	}
+
+	/**
+	 * @brief Fires every node that expires up to (and including) now.
+	 *
+	 * The callback receives the stored value and its handle and returns the new
+	 * expiration time to re-arm the same node (cycle events), or a negative value
+	 * to release it. The callback may insert or erase other nodes.
+	 */
+	template <typename F>
+	void advance(int64_t now, F &&f) {
+		while (currentTime < now) {
+			if (count == 0) {
+				currentTime = now;
+				return;
+			}
+
+			// Nothing due on the first level: jump straight to the next cascade point.
+			if (isLevelEmpty(0)) {
+				const int64_t nextCascade = nextCascadeTime();
+				if (nextCascade > now) {
+					currentTime = now;
+					return;
+				}
+				currentTime = nextCascade - 1;
+			}
+
+			++currentTime;
+			cascade();
+
+			auto &slot = levels[0][currentTime & SLOT_MASK];
+			while (slot.head != INVALID_HANDLE) {
+				const uint32_t handle = slot.head;
+				unlink(handle);
+
+				auto &node = getNode(handle);
+				const int64_t nextTime = f(*node.value, handle);
+				if (nextTime >= 0) {
+					node.time = nextTime;
+					link(handle, currentTime + 1);
+				} else {
+					release(handle);
+					--count;
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Lower bound for the next expiration, or INT64_MAX when empty.
+	 * Exact for nodes due within the first level window; nodes on the upper
+	 * levels are bounded by the next cascade point.
+	 */
+	[[nodiscard]] int64_t nextExpiration() const {
+		if (count == 0) {
+			return std::numeric_limits<int64_t>::max();
+		}
+
+		int64_t next = std::numeric_limits<int64_t>::max();
+		for (uint8_t level = 1; level < LEVELS; ++level) {
+			if (!isLevelEmpty(level)) {
+				next = isLevelEmpty(0) ? nextCascadeTime() : (currentTime | SLOT_MASK) + 1;
+				break;
+			}
+		}
+
+		const auto &bitmap = occupancy[0];
+		const uint32_t start = (currentTime + 1) & SLOT_MASK;
+		for (uint32_t offset = 0; offset < SLOTS;) {
+			const uint32_t index = (start + offset) & SLOT_MASK;
+			const uint64_t word = bitmap[index >> 6] >> (index & 63);
+			if (word != 0) {
+				const uint32_t found = offset + std::countr_zero(word);
+				if (found < SLOTS) {
+					return std::min<int64_t>(next, currentTime + 1 + found);
+				}
+			}
+			offset += 64 - (index & 63);
+		}
+
+		return next;
+	}
+
+private:
+	static constexpr uint8_t LEVELS = 4;
+	static constexpr uint8_t SLOT_BITS = 8;
+	static constexpr uint32_t SLOTS = 1 << SLOT_BITS;
+	static constexpr uint32_t SLOT_MASK = SLOTS - 1;
+	static constexpr uint16_t NO_SLOT = std::numeric_limits<uint16_t>::max();
+	static constexpr uint8_t CHUNK_BITS = 10;
+	static constexpr uint32_t CHUNK_SIZE = 1 << CHUNK_BITS;
+
+	struct Node {
+		std::optional<T> value;
+		int64_t time = 0;
+		uint32_t prev = INVALID_HANDLE;
+		uint32_t next = INVALID_HANDLE;
+		// level * SLOTS + slot index, NO_SLOT when detached
+		uint16_t slot = NO_SLOT;
+	};
+
+	struct Slot {
+		uint32_t head = INVALID_HANDLE;
+		uint32_t tail = INVALID_HANDLE;
+	};
+
+	Node &getNode(uint32_t handle) {
+		return chunks[handle >> CHUNK_BITS][handle & (CHUNK_SIZE - 1)];
+	}
+
+	const Node &getNode(uint32_t handle) const {
+		return chunks[handle >> CHUNK_BITS][handle & (CHUNK_SIZE - 1)];
+	}
+
+	uint32_t acquire() {
+		if (!freeList.empty()) {
+			const uint32_t handle = freeList.back();
+			freeList.pop_back();
+			return handle;
+		}
+
+		if ((nodeCount & (CHUNK_SIZE - 1)) == 0) {
+			chunks.emplace_back(std::make_unique<Node[]>(CHUNK_SIZE));
+		}
+		return nodeCount++;
+	}
+
+	void release(uint32_t handle) {
+		getNode(handle).value.reset();
+		freeList.emplace_back(handle);
+	}
+
+	bool isLevelEmpty(uint8_t level) const {
+		const auto &bitmap = occupancy[level];
+		return (bitmap[0] | bitmap[1] | bitmap[2] | bitmap[3]) == 0;
+	}
+
+	// Next tick that cascades a non-empty level, skipping the levels below it that are empty
+	int64_t nextCascadeTime() const {
+		uint8_t level = 1;
+		while (level < LEVELS - 1 && isLevelEmpty(level)) {
+			++level;
+		}
+
+		const uint8_t shift = level * SLOT_BITS;
+		return ((currentTime >> shift) + 1) << shift;
+	}
+
+	// Nodes that are already due are placed at `earliest`
+	void link(uint32_t handle, int64_t earliest) {
+		auto &node = getNode(handle);
+
+		const int64_t time = std::max<int64_t>(node.time, earliest);
+		const uint64_t delta = static_cast<uint64_t>(time - currentTime);
+
+		uint8_t level = 0;
+		uint64_t index;
+		if (delta < (1ULL << SLOT_BITS)) {
+			index = static_cast<uint64_t>(time);
+		} else if (delta < (1ULL << (2 * SLOT_BITS))) {
+			level = 1;
+			index = static_cast<uint64_t>(time) >> SLOT_BITS;
+		} else if (delta < (1ULL << (3 * SLOT_BITS))) {
+			level = 2;
+			index = static_cast<uint64_t>(time) >> (2 * SLOT_BITS);
+		} else {
+			level = 3;
+			// Beyond the wheel range: park it at the furthest slot, it is re-linked on cascade
+			const int64_t clamped = std::min<int64_t>(time, currentTime + (1LL << (LEVELS * SLOT_BITS)) - 1);
+			index = static_cast<uint64_t>(clamped) >> (3 * SLOT_BITS);
+		}
+		index &= SLOT_MASK;
+
+		auto &slot = levels[level][index];
+		node.slot = static_cast<uint16_t>(level * SLOTS + index);
+		node.next = INVALID_HANDLE;
+		node.prev = slot.tail;
+		if (slot.tail != INVALID_HANDLE) {
+			getNode(slot.tail).next = handle;
+		} else {
+			slot.head = handle;
+			occupancy[level][index >> 6] |= 1ULL << (index & 63);
+		}
+		slot.tail = handle;
+	}
+
+	void unlink(uint32_t handle) {
+		auto &node = getNode(handle);
+		const uint8_t level = node.slot / SLOTS;
+		const uint32_t index = node.slot & SLOT_MASK;
+		auto &slot = levels[level][index];
+
+		if (node.prev != INVALID_HANDLE) {
+			getNode(node.prev).next = node.next;
+		} else {
+			slot.head = node.next;
+		}
+
+		if (node.next != INVALID_HANDLE) {
+			getNode(node.next).prev = node.prev;
+		} else {
+			slot.tail = node.prev;
+		}
+
+		if (slot.head == INVALID_HANDLE) {
+			occupancy[level][index >> 6] &= ~(1ULL << (index & 63));
+		}
+
+		node.prev = node.next = INVALID_HANDLE;
+		node.slot = NO_SLOT;
+	}
+
+	// Moves the nodes of the upper level slots that became current down the wheel
+	void cascade() {
+		for (uint8_t level = 1; level < LEVELS; ++level) {
+			if ((currentTime & ((1LL << (level * SLOT_BITS)) - 1)) != 0) {
+				break;
+			}
+
+			const uint32_t index = (currentTime >> (level * SLOT_BITS)) & SLOT_MASK;
+			auto &slot = levels[level][index];
+			uint32_t handle = slot.head;
+			slot = {};
+			occupancy[level][index >> 6] &= ~(1ULL << (index & 63));
+
+			while (handle != INVALID_HANDLE) {
+				const uint32_t next = getNode(handle).next;
+				// The first level slot for the current tick is fired right after the cascade
+				link(handle, currentTime);
+				handle = next;
+			}
+		}
+	}
+
+	std::array<std::array<Slot, SLOTS>, LEVELS> levels {};
+	std::array<std::array<uint64_t, SLOTS / 64>, LEVELS> occupancy {};
+
+	std::vector<std::unique_ptr<Node[]>> chunks;
+	std::vector<uint32_t> freeList;
+	uint32_t nodeCount = 0;
+	size_t count = 0;
+
+	int64_t currentTime = 0;
+};
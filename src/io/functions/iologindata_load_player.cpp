@@ -29,15 +29,20 @@
 #include "utils/tools.hpp"
 #include "io/player_storage_repository.hpp"
 
+namespace {
+	// Rows read by loadItems, from player_items, player_depotitems, player_inboxitems and player_rewards
+	using ItemColumns = DBColumns<"pid", "sid", "itemtype", "count", "attributes">;
+}
+
 void IOLoginDataLoad::loadItems(ItemsMap &itemsMap, const DBResult_ptr &result, const std::shared_ptr<Player> &player) {
 	try {
 		do {
-			auto sid = result->getNumber<uint32_t>("sid");
-			auto pid = result->getNumber<uint32_t>("pid");
-			auto type = result->getNumber<uint16_t>("itemtype");
-			auto count = result->getNumber<uint16_t>("count");
+			auto sid = result->getNumber<uint32_t>(ItemColumns::index<"sid">());
+			auto pid = result->getNumber<uint32_t>(ItemColumns::index<"pid">());
+			auto type = result->getNumber<uint16_t>(ItemColumns::index<"itemtype">());
+			auto count = result->getNumber<uint16_t>(ItemColumns::index<"count">());
 			unsigned long attrSize;
-			const char* attr = result->getStream("attributes", attrSize);
+			const char* attr = result->getStream(ItemColumns::index<"attributes">(), attrSize);
 			PropStream propStream;
 			propStream.init(attr, attrSize);
 
@@ -63,11 +68,8 @@ void IOLoginDataLoad::loadItems(ItemsMap &itemsMap, const DBResult_ptr &result,
 }
 
 bool IOLoginDataLoad::preLoadPlayer(const std::shared_ptr<Player> &player, const std::string &name) {
-	Database &db = Database::getInstance();
-
-	std::ostringstream query;
-	query << "SELECT `id`, `account_id`, `group_id`, `deletion` FROM `players` WHERE `name` = " << db.escapeString(name);
-	DBResult_ptr result = db.storeQuery(query.str());
+	DBStatement statement("SELECT `id`, `account_id`, `group_id`, `deletion` FROM `players` WHERE `name` = ?");
+	DBResult_ptr result = statement.bind(name).store();
 	if (!result) {
 		return false;
 	}
@@ -540,13 +542,14 @@ void IOLoginDataLoad::loadPlayerInventoryItems(const std::shared_ptr<Player> &pl
 		return;
 	}
 
-	auto query = fmt::format("SELECT pid, sid, itemtype, count, attributes FROM player_items WHERE player_id = {} ORDER BY sid DESC", player->getGUID());
+	DBStatement statement(fmt::format("SELECT {} FROM `player_items` WHERE `player_id` = ? ORDER BY `sid` DESC", ItemColumns::list()));
+	statement.bind(player->getGUID());
 
 	ItemsMap inventoryItems;
 	std::vector<std::shared_ptr<Item>> itemsToStartDecaying;
 
 	try {
-		if ((result = g_database().storeQuery(query))) {
+		if ((result = statement.store())) {
 			loadItems(inventoryItems, result, player);
 
 			for (auto it = inventoryItems.rbegin(), end = inventoryItems.rend(); it != end; ++it) {
@@ -620,11 +623,8 @@ void IOLoginDataLoad::loadRewardItems(const std::shared_ptr<Player> &player) {
 	}
 
 	ItemsMap rewardItems;
-	std::ostringstream query;
-	query.str(std::string());
-	query << "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_rewards` WHERE `player_id` = "
-		  << player->getGUID() << " ORDER BY `pid`, `sid` ASC";
-	if (auto result = Database::getInstance().storeQuery(query.str())) {
+	DBStatement statement(fmt::format("SELECT {} FROM `player_rewards` WHERE `player_id` = ? ORDER BY `pid`, `sid` ASC", ItemColumns::list()));
+	if (auto result = statement.bind(player->getGUID()).store()) {
 		loadItems(rewardItems, result, player);
 		bindRewardBag(player, rewardItems);
 		insertItemsIntoRewardBag(rewardItems);
@@ -639,8 +639,8 @@ void IOLoginDataLoad::loadPlayerDepotItems(const std::shared_ptr<Player> &player
 
 	ItemsMap depotItems;
 	std::vector<std::shared_ptr<Item>> itemsToStartDecaying;
-	auto query = fmt::format("SELECT pid, sid, itemtype, count, attributes FROM player_depotitems WHERE player_id = {} ORDER BY sid DESC", player->getGUID());
-	if ((result = g_database().storeQuery(query))) {
+	DBStatement statement(fmt::format("SELECT {} FROM `player_depotitems` WHERE `player_id` = ? ORDER BY `sid` DESC", ItemColumns::list()));
+	if ((result = statement.bind(player->getGUID()).store())) {
 		loadItems(depotItems, result, player);
 		for (auto it = depotItems.rbegin(), end = depotItems.rend(); it != end; ++it) {
 			const std::pair<std::shared_ptr<Item>, int32_t> &pair = it->second;
@@ -685,8 +685,8 @@ void IOLoginDataLoad::loadPlayerInboxItems(const std::shared_ptr<Player> &player
 	}
 
 	std::vector<std::shared_ptr<Item>> itemsToStartDecaying;
-	auto query = fmt::format("SELECT pid, sid, itemtype, count, attributes FROM player_inboxitems WHERE player_id = {} ORDER BY sid DESC", player->getGUID());
-	if ((result = g_database().storeQuery(query))) {
+	DBStatement statement(fmt::format("SELECT {} FROM `player_inboxitems` WHERE `player_id` = ? ORDER BY `sid` DESC", ItemColumns::list()));
+	if ((result = statement.bind(player->getGUID()).store())) {
 		ItemsMap inboxItems;
 		loadItems(inboxItems, result, player);
 
@@ -941,15 +941,13 @@ void IOLoginDataLoad::bindRewardBag(const std::shared_ptr<Player> &player, Items
 		return;
 	}
 
+	// Reward bags keep pid 0, the sids kept across saves don't put them before their items
 	for (auto &[id, itemPair] : rewardItemsMap) {
-		const auto [item, pid] = itemPair;
+		const auto &[item, pid] = itemPair;
 		if (pid == 0) {
-			auto reward = player->getReward(item->getAttribute<uint64_t>(ItemAttribute_t::DATE), true);
-			if (reward) {
-				itemPair = std::pair<std::shared_ptr<Item>, int32_t>(reward->getItem(), player->getRewardChest()->getID());
+			if (const auto reward = player->getReward(item->getAttribute<uint64_t>(ItemAttribute_t::DATE), true)) {
+				itemPair.first = reward->getItem();
 			}
-		} else {
-			break;
 		}
 	}
 }
@@ -964,7 +962,7 @@ void IOLoginDataLoad::insertItemsIntoRewardBag(const ItemsMap &rewardItemsMap) {
 
 		int32_t pid = pair.second;
 		if (pid == 0) {
-			break;
+			continue;
 		}
 
 		auto rewardIt = rewardItemsMap.find(pid);
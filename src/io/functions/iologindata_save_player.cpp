@@ -21,58 +21,135 @@
 #include "items/containers/rewards/reward.hpp"
 #include "creatures/players/player.hpp"
 #include "io/player_storage_repository.hpp"
+#include "utils/hash.hpp"
 
-bool IOLoginDataSave::saveItems(const std::shared_ptr<Player> &player, const ItemBlockList &itemList, DBInsert &query_insert, PropWriteStream &propWriteStream) {
+namespace {
+	uint64_t hashItemRow(const IOLoginDataSave::ItemRow &row) {
+		size_t rowHash = std::hash<std::string_view> {}(row.attributes);
+		stdext::hash_combine(rowHash, static_cast<uint32_t>(row.pid));
+		stdext::hash_combine(rowHash, row.itemType);
+		stdext::hash_combine(rowHash, row.count);
+		return rowHash;
+	}
+
+	// Adds the hash of each row to the fingerprint, so that the same content in another order differs
+	void addToFingerprint(size_t &fingerprint, int64_t key, uint64_t rowHash) {
+		stdext::hash_combine(fingerprint, static_cast<uint64_t>(key));
+		stdext::hash_combine(fingerprint, rowHash);
+	}
+
+	uint64_t hashRows(const std::vector<std::string> &rows) {
+		size_t fingerprint = rows.size();
+		for (const auto &row : rows) {
+			stdext::hash_combine(fingerprint, static_cast<uint64_t>(std::hash<std::string_view> {}(row)));
+		}
+		return fingerprint;
+	}
+
+	// Deletes every row of the player in the table and inserts the given ones
+	bool rewriteSection(const std::shared_ptr<Player> &player, PlayerSaveSection section, std::string_view table, const std::string &insertQuery, const std::vector<std::string> &rows) {
+		auto &report = player->saveState().report()[section];
+		if (!Database::getInstance().executeQuery(fmt::format("DELETE FROM `{}` WHERE `player_id` = {}", table, player->getGUID()))) {
+			return false;
+		}
+		report.deletes = 1;
+
+		DBInsert insert(insertQuery);
+		for (const auto &row : rows) {
+			if (!insert.addRow(row)) {
+				return false;
+			}
+			report.bytes += row.size();
+			++report.rows;
+		}
+		return insert.execute();
+	}
+
+	// Remembers the snapshot once the save commits, players loaded offline are rewritten in full every time
+	void stageSnapshot(const std::shared_ptr<Player> &player, PlayerSaveSection section, PlayerSaveState::Snapshot snapshot) {
+		if (!player->isOffline()) {
+			player->saveState().stage(section, std::move(snapshot));
+		}
+	}
+}
+
+bool IOLoginDataSave::collectItems(const std::shared_ptr<Player> &player, PlayerSaveSection section, const ItemBlockList &itemList, std::vector<ItemRow> &rows, PropWriteStream &propWriteStream) {
 	if (!player) {
 		g_logger().warn("[IOLoginData::savePlayer] - Player nullptr: {}", __FUNCTION__);
 		return false;
 	}
 
-	const Database &db = Database::getInstance();
-	std::ostringstream ss;
+	// Items in traversal order, the top-level ones are stored under the pid of their block
+	struct ItemNode {
+		std::shared_ptr<Item> item;
+		int32_t pid;
+		size_t parent;
+	};
+	static constexpr size_t TOP_LEVEL = std::numeric_limits<size_t>::max();
 
-	// Initialize variables
-	using ContainerBlock = std::pair<std::shared_ptr<Container>, int32_t>;
-	std::list<ContainerBlock> queue;
-	int32_t runningId = 100;
+	std::vector<ItemNode> nodes;
+	std::vector<std::pair<size_t, size_t>> siblings;
 
-	// Loop through each item in itemList
+	// Update container attributes if necessary
 	const auto &openContainers = player->getOpenContainers();
-	for (const auto &it : itemList) {
-		const auto &item = it.second;
+	const auto updateOpenContainer = [&openContainers](const std::shared_ptr<Container> &container) {
+		if (container->getAttribute<int64_t>(ItemAttribute_t::OPENCONTAINER) > 0) {
+			container->setAttribute(ItemAttribute_t::OPENCONTAINER, 0);
+		}
+
+		for (const auto &[containerId, openContainer] : openContainers) {
+			if (openContainer.container == container) {
+				container->setAttribute(ItemAttribute_t::OPENCONTAINER, static_cast<int>(containerId) + 1);
+				break;
+			}
+		}
+	};
+
+	for (const auto &[pid, item] : itemList) {
 		if (!item) {
 			continue;
 		}
 
-		int32_t pid = it.first;
+		if (const auto &container = item->getContainer()) {
+			updateOpenContainer(container);
+		}
+		nodes.push_back({ item, pid, TOP_LEVEL });
+	}
+	siblings.emplace_back(0, nodes.size());
 
-		++runningId;
+	// Breadth first, the items of a container are next to each other and in their order
+	for (size_t parent = 0; parent < nodes.size(); ++parent) {
+		const auto container = nodes[parent].item->getContainer();
+		if (!container) {
+			continue;
+		}
 
-		// Update container attributes if necessary
-		if (const std::shared_ptr<Container> &container = item->getContainer()) {
-			if (!container) {
+		const auto begin = nodes.size();
+		for (const auto &item : container->getItemList()) {
+			if (!item) {
 				continue;
 			}
 
-			if (container->getAttribute<int64_t>(ItemAttribute_t::OPENCONTAINER) > 0) {
-				container->setAttribute(ItemAttribute_t::OPENCONTAINER, 0);
+			if (const auto &subContainer = item->getContainer()) {
+				updateOpenContainer(subContainer);
 			}
+			nodes.push_back({ item, 0, parent });
+		}
+		siblings.emplace_back(begin, nodes.size());
+	}
 
-			if (!openContainers.empty()) {
-				for (const auto &its : openContainers) {
-					auto openContainer = its.second;
-					auto opcontainer = openContainer.container;
-
-					if (opcontainer == container) {
-						container->setAttribute(ItemAttribute_t::OPENCONTAINER, ((int)its.first) + 1);
-						break;
-					}
-				}
-			}
+	// Sids of the last save are kept, so one item added or removed doesn't renumber the ones after it
+	std::vector<const void*> identities;
+	identities.reserve(nodes.size());
+	for (const auto &node : nodes) {
+		identities.emplace_back(node.item.get());
+	}
+	const auto* persisted = player->saveState().getPersisted(section);
+	const auto sids = PlayerSaveState::assignSids(identities, siblings, persisted ? &persisted->sids : nullptr);
 
-			// Add container to queue
-			queue.emplace_back(container, runningId);
-		}
+	rows.reserve(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		const auto &[item, pid, parent] = nodes[i];
 
 		// Serialize item attributes
 		propWriteStream.clear();
@@ -80,81 +157,100 @@ bool IOLoginDataSave::saveItems(const std::shared_ptr<Player> &player, const Ite
 
 		size_t attributesSize;
 		const char* attributes = propWriteStream.getStream(attributesSize);
-
-		// Build query string and add row
-		ss << player->getGUID() << ',' << pid << ',' << runningId << ',' << item->getID() << ',' << item->getSubType() << ',' << db.escapeBlob(attributes, static_cast<uint32_t>(attributesSize));
-		if (!query_insert.addRow(ss)) {
-			g_logger().error("Error adding row to query.");
-			return false;
-		}
+		rows.push_back({ parent == TOP_LEVEL ? pid : sids[parent], sids[i], item->getID(), item->getSubType(), std::string(attributes, attributesSize), item.get() });
 	}
+	return true;
+}
 
-	// Loop through containers in queue
-	while (!queue.empty()) {
-		const ContainerBlock &cb = queue.front();
-		const std::shared_ptr<Container> &container = cb.first;
-		if (!container) {
-			continue;
-		}
-
-		int32_t parentId = cb.second;
-
-		// Loop through items in container
-		for (auto &item : container->getItemList()) {
-			if (!item) {
-				continue;
-			}
-
-			++runningId;
+bool IOLoginDataSave::saveItemRows(const std::shared_ptr<Player> &player, PlayerSaveSection section, std::string_view table, const std::vector<ItemRow> &rows) {
+	auto &state = player->saveState();
+	auto &report = state.report()[section];
 
-			// Update sub-container attributes if necessary
-			const auto &subContainer = item->getContainer();
-			if (subContainer) {
-				queue.emplace_back(subContainer, runningId);
-				if (subContainer->getAttribute<int64_t>(ItemAttribute_t::OPENCONTAINER) > 0) {
-					subContainer->setAttribute(ItemAttribute_t::OPENCONTAINER, 0);
-				}
+	PlayerSaveState::Snapshot snapshot;
+	snapshot.rows.reserve(rows.size());
+	snapshot.sids.reserve(rows.size());
+	size_t fingerprint = rows.size();
+	for (const auto &row : rows) {
+		const auto rowHash = hashItemRow(row);
+		snapshot.rows.emplace(row.sid, rowHash);
+		snapshot.sids.emplace(row.item, row.sid);
+		addToFingerprint(fingerprint, row.sid, rowHash);
+	}
+	snapshot.fingerprint = fingerprint;
 
-				if (!openContainers.empty()) {
-					for (const auto &it : openContainers) {
-						auto openContainer = it.second;
-						auto opcontainer = openContainer.container;
+	if (state.isUnchanged(section, snapshot.fingerprint)) {
+		return true;
+	}
 
-						if (opcontainer == subContainer) {
-							subContainer->setAttribute(ItemAttribute_t::OPENCONTAINER, (it.first) + 1);
-							break;
-						}
-					}
-				}
+	Database &db = Database::getInstance();
+	const auto guid = player->getGUID();
+	report.written = true;
+
+	// Without a snapshot of what the database holds the whole section is rewritten, otherwise
+	// only rows that are gone or changed are deleted, and the changed ones inserted again
+	const auto* persisted = state.getPersisted(section);
+	if (!persisted) {
+		if (!db.executeQuery(fmt::format("DELETE FROM `{}` WHERE `player_id` = {}", table, guid))) {
+			g_logger().warn("[IOLoginData::savePlayer] - Error delete query '{}' from player: {}", table, player->getName());
+			return false;
+		}
+		report.deletes = 1;
+	} else {
+		std::vector<int64_t> staleRows;
+		for (const auto &[sid, rowHash] : persisted->rows) {
+			const auto it = snapshot.rows.find(sid);
+			if (it == snapshot.rows.end() || it->second != rowHash) {
+				staleRows.emplace_back(sid);
 			}
+		}
 
-			// Serialize item attributes
-			propWriteStream.clear();
-			item->serializeAttr(propWriteStream);
-
-			size_t attributesSize;
-			const char* attributes = propWriteStream.getStream(attributesSize);
-
-			// Build query string and add row
-			ss << player->getGUID() << ',' << parentId << ',' << runningId << ',' << item->getID() << ',' << item->getSubType() << ',' << db.escapeBlob(attributes, static_cast<uint32_t>(attributesSize));
-			if (!query_insert.addRow(ss)) {
-				g_logger().error("Error adding row to query for container item.");
+		if (!staleRows.empty()) {
+			if (!db.executeQuery(fmt::format("DELETE FROM `{}` WHERE `player_id` = {} AND `sid` IN ({})", table, guid, fmt::join(staleRows, ",")))) {
+				g_logger().warn("[IOLoginData::savePlayer] - Error delete query '{}' from player: {}", table, player->getName());
 				return false;
 			}
+			report.deletes = static_cast<uint32_t>(staleRows.size());
 		}
+	}
 
-		// Removes the object after processing everything, avoiding memory usage after freeing
-		queue.pop_front();
+	DBInsert insertQuery(fmt::format("INSERT INTO `{}` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ", table));
+	for (const auto &row : rows) {
+		if (persisted) {
+			const auto it = persisted->rows.find(row.sid);
+			if (it != persisted->rows.end() && it->second == snapshot.rows[row.sid]) {
+				continue;
+			}
+		}
+
+		const auto values = fmt::format("{},{},{},{},{},{}", guid, row.pid, row.sid, row.itemType, row.count, db.escapeBlob(row.attributes.data(), static_cast<uint32_t>(row.attributes.size())));
+		if (!insertQuery.addRow(values)) {
+			g_logger().error("Error adding row to query.");
+			return false;
+		}
+		report.bytes += values.size();
+		++report.rows;
 	}
 
-	// Execute query
-	if (!query_insert.execute()) {
+	if (!insertQuery.execute()) {
 		g_logger().error("Error executing query.");
 		return false;
 	}
+
+	stageSnapshot(player, section, std::move(snapshot));
 	return true;
 }
 
+bool IOLoginDataSave::skipUnchangedSection(const std::shared_ptr<Player> &player, PlayerSaveSection section, uint64_t fingerprint) {
+	auto &state = player->saveState();
+	if (state.isUnchanged(section, fingerprint)) {
+		return true;
+	}
+
+	state.report()[section].written = true;
+	stageSnapshot(player, section, { fingerprint, {} });
+	return false;
+}
+
 bool IOLoginDataSave::savePlayerFirst(const std::shared_ptr<Player> &player) {
 	if (!player) {
 		g_logger().warn("[IOLoginData::savePlayer] - Player nullptr: {}", __FUNCTION__);
@@ -342,16 +438,9 @@ bool IOLoginDataSave::savePlayerStash(const std::shared_ptr<Player> &player) {
 		return false;
 	}
 
-	Database &db = Database::getInstance();
-	std::ostringstream query;
-	query << "DELETE FROM `player_stash` WHERE `player_id` = " << player->getGUID();
-	if (!db.executeQuery(query.str())) {
-		return false;
-	}
-
-	query.str("");
-
-	DBInsert stashQuery("INSERT INTO `player_stash` (`player_id`,`item_id`,`item_count`) VALUES ");
+	auto &state = player->saveState();
+	PlayerSaveState::Snapshot snapshot;
+	size_t fingerprint = 0;
 	for (const auto &[itemId, itemCount] : player->getStashItems()) {
 		const ItemType &itemType = Item::items[itemId];
 		if (itemType.decayTo >= 0 && itemType.decayTime > 0) {
@@ -364,15 +453,66 @@ bool IOLoginDataSave::savePlayerStash(const std::shared_ptr<Player> &player) {
 			continue;
 		}
 
-		query << player->getGUID() << ',' << itemId << ',' << itemCount;
-		if (!stashQuery.addRow(query)) {
+		snapshot.rows.emplace(itemId, itemCount);
+		addToFingerprint(fingerprint, itemId, itemCount);
+	}
+	snapshot.fingerprint = fingerprint;
+
+	if (state.isUnchanged(PlayerSaveSection::Stash, snapshot.fingerprint)) {
+		return true;
+	}
+
+	Database &db = Database::getInstance();
+	const auto guid = player->getGUID();
+	auto &report = state.report()[PlayerSaveSection::Stash];
+	report.written = true;
+
+	// The stash is keyed by item id, withdrawn items are deleted and the other changed counts upserted
+	const auto* persisted = state.getPersisted(PlayerSaveSection::Stash);
+	if (!persisted) {
+		if (!db.executeQuery(fmt::format("DELETE FROM `player_stash` WHERE `player_id` = {}", guid))) {
+			return false;
+		}
+		report.deletes = 1;
+	} else {
+		std::vector<int64_t> removedItems;
+		for (const auto &[itemId, itemCount] : persisted->rows) {
+			if (!snapshot.rows.contains(itemId)) {
+				removedItems.emplace_back(itemId);
+			}
+		}
+
+		if (!removedItems.empty()) {
+			if (!db.executeQuery(fmt::format("DELETE FROM `player_stash` WHERE `player_id` = {} AND `item_id` IN ({})", guid, fmt::join(removedItems, ",")))) {
+				return false;
+			}
+			report.deletes = static_cast<uint32_t>(removedItems.size());
+		}
+	}
+
+	DBInsert stashQuery("INSERT INTO `player_stash` (`player_id`,`item_id`,`item_count`) VALUES ");
+	stashQuery.upsert({ "item_count" });
+	for (const auto &[itemId, itemCount] : snapshot.rows) {
+		if (persisted) {
+			const auto it = persisted->rows.find(itemId);
+			if (it != persisted->rows.end() && it->second == itemCount) {
+				continue;
+			}
+		}
+
+		const auto values = fmt::format("{},{},{}", guid, itemId, itemCount);
+		if (!stashQuery.addRow(values)) {
 			return false;
 		}
+		report.bytes += values.size();
+		++report.rows;
 	}
 
 	if (!stashQuery.execute()) {
 		return false;
 	}
+
+	stageSnapshot(player, PlayerSaveSection::Stash, std::move(snapshot));
 	return true;
 }
 
@@ -382,27 +522,17 @@ bool IOLoginDataSave::savePlayerSpells(const std::shared_ptr<Player> &player) {
 		return false;
 	}
 
-	Database &db = Database::getInstance();
-	std::ostringstream query;
-	query << "DELETE FROM `player_spells` WHERE `player_id` = " << player->getGUID();
-	if (!db.executeQuery(query.str())) {
-		return false;
-	}
-
-	query.str("");
-
-	DBInsert spellsQuery("INSERT INTO `player_spells` (`player_id`, `name` ) VALUES ");
+	const Database &db = Database::getInstance();
+	std::vector<std::string> rows;
+	rows.reserve(player->learnedInstantSpellList.size());
 	for (const std::string &spellName : player->learnedInstantSpellList) {
-		query << player->getGUID() << ',' << db.escapeString(spellName);
-		if (!spellsQuery.addRow(query)) {
-			return false;
-		}
+		rows.emplace_back(fmt::format("{},{}", player->getGUID(), db.escapeString(spellName)));
 	}
 
-	if (!spellsQuery.execute()) {
-		return false;
+	if (skipUnchangedSection(player, PlayerSaveSection::Spells, hashRows(rows))) {
+		return true;
 	}
-	return true;
+	return rewriteSection(player, PlayerSaveSection::Spells, "player_spells", "INSERT INTO `player_spells` (`player_id`, `name` ) VALUES ", rows);
 }
 
 bool IOLoginDataSave::savePlayerKills(const std::shared_ptr<Player> &player) {
@@ -411,27 +541,16 @@ bool IOLoginDataSave::savePlayerKills(const std::shared_ptr<Player> &player) {
 		return false;
 	}
 
-	Database &db = Database::getInstance();
-	std::ostringstream query;
-	query << "DELETE FROM `player_kills` WHERE `player_id` = " << player->getGUID();
-	if (!db.executeQuery(query.str())) {
-		return false;
-	}
-
-	query.str("");
-
-	DBInsert killsQuery("INSERT INTO `player_kills` (`player_id`, `target`, `time`, `unavenged`) VALUES");
+	std::vector<std::string> rows;
+	rows.reserve(player->unjustifiedKills.size());
 	for (const auto &kill : player->unjustifiedKills) {
-		query << player->getGUID() << ',' << kill.target << ',' << kill.time << ',' << kill.unavenged;
-		if (!killsQuery.addRow(query)) {
-			return false;
-		}
+		rows.emplace_back(fmt::format("{},{},{},{}", player->getGUID(), kill.target, kill.time, kill.unavenged ? 1 : 0));
 	}
 
-	if (!killsQuery.execute()) {
-		return false;
+	if (skipUnchangedSection(player, PlayerSaveSection::Kills, hashRows(rows))) {
+		return true;
 	}
-	return true;
+	return rewriteSection(player, PlayerSaveSection::Kills, "player_kills", "INSERT INTO `player_kills` (`player_id`, `target`, `time`, `unavenged`) VALUES", rows);
 }
 
 bool IOLoginDataSave::savePlayerBestiarySystem(const std::shared_ptr<Player> &player) {
@@ -485,17 +604,7 @@ bool IOLoginDataSave::savePlayerItem(const std::shared_ptr<Player> &player) {
 		return false;
 	}
 
-	Database &db = Database::getInstance();
 	PropWriteStream propWriteStream;
-	std::ostringstream query;
-	query << "DELETE FROM `player_items` WHERE `player_id` = " << player->getGUID();
-	if (!db.executeQuery(query.str())) {
-		g_logger().warn("[IOLoginData::savePlayer] - Error delete query 'player_items' from player: {}", player->getName());
-		return false;
-	}
-
-	DBInsert itemsQuery("INSERT INTO `player_items` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-
 	ItemBlockList itemList;
 	for (int32_t slotId = CONST_SLOT_FIRST; slotId <= CONST_SLOT_LAST; ++slotId) {
 		const auto &item = player->inventory[slotId];
@@ -504,7 +613,8 @@ bool IOLoginDataSave::savePlayerItem(const std::shared_ptr<Player> &player) {
 		}
 	}
 
-	if (!saveItems(player, itemList, itemsQuery, propWriteStream)) {
+	std::vector<ItemRow> rows;
+	if (!collectItems(player, PlayerSaveSection::Items, itemList, rows, propWriteStream) || !saveItemRows(player, PlayerSaveSection::Items, "player_items", rows)) {
 		g_logger().warn("[IOLoginData::savePlayer] - Failed for save items from player: {}", player->getName());
 		return false;
 	}
@@ -517,33 +627,21 @@ bool IOLoginDataSave::savePlayerDepotItems(const std::shared_ptr<Player> &player
 		return false;
 	}
 
-	Database &db = Database::getInstance();
+	// Depots that were never opened are not loaded, what the database holds is left as is
+	if (player->lastDepotId == -1) {
+		return true;
+	}
+
 	PropWriteStream propWriteStream;
 	ItemDepotList depotList;
-	if (player->lastDepotId != -1) {
-		std::ostringstream query;
-		query << "DELETE FROM `player_depotitems` WHERE `player_id` = " << player->getGUID();
-
-		if (!db.executeQuery(query.str())) {
-			return false;
-		}
-
-		query.str("");
-
-		DBInsert depotQuery("INSERT INTO `player_depotitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-
-		for (const auto &[pid, depotChest] : player->depotChests) {
-			for (const std::shared_ptr<Item> &item : depotChest->getItemList()) {
-				depotList.emplace_back(pid, item);
-			}
-		}
-
-		if (!saveItems(player, depotList, depotQuery, propWriteStream)) {
-			return false;
+	for (const auto &[pid, depotChest] : player->depotChests) {
+		for (const std::shared_ptr<Item> &item : depotChest->getItemList()) {
+			depotList.emplace_back(pid, item);
 		}
-		return true;
 	}
-	return true;
+
+	std::vector<ItemRow> rows;
+	return collectItems(player, PlayerSaveSection::DepotItems, depotList, rows, propWriteStream) && saveItemRows(player, PlayerSaveSection::DepotItems, "player_depotitems", rows);
 }
 
 bool IOLoginDataSave::saveRewardItems(const std::shared_ptr<Player> &player) {
@@ -552,32 +650,20 @@ bool IOLoginDataSave::saveRewardItems(const std::shared_ptr<Player> &player) {
 		return false;
 	}
 
-	std::ostringstream query;
-	query << "DELETE FROM `player_rewards` WHERE `player_id` = " << player->getGUID();
-
-	if (!Database::getInstance().executeQuery(query.str())) {
-		return false;
-	}
-
 	std::vector<uint64_t> rewardList;
 	player->getRewardList(rewardList);
 
 	ItemRewardList rewardListItems;
-	if (!rewardList.empty()) {
-		for (const auto &rewardId : rewardList) {
-			auto reward = player->getReward(rewardId, false);
-			if (!reward->empty() && (getTimeMsNow() - rewardId <= 1000 * 60 * 60 * 24 * 7)) {
-				rewardListItems.emplace_back(0, reward);
-			}
-		}
-
-		DBInsert rewardQuery("INSERT INTO `player_rewards` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-		PropWriteStream propWriteStream;
-		if (!saveItems(player, rewardListItems, rewardQuery, propWriteStream)) {
-			return false;
+	for (const auto &rewardId : rewardList) {
+		auto reward = player->getReward(rewardId, false);
+		if (!reward->empty() && (getTimeMsNow() - rewardId <= 1000 * 60 * 60 * 24 * 7)) {
+			rewardListItems.emplace_back(0, reward);
 		}
 	}
-	return true;
+
+	PropWriteStream propWriteStream;
+	std::vector<ItemRow> rows;
+	return collectItems(player, PlayerSaveSection::RewardItems, rewardListItems, rows, propWriteStream) && saveItemRows(player, PlayerSaveSection::RewardItems, "player_rewards", rows);
 }
 
 bool IOLoginDataSave::savePlayerInbox(const std::shared_ptr<Player> &player) {
@@ -586,26 +672,14 @@ bool IOLoginDataSave::savePlayerInbox(const std::shared_ptr<Player> &player) {
 		return false;
 	}
 
-	Database &db = Database::getInstance();
 	PropWriteStream propWriteStream;
 	ItemInboxList inboxList;
-	std::ostringstream query;
-	query << "DELETE FROM `player_inboxitems` WHERE `player_id` = " << player->getGUID();
-	if (!db.executeQuery(query.str())) {
-		return false;
-	}
-
-	query.str("");
-	DBInsert inboxQuery("INSERT INTO `player_inboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-
 	for (const auto &item : player->getInbox()->getItemList()) {
 		inboxList.emplace_back(0, item);
 	}
 
-	if (!saveItems(player, inboxList, inboxQuery, propWriteStream)) {
-		return false;
-	}
-	return true;
+	std::vector<ItemRow> rows;
+	return collectItems(player, PlayerSaveSection::InboxItems, inboxList, rows, propWriteStream) && saveItemRows(player, PlayerSaveSection::InboxItems, "player_inboxitems", rows);
 }
 
 bool IOLoginDataSave::savePlayerPreyClass(const std::shared_ptr<Player> &player) {
@@ -720,32 +794,18 @@ bool IOLoginDataSave::savePlayerForgeHistory(const std::shared_ptr<Player> &play
 		return false;
 	}
 
-	std::ostringstream query;
-	query << "DELETE FROM `forge_history` WHERE `player_id` = " << player->getGUID();
-	if (!Database::getInstance().executeQuery(query.str())) {
-		return false;
-	}
-
-	query.str("");
-	DBInsert insertQuery("INSERT INTO `forge_history` (`player_id`, `action_type`, `description`, `done_at`, `is_success`) VALUES");
+	const Database &db = Database::getInstance();
+	std::vector<std::string> rows;
 	for (const auto &history : player->getForgeHistory()) {
-		const auto stringDescription = Database::getInstance().escapeString(history.description);
+		const auto stringDescription = db.escapeString(history.description);
 		auto actionString = magic_enum::enum_integer(history.actionType);
-		// Append query informations
-		query << player->getGUID() << ','
-			  << std::to_string(actionString) << ','
-			  << stringDescription << ','
-			  << history.createdAt << ','
-			  << history.success;
-
-		if (!insertQuery.addRow(query)) {
-			return false;
-		}
+		rows.emplace_back(fmt::format("{},{},{},{},{}", player->getGUID(), actionString, stringDescription, history.createdAt, history.success ? 1 : 0));
 	}
-	if (!insertQuery.execute()) {
-		return false;
+
+	if (skipUnchangedSection(player, PlayerSaveSection::ForgeHistory, hashRows(rows))) {
+		return true;
 	}
-	return true;
+	return rewriteSection(player, PlayerSaveSection::ForgeHistory, "forge_history", "INSERT INTO `forge_history` (`player_id`, `action_type`, `description`, `done_at`, `is_success`) VALUES", rows);
 }
 
 bool IOLoginDataSave::savePlayerBosstiary(const std::shared_ptr<Player> &player) {
@@ -754,15 +814,6 @@ bool IOLoginDataSave::savePlayerBosstiary(const std::shared_ptr<Player> &player)
 		return false;
 	}
 
-	std::ostringstream query;
-	query << "DELETE FROM `player_bosstiary` WHERE `player_id` = " << player->getGUID();
-	if (!Database::getInstance().executeQuery(query.str())) {
-		return false;
-	}
-
-	query.str("");
-	DBInsert insertQuery("INSERT INTO `player_bosstiary` (`player_id`, `bossIdSlotOne`, `bossIdSlotTwo`, `removeTimes`, `tracker`) VALUES");
-
 	// Bosstiary tracker
 	PropWriteStream stream;
 	for (const auto &monsterType : player->getCyclopediaMonsterTrackerSet(true)) {
@@ -774,22 +825,14 @@ bool IOLoginDataSave::savePlayerBosstiary(const std::shared_ptr<Player> &player)
 	}
 	size_t size;
 	const char* chars = stream.getStream(size);
-	// Append query informations
-	query << player->getGUID() << ','
-		  << player->getSlotBossId(1) << ','
-		  << player->getSlotBossId(2) << ','
-		  << std::to_string(player->getRemoveTimes()) << ','
-		  << Database::getInstance().escapeBlob(chars, static_cast<uint32_t>(size));
-
-	if (!insertQuery.addRow(query)) {
-		return false;
-	}
+	const std::vector<std::string> rows {
+		fmt::format("{},{},{},{},{}", player->getGUID(), player->getSlotBossId(1), player->getSlotBossId(2), player->getRemoveTimes(), Database::getInstance().escapeBlob(chars, static_cast<uint32_t>(size)))
+	};
 
-	if (!insertQuery.execute()) {
-		return false;
+	if (skipUnchangedSection(player, PlayerSaveSection::Bosstiary, hashRows(rows))) {
+		return true;
 	}
-
-	return true;
+	return rewriteSection(player, PlayerSaveSection::Bosstiary, "player_bosstiary", "INSERT INTO `player_bosstiary` (`player_id`, `bossIdSlotOne`, `bossIdSlotTwo`, `removeTimes`, `tracker`) VALUES", rows);
 }
 
 bool IOLoginDataSave::savePlayerStorage(const std::shared_ptr<Player> &player) {
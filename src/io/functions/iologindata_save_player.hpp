@@ -10,9 +10,9 @@
 #pragma once
 
 #include "io/iologindata.hpp"
+#include "creatures/players/components/player_save_state.hpp"
 
 class PropWriteStream;
-class DBInsert;
 
 class IOLoginDataSave : public IOLoginData {
 public:
@@ -31,11 +31,25 @@ public:
 	static bool savePlayerBosstiary(const std::shared_ptr<Player> &player);
 	static bool savePlayerStorage(const std::shared_ptr<Player> &player);
 
+	// One row of the player_items, player_depotitems, player_rewards or player_inboxitems tables
+	struct ItemRow {
+		int32_t pid;
+		int32_t sid;
+		uint16_t itemType;
+		uint16_t count;
+		std::string attributes;
+		// Keeps its sid on the next save of the session
+		const Item* item = nullptr;
+	};
+
 protected:
 	using ItemBlockList = std::list<std::pair<int32_t, std::shared_ptr<Item>>>;
 	using ItemDepotList = std::list<std::pair<int32_t, std::shared_ptr<Item>>>;
 	using ItemRewardList = std::list<std::pair<int32_t, std::shared_ptr<Item>>>;
 	using ItemInboxList = std::list<std::pair<int32_t, std::shared_ptr<Item>>>;
 
-	static bool saveItems(const std::shared_ptr<Player> &player, const ItemBlockList &itemList, DBInsert &query_insert, PropWriteStream &stream);
+	static bool collectItems(const std::shared_ptr<Player> &player, PlayerSaveSection section, const ItemBlockList &itemList, std::vector<ItemRow> &rows, PropWriteStream &stream);
+	static bool saveItemRows(const std::shared_ptr<Player> &player, PlayerSaveSection section, std::string_view table, const std::vector<ItemRow> &rows);
+	// Whether a section rewritten in full can be skipped, otherwise stages its fingerprint for the rewrite
+	static bool skipUnchangedSection(const std::shared_ptr<Player> &player, PlayerSaveSection section, uint64_t fingerprint);
 };
@@ -246,7 +246,7 @@ std::shared_ptr<Charm> IOBestiary::getBestiaryCharm(charmRune_t activeCharm, boo
 	return nullptr;
 }
 
-std::map<uint16_t, std::string> IOBestiary::findRaceByName(const std::string &race, bool Onlystring /*= true*/, BestiaryType_t raceNumber /*= BESTY_RACE_NONE*/) const {
+std::map<uint16_t, std::string> IOBestiary::findRaceByName(std::string_view race, bool Onlystring /*= true*/, BestiaryType_t raceNumber /*= BESTY_RACE_NONE*/) const {
 	const std::map<uint16_t, std::string> &best_list = g_game().getBestiaryList();
 	std::map<uint16_t, std::string> race_list;
 
@@ -12,6 +12,7 @@
 #include "account/account.hpp"
 #include "config/configmanager.hpp"
 #include "database/database.hpp"
+#include "database/persistence_journal.hpp"
 #include "io/functions/iologindata_load_player.hpp"
 #include "io/functions/iologindata_save_player.hpp"
 #include "game/game.hpp"
@@ -79,17 +80,19 @@ uint8_t IOLoginData::getAccountType(uint32_t accountId) {
 
 // The boolean "disableIrrelevantInfo" will deactivate the loading of information that is not relevant to the preload, for example, forge, bosstiary, etc. None of this we need to access if the player is offline
 bool IOLoginData::loadPlayerById(const std::shared_ptr<Player> &player, uint32_t id, bool disableIrrelevantInfo /* = true*/) {
-	Database &db = Database::getInstance();
-	std::ostringstream query;
-	query << "SELECT * FROM `players` WHERE `id` = " << id;
-	return loadPlayer(player, db.storeQuery(query.str()), disableIrrelevantInfo);
+	g_persistenceJournal().waitFlushed(PersistenceJournal::playerKey(id));
+	DBStatement statement("SELECT * FROM `players` WHERE `id` = ?");
+	return loadPlayer(player, statement.bind(id).store(), disableIrrelevantInfo);
 }
 
 bool IOLoginData::loadPlayerByName(const std::shared_ptr<Player> &player, const std::string &name, bool disableIrrelevantInfo /* = true*/) {
-	Database &db = Database::getInstance();
-	std::ostringstream query;
-	query << "SELECT * FROM `players` WHERE `name` = " << db.escapeString(name);
-	return loadPlayer(player, db.storeQuery(query.str()), disableIrrelevantInfo);
+	DBStatement statement("SELECT * FROM `players` WHERE `name` = ?");
+	auto result = statement.bind(name).store();
+	// The row read may be older than a save still in the journal
+	if (result && g_persistenceJournal().waitFlushed(PersistenceJournal::playerKey(result->getNumber<uint32_t>("id")))) {
+		result = statement.store();
+	}
+	return loadPlayer(player, result, disableIrrelevantInfo);
 }
 
 bool IOLoginData::loadPlayer(const std::shared_ptr<Player> &player, const DBResult_ptr &result, bool disableIrrelevantInfo /* = false*/) {
@@ -192,20 +195,38 @@ void IOLoginData::loadOnlyDataForOnlinePlayer(const std::shared_ptr<Player> &pla
 }
 
 bool IOLoginData::savePlayer(const std::shared_ptr<Player> &player) {
+	if (!player) {
+		g_logger().error("[{}] Player nullptr", __FUNCTION__);
+		return false;
+	}
+
+	// Sections only know what they last wrote once the transaction holding it committed
+	auto &saveState = player->saveState();
+	const auto journalKey = PersistenceJournal::playerKey(player->getGUID());
+	// A journaled save was given up on, the diffs of the later ones miss its rows
+	if (g_persistenceJournal().takeRejected(journalKey)) {
+		saveState.invalidate();
+	}
+	saveState.begin();
+	Benchmark bm_save;
 	try {
-		bool success = DBTransaction::executeWithinTransaction([player]() {
+		bool success = g_persistenceJournal().write(journalKey, [player]() {
 			return savePlayerGuard(player);
 		});
 
 		if (!success) {
 			g_logger().error("[{}] Error occurred saving player", __FUNCTION__);
+			saveState.discard(bm_save.duration());
+			return false;
 		}
 
-		return success;
+		saveState.commit(bm_save.duration());
+		return true;
 	} catch (const DatabaseException &e) {
 		g_logger().error("[{}] Exception occurred: {}", __FUNCTION__, e.what());
 	}
 
+	saveState.discard(bm_save.duration());
 	return false;
 }
 
@@ -352,7 +373,10 @@ bool IOLoginData::formatPlayerName(std::string &name) {
 void IOLoginData::increaseBankBalance(uint32_t guid, uint64_t bankBalance) {
 	std::ostringstream query;
 	query << "UPDATE `players` SET `balance` = `balance` + " << bankBalance << " WHERE `id` = " << guid;
-	Database::getInstance().executeQuery(query.str());
+	// Queued behind the saves of the player, a pending one rewrites the balance
+	g_persistenceJournal().write(PersistenceJournal::playerKey(guid), [&query] {
+		return Database::getInstance().executeQuery(query.str());
+	});
 }
 
 std::vector<VIPEntry> IOLoginData::getVIPEntries(uint32_t accountId) {
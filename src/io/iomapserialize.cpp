@@ -10,6 +10,7 @@
 #include "io/iomapserialize.hpp"
 
 #include "config/configmanager.hpp"
+#include "database/persistence_journal.hpp"
 #include "io/iologindata.hpp"
 #include "game/game.hpp"
 #include "items/bed.hpp"
@@ -63,7 +64,7 @@ void IOMapSerialize::loadHouseItems(Map* map) {
 }
 
 bool IOMapSerialize::saveHouseItems() {
-	bool success = DBTransaction::executeWithinTransaction([]() {
+	bool success = g_persistenceJournal().write(PersistenceJournal::HOUSES_KEY, []() {
 		return SaveHouseItemsGuard();
 	});
 
@@ -366,7 +367,7 @@ bool IOMapSerialize::loadHouseInfo() {
 }
 
 bool IOMapSerialize::saveHouseInfo() {
-	bool success = DBTransaction::executeWithinTransaction([]() {
+	bool success = g_persistenceJournal().write(PersistenceJournal::HOUSES_KEY, []() {
 		return SaveHouseInfoGuard();
 	});
 
@@ -369,6 +369,8 @@ std::shared_ptr<Thing> Tile::getTopVisibleThing(const std::shared_ptr<Creature>
 }
 
 void Tile::onAddTileItem(const std::shared_ptr<Item> &item) {
+	invalidateDescriptionCache();
+
 	if (!item) {
 		g_logger().error("Tile::onAddTileItem: item is nullptr");
 		return;
@@ -447,6 +449,8 @@ void Tile::onAddTileItem(const std::shared_ptr<Item> &item) {
 }
 
 void Tile::onUpdateTileItem(const std::shared_ptr<Item> &oldItem, const ItemType &oldType, const std::shared_ptr<Item> &newItem, const ItemType &newType) {
+	invalidateDescriptionCache();
+
 	if (!oldItem || !newItem) {
 		g_logger().error("Tile::onUpdateTileItem: oldItem or newItem is nullptr");
 		return;
@@ -494,6 +498,8 @@ void Tile::onUpdateTileItem(const std::shared_ptr<Item> &oldItem, const ItemType
 }
 
 void Tile::onRemoveTileItem(const CreatureVector &spectators, const std::vector<int32_t> &oldStackPosVector, const std::shared_ptr<Item> &item) {
+	invalidateDescriptionCache();
+
 	if (!item) {
 		g_logger().error("Tile::onRemoveTileItem: item is nullptr");
 		return;
@@ -582,6 +588,8 @@ void Tile::onRemoveTileItem(const CreatureVector &spectators, const std::vector<
 }
 
 void Tile::onUpdateTile(const CreatureVector &spectators) {
+	invalidateDescriptionCache();
+
 	const Position &cylinderMapPos = getPosition();
 
 	// send to clients
@@ -1025,7 +1033,7 @@ void Tile::addThing(int32_t, const std::shared_ptr<Thing> &thing) {
 
 	const auto &creature = thing->getCreature();
 	if (creature) {
-		Spectators::clearCache();
+		Spectators::invalidateCache(tilePos);
 		creature->setParent(static_self_cast<Tile>());
 
 		CreatureVector* creatures = makeCreatures();
@@ -1241,7 +1249,7 @@ void Tile::removeThing(const std::shared_ptr<Thing> &thing, uint32_t count) {
 		if (creatures) {
 			const auto it = std::ranges::find(*creatures, thing);
 			if (it != creatures->end()) {
-				Spectators::clearCache();
+				Spectators::invalidateCache(tilePos);
 				creatures->erase(it);
 			}
 		}
@@ -1647,7 +1655,7 @@ void Tile::internalAddThing(uint32_t, const std::shared_ptr<Thing> &thing) {
 
 	const auto &creature = thing->getCreature();
 	if (creature) {
-		Spectators::clearCache();
+		Spectators::invalidateCache(tilePos);
 
 		CreatureVector* creatures = makeCreatures();
 		creatures->insert(creatures->begin(), creature);
@@ -1657,6 +1665,8 @@ void Tile::internalAddThing(uint32_t, const std::shared_ptr<Thing> &thing) {
 			return;
 		}
 
+		invalidateDescriptionCache();
+
 		const ItemType &itemType = Item::items[item->getID()];
 		if (itemType.isGroundTile()) {
 			if (ground == nullptr) {
@@ -257,6 +257,19 @@ public:
 		if ((ground = item)) {
 			setTileFlags(item);
 		}
+		invalidateDescriptionCache();
+	}
+
+	// Client encoding of the items, built and read by ProtocolGame::GetTileDescription.
+	// Dropped whenever an item of the tile is added, removed or updated.
+	const uint8_t* getDescriptionCache() const {
+		return descriptionCache.get();
+	}
+	void setDescriptionCache(std::unique_ptr<uint8_t[]> cache) {
+		descriptionCache = std::move(cache);
+	}
+	void invalidateDescriptionCache() {
+		descriptionCache.reset();
 	}
 
 	// This method maintains safety in asynchronous calls, avoiding competition between threads.
@@ -278,6 +291,7 @@ protected:
 	Position tilePos;
 	uint32_t flags = 0;
 	std::unordered_set<std::shared_ptr<Zone>> zones {};
+	std::unique_ptr<uint8_t[]> descriptionCache;
 };
 
 // Used for walkable tiles, where there is high likeliness of
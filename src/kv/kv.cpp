@@ -20,103 +20,370 @@ KVStore &KVStore::getInstance() {
 	return inject<KVStore>();
 }
 
+KVStore::~KVStore() {
+	stopWriteBack();
+}
+
 void KVStore::set(const std::string &key, const std::initializer_list<ValueWrapper> &init_list) {
 	const ValueWrapper wrappedInitList(init_list);
-	set(key, wrappedInitList);
+	set(KVKey(key), wrappedInitList);
 }
 
 void KVStore::set(const std::string &key, const std::initializer_list<std::pair<const std::string, ValueWrapper>> &init_list) {
 	const ValueWrapper wrappedInitList(init_list);
-	set(key, wrappedInitList);
+	set(KVKey(key), wrappedInitList);
 }
 
 void KVStore::set(const std::string &key, const ValueWrapper &value) {
-	{
-		std::scoped_lock lock(mutex_);
-		setLocked(key, value);
+	set(KVKey(key), value);
+}
+
+void KVStore::set(const KVKey &key, const ValueWrapper &value) {
+	auto &shard = getShard(key);
+	std::scoped_lock lock(shard.mutex);
+	const auto it = shard.entries.find(key);
+	if (it != shard.entries.end()) {
+		auto &entry = it->second;
+		entry.value = value;
+		entry.version = nextVersion.fetch_add(1, std::memory_order_relaxed) + 1;
+		entry.dirty = true;
+		entry.referenced.store(true, std::memory_order_relaxed);
+		return;
+	}
+
+	// The new value supersedes an evicted one still waiting for its write
+	if (evictedCount.load(std::memory_order_relaxed) > 0) {
+		std::scoped_lock evictedLock(evictedMutex);
+		if (const auto evictedIt = evicted.find(key.str()); evictedIt != evicted.end()) {
+			evicted.erase(evictedIt);
+			evictedCount.store(evicted.size(), std::memory_order_relaxed);
+		}
 	}
-	processEvictions();
+	insertLocked(shard, key.str(), value, true);
 }
 
-void KVStore::setLocked(const std::string &key, const ValueWrapper &value) {
-	auto it = store_.find(key);
-	if (it != store_.end()) {
-		it->second.first = value;
-		lruQueue_.splice(lruQueue_.begin(), lruQueue_, it->second.second);
-	} else {
-		std::string evictKey;
-		ValueWrapper evictValue;
-		bool needsEviction = false;
+std::optional<ValueWrapper> KVStore::get(const std::string &key, bool forceLoad /*= false*/) {
+	return get(KVKey(key), forceLoad);
+}
+
+std::optional<ValueWrapper> KVStore::get(const KVKey &key, bool forceLoad /*= false*/) {
+	logger.trace("KVStore::get({}{})", key.prefix, key.key);
 
-		if (store_.size() >= MAX_SIZE && !lruQueue_.empty()) {
-			logger.debug("KVStore::set() - MAX_SIZE reached, removing last element");
-			auto last = std::prev(lruQueue_.end());
-			evictKey = *last;
-			evictValue = store_[*last].first;
-			needsEviction = true;
-			store_.erase(*last);
-			lruQueue_.pop_back();
+	auto &shard = getShard(key);
+	if (!forceLoad) {
+		std::shared_lock lock(shard.mutex);
+		const auto it = shard.entries.find(key);
+		if (it != shard.entries.end()) {
+			hits.fetch_add(1, std::memory_order_relaxed);
+			const auto &entry = it->second;
+			// Deleted markers are left unreferenced, they are the first to be evicted
+			if (entry.value.isDeleted()) {
+				return std::nullopt;
+			}
+			entry.referenced.store(true, std::memory_order_relaxed);
+			return entry.value;
+		}
+	}
+	misses.fetch_add(1, std::memory_order_relaxed);
+
+	if (!forceLoad) {
+		std::scoped_lock lock(shard.mutex);
+		if (const auto it = shard.entries.find(key); it != shard.entries.end()) {
+			return it->second.value.isDeleted() ? std::nullopt : std::make_optional(it->second.value);
+		}
+		if (auto value = takeEvicted(key)) {
+			insertLocked(shard, key.str(), *value, true);
+			return value->isDeleted() ? std::nullopt : value;
 		}
+	}
 
-		lruQueue_.push_front(key);
-		store_.try_emplace(key, std::make_pair(value, lruQueue_.begin()));
+	const auto fullKey = key.str();
+	auto value = load(fullKey);
+	if (!value) {
+		return value;
+	}
 
-		if (needsEviction) {
-			pendingEvictions_.emplace_back(evictKey, evictValue);
+	std::scoped_lock lock(shard.mutex);
+	const auto it = shard.entries.find(key);
+	if (it == shard.entries.end()) {
+		// Evicted while loading, the evicted value is newer than the database
+		if (auto evictedValue = takeEvicted(key)) {
+			insertLocked(shard, fullKey, *evictedValue, true);
+			return evictedValue->isDeleted() ? std::nullopt : evictedValue;
 		}
+		insertLocked(shard, fullKey, *value, false);
+	} else if (forceLoad) {
+		auto &entry = it->second;
+		entry.value = *value;
+		entry.version = nextVersion.fetch_add(1, std::memory_order_relaxed) + 1;
+		entry.dirty = false;
+	} else {
+		// Set while loading, the cached value is newer
+		return it->second.value.isDeleted() ? std::nullopt : std::make_optional(it->second.value);
 	}
+	return value;
 }
 
-std::optional<ValueWrapper> KVStore::get(const std::string &key, bool forceLoad /*= false*/) {
-	logger.trace("KVStore::get({})", key);
+KVStore::Node &KVStore::insertLocked(Shard &shard, std::string key, const ValueWrapper &value, bool dirty) {
+	if (shard.entries.size() >= shardCapacity) {
+		evictLocked(shard);
+	}
+
+	auto [it, inserted] = shard.entries.try_emplace(std::move(key), value, dirty);
+	auto &node = *it;
+	node.second.version = nextVersion.fetch_add(1, std::memory_order_relaxed) + 1;
+	node.second.slot = shard.ring.size();
+	shard.ring.push_back(&node);
+	return node;
+}
+
+void KVStore::evictLocked(Shard &shard) {
+	if (shard.ring.empty()) {
+		return;
+	}
+
+	// Clock sweep: referenced entries get a second chance, it ends within two turns
+	auto hand = shard.hand % shard.ring.size();
+	while (shard.ring[hand]->second.referenced.exchange(false, std::memory_order_relaxed)) {
+		hand = (hand + 1) % shard.ring.size();
+	}
+
+	auto* victim = shard.ring[hand];
+	if (victim->second.dirty) {
+		std::scoped_lock evictedLock(evictedMutex);
+		evicted.insert_or_assign(victim->first, Evicted { std::move(victim->second.value), victim->second.version });
+		evictedCount.store(evicted.size(), std::memory_order_relaxed);
+	}
+
+	shard.ring[hand] = shard.ring.back();
+	shard.ring[hand]->second.slot = hand;
+	shard.ring.pop_back();
+	shard.hand = hand;
+	shard.entries.erase(shard.entries.find(victim->first));
+	evictions.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::optional<ValueWrapper> KVStore::takeEvicted(const KVKey &key) {
+	if (evictedCount.load(std::memory_order_relaxed) == 0) {
+		return std::nullopt;
+	}
+
+	std::scoped_lock evictedLock(evictedMutex);
+	const auto it = evicted.find(key.str());
+	if (it == evicted.end()) {
+		return std::nullopt;
+	}
+	auto value = std::move(it->second.value);
+	evicted.erase(it);
+	evictedCount.store(evicted.size(), std::memory_order_relaxed);
+	return value;
+}
+
+bool KVStore::saveAll() {
+	std::scoped_lock writeBackLock(writeBackMutex);
+	Benchmark bm_writeBack;
+
+	// The rejected keys were cleaned meanwhile, which ones is not known
+	if (takeRejectedWrites()) {
+		logger.warn("KVStore::saveAll() - a previous write-back was rejected, writing every cached key again");
+		for (auto &shard : shards) {
+			std::scoped_lock lock(shard.mutex);
+			for (auto &[key, entry] : shard.entries) {
+				entry.dirty = true;
+			}
+		}
+	}
+
+	// Version of a cached entry or sequence of an evicted value, to tell if it changed while writing
+	struct Origin {
+		bool cached;
+		uint64_t version;
+	};
+
+	// Evicted values come last, a key evicted after its shard was collected has its newest value there
+	std::vector<std::pair<std::string, ValueWrapper>> batch;
+	std::vector<Origin> origins;
+	phmap::flat_hash_map<std::string, size_t> positions;
+	const auto add = [&](const std::string &key, const ValueWrapper &value, Origin origin) {
+		const auto [it, inserted] = positions.try_emplace(key, batch.size());
+		if (inserted) {
+			batch.emplace_back(key, value);
+			origins.emplace_back(origin);
+		} else {
+			batch[it->second].second = value;
+			origins[it->second] = origin;
+		}
+	};
 
+	for (auto &shard : shards) {
+		std::shared_lock lock(shard.mutex);
+		for (const auto &[key, entry] : shard.entries) {
+			if (entry.dirty) {
+				add(key, entry.value, { true, entry.version });
+			}
+		}
+	}
 	{
-		std::scoped_lock lock(mutex_);
-		if (!forceLoad) {
-			auto it = store_.find(key);
-			if (it != store_.end()) {
-				auto &[value, lruIt] = it->second;
-				if (value.isDeleted()) {
-					lruQueue_.splice(lruQueue_.end(), lruQueue_, lruIt);
-					return std::nullopt;
+		// They stay queued until written, lookups keep finding them meanwhile
+		std::scoped_lock evictedLock(evictedMutex);
+		for (const auto &[key, pending] : evicted) {
+			add(key, pending.value, { false, pending.sequence });
+		}
+	}
+
+	bool success = true;
+	for (size_t begin = 0; begin < batch.size(); begin += WRITE_BACK_BATCH) {
+		const auto end = std::min(batch.size(), begin + WRITE_BACK_BATCH);
+		const std::vector<std::pair<std::string, ValueWrapper>> chunk(batch.begin() + begin, batch.begin() + end);
+		if (!saveBatch(chunk)) {
+			// Cached entries stay dirty and evicted values queued, the next write-back retries them
+			success = false;
+			continue;
+		}
+		written.fetch_add(chunk.size(), std::memory_order_relaxed);
+
+		for (size_t i = begin; i < end; ++i) {
+			const auto &key = batch[i].first;
+			const auto &origin = origins[i];
+			if (!origin.cached) {
+				std::scoped_lock evictedLock(evictedMutex);
+				if (const auto it = evicted.find(key); it != evicted.end() && it->second.sequence == origin.version) {
+					evicted.erase(it);
+					evictedCount.store(evicted.size(), std::memory_order_relaxed);
 				}
-				lruQueue_.splice(lruQueue_.begin(), lruQueue_, lruIt);
-				return value;
+				continue;
+			}
+
+			// Unless it was set again while writing
+			const KVKey lookup(key);
+			auto &shard = getShard(lookup);
+			std::scoped_lock lock(shard.mutex);
+			if (const auto it = shard.entries.find(lookup); it != shard.entries.end() && it->second.version == origin.version) {
+				it->second.dirty = false;
 			}
 		}
 	}
 
-	auto value = load(key);
-	if (value) {
-		{
-			std::scoped_lock lock(mutex_);
-			setLocked(key, *value);
+	lastWriteBackMs.store(bm_writeBack.duration(), std::memory_order_relaxed);
+	if (!batch.empty()) {
+		logger.debug("KVStore::saveAll() - {} keys written in {:.2f} ms", batch.size(), lastWriteBackMs.load(std::memory_order_relaxed));
+	}
+	return success;
+}
+
+bool KVStore::saveBatch(const std::vector<std::pair<std::string, ValueWrapper>> &batch) {
+	return std::ranges::all_of(batch, [this](const auto &row) {
+		return save(row.first, row.second);
+	});
+}
+
+void KVStore::flush() {
+	if (!saveAll()) {
+		logger.error("KVStore flush failed, the changed keys stay cached until the next write-back");
+	}
+
+	// Only written entries are dropped, the ones set meanwhile or not written stay dirty.
+	// Evicted values left are the ones not written, saveAll removed the others.
+	std::scoped_lock writeBackLock(writeBackMutex);
+	for (auto &shard : shards) {
+		std::scoped_lock lock(shard.mutex);
+		std::vector<Node*> kept;
+		for (auto* node : shard.ring) {
+			if (node->second.dirty) {
+				node->second.slot = kept.size();
+				kept.push_back(node);
+			} else {
+				shard.entries.erase(shard.entries.find(node->first));
+			}
 		}
-		processEvictions();
+		shard.ring = std::move(kept);
+		shard.hand = 0;
+	}
+}
+
+void KVStore::startWriteBack(std::chrono::milliseconds interval) {
+	stopWriteBack();
+	if (interval.count() <= 0) {
+		return;
+	}
+
+	writeBackStopping = false;
+	writeBackThread = std::thread([this, interval] {
+		std::unique_lock lock(writeBackThreadMutex);
+		while (!writeBackCondition.wait_for(lock, interval, [this] { return writeBackStopping; })) {
+			lock.unlock();
+			if (!saveAll()) {
+				logger.error("KVStore write-back failed, the keys are retried on the next one");
+			}
+			lock.lock();
+		}
+	});
+}
+
+void KVStore::stopWriteBack() {
+	{
+		std::scoped_lock lock(writeBackThreadMutex);
+		writeBackStopping = true;
+	}
+	writeBackCondition.notify_all();
+	if (writeBackThread.joinable()) {
+		writeBackThread.join();
 	}
-	return value;
 }
 
 std::unordered_set<std::string> KVStore::keys(const std::string &prefix /*= ""*/) {
 	std::unordered_set<std::string> keys;
+	for (auto &key : loadPrefix(prefix)) {
+		keys.insert(std::move(key));
+	}
+
+	// Values not written yet override the backend, the evicted ones first as cached ones are newer
+	const auto merge = [&keys, &prefix](const std::string &key, const ValueWrapper &value) {
+		if (!key.starts_with(prefix)) {
+			return;
+		}
+		if (value.isDeleted()) {
+			keys.erase(key.substr(prefix.size()));
+		} else {
+			keys.insert(key.substr(prefix.size()));
+		}
+	};
 
 	{
-		std::scoped_lock lock(mutex_);
-		for (const auto &[key, value] : store_) {
-			if (key.find(prefix) == 0 && !value.first.isDeleted()) {
-				std::string suffix = key.substr(prefix.size());
-				keys.insert(suffix);
-			}
+		std::scoped_lock evictedLock(evictedMutex);
+		for (const auto &[key, pending] : evicted) {
+			merge(key, pending.value);
 		}
 	}
 
-	for (const auto &key : loadPrefix(prefix)) {
-		keys.insert(key);
+	for (auto &shard : shards) {
+		std::shared_lock lock(shard.mutex);
+		for (const auto &[key, entry] : shard.entries) {
+			merge(key, entry.value);
+		}
 	}
 
 	return keys;
 }
 
+KVStore::Stats KVStore::getStats() {
+	Stats stats;
+	stats.hits = hits.load(std::memory_order_relaxed);
+	stats.misses = misses.load(std::memory_order_relaxed);
+	stats.evictions = evictions.load(std::memory_order_relaxed);
+	stats.written = written.load(std::memory_order_relaxed);
+	stats.lastWriteBackMs = lastWriteBackMs.load(std::memory_order_relaxed);
+	for (auto &shard : shards) {
+		std::shared_lock lock(shard.mutex);
+		stats.size += shard.entries.size();
+		for (const auto &[key, entry] : shard.entries) {
+			stats.dirty += entry.dirty ? 1 : 0;
+		}
+	}
+	stats.dirty += evictedCount.load(std::memory_order_relaxed);
+	return stats;
+}
+
 void KV::remove(const std::string &key) {
 	set(key, ValueWrapper::deleted());
 }
@@ -125,18 +392,3 @@ std::shared_ptr<KV> KVStore::scoped(const std::string &scope) {
 	logger.trace("KVStore::scoped({})", scope);
 	return std::make_shared<ScopedKV>(logger, *this, scope);
 }
-
-void KVStore::processEvictions() {
-	std::vector<std::pair<std::string, ValueWrapper>> evictions;
-	{
-		std::scoped_lock lock(mutex_);
-		if (!pendingEvictions_.empty()) {
-			evictions = std::move(pendingEvictions_);
-			pendingEvictions_.clear();
-		}
-	}
-
-	for (const auto &[key, value] : evictions) {
-		save(key, value);
-	}
-}
@@ -17,10 +17,14 @@
 	#include <optional>
 	#include <unordered_set>
 	#include <iomanip>
-	#include <list>
+	#include <thread>
 	#include <utility>
 #endif
 
+#include <bit>
+#include <condition_variable>
+#include <shared_mutex>
+
 #include "kv/value_wrapper.hpp"
 
 class KV : public std::enable_shared_from_this<KV> {
@@ -72,49 +76,111 @@ private:
 	static std::mutex mutex_;
 };
 
+/**
+ * @brief Key of the store, a scope prefix and a key hashed as if they were one string.
+ *
+ * The hash is streamed, so a scope keeps the state after its prefix and only hashes
+ * the key on each access (see ScopedKV), no "prefix.key" string is built for lookups.
+ */
+struct KVKey {
+	static constexpr uint64_t HASH_SEED = 0xcbf29ce484222325ULL;
+
+	static uint64_t hashUpdate(uint64_t state, std::string_view data) {
+		for (const auto c : data) {
+			state = (state ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+		}
+		return state;
+	}
+
+	// FNV-1a spreads poorly over the low bits the tables index with
+	static uint64_t hashFinalize(uint64_t state) {
+		state ^= state >> 33;
+		state *= 0xff51afd7ed558ccdULL;
+		state ^= state >> 33;
+		state *= 0xc4ceb9fe1a85ec53ULL;
+		state ^= state >> 33;
+		return state;
+	}
+
+	explicit KVKey(std::string_view key) :
+		key(key), hash(hashFinalize(hashUpdate(HASH_SEED, key))) { }
+
+	KVKey(std::string_view prefix, uint64_t prefixState, std::string_view key) :
+		prefix(prefix), key(key), hash(hashFinalize(hashUpdate(prefixState, key))) { }
+
+	size_t size() const {
+		return prefix.size() + key.size();
+	}
+
+	std::string str() const {
+		std::string full;
+		full.reserve(size());
+		full.append(prefix).append(key);
+		return full;
+	}
+
+	std::string_view prefix;
+	std::string_view key;
+	uint64_t hash;
+};
+
 class KVStore : public KV {
 public:
 	static constexpr size_t MAX_SIZE = 1000000;
+	// Power of two, the shard is picked from the top bits of the key hash
+	static constexpr size_t SHARDS = 32;
+	// Dirty keys written per saveBatch call
+	static constexpr size_t WRITE_BACK_BATCH = 1000;
+
 	static KVStore &getInstance();
 
-	explicit KVStore(Logger &logger) :
-		logger(logger) { }
+	explicit KVStore(Logger &logger, size_t capacity = MAX_SIZE) :
+		logger(logger), shardCapacity(std::max<size_t>(capacity / SHARDS, 1)) { }
+	~KVStore() override;
 
 	void set(const std::string &key, const std::initializer_list<ValueWrapper> &init_list) override;
 	void set(const std::string &key, const std::initializer_list<std::pair<const std::string, ValueWrapper>> &init_list) override;
 	void set(const std::string &key, const ValueWrapper &value) override;
+	void set(const KVKey &key, const ValueWrapper &value);
 
 	std::optional<ValueWrapper> get(const std::string &key, bool forceLoad = false) override;
-
-	void flush() override {
-		std::vector<std::pair<std::string, ValueWrapper>> snapshot;
-		{
-			std::scoped_lock lock(mutex_);
-			snapshot.reserve(store_.size() + pendingEvictions_.size());
-			for (const auto &[k, v] : store_) {
-				snapshot.emplace_back(k, v.first);
-			}
-			snapshot.insert(snapshot.end(), pendingEvictions_.begin(), pendingEvictions_.end());
-			store_.clear();
-			pendingEvictions_.clear();
-		}
-		for (const auto &[k, v] : snapshot) {
-			save(k, v);
-		}
-	}
+	std::optional<ValueWrapper> get(const KVKey &key, bool forceLoad = false);
+
+	/**
+	 * @brief Writes the keys changed since their last write, and the evicted ones not written yet.
+	 * @return false if a batch failed, its keys are written again by the next call.
+	 */
+	bool saveAll() override;
+
+	/**
+	 * @brief Writes the pending changes and empties the cache of the written keys.
+	 *
+	 * Keys that failed to write or were set meanwhile stay cached and dirty.
+	 */
+	void flush() override;
+
+	/**
+	 * @brief Runs saveAll every `interval` on a background thread, until stopWriteBack.
+	 */
+	void startWriteBack(std::chrono::milliseconds interval);
+	void stopWriteBack();
 
 	std::shared_ptr<KV> scoped(const std::string &scope) final;
+	/**
+	 * @brief Keys of the backend under `prefix`, with the cached and evicted changes not written yet applied.
+	 */
 	std::unordered_set<std::string> keys(const std::string &prefix = "") override;
 
-protected:
-	phmap::parallel_flat_hash_map<std::string, std::pair<ValueWrapper, std::list<std::string>::iterator>> getStore() {
-		std::scoped_lock lock(mutex_);
-		phmap::parallel_flat_hash_map<std::string, std::pair<ValueWrapper, std::list<std::string>::iterator>> copy;
-		for (const auto &[key, value] : store_) {
-			copy.try_emplace(key, value);
-		}
-		return copy;
-	}
+	struct Stats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+		uint64_t written = 0;
+		size_t size = 0;
+		size_t dirty = 0;
+		double lastWriteBackMs = 0;
+	};
+	Stats getStats();
 
 protected:
 	Logger &logger;
@@ -123,27 +189,120 @@ protected:
 	virtual bool save(const std::string &key, const ValueWrapper &value) = 0;
 	virtual std::vector<std::string> loadPrefix(const std::string &prefix = "") = 0;
 
+	/**
+	 * @brief Writes a batch of the write-back, a key appears at most once.
+	 */
+	virtual bool saveBatch(const std::vector<std::pair<std::string, ValueWrapper>> &batch);
+
+	/**
+	 * @brief Whether a batch accepted by saveBatch was rejected afterwards, the cached keys are then written again.
+	 */
+	virtual bool takeRejectedWrites() {
+		return false;
+	}
+
 private:
-	void setLocked(const std::string &key, const ValueWrapper &value);
-	void processEvictions();
-
-	phmap::parallel_flat_hash_map<std::string, std::pair<ValueWrapper, std::list<std::string>::iterator>> store_;
-	std::list<std::string> lruQueue_;
-	std::mutex mutex_;
-	// Evicted entries pending persistence; accessed under mutex_
-	std::vector<std::pair<std::string, ValueWrapper>> pendingEvictions_;
+	struct KeyHash {
+		using is_transparent = void;
+
+		size_t operator()(std::string_view key) const {
+			return KVKey::hashFinalize(KVKey::hashUpdate(KVKey::HASH_SEED, key));
+		}
+		size_t operator()(const std::string &key) const {
+			return operator()(std::string_view(key));
+		}
+		size_t operator()(const KVKey &key) const {
+			return key.hash;
+		}
+	};
+
+	struct KeyEqual {
+		using is_transparent = void;
+
+		bool operator()(const std::string &lhs, const std::string &rhs) const {
+			return lhs == rhs;
+		}
+		bool operator()(const std::string &lhs, const KVKey &rhs) const {
+			return lhs.size() == rhs.size() && std::string_view(lhs).starts_with(rhs.prefix) && std::string_view(lhs).ends_with(rhs.key);
+		}
+		bool operator()(const KVKey &lhs, const std::string &rhs) const {
+			return operator()(rhs, lhs);
+		}
+	};
+
+	struct Entry {
+		Entry(const ValueWrapper &value, bool dirty) :
+			value(value), dirty(dirty) { }
+
+		ValueWrapper value;
+		// Changed by every set, a write-back only cleans the version it wrote
+		uint64_t version = 0;
+		// Position in the clock ring of the shard
+		size_t slot = 0;
+		bool dirty;
+		// Clock bit, set by reads under the shared lock
+		mutable std::atomic_bool referenced = true;
+	};
+
+	using Entries = phmap::node_hash_map<std::string, Entry, KeyHash, KeyEqual>;
+	using Node = Entries::value_type;
+
+	// Lookups only take the shared lock, a hit sets the clock bit instead of moving a list node
+	struct alignas(64) Shard {
+		std::shared_mutex mutex;
+		Entries entries;
+		std::vector<Node*> ring;
+		size_t hand = 0;
+	};
+
+	Shard &getShard(const KVKey &key) {
+		return shards[key.hash >> (64 - std::countr_zero(SHARDS))];
+	}
+
+	Node &insertLocked(Shard &shard, std::string key, const ValueWrapper &value, bool dirty);
+	void evictLocked(Shard &shard);
+	std::optional<ValueWrapper> takeEvicted(const KVKey &key);
+
+	const size_t shardCapacity;
+	std::array<Shard, SHARDS> shards;
+
+	// Evicted values not written yet, lookups check them before the backend. Locked after a shard.
+	std::mutex evictedMutex;
+	struct Evicted {
+		ValueWrapper value;
+		uint64_t sequence;
+	};
+	phmap::flat_hash_map<std::string, Evicted> evicted;
+	std::atomic_size_t evictedCount = 0;
+
+	// Store-wide, a key evicted and cached again never reuses the version a write-back is holding
+	std::atomic_uint64_t nextVersion = 0;
+
+	// One write-back at a time, so batches reach the backend in order
+	std::mutex writeBackMutex;
+
+	std::mutex writeBackThreadMutex;
+	std::condition_variable writeBackCondition;
+	std::thread writeBackThread;
+	bool writeBackStopping = false;
+
+	std::atomic_uint64_t hits = 0;
+	std::atomic_uint64_t misses = 0;
+	std::atomic_uint64_t evictions = 0;
+	std::atomic_uint64_t written = 0;
+	std::atomic<double> lastWriteBackMs = 0;
 };
 
 class ScopedKV final : public KV {
 public:
 	ScopedKV(Logger &logger, KVStore &rootKV, std::string prefix) :
-		logger(logger), rootKV_(rootKV), prefix_(std::move(prefix)) { }
+		ScopedKV(logger, rootKV, prefix + ".", KVKey::hashUpdate(KVKey::HASH_SEED, prefix + ".")) { }
 
 	void set(const std::string &key, const std::initializer_list<ValueWrapper> &init_list) override {
-		rootKV_.set(buildKey(key), init_list);
+		rootKV_.set(buildKey(key), ValueWrapper(init_list));
 	}
 	void set(const std::string &key, const std::initializer_list<std::pair<const std::string, ValueWrapper>> &init_list) override {
-		rootKV_.set(buildKey(key), init_list);
+		rootKV_.set(buildKey(key), ValueWrapper(init_list));
 	}
 	void set(const std::string &key, const ValueWrapper &value) override {
 		rootKV_.set(buildKey(key), value);
@@ -167,22 +326,29 @@ public:
 	}
 
 	std::shared_ptr<KV> scoped(const std::string &scope) override {
-		logger.trace("ScopedKV::scoped({})", buildKey(scope));
-		return std::make_shared<ScopedKV>(logger, rootKV_, buildKey(scope));
+		logger.trace("ScopedKV::scoped({}{})", prefix_, scope);
+		// Continues the hash of this prefix instead of hashing the nested one from the start
+		const auto nestedState = KVKey::hashUpdate(KVKey::hashUpdate(prefixState_, scope), ".");
+		return std::make_shared<ScopedKV>(logger, rootKV_, fmt::format("{}{}.", prefix_, scope), nestedState);
 	}
 
 	std::unordered_set<std::string> keys(const std::string &prefix = "") override {
-		return rootKV_.keys(buildKey(prefix));
+		return rootKV_.keys(prefix_ + prefix);
 	}
 
+	// Prefix including its trailing dot and the hash state after it, see scoped()
+	ScopedKV(Logger &logger, KVStore &rootKV, std::string prefix, uint64_t prefixState) :
+		logger(logger), rootKV_(rootKV), prefix_(std::move(prefix)), prefixState_(prefixState) { }
+
 private:
-	std::string buildKey(const std::string &key) const {
-		return fmt::format("{}.{}", prefix_, key);
+	KVKey buildKey(const std::string &key) const {
+		return { prefix_, prefixState_, key };
 	}
 
 	Logger &logger;
 	KVStore &rootKV_;
 	std::string prefix_;
+	uint64_t prefixState_;
 };
 
 constexpr auto g_kv = KVStore::getInstance;
@@ -10,6 +10,7 @@
 #include "kv/kv_sql.hpp"
 
 #include "database/database.hpp"
+#include "database/persistence_journal.hpp"
 #include "kv/value_wrapper_proto.hpp"
 #include "utils/tools.hpp"
 
@@ -19,8 +20,9 @@ KVSQL::KVSQL(Database &db, Logger &logger) :
 	KVStore(logger), db(db) { }
 
 std::optional<ValueWrapper> KVSQL::load(const std::string &key) {
-	const auto query = fmt::format("SELECT `key_name`, `timestamp`, `value` FROM `kv_store` WHERE `key_name` = {}", db.escapeString(key));
-	const auto result = db.storeQuery(query);
+	g_persistenceJournal().waitFlushed(JOURNAL_KEY);
+	DBStatement statement("SELECT `key_name`, `timestamp`, `value` FROM `kv_store` WHERE `key_name` = ?");
+	const auto result = statement.bind(key).store();
 	if (result == nullptr) {
 		return std::nullopt;
 	}
@@ -44,9 +46,9 @@ std::optional<ValueWrapper> KVSQL::load(const std::string &key) {
 
 std::vector<std::string> KVSQL::loadPrefix(const std::string &prefix /* = ""*/) {
 	std::vector<std::string> keys;
-	std::string keySearch = db.escapeString(prefix + "%");
-	const auto query = fmt::format("SELECT `key_name` FROM `kv_store` WHERE `key_name` LIKE {}", keySearch);
-	const auto result = db.storeQuery(query);
+	g_persistenceJournal().waitFlushed(JOURNAL_KEY);
+	DBStatement statement("SELECT `key_name` FROM `kv_store` WHERE `key_name` LIKE ?");
+	const auto result = statement.bind(prefix + "%").store();
 	if (result == nullptr) {
 		return keys;
 	}
@@ -61,9 +63,17 @@ std::vector<std::string> KVSQL::loadPrefix(const std::string &prefix /* = ""*/)
 }
 
 bool KVSQL::save(const std::string &key, const ValueWrapper &value) {
-	auto update = dbUpdate();
-	prepareSave(key, value, update);
-	return update.execute();
+	if (value.isDeleted()) {
+		return DBStatement("DELETE FROM `kv_store` WHERE `key_name` = ?").bind(key).execute();
+	}
+
+	std::string data;
+	if (!ProtoSerializable::toProto(value).SerializeToString(&data)) {
+		return false;
+	}
+
+	DBStatement statement("INSERT INTO `kv_store` (`key_name`, `timestamp`, `value`) VALUES (?, ?, ?) ON DUPLICATE KEY UPDATE `timestamp` = VALUES(`timestamp`), `value` = VALUES(`value`)");
+	return statement.bind(key).bind(value.getTimestamp()).bindBlob(data.data(), data.size()).execute();
 }
 
 bool KVSQL::prepareSave(const std::string &key, const ValueWrapper &value, DBInsert &update) const {
@@ -72,35 +82,42 @@ bool KVSQL::prepareSave(const std::string &key, const ValueWrapper &value, DBIns
 	if (!protoValue.SerializeToString(&data)) {
 		return false;
 	}
-	if (value.isDeleted()) {
-		const auto query = fmt::format("DELETE FROM `kv_store` WHERE `key_name` = {}", db.escapeString(key));
-		return db.executeQuery(query);
-	}
 
+	// Batched into one multi-row upsert, fewer round trips than executing a statement per key
 	update.addRow(fmt::format("{}, {}, {}", db.escapeString(key), value.getTimestamp(), db.escapeString(data)));
 	return true;
 }
 
-bool KVSQL::saveAll() {
-	auto store = getStore();
-	const bool success = DBTransaction::executeWithinTransaction([this, &store]() {
+bool KVSQL::saveBatch(const std::vector<std::pair<std::string, ValueWrapper>> &batch) {
+	const bool success = g_persistenceJournal().write(JOURNAL_KEY, [this, &batch]() {
 		auto update = dbUpdate();
-		if (!std::ranges::all_of(store, [this, &update](const auto &kv) {
-				const auto &[key, value] = kv;
-				return prepareSave(key, value.first, update);
-			})) {
+		std::string deleted;
+		for (const auto &[key, value] : batch) {
+			if (value.isDeleted()) {
+				deleted += fmt::format("{}{}", deleted.empty() ? "" : ", ", db.escapeString(key));
+			} else if (!prepareSave(key, value, update)) {
+				return false;
+			}
+		}
+
+		if (!deleted.empty() && !db.executeQuery(fmt::format("DELETE FROM `kv_store` WHERE `key_name` IN ({})", deleted))) {
 			return false;
 		}
 		return update.execute();
 	});
 
 	if (!success) {
-		g_logger().error("[{}] Error occurred saving player", __FUNCTION__);
+		g_logger().error("[{}] Error occurred saving key-value store", __FUNCTION__);
 	}
 
 	return success;
 }
 
+bool KVSQL::takeRejectedWrites() {
+	// The journal accepted the batches, its flusher failed to apply them
+	return g_persistenceJournal().takeRejected(JOURNAL_KEY);
+}
+
 DBInsert KVSQL::dbUpdate() {
 	auto insert = DBInsert("INSERT INTO `kv_store` (`key_name`, `timestamp`, `value`) VALUES");
 	insert.upsert({ "key_name", "timestamp", "value" });
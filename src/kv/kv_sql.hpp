@@ -20,15 +20,18 @@ class KVSQL final : public KVStore {
 public:
 	explicit KVSQL(Database &db, Logger &logger);
 
-	bool saveAll() override;
-
 private:
 	std::vector<std::string> loadPrefix(const std::string &prefix = "") override;
 	std::optional<ValueWrapper> load(const std::string &key) override;
 	bool save(const std::string &key, const ValueWrapper &value) override;
+	bool saveBatch(const std::vector<std::pair<std::string, ValueWrapper>> &batch) override;
+	bool takeRejectedWrites() override;
 	bool prepareSave(const std::string &key, const ValueWrapper &value, DBInsert &update) const;
 
 	DBInsert dbUpdate();
 
+	// Journal records of the store, its loads wait for them (see PersistenceJournal::waitFlushed)
+	static constexpr auto JOURNAL_KEY = "kv";
+
 	Database &db;
 };
@@ -0,0 +1,176 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "lib/thread/parallel_executor.hpp"
+
+#include "lib/thread/thread_pool.hpp"
+
+namespace {
+	// Chunks are sized to take about this long, so the clock and the
+	// atomics are amortized while leaving enough items to be stolen
+	constexpr uint64_t TARGET_CHUNK_NS = 50'000;
+	constexpr uint32_t MAX_CHUNK_SIZE = 1024;
+
+	// A slot range packs [begin, end) in a single word so it can be split with one CAS
+	constexpr uint64_t packRange(uint32_t begin, uint32_t end) {
+		return static_cast<uint64_t>(end) << 32 | begin;
+	}
+
+	constexpr uint32_t rangeBegin(uint64_t range) {
+		return static_cast<uint32_t>(range);
+	}
+
+	constexpr uint32_t rangeEnd(uint64_t range) {
+		return static_cast<uint32_t>(range >> 32);
+	}
+
+	constexpr uint32_t rangeSize(uint64_t range) {
+		return rangeEnd(range) > rangeBegin(range) ? rangeEnd(range) - rangeBegin(range) : 0;
+	}
+}
+
+struct ParallelExecutor::Job {
+	struct alignas(64) Slot {
+		std::atomic_uint64_t range = 0;
+	};
+
+	Job(size_t size, uint32_t slotCount, void* function, RangeInvoker invoker) :
+		slots(std::make_unique<Slot[]>(slotCount)), slotCount(slotCount), pending(size), function(function), invoker(invoker) {
+		const auto perSlot = size / slotCount;
+		const auto extra = size % slotCount;
+		uint32_t begin = 0;
+		for (uint32_t i = 0; i < slotCount; ++i) {
+			const auto end = static_cast<uint32_t>(begin + perSlot + (i < extra ? 1 : 0));
+			slots[i].range.store(packRange(begin, end), std::memory_order_relaxed);
+			begin = end;
+		}
+	}
+
+	std::unique_ptr<Slot[]> slots;
+	const uint32_t slotCount;
+	// Slot 0 belongs to the calling thread
+	std::atomic_uint32_t nextSlot = 1;
+	std::atomic_uint64_t pending;
+
+	void* const function;
+	const RangeInvoker invoker;
+
+	std::atomic_bool failed = false;
+	std::exception_ptr exception;
+};
+
+void ParallelExecutor::run(size_t size, void* function, RangeInvoker invoker) {
+	if (size == 0) {
+		return;
+	}
+
+	const auto threadCount = threadPool.get_thread_count();
+	if (size == 1 || threadCount <= 1 || size > std::numeric_limits<uint32_t>::max()) {
+		invoker(function, 0, size);
+		return;
+	}
+
+	jobs.fetch_add(1, std::memory_order_relaxed);
+
+	const auto slotCount = static_cast<uint32_t>(std::min<size_t>(size, threadCount));
+	const auto job = std::make_shared<Job>(size, slotCount, function, invoker);
+
+	// Helpers only hold the job: once every slot is drained they return without touching the function
+	for (uint32_t i = 1; i < slotCount; ++i) {
+		threadPool.detach_task([this, job] {
+			const auto slotId = job->nextSlot.fetch_add(1, std::memory_order_relaxed);
+			if (slotId < job->slotCount) {
+				participate(*job, slotId);
+			}
+		});
+	}
+
+	participate(*job, 0);
+
+	// Items still running on helpers
+	for (auto pending = job->pending.load(std::memory_order_acquire); pending != 0; pending = job->pending.load(std::memory_order_acquire)) {
+		job->pending.wait(pending, std::memory_order_acquire);
+	}
+
+	if (job->failed.load(std::memory_order_acquire)) {
+		std::rethrow_exception(job->exception);
+	}
+}
+
+void ParallelExecutor::participate(Job &job, uint32_t slotId) {
+	auto &own = job.slots[slotId].range;
+	uint64_t costPerItemNs = 0;
+	uint64_t executedChunks = 0;
+	uint64_t stolenRanges = 0;
+
+	while (true) {
+		// Take chunks from the front of the own slot
+		auto range = own.load(std::memory_order_acquire);
+		while (const auto available = rangeSize(range)) {
+			const auto maxChunk = costPerItemNs == 0 ? 1 : std::clamp<uint64_t>(TARGET_CHUNK_NS / costPerItemNs, 1, MAX_CHUNK_SIZE);
+			const auto chunk = static_cast<uint32_t>(std::clamp<uint64_t>(available / 4, 1, maxChunk));
+			const auto begin = rangeBegin(range);
+			if (!own.compare_exchange_weak(range, packRange(begin + chunk, rangeEnd(range)), std::memory_order_acq_rel)) {
+				continue;
+			}
+
+			const auto start = std::chrono::steady_clock::now();
+			try {
+				job.invoker(job.function, begin, begin + chunk);
+			} catch (...) {
+				if (!job.failed.exchange(true, std::memory_order_acq_rel)) {
+					job.exception = std::current_exception();
+				}
+			}
+
+			const auto elapsedNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+			const auto itemNs = std::max<uint64_t>(elapsedNs / chunk, 1);
+			costPerItemNs = costPerItemNs == 0 ? itemNs : (costPerItemNs * 3 + itemNs) / 4;
+			++executedChunks;
+
+			if (job.pending.fetch_sub(chunk, std::memory_order_acq_rel) == chunk) {
+				job.pending.notify_all();
+			}
+
+			range = own.load(std::memory_order_acquire);
+		}
+
+		// Own slot is empty: steal the back half of the busiest one
+		bool stolen = false;
+		while (!stolen) {
+			uint32_t victimId = slotId;
+			uint64_t victimRange = 0;
+			uint32_t victimSize = 0;
+			for (uint32_t offset = 1; offset < job.slotCount; ++offset) {
+				const auto id = (slotId + offset) % job.slotCount;
+				const auto candidate = job.slots[id].range.load(std::memory_order_acquire);
+				if (rangeSize(candidate) > victimSize) {
+					victimId = id;
+					victimRange = candidate;
+					victimSize = rangeSize(candidate);
+				}
+			}
+
+			if (victimSize == 0) {
+				steals.fetch_add(stolenRanges, std::memory_order_relaxed);
+				chunks.fetch_add(executedChunks, std::memory_order_relaxed);
+				return;
+			}
+
+			const auto take = (victimSize + 1) / 2;
+			const auto splitAt = rangeEnd(victimRange) - take;
+			if (job.slots[victimId].range.compare_exchange_strong(victimRange, packRange(rangeBegin(victimRange), splitAt), std::memory_order_acq_rel)) {
+				// Nobody steals from an empty slot, so it is safe to install the stolen range with a plain store
+				own.store(packRange(splitAt, splitAt + take), std::memory_order_release);
+				++stolenRanges;
+				stolen = true;
+			}
+		}
+	}
+}
@@ -0,0 +1,79 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+class ThreadPool;
+
+struct ParallelExecutorStats {
+	uint64_t jobs = 0;
+	uint64_t chunks = 0;
+	// Ranges taken from another participant once the own one was exhausted
+	uint64_t steals = 0;
+};
+
+/**
+ * Runs parallel loops on the thread pool with work stealing.
+ *
+ * The index range is split into one slot per participant (the calling thread
+ * plus pool helpers). Each participant takes chunks from the front of its own
+ * slot, sized from the measured cost of the previous items, and once it is
+ * empty it steals the back half of the busiest slot. A few expensive items no
+ * longer hold back the whole loop, and slots of helpers that did not start yet
+ * (pool busy) are drained by the others.
+ *
+ * The calling thread always takes part, so nested loops (a loop body calling
+ * parallelFor again) make progress even when every pool thread is busy.
+ */
+class ParallelExecutor {
+public:
+	explicit ParallelExecutor(ThreadPool &threadPool) :
+		threadPool(threadPool) { }
+
+	// Ensures that we don't accidentally copy it
+	ParallelExecutor(const ParallelExecutor &) = delete;
+	ParallelExecutor &operator=(const ParallelExecutor &) = delete;
+
+	/**
+	 * @brief Calls f(i) for every i in [0, size) and returns once all of them finished.
+	 * The first exception thrown by f is rethrown on the calling thread.
+	 */
+	template <typename F>
+	void parallelFor(size_t size, F &&f) {
+		using Fn = std::remove_reference_t<F>;
+		run(size, const_cast<void*>(static_cast<const void*>(std::addressof(f))), [](void* function, size_t begin, size_t end) {
+			auto &fn = *static_cast<Fn*>(function);
+			for (size_t i = begin; i < end; ++i) {
+				fn(i);
+			}
+		});
+	}
+
+	[[nodiscard]] ParallelExecutorStats getStats() const {
+		return {
+			jobs.load(std::memory_order_relaxed),
+			chunks.load(std::memory_order_relaxed),
+			steals.load(std::memory_order_relaxed),
+		};
+	}
+
+private:
+	using RangeInvoker = void (*)(void* function, size_t begin, size_t end);
+
+	struct Job;
+
+	void run(size_t size, void* function, RangeInvoker invoker);
+	void participate(Job &job, uint32_t slotId);
+
+	ThreadPool &threadPool;
+
+	std::atomic_uint64_t jobs = 0;
+	std::atomic_uint64_t chunks = 0;
+	std::atomic_uint64_t steals = 0;
+};
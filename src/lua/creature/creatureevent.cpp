@@ -517,7 +517,7 @@ void CreatureEvent::executeManaChange(const std::shared_ptr<Creature> &creature,
 	LuaScriptInterface::resetScriptEnv();
 }
 
-void CreatureEvent::executeExtendedOpcode(const std::shared_ptr<Player> &player, uint8_t opcode, const std::string &buffer) const {
+void CreatureEvent::executeExtendedOpcode(const std::shared_ptr<Player> &player, uint8_t opcode, std::string_view buffer) const {
 	// onExtendedOpcode(player, opcode, buffer)
 	if (!LuaScriptInterface::reserveScriptEnv()) {
 		g_logger().error("[CreatureEvent::executeExtendedOpcode - "
@@ -538,7 +538,7 @@ void CreatureEvent::executeExtendedOpcode(const std::shared_ptr<Player> &player,
 	LuaScriptInterface::setMetatable(L, -1, "Player");
 
 	lua_pushnumber(L, opcode);
-	LuaScriptInterface::pushString(L, buffer);
+	lua_pushlstring(L, buffer.data(), buffer.size());
 
 	getScriptInterface()->callVoidFunction(3);
 }
@@ -59,7 +59,7 @@ public:
 	bool executeTextEdit(const std::shared_ptr<Player> &player, const std::shared_ptr<Item> &item, const std::string &text) const;
 	void executeHealthChange(const std::shared_ptr<Creature> &creature, const std::shared_ptr<Creature> &attacker, CombatDamage &damage) const;
 	void executeManaChange(const std::shared_ptr<Creature> &creature, const std::shared_ptr<Creature> &attacker, CombatDamage &damage) const;
-	void executeExtendedOpcode(const std::shared_ptr<Player> &player, uint8_t opcode, const std::string &buffer) const;
+	void executeExtendedOpcode(const std::shared_ptr<Player> &player, uint8_t opcode, std::string_view buffer) const;
 
 	std::string getScriptTypeName() const;
 	LuaScriptInterface* getScriptInterface() const;
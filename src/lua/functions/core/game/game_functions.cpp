@@ -14,12 +14,15 @@
 #include "creatures/monsters/monsters.hpp"
 #include "creatures/npcs/npc.hpp"
 #include "creatures/players/player.hpp"
+#include "database/database.hpp"
+#include "database/persistence_journal.hpp"
 #include "game/functions/game_reload.hpp"
 #include "game/game.hpp"
 #include "game/scheduling/dispatcher.hpp"
 #include "io/io_bosstiary.hpp"
 #include "io/iobestiary.hpp"
 #include "items/item.hpp"
+#include "kv/kv.hpp"
 #include "lua/callbacks/event_callback.hpp"
 #include "lua/callbacks/events_callbacks.hpp"
 #include "lua/creature/events.hpp"
@@ -28,6 +31,9 @@
 #include "lua/functions/events/event_callback_functions.hpp"
 #include "lua/scripts/lua_environment.hpp"
 #include "map/spectators.hpp"
+#include "server/network/connection/connection.hpp"
+#include "server/network/protocol/compression_policy.hpp"
+#include "server/network/protocol/protocolgame.hpp"
 #include "lua/functions/lua_functions_loader.hpp"
 
 void GameFunctions::init(lua_State* L) {
@@ -112,6 +118,16 @@ void GameFunctions::init(lua_State* L) {
 
 	Lua::registerMethod(L, "Game", "getMonstersByRace", GameFunctions::luaGameGetMonstersByRace);
 	Lua::registerMethod(L, "Game", "getMonstersByBestiaryStars", GameFunctions::luaGameGetMonstersByBestiaryStars);
+
+	Lua::registerMethod(L, "Game", "getTaskProfile", GameFunctions::luaGameGetTaskProfile);
+	Lua::registerMethod(L, "Game", "resetTaskProfile", GameFunctions::luaGameResetTaskProfile);
+	Lua::registerMethod(L, "Game", "getSpectatorsCacheStats", GameFunctions::luaGameGetSpectatorsCacheStats);
+	Lua::registerMethod(L, "Game", "getNetworkStats", GameFunctions::luaGameGetNetworkStats);
+	Lua::registerMethod(L, "Game", "getCompressionStats", GameFunctions::luaGameGetCompressionStats);
+	Lua::registerMethod(L, "Game", "getStatusUpdateStats", GameFunctions::luaGameGetStatusUpdateStats);
+	Lua::registerMethod(L, "Game", "getDatabaseStats", GameFunctions::luaGameGetDatabaseStats);
+	Lua::registerMethod(L, "Game", "getPersistenceJournalStats", GameFunctions::luaGameGetPersistenceJournalStats);
+	Lua::registerMethod(L, "Game", "getKVStats", GameFunctions::luaGameGetKVStats);
 }
 
 // Game
@@ -1086,3 +1102,138 @@ int GameFunctions::luaGameGetMonstersByBestiaryStars(lua_State* L) {
 	}
 	return 1;
 }
+
+int GameFunctions::luaGameGetTaskProfile(lua_State* L) {
+	// Game.getTaskProfile([limit = 10])
+	const auto limit = Lua::getNumber<uint32_t>(L, 1, 10);
+	const auto profiles = g_dispatcher().profiler().getTopContexts(limit);
+
+	lua_createtable(L, profiles.size(), 0);
+	int index = 0;
+	for (const auto &profile : profiles) {
+		lua_createtable(L, 0, 6);
+		Lua::setField(L, "context", std::string(profile.context));
+		Lua::setField(L, "count", profile.count);
+		Lua::setField(L, "total", profile.totalNs / 1000000.0);
+		Lua::setField(L, "max", profile.maxNs / 1000000.0);
+		Lua::setField(L, "average", profile.totalNs / 1000000.0 / profile.count);
+
+		// histogram[1] counts the tasks under 1us, histogram[n] the ones in [2^(n-2), 2^(n-1)) us
+		lua_createtable(L, profile.histogram.size(), 0);
+		for (size_t bucket = 0; bucket < profile.histogram.size(); ++bucket) {
+			lua_pushnumber(L, profile.histogram[bucket]);
+			lua_rawseti(L, -2, bucket + 1);
+		}
+		lua_setfield(L, -2, "histogram");
+
+		lua_rawseti(L, -2, ++index);
+	}
+	return 1;
+}
+
+int GameFunctions::luaGameResetTaskProfile(lua_State* L) {
+	// Game.resetTaskProfile()
+	g_dispatcher().profiler().reset();
+	Lua::pushBoolean(L, true);
+	return 1;
+}
+
+int GameFunctions::luaGameGetSpectatorsCacheStats(lua_State* L) {
+	// Game.getSpectatorsCacheStats()
+	const auto stats = Spectators::getCacheStats();
+	lua_createtable(L, 0, 4);
+	Lua::setField(L, "hits", stats.hits);
+	Lua::setField(L, "misses", stats.misses);
+	Lua::setField(L, "invalidations", stats.invalidations);
+	Lua::setField(L, "positions", stats.cachedPositions);
+	return 1;
+}
+
+int GameFunctions::luaGameGetNetworkStats(lua_State* L) {
+	// Game.getNetworkStats()
+	const auto stats = ConnectionManager::getInstance().getStats();
+	lua_createtable(L, 0, 7);
+	Lua::setField(L, "writes", stats.writes);
+	Lua::setField(L, "messages", stats.messages);
+	Lua::setField(L, "bytes", stats.bytes);
+	Lua::setField(L, "congestions", stats.congestions);
+	Lua::setField(L, "coalescedUpdates", stats.coalescedUpdates);
+	Lua::setField(L, "slowDisconnects", stats.slowDisconnects);
+
+	// Samples up to 4, 16, 64, 256, 1024 KB and above
+	lua_createtable(L, static_cast<int>(stats.queueDepth.size()), 0);
+	int index = 0;
+	for (const auto samples : stats.queueDepth) {
+		lua_pushnumber(L, static_cast<lua_Number>(samples));
+		lua_rawseti(L, -2, ++index);
+	}
+	lua_setfield(L, -2, "queueDepth");
+	return 1;
+}
+
+int GameFunctions::luaGameGetCompressionStats(lua_State* L) {
+	// Game.getCompressionStats()
+	const auto stats = g_compressionPolicy().getStats();
+	lua_createtable(L, 0, 7);
+	Lua::setField(L, "messages", stats.messages);
+	Lua::setField(L, "compressed", stats.compressed);
+	Lua::setField(L, "skipped", stats.skipped);
+	Lua::setField(L, "bytesIn", stats.bytesIn);
+	Lua::setField(L, "bytesOut", stats.bytesOut);
+	Lua::setField(L, "cpuTime", stats.cpuTimeUs / 1000.0);
+	Lua::setField(L, "level", stats.level);
+	return 1;
+}
+
+int GameFunctions::luaGameGetStatusUpdateStats(lua_State* L) {
+	// Game.getStatusUpdateStats()
+	const auto stats = ProtocolGame::getStatusUpdateStats();
+	lua_createtable(L, 0, 4);
+	Lua::setField(L, "requested", stats.requested);
+	Lua::setField(L, "coalesced", stats.coalesced);
+	Lua::setField(L, "unchanged", stats.unchanged);
+	Lua::setField(L, "sent", stats.sent);
+	return 1;
+}
+
+int GameFunctions::luaGameGetDatabaseStats(lua_State* L) {
+	// Game.getDatabaseStats()
+	const auto stats = g_database().getStats();
+	lua_createtable(L, 0, 6);
+	Lua::setField(L, "queries", stats.queries);
+	Lua::setField(L, "waits", stats.waits);
+	Lua::setField(L, "waitTime", stats.waitTimeUs / 1000.0);
+	Lua::setField(L, "maxWaitTime", stats.maxWaitTimeUs / 1000.0);
+	Lua::setField(L, "inUse", stats.inUse);
+	Lua::setField(L, "poolSize", stats.poolSize);
+	return 1;
+}
+
+int GameFunctions::luaGameGetPersistenceJournalStats(lua_State* L) {
+	// Game.getPersistenceJournalStats()
+	const auto stats = g_persistenceJournal().getStats();
+	lua_createtable(L, 0, 7);
+	Lua::pushBoolean(L, g_persistenceJournal().isEnabled());
+	lua_setfield(L, -2, "enabled");
+	Lua::setField(L, "appended", stats.appended);
+	Lua::setField(L, "flushed", stats.flushed);
+	Lua::setField(L, "rejected", stats.rejected);
+	Lua::setField(L, "pending", stats.pending);
+	Lua::setField(L, "pendingBytes", stats.pendingBytes);
+	Lua::setField(L, "lastFlushTime", stats.lastFlushMs);
+	return 1;
+}
+
+int GameFunctions::luaGameGetKVStats(lua_State* L) {
+	// Game.getKVStats()
+	const auto stats = g_kv().getStats();
+	lua_createtable(L, 0, 7);
+	Lua::setField(L, "hits", stats.hits);
+	Lua::setField(L, "misses", stats.misses);
+	Lua::setField(L, "evictions", stats.evictions);
+	Lua::setField(L, "written", stats.written);
+	Lua::setField(L, "size", stats.size);
+	Lua::setField(L, "dirty", stats.dirty);
+	Lua::setField(L, "lastWriteBackTime", stats.lastWriteBackMs);
+	return 1;
+}
@@ -94,4 +94,14 @@ private:
 
 	static int luaGameGetMonstersByRace(lua_State* L);
 	static int luaGameGetMonstersByBestiaryStars(lua_State* L);
+
+	static int luaGameGetTaskProfile(lua_State* L);
+	static int luaGameResetTaskProfile(lua_State* L);
+	static int luaGameGetSpectatorsCacheStats(lua_State* L);
+	static int luaGameGetNetworkStats(lua_State* L);
+	static int luaGameGetCompressionStats(lua_State* L);
+	static int luaGameGetStatusUpdateStats(lua_State* L);
+	static int luaGameGetDatabaseStats(lua_State* L);
+	static int luaGameGetPersistenceJournalStats(lua_State* L);
+	static int luaGameGetKVStats(lua_State* L);
 };
@@ -10,6 +10,7 @@
 #include "map/house/house.hpp"
 
 #include "config/configmanager.hpp"
+#include "database/persistence_journal.hpp"
 #include "game/game.hpp"
 #include "game/scheduling/save_manager.hpp"
 #include "io/ioguild.hpp"
@@ -39,8 +40,10 @@ void House::setNewOwnerGuid(int32_t newOwnerGuid, bool serverStartup) {
 	std::ostringstream query;
 	query << "UPDATE `houses` SET `new_owner` = " << newOwnerGuid << " WHERE `id` = " << id;
 
-	Database &db = Database::getInstance();
-	db.executeQuery(query.str());
+	// Queued behind the house saves, a pending one rewrites the row
+	g_persistenceJournal().write(PersistenceJournal::HOUSES_KEY, [&query] {
+		return Database::getInstance().executeQuery(query.str());
+	});
 	if (!serverStartup) {
 		setNewOwnership();
 	}
@@ -92,11 +95,11 @@ bool House::tryTransferOwnership(const std::shared_ptr<Player> &player, bool ser
 
 void House::setOwner(uint32_t guid, bool updateDatabase /* = true*/, const std::shared_ptr<Player> &player /* = nullptr*/) {
 	if (updateDatabase && owner != guid) {
-		Database &db = Database::getInstance();
-
 		std::ostringstream query;
 		query << "UPDATE `houses` SET `owner` = " << guid << ", `new_owner` = -1, `paid` = 0, `bidder` = 0, `bidder_name` = '', `highest_bid` = 0, `internal_bid` = 0, `bid_end_date` = 0, `state` = " << (guid > 0 ? 2 : 0) << " WHERE `id` = " << id;
-		db.executeQuery(query.str());
+		g_persistenceJournal().write(PersistenceJournal::HOUSES_KEY, [&query] {
+			return Database::getInstance().executeQuery(query.str());
+		});
 	}
 
 	if (isLoaded && owner == guid) {
@@ -220,11 +220,14 @@ void Map::setTile(uint16_t x, uint16_t y, uint8_t z, const std::shared_ptr<Tile>
 		return;
 	}
 
-	if (const auto &sector = getMapSector(x, y)) {
-		sector->createFloor(z)->setTile(x, y, newTile);
-	} else {
-		getBestMapSector(x, y)->createFloor(z)->setTile(x, y, newTile);
+	auto* sector = getMapSector(x, y);
+	if (!sector) {
+		sector = getBestMapSector(x, y);
 	}
+
+	const auto &floor = sector->createFloor(z);
+	std::scoped_lock lock(floor->getMutex());
+	retireTile(floor->setTile(x, y, newTile));
 }
 
 bool Map::placeCreature(const Position &centerPos, const std::shared_ptr<Creature> &creature, bool extendedPos /* = false*/, bool forceLogin /* = false*/) {
@@ -321,7 +324,7 @@ bool Map::placeCreature(const Position &centerPos, const std::shared_ptr<Creatur
 		toCylinder->internalAddThing(creature);
 
 		const Position &dest = toCylinder->getPosition();
-		getMapSector(dest.x, dest.y)->addCreature(creature);
+		getMapSector(dest.x, dest.y)->addCreature(creature, dest);
 	}
 	return true;
 }
@@ -399,7 +402,9 @@ void Map::moveCreature(const std::shared_ptr<Creature> &creature, const std::sha
 	// Switch the node ownership
 	if (old_sector != new_sector) {
 		old_sector->removeCreature(creature);
-		new_sector->addCreature(creature);
+		new_sector->addCreature(creature, newPos);
+	} else {
+		new_sector->updateCreaturePosition(creature, newPos);
 	}
 
 	// add the creature
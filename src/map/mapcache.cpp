@@ -99,15 +99,20 @@ std::shared_ptr<Item> MapCache::createItem(const std::shared_ptr<BasicItem> &Bas
 	return item;
 }
 
-std::shared_ptr<Tile> MapCache::getOrCreateTileFromCache(const std::shared_ptr<Floor> &floor, uint16_t x, uint16_t y) {
+std::shared_ptr<Tile> MapCache::getOrCreateTileFromCache(Floor* floor, uint16_t x, uint16_t y) {
+	if (!floor->hasTileCache(x, y)) {
+		return floor->getTile(x, y);
+	}
+
+	std::unique_lock l(floor->getMutex());
+
+	// Another thread may have created it while we were waiting
 	const auto &cachedTile = floor->getTileCache(x, y);
 	const auto oldTile = floor->getTile(x, y);
 	if (!cachedTile) {
 		return oldTile;
 	}
 
-	std::unique_lock l(floor->getMutex());
-
 	const uint8_t z = floor->getZ();
 	const auto map = static_cast<Map*>(this);
 
@@ -159,7 +164,7 @@ std::shared_ptr<Tile> MapCache::getOrCreateTileFromCache(const std::shared_ptr<F
 		}
 	});
 
-	floor->setTile(x, y, tile);
+	retireTile(floor->setTile(x, y, tile));
 
 	// Remove Tile from cache
 	floor->setTileCache(x, y, nullptr);
@@ -174,11 +179,33 @@ void MapCache::setBasicTile(uint16_t x, uint16_t y, uint8_t z, const std::shared
 	}
 
 	const auto &tile = static_tryGetTileFromCache(newTile);
-	if (const auto sector = getMapSector(x, y)) {
-		sector->createFloor(z)->setTileCache(x, y, tile);
-	} else {
-		getBestMapSector(x, y)->createFloor(z)->setTileCache(x, y, tile);
+	auto* sector = getMapSector(x, y);
+	if (!sector) {
+		sector = getBestMapSector(x, y);
 	}
+
+	const auto &floor = sector->createFloor(z);
+	std::scoped_lock lock(floor->getMutex());
+	floor->setTileCache(x, y, tile);
+}
+
+void MapCache::retireTile(Floor::TilePointer tile) {
+	if (!tile) {
+		return;
+	}
+	std::scoped_lock lock(retiredTilesMutex);
+	retiredTiles.emplace_back(std::move(tile));
+}
+
+void MapCache::reclaimRetiredTiles() {
+	std::vector<Floor::TilePointer> expired;
+	{
+		std::scoped_lock lock(retiredTilesMutex);
+		expired.swap(expiringTiles);
+		expiringTiles.swap(retiredTiles);
+	}
+	// The last reference of a tile destroys its items, outside the lock
+	expired.clear();
 }
 
 std::shared_ptr<BasicItem> MapCache::tryReplaceItemFromCache(const std::shared_ptr<BasicItem> &ref) const {
@@ -186,21 +213,13 @@ std::shared_ptr<BasicItem> MapCache::tryReplaceItemFromCache(const std::shared_p
 }
 
 MapSector* MapCache::createMapSector(const uint32_t x, const uint32_t y) {
-	const uint32_t index = x / SECTOR_SIZE | y / SECTOR_SIZE << 16;
-	const auto it = mapSectors.find(index);
-	if (it != mapSectors.end()) {
-		return &it->second;
-	}
-
-	MapSector::newSector = true;
-	return &mapSectors[index];
+	return mapSectors.emplace(x, y).first;
 }
 
 MapSector* MapCache::getBestMapSector(uint32_t x, uint32_t y) {
-	MapSector::newSector = false;
-	const auto sector = createMapSector(x, y);
+	const auto [sector, created] = mapSectors.emplace(x, y);
 
-	if (MapSector::newSector) {
+	if (created) {
 		// update north sector
 		if (const auto northSector = getMapSector(x, y - SECTOR_SIZE)) {
 			northSector->sectorS = sector;
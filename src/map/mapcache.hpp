@@ -89,6 +89,15 @@ public:
 
 	void flush() const;
 
+	/**
+	 * @brief Frees the tiles retired before the previous call.
+	 *
+	 * Runs as a cycle event of the dispatcher (see Game::start), so a tile is freed
+	 * at least one interval after it was replaced, long after the readers that could
+	 * still hold its pointer copied it.
+	 */
+	void reclaimRetiredTiles();
+
 	/**
 	 * Creates a map sector.
 	 * \returns A pointer to that map sector.
@@ -101,21 +110,27 @@ public:
 	 * \returns A pointer to that map sector.
 	 */
 	MapSector* getMapSector(const uint32_t x, const uint32_t y) {
-		const auto it = mapSectors.find(x / SECTOR_SIZE | y / SECTOR_SIZE << 16);
-		return it != mapSectors.end() ? &it->second : nullptr;
+		return mapSectors.find(x, y);
 	}
 
 	const MapSector* getMapSector(const uint32_t x, const uint32_t y) const {
-		const auto it = mapSectors.find(x / SECTOR_SIZE | y / SECTOR_SIZE << 16);
-		return it != mapSectors.end() ? &it->second : nullptr;
+		return mapSectors.find(x, y);
 	}
 
 protected:
-	std::shared_ptr<Tile> getOrCreateTileFromCache(const std::shared_ptr<Floor> &floor, uint16_t x, uint16_t y);
+	std::shared_ptr<Tile> getOrCreateTileFromCache(Floor* floor, uint16_t x, uint16_t y);
 
-	std::unordered_map<uint32_t, MapSector> mapSectors;
+	// Keeps a tile replaced by Floor::setTile until reclaimRetiredTiles frees it
+	void retireTile(Floor::TilePointer tile);
+
+	MapSectorIndex mapSectors;
 
 private:
+	std::mutex retiredTilesMutex;
+	// Retired since the last reclaim, and before it
+	std::vector<Floor::TilePointer> retiredTiles;
+	std::vector<Floor::TilePointer> expiringTiles;
+
 	void parseItemAttr(const std::shared_ptr<BasicItem> &BasicItem, const std::shared_ptr<Item> &item) const;
 	std::shared_ptr<Item> createItem(const std::shared_ptr<BasicItem> &BasicItem, Position position);
 };
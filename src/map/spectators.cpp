@@ -13,9 +13,114 @@
 #include "game/game.hpp"
 
 phmap::flat_hash_map<Position, SpectatorsCache> Spectators::spectatorsCache;
+phmap::flat_hash_map<uint32_t, phmap::flat_hash_set<Position>> Spectators::spectatorsCacheSectors;
+SpectatorsCacheStats Spectators::cacheStats;
+
+namespace {
+	// Queries are only dropped when something moves in their range, this bounds the positions nobody walks around anymore
+	constexpr size_t MAX_CACHED_POSITIONS = 65536;
+
+	uint32_t getSectorKey(int32_t x, int32_t y) {
+		return x / SECTOR_SIZE | y / SECTOR_SIZE << 16;
+	}
+}
 
 void Spectators::clearCache() {
+	cacheStats.invalidations += spectatorsCache.size();
 	spectatorsCache.clear();
+	spectatorsCacheSectors.clear();
+}
+
+void Spectators::invalidateCache(const Position &pos) {
+	const auto sectorIt = spectatorsCacheSectors.find(getSectorKey(pos.x, pos.y));
+	if (sectorIt == spectatorsCacheSectors.end()) {
+		return;
+	}
+
+	std::vector<Position> invalidated;
+	for (const auto &centerPos : sectorIt->second) {
+		const auto it = spectatorsCache.find(centerPos);
+		if (it != spectatorsCache.end() && isInCacheRange(centerPos, it->second, pos)) {
+			invalidated.emplace_back(centerPos);
+		}
+	}
+
+	for (const auto &centerPos : invalidated) {
+		const auto it = spectatorsCache.find(centerPos);
+		forEachCacheSector(centerPos, it->second, [&centerPos](uint32_t sectorKey) {
+			const auto indexIt = spectatorsCacheSectors.find(sectorKey);
+			if (indexIt != spectatorsCacheSectors.end() && indexIt->second.erase(centerPos) > 0 && indexIt->second.empty()) {
+				spectatorsCacheSectors.erase(indexIt);
+			}
+		});
+		spectatorsCache.erase(it);
+	}
+
+	cacheStats.invalidations += invalidated.size();
+}
+
+SpectatorsCacheStats Spectators::getCacheStats() {
+	auto stats = cacheStats;
+	stats.cachedPositions = spectatorsCache.size();
+	return stats;
+}
+
+std::pair<uint8_t, uint8_t> Spectators::getFloorRange(const Position &centerPos, bool multifloor) {
+	uint8_t minRangeZ = centerPos.z;
+	uint8_t maxRangeZ = centerPos.z;
+
+	if (multifloor) {
+		if (centerPos.z > MAP_INIT_SURFACE_LAYER) {
+			minRangeZ = static_cast<uint8_t>(std::max<int8_t>(centerPos.z - MAP_LAYER_VIEW_LIMIT, 0u));
+			maxRangeZ = static_cast<uint8_t>(std::min<int8_t>(centerPos.z + MAP_LAYER_VIEW_LIMIT, MAP_MAX_LAYERS - 1));
+		} else if (centerPos.z == MAP_INIT_SURFACE_LAYER - 1) {
+			minRangeZ = 0;
+			maxRangeZ = (MAP_INIT_SURFACE_LAYER - 1) + MAP_LAYER_VIEW_LIMIT;
+		} else if (centerPos.z == MAP_INIT_SURFACE_LAYER) {
+			minRangeZ = 0;
+			maxRangeZ = MAP_INIT_SURFACE_LAYER + MAP_LAYER_VIEW_LIMIT;
+		} else {
+			minRangeZ = 0;
+			maxRangeZ = MAP_INIT_SURFACE_LAYER;
+		}
+	}
+
+	return { minRangeZ, maxRangeZ };
+}
+
+void Spectators::indexCache(const Position &centerPos, const SpectatorsCache &cache) {
+	forEachCacheSector(centerPos, cache, [&centerPos](uint32_t sectorKey) {
+		spectatorsCacheSectors[sectorKey].emplace(centerPos);
+	});
+}
+
+void Spectators::forEachCacheSector(const Position &centerPos, const SpectatorsCache &cache, const std::function<void(uint32_t)> &function) {
+	// The multifloor range is a superset of the single floor one, so it covers both lists of the entry
+	const auto [minRangeZ, maxRangeZ] = getFloorRange(centerPos, true);
+	const int32_t minoffset = centerPos.getZ() - maxRangeZ;
+	const int32_t maxoffset = centerPos.getZ() - minRangeZ;
+	const int32_t x1 = std::clamp<int32_t>(centerPos.x + cache.minRangeX + minoffset, 0, 0xFFFF);
+	const int32_t y1 = std::clamp<int32_t>(centerPos.y + cache.minRangeY + minoffset, 0, 0xFFFF);
+	const int32_t x2 = std::clamp<int32_t>(centerPos.x + cache.maxRangeX + maxoffset, 0, 0xFFFF);
+	const int32_t y2 = std::clamp<int32_t>(centerPos.y + cache.maxRangeY + maxoffset, 0, 0xFFFF);
+
+	for (int32_t ny = y1 - (y1 & SECTOR_MASK); ny <= y2; ny += SECTOR_SIZE) {
+		for (int32_t nx = x1 - (x1 & SECTOR_MASK); nx <= x2; nx += SECTOR_SIZE) {
+			function(getSectorKey(nx, ny));
+		}
+	}
+}
+
+bool Spectators::isInCacheRange(const Position &centerPos, const SpectatorsCache &cache, const Position &pos) {
+	const auto [minRangeZ, maxRangeZ] = getFloorRange(centerPos, true);
+	if (pos.z < minRangeZ || pos.z > maxRangeZ) {
+		return false;
+	}
+
+	// Same test as getSpectators: a creature on another floor is seen shifted by one tile per floor
+	const int32_t offsetX = pos.x + pos.z - centerPos.z - centerPos.x;
+	const int32_t offsetY = pos.y + pos.z - centerPos.z - centerPos.y;
+	return offsetX >= cache.minRangeX && offsetX <= cache.maxRangeX && offsetY >= cache.minRangeY && offsetY <= cache.maxRangeY;
 }
 
 Spectators Spectators::insert(const std::shared_ptr<Creature> &creature) {
@@ -79,24 +184,7 @@ bool Spectators::checkCache(const SpectatorsCache::FloorData &specData, bool onl
 }
 
 CreatureVector Spectators::getSpectators(const Position &centerPos, bool multifloor, bool onlyPlayers, bool onlyMonsters, bool onlyNpcs, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY) {
-	uint8_t minRangeZ = centerPos.z;
-	uint8_t maxRangeZ = centerPos.z;
-
-	if (multifloor) {
-		if (centerPos.z > MAP_INIT_SURFACE_LAYER) {
-			minRangeZ = static_cast<uint8_t>(std::max<int8_t>(centerPos.z - MAP_LAYER_VIEW_LIMIT, 0u));
-			maxRangeZ = static_cast<uint8_t>(std::min<int8_t>(centerPos.z + MAP_LAYER_VIEW_LIMIT, MAP_MAX_LAYERS - 1));
-		} else if (centerPos.z == MAP_INIT_SURFACE_LAYER - 1) {
-			minRangeZ = 0;
-			maxRangeZ = (MAP_INIT_SURFACE_LAYER - 1) + MAP_LAYER_VIEW_LIMIT;
-		} else if (centerPos.z == MAP_INIT_SURFACE_LAYER) {
-			minRangeZ = 0;
-			maxRangeZ = MAP_INIT_SURFACE_LAYER + MAP_LAYER_VIEW_LIMIT;
-		} else {
-			minRangeZ = 0;
-			maxRangeZ = MAP_INIT_SURFACE_LAYER;
-		}
-	}
+	const auto [minRangeZ, maxRangeZ] = getFloorRange(centerPos, multifloor);
 
 	const int32_t min_y = centerPos.y + minRangeY;
 	const int32_t min_x = centerPos.x + minRangeX;
@@ -120,6 +208,16 @@ CreatureVector Spectators::getSpectators(const Position &centerPos, bool multifl
 	const int32_t endx2 = x2 - (x2 & SECTOR_MASK);
 	const int32_t endy2 = y2 - (y2 & SECTOR_MASK);
 
+	// A creature on another floor is seen shifted by one tile per floor: x - (centerPos.z - z) - min_x <= width
+	const SectorCreatureList::Area area {
+		minRangeZ,
+		static_cast<uint16_t>(depth),
+		static_cast<uint16_t>(centerPos.z + min_x),
+		static_cast<uint16_t>(width),
+		static_cast<uint16_t>(centerPos.z + min_y),
+		static_cast<uint16_t>(height),
+	};
+
 	CreatureVector spectators;
 	spectators.reserve(std::max<uint8_t>(MAP_MAX_VIEW_PORT_X, MAP_MAX_VIEW_PORT_Y) * 2);
 
@@ -134,15 +232,7 @@ CreatureVector Spectators::getSpectators(const Position &centerPos, bool multifl
 					: onlyNpcs                     ? sectorE->npc_list
 												   : sectorE->creature_list;
 
-				for (const auto &creature : nodeList) {
-					const auto &cpos = creature->getPosition();
-					if (static_cast<uint32_t>(static_cast<int32_t>(cpos.z) - minRangeZ) <= depth) {
-						const int_fast16_t offsetZ = Position::getOffsetZ(centerPos, cpos);
-						if (static_cast<uint32_t>(cpos.x - offsetZ - min_x) <= width && static_cast<uint32_t>(cpos.y - offsetZ - min_y) <= height) {
-							spectators.emplace_back(creature);
-						}
-					}
-				}
+				nodeList.collect(area, spectators);
 				sectorE = sectorE->sectorE;
 			} else {
 				sectorE = g_game().map.getMapSector(nx + SECTOR_SIZE, ny);
@@ -180,6 +270,11 @@ Spectators Spectators::find(const Position &centerPos, bool multifloor, bool onl
 			cache.minRangeY = minRangeY = std::min<int32_t>(minRangeY, cache.minRangeY);
 			cache.maxRangeX = maxRangeX = std::max<int32_t>(maxRangeX, cache.maxRangeX);
 			cache.maxRangeY = maxRangeY = std::max<int32_t>(maxRangeY, cache.maxRangeY);
+			// The other lists were collected with the old range, now that entries outlive moves they would stay incomplete
+			cache.creatures = {};
+			cache.monsters = {};
+			cache.npcs = {};
+			cache.players = {};
 		} else {
 			const bool checkDistance = minRangeX != cache.minRangeX || maxRangeX != cache.maxRangeX || minRangeY != cache.minRangeY || maxRangeY != cache.maxRangeY;
 
@@ -193,22 +288,30 @@ Spectators Spectators::find(const Position &centerPos, bool multifloor, bool onl
 
 				// check players/monsters/npcs cache
 				if (checkCache(creaturesCache, onlyPlayers, onlyMonsters, onlyNpcs, centerPos, checkDistance, multifloor, minRangeX, maxRangeX, minRangeY, maxRangeY)) {
+					++cacheStats.hits;
 					return *this;
 				}
 
 				// if there is no players/monsters/npcs cache, look for players/monsters/npcs in the creatures cache.
 				if (checkCache(cache.creatures, onlyPlayers, onlyMonsters, onlyNpcs, centerPos, true, multifloor, minRangeX, maxRangeX, minRangeY, maxRangeY)) {
+					++cacheStats.hits;
 					return *this;
 				}
 				// All Creatures
 			} else if (checkCache(cache.creatures, false, false, false, centerPos, checkDistance, multifloor, minRangeX, maxRangeX, minRangeY, maxRangeY)) {
+				++cacheStats.hits;
 				return *this;
 			}
 		}
 	}
 
+	++cacheStats.misses;
 	const auto &spectators = getSpectators(centerPos, multifloor, onlyPlayers, onlyMonsters, onlyNpcs, minRangeX, maxRangeX, minRangeY, maxRangeY);
 
+	if (!cacheFound && spectatorsCache.size() >= MAX_CACHED_POSITIONS) {
+		clearCache();
+	}
+
 	// It is necessary to create the cache even if no spectators is found, so that there is no future query.
 	auto &cache = cacheFound ? it->second : spectatorsCache.emplace(centerPos, SpectatorsCache { .minRangeX = minRangeX, .maxRangeX = maxRangeX, .minRangeY = minRangeY, .maxRangeY = maxRangeY, .creatures = {}, .monsters = {}, .npcs = {}, .players = {} }).first->second;
 	auto &creaturesCache = onlyPlayers ? cache.players
@@ -228,6 +331,9 @@ Spectators Spectators::find(const Position &centerPos, bool multifloor, bool onl
 		creatureList->insert(creatureList->end(), spectators.begin(), spectators.end());
 	}
 
+	// Also after a recache with a wider range, the entry may now overlap more sectors
+	indexCache(centerPos, cache);
+
 	return *this;
 }
 
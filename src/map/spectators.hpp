@@ -35,10 +35,26 @@ struct SpectatorsCache {
 	FloorData players;
 };
 
+struct SpectatorsCacheStats {
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	// Cached queries dropped because a creature entered or left their range
+	uint64_t invalidations = 0;
+	uint64_t cachedPositions = 0;
+};
+
 class Spectators {
 public:
 	static void clearCache();
 
+	/**
+	 * @brief Drops only the cached queries whose range covers the given position.
+	 * Must be called whenever a creature is added to or removed from that position.
+	 */
+	static void invalidateCache(const Position &pos);
+
+	static SpectatorsCacheStats getCacheStats();
+
 	template <typename T>
 		requires std::is_base_of_v<Creature, T>
 	Spectators find(const Position &centerPos, bool multifloor = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0, bool useCache = true) {
@@ -96,6 +112,14 @@ public:
 
 private:
 	static phmap::flat_hash_map<Position, SpectatorsCache> spectatorsCache;
+	// Cached center positions by the sectors their range overlaps
+	static phmap::flat_hash_map<uint32_t, phmap::flat_hash_set<Position>> spectatorsCacheSectors;
+	static SpectatorsCacheStats cacheStats;
+
+	static std::pair<uint8_t, uint8_t> getFloorRange(const Position &centerPos, bool multifloor);
+	static void indexCache(const Position &centerPos, const SpectatorsCache &cache);
+	static void forEachCacheSector(const Position &centerPos, const SpectatorsCache &cache, const std::function<void(uint32_t)> &function);
+	static bool isInCacheRange(const Position &centerPos, const SpectatorsCache &cache, const Position &pos);
 
 	Spectators find(const Position &centerPos, bool multifloor = false, bool onlyPlayers = false, bool onlyMonsters = false, bool onlyNpcs = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0, bool useCache = true);
 	CreatureVector getSpectators(const Position &centerPos, bool multifloor = false, bool onlyPlayers = false, bool onlyMonsters = false, bool onlyNpcs = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0);
@@ -11,59 +11,208 @@
 
 #include "creatures/creature.hpp"
 
-bool MapSector::newSector = false;
+Floor::~Floor() {
+	for (auto &row : tiles) {
+		for (auto &slot : row) {
+			delete slot.tile.load(std::memory_order_relaxed);
+		}
+	}
+}
 
-void MapSector::addCreature(const std::shared_ptr<Creature> &c) {
-	creature_list.emplace_back(c);
+Floor::TilePointer Floor::setTile(uint16_t x, uint16_t y, std::shared_ptr<Tile> tile) {
+	const auto* newTile = tile ? new std::shared_ptr<Tile>(std::move(tile)) : nullptr;
+	return TilePointer(getSlot(x, y).tile.exchange(newTile, std::memory_order_acq_rel));
+}
+
+void MapSector::addCreature(const std::shared_ptr<Creature> &c, const Position &pos) {
+	creature_list.add(c, pos);
 	if (c->getPlayer()) {
-		player_list.emplace_back(c);
+		player_list.add(c, pos);
 	} else if (c->getMonster()) {
-		monster_list.emplace_back(c);
+		monster_list.add(c, pos);
 	} else if (c->getNpc()) {
-		npc_list.emplace_back(c);
+		npc_list.add(c, pos);
 	}
 }
 
 void MapSector::removeCreature(const std::shared_ptr<Creature> &c) {
-	auto iter = std::ranges::find(creature_list, c);
-	if (iter == creature_list.end()) {
+	if (!creature_list.remove(c)) {
 		g_logger().error("[{}]: Creature not found in creature_list!", __FUNCTION__);
 		return;
 	}
 
-	assert(iter != creature_list.end());
-	*iter = creature_list.back();
-	creature_list.pop_back();
-
 	if (c->getPlayer()) {
-		iter = std::ranges::find(player_list, c);
-		if (iter == player_list.end()) {
+		if (!player_list.remove(c)) {
 			g_logger().error("[{}]: Player not found in player_list!", __FUNCTION__);
-			return;
 		}
-
-		assert(iter != player_list.end());
-		*iter = player_list.back();
-		player_list.pop_back();
 	} else if (c->getMonster()) {
-		iter = std::ranges::find(monster_list, c);
-		if (iter == monster_list.end()) {
-			g_logger().error("[{}]: Monster not found in player_list!", __FUNCTION__);
-			return;
+		if (!monster_list.remove(c)) {
+			g_logger().error("[{}]: Monster not found in monster_list!", __FUNCTION__);
 		}
+	} else if (c->getNpc()) {
+		if (!npc_list.remove(c)) {
+			g_logger().error("[{}]: NPC not found in npc_list!", __FUNCTION__);
+		}
+	}
+}
 
-		assert(iter != monster_list.end());
-		*iter = monster_list.back();
-		monster_list.pop_back();
+void MapSector::updateCreaturePosition(const std::shared_ptr<Creature> &c, const Position &pos) {
+	creature_list.updatePosition(c, pos);
+	if (c->getPlayer()) {
+		player_list.updatePosition(c, pos);
+	} else if (c->getMonster()) {
+		monster_list.updatePosition(c, pos);
 	} else if (c->getNpc()) {
-		iter = std::ranges::find(npc_list, c);
-		if (iter == npc_list.end()) {
-			g_logger().error("[{}]: NPC not found in player_list!", __FUNCTION__);
-			return;
+		npc_list.updatePosition(c, pos);
+	}
+}
+
+void SectorCreatureList::add(const std::shared_ptr<Creature> &creature, const Position &position) {
+	creatures.emplace_back(creature);
+	xs.emplace_back(position.x);
+	ys.emplace_back(position.y);
+	zs.emplace_back(position.z);
+}
+
+size_t SectorCreatureList::indexOf(const std::shared_ptr<Creature> &creature) const {
+	return static_cast<size_t>(std::ranges::find(creatures, creature) - creatures.begin());
+}
+
+bool SectorCreatureList::remove(const std::shared_ptr<Creature> &creature) {
+	const auto index = indexOf(creature);
+	if (index == creatures.size()) {
+		return false;
+	}
+
+	// Swap with the last one, order does not matter
+	creatures[index] = std::move(creatures.back());
+	xs[index] = xs.back();
+	ys[index] = ys.back();
+	zs[index] = zs.back();
+
+	creatures.pop_back();
+	xs.pop_back();
+	ys.pop_back();
+	zs.pop_back();
+	return true;
+}
+
+void SectorCreatureList::updatePosition(const std::shared_ptr<Creature> &creature, const Position &position) {
+	const auto index = indexOf(creature);
+	if (index == creatures.size()) {
+		return;
+	}
+
+	xs[index] = position.x;
+	ys[index] = position.y;
+	zs[index] = position.z;
+}
+
+void SectorCreatureList::collect(const Area &area, std::vector<std::shared_ptr<Creature>> &spectators) const {
+	const size_t count = creatures.size();
+	size_t i = 0;
+
+	// Each 16-bit lane that passes the three range tests sets two bits of the byte mask
+#if defined(__AVX2__)
+	{
+		const __m256i minZ = _mm256_set1_epi16(static_cast<int16_t>(area.minZ));
+		const __m256i depth = _mm256_set1_epi16(static_cast<int16_t>(area.depth));
+		const __m256i offsetX = _mm256_set1_epi16(static_cast<int16_t>(area.offsetX));
+		const __m256i width = _mm256_set1_epi16(static_cast<int16_t>(area.width));
+		const __m256i offsetY = _mm256_set1_epi16(static_cast<int16_t>(area.offsetY));
+		const __m256i height = _mm256_set1_epi16(static_cast<int16_t>(area.height));
+		const __m256i zero = _mm256_setzero_si256();
+
+		for (; i + 16 <= count; i += 16) {
+			const __m256i z = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&zs[i]));
+			const __m256i x = _mm256_add_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&xs[i])), z);
+			const __m256i y = _mm256_add_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&ys[i])), z);
+
+			// Unsigned a <= b is a saturated a - b being zero
+			const __m256i inZ = _mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_sub_epi16(z, minZ), depth), zero);
+			const __m256i inX = _mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_sub_epi16(x, offsetX), width), zero);
+			const __m256i inY = _mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_sub_epi16(y, offsetY), height), zero);
+
+			auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(inZ, _mm256_and_si256(inX, inY))));
+			while (mask != 0) {
+				const auto bit = mm_ctz(mask);
+				spectators.emplace_back(creatures[i + bit / 2]);
+				mask &= ~(3u << bit);
+			}
 		}
+	}
+#endif
+#if defined(__SSE2__)
+	{
+		const __m128i minZ = _mm_set1_epi16(static_cast<int16_t>(area.minZ));
+		const __m128i depth = _mm_set1_epi16(static_cast<int16_t>(area.depth));
+		const __m128i offsetX = _mm_set1_epi16(static_cast<int16_t>(area.offsetX));
+		const __m128i width = _mm_set1_epi16(static_cast<int16_t>(area.width));
+		const __m128i offsetY = _mm_set1_epi16(static_cast<int16_t>(area.offsetY));
+		const __m128i height = _mm_set1_epi16(static_cast<int16_t>(area.height));
+		const __m128i zero = _mm_setzero_si128();
+
+		for (; i + 8 <= count; i += 8) {
+			const __m128i z = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&zs[i]));
+			const __m128i x = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&xs[i])), z);
+			const __m128i y = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&ys[i])), z);
 
-		assert(iter != npc_list.end());
-		*iter = npc_list.back();
-		npc_list.pop_back();
+			const __m128i inZ = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(z, minZ), depth), zero);
+			const __m128i inX = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(x, offsetX), width), zero);
+			const __m128i inY = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(y, offsetY), height), zero);
+
+			auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(inZ, _mm_and_si128(inX, inY))));
+			while (mask != 0) {
+				const auto bit = mm_ctz(mask);
+				spectators.emplace_back(creatures[i + bit / 2]);
+				mask &= ~(3u << bit);
+			}
+		}
+	}
+#endif
+
+	for (; i < count; ++i) {
+		const uint16_t z = zs[i];
+		if (static_cast<uint16_t>(z - area.minZ) <= area.depth
+		    && static_cast<uint16_t>(xs[i] + z - area.offsetX) <= area.width
+		    && static_cast<uint16_t>(ys[i] + z - area.offsetY) <= area.height) {
+			spectators.emplace_back(creatures[i]);
+		}
 	}
 }
+
+MapSectorIndex::~MapSectorIndex() {
+	for (auto &page : pages) {
+		delete page.load(std::memory_order_relaxed);
+	}
+}
+
+std::pair<MapSector*, bool> MapSectorIndex::emplace(uint32_t x, uint32_t y) {
+	if (x > MAX_COORDINATE || y > MAX_COORDINATE) {
+		g_logger().error("Attempt to create map sector on invalid coordinate: {}, {}", x, y);
+		return { nullptr, false };
+	}
+
+	std::scoped_lock lock(mutex);
+	auto &pageSlot = pages[getPageIndex(x, y)];
+	auto* page = pageSlot.load(std::memory_order_relaxed);
+	if (!page) {
+		page = new Page();
+		pageSlot.store(page, std::memory_order_release);
+	}
+
+	auto &sectorSlot = page->sectors[getSlotIndex(x, y)];
+	if (auto* sector = sectorSlot.load(std::memory_order_relaxed)) {
+		return { sector, false };
+	}
+
+	if (chunkUsed == SECTORS_PER_CHUNK) {
+		chunks.emplace_back(std::make_unique<MapSector[]>(SECTORS_PER_CHUNK));
+		chunkUsed = 0;
+	}
+
+	auto* sector = &chunks.back()[chunkUsed++];
+	sectorSlot.store(sector, std::memory_order_release);
+	sectorCount.fetch_add(1, std::memory_order_relaxed);
+	return { sector, true };
+}
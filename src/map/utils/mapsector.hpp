@@ -9,37 +9,126 @@
 
 #pragma once
 
+#include "game/movement/position.hpp"
 #include "map/map_const.hpp"
 
 class Creature;
 class Tile;
 struct BasicTile;
 
+/**
+ * Creatures of a sector along with their positions stored as separate arrays,
+ * so spectator queries test positions over contiguous memory (eight or sixteen
+ * at a time with SSE2/AVX2) and only touch the creatures that are in range.
+ */
+class SectorCreatureList {
+public:
+	/**
+	 * Query box in wrapping uint16 arithmetic: a creature at (x, y, z) is inside when
+	 * (z - minZ) <= depth, (x + z - offsetX) <= width and (y + z - offsetY) <= height.
+	 * Adding z shifts the box by one tile per floor, as the client shows other floors.
+	 */
+	struct Area {
+		uint16_t minZ = 0;
+		uint16_t depth = 0;
+		uint16_t offsetX = 0;
+		uint16_t width = 0;
+		uint16_t offsetY = 0;
+		uint16_t height = 0;
+	};
+
+	void add(const std::shared_ptr<Creature> &creature, const Position &position);
+	bool remove(const std::shared_ptr<Creature> &creature);
+	void updatePosition(const std::shared_ptr<Creature> &creature, const Position &position);
+
+	/**
+	 * @brief Appends the creatures inside the area to the given vector.
+	 */
+	void collect(const Area &area, std::vector<std::shared_ptr<Creature>> &spectators) const;
+
+	[[nodiscard]] size_t size() const {
+		return creatures.size();
+	}
+
+	[[nodiscard]] bool empty() const {
+		return creatures.empty();
+	}
+
+	[[nodiscard]] auto begin() const {
+		return creatures.begin();
+	}
+
+	[[nodiscard]] auto end() const {
+		return creatures.end();
+	}
+
+private:
+	size_t indexOf(const std::shared_ptr<Creature> &creature) const;
+
+	std::vector<std::shared_ptr<Creature>> creatures;
+	std::vector<uint16_t> xs;
+	std::vector<uint16_t> ys;
+	std::vector<uint16_t> zs;
+};
+
+/**
+ * Tiles of one floor of a sector.
+ *
+ * Reads never lock: every slot publishes its tile through an atomic pointer to
+ * an immutable shared_ptr, which readers copy. Writers serialize on getMutex()
+ * and a replaced pointer is handed back to be retired (see MapCache::retireTile),
+ * since a reader may still be copying it. A slot tile is written once in the
+ * common case (the map loads into the tile cache and the tile is created on
+ * first access), so retiring almost never happens.
+ */
 struct Floor {
+	using TilePointer = std::unique_ptr<const std::shared_ptr<Tile>>;
+
 	explicit Floor(uint8_t z) :
 		z(z) { }
 
+	~Floor();
+
+	// Ensures that we don't accidentally copy it
+	Floor(const Floor &) = delete;
+	Floor &operator=(const Floor &) = delete;
+
 	std::shared_ptr<Tile> getTile(uint16_t x, uint16_t y) const {
-		std::shared_lock<std::shared_mutex> sl(mutex);
-		return tiles[x & SECTOR_MASK][y & SECTOR_MASK].first;
+		const auto* tile = getSlot(x, y).tile.load(std::memory_order_acquire);
+		return tile ? *tile : nullptr;
 	}
 
-	void setTile(uint16_t x, uint16_t y, std::shared_ptr<Tile> tile) {
-		tiles[x & SECTOR_MASK][y & SECTOR_MASK].first = std::move(tile);
+	/**
+	 * @brief Publishes the tile of a slot. Callers must hold getMutex().
+	 * @return The replaced tile, readers may still be copying it until it is retired.
+	 */
+	[[nodiscard]] TilePointer setTile(uint16_t x, uint16_t y, std::shared_ptr<Tile> tile);
+
+	bool hasTileCache(uint16_t x, uint16_t y) const {
+		return getSlot(x, y).hasCache.load(std::memory_order_acquire);
 	}
 
+	// Callers must hold getMutex(), hasTileCache is the lock-free check
 	std::shared_ptr<BasicTile> getTileCache(uint16_t x, uint16_t y) const {
-		std::shared_lock<std::shared_mutex> sl(mutex);
-		return tiles[x & SECTOR_MASK][y & SECTOR_MASK].second;
+		const auto &slot = getSlot(x, y);
+		return slot.hasCache.load(std::memory_order_acquire) ? slot.cache : nullptr;
 	}
 
+	/**
+	 * @brief Sets the tile loaded from the map file, or clears it once the tile is created.
+	 * Callers must hold getMutex(). Clearing releases the cache, once MapCache::flush
+	 * emptied the load caches the slot holds the last reference to it.
+	 */
 	void setTileCache(uint16_t x, uint16_t y, const std::shared_ptr<BasicTile> &newTile) {
-		tiles[x & SECTOR_MASK][y & SECTOR_MASK].second = newTile;
-	}
-
-	const auto &getTiles() const {
-		std::shared_lock<std::shared_mutex> sl(mutex);
-		return tiles;
+		auto &slot = getSlot(x, y);
+		if (newTile) {
+			slot.cache = newTile;
+			slot.hasCache.store(true, std::memory_order_release);
+			return;
+		}
+		// The tile created from the cache is published before the cache is cleared
+		slot.hasCache.store(false, std::memory_order_release);
+		slot.cache.reset();
 	}
 
 	uint8_t getZ() const {
@@ -51,9 +140,23 @@ struct Floor {
 	}
 
 private:
-	std::pair<std::shared_ptr<Tile>, std::shared_ptr<BasicTile>> tiles[SECTOR_SIZE][SECTOR_SIZE] = {};
+	struct TileSlot {
+		std::atomic<const std::shared_ptr<Tile>*> tile = nullptr;
+		std::atomic_bool hasCache = false;
+		std::shared_ptr<BasicTile> cache;
+	};
+
+	TileSlot &getSlot(uint16_t x, uint16_t y) {
+		return tiles[x & SECTOR_MASK][y & SECTOR_MASK];
+	}
+
+	const TileSlot &getSlot(uint16_t x, uint16_t y) const {
+		return tiles[x & SECTOR_MASK][y & SECTOR_MASK];
+	}
 
-	mutable std::shared_mutex mutex;
+	TileSlot tiles[SECTOR_SIZE][SECTOR_SIZE];
+
+	mutable std::mutex mutex;
 
 	uint8_t z { 0 };
 };
@@ -67,48 +170,121 @@ public:
 	MapSector(const MapSector &&) = delete;
 	MapSector &operator=(const MapSector &&) = delete;
 
-	std::shared_ptr<Floor> createFloor(uint32_t z) {
+	Floor* createFloor(uint32_t z) {
 		if (z >= MAP_MAX_LAYERS) {
 			g_logger().error("Attempt to create floor on invalid coordinate: {}", z);
 			return nullptr;
 		}
+
+		if (auto* floor = floors[z].load(std::memory_order_acquire)) {
+			return floor;
+		}
+
 		std::scoped_lock lock(floors_mutex);
-		if (!floors[z]) {
-			floors[z] = std::make_shared<Floor>(static_cast<uint8_t>(z));
+		if (!floorStorage[z]) {
+			floorStorage[z] = std::make_unique<Floor>(static_cast<uint8_t>(z));
+			floors[z].store(floorStorage[z].get(), std::memory_order_release);
 		}
-		return floors[z];
+		return floorStorage[z].get();
 	}
 
-	std::shared_ptr<Floor> getFloor(uint8_t z) {
+	Floor* getFloor(uint8_t z) const {
 		if (z >= MAP_MAX_LAYERS) {
 			g_logger().error("Attempt to get floor on invalid coordinate: {}", z);
 			return nullptr;
 		}
-		std::scoped_lock lock(floors_mutex);
-		return floors[z];
+		return floors[z].load(std::memory_order_acquire);
 	}
 
-	void addCreature(const std::shared_ptr<Creature> &c);
+	void addCreature(const std::shared_ptr<Creature> &c, const Position &pos);
 
 	void removeCreature(const std::shared_ptr<Creature> &c);
 
-private:
-	static bool newSector;
+	// Called when the creature moves inside the same sector
+	void updateCreaturePosition(const std::shared_ptr<Creature> &c, const Position &pos);
 
+private:
 	MapSector* sectorS = nullptr;
 	MapSector* sectorE = nullptr;
 
-	std::vector<std::shared_ptr<Creature>> creature_list;
-	std::vector<std::shared_ptr<Creature>> player_list;
-	std::vector<std::shared_ptr<Creature>> monster_list;
-	std::vector<std::shared_ptr<Creature>> npc_list;
+	SectorCreatureList creature_list;
+	SectorCreatureList player_list;
+	SectorCreatureList monster_list;
+	SectorCreatureList npc_list;
 
+	// Floors are created once and live as long as the sector, so readers only need the published pointer
 	mutable std::mutex floors_mutex;
-
-	std::shared_ptr<Floor> floors[MAP_MAX_LAYERS] = {};
+	std::unique_ptr<Floor> floorStorage[MAP_MAX_LAYERS];
+	std::atomic<Floor*> floors[MAP_MAX_LAYERS] = {};
 
 	uint32_t floorBits = 0;
 
 	friend class Spectators;
 	friend class MapCache;
 };
+
+/**
+ * Map sectors indexed by a two-level page table: the sector coordinates select
+ * a page of 64x64 sectors and a slot inside it, so a lookup is a couple of
+ * shifts and two loads instead of hashing. Pages are only allocated where the
+ * map has sectors. Sectors are allocated in chunks and never move, so the
+ * sectorS/sectorE links stay valid.
+ *
+ * Lookups never lock and are safe while sectors are being created.
+ */
+class MapSectorIndex {
+public:
+	MapSectorIndex() = default;
+	~MapSectorIndex();
+
+	// Ensures that we don't accidentally copy it
+	MapSectorIndex(const MapSectorIndex &) = delete;
+	MapSectorIndex &operator=(const MapSectorIndex &) = delete;
+
+	MapSector* find(uint32_t x, uint32_t y) const {
+		if (x > MAX_COORDINATE || y > MAX_COORDINATE) {
+			return nullptr;
+		}
+
+		const auto* page = pages[getPageIndex(x, y)].load(std::memory_order_acquire);
+		return page ? page->sectors[getSlotIndex(x, y)].load(std::memory_order_acquire) : nullptr;
+	}
+
+	/**
+	 * @brief Gets the sector of the given tile coordinates, creating it if needed.
+	 * @return The sector, and whether it was created by this call.
+	 */
+	std::pair<MapSector*, bool> emplace(uint32_t x, uint32_t y);
+
+	size_t size() const {
+		return sectorCount.load(std::memory_order_relaxed);
+	}
+
+private:
+	static constexpr uint32_t MAX_COORDINATE = std::numeric_limits<uint16_t>::max();
+	static constexpr uint32_t PAGE_BITS = 6;
+	static constexpr uint32_t PAGE_SIZE = 1 << PAGE_BITS;
+	static constexpr uint32_t PAGE_MASK = PAGE_SIZE - 1;
+	static constexpr uint32_t SECTORS_PER_AXIS = (MAX_COORDINATE + 1) / SECTOR_SIZE;
+	static constexpr uint32_t PAGES_PER_AXIS = SECTORS_PER_AXIS / PAGE_SIZE;
+	static constexpr size_t SECTORS_PER_CHUNK = 256;
+
+	struct Page {
+		std::array<std::atomic<MapSector*>, PAGE_SIZE * PAGE_SIZE> sectors {};
+	};
+
+	static uint32_t getPageIndex(uint32_t x, uint32_t y) {
+		return (y / SECTOR_SIZE >> PAGE_BITS) * PAGES_PER_AXIS + (x / SECTOR_SIZE >> PAGE_BITS);
+	}
+
+	static uint32_t getSlotIndex(uint32_t x, uint32_t y) {
+		return (y / SECTOR_SIZE & PAGE_MASK) << PAGE_BITS | (x / SECTOR_SIZE & PAGE_MASK);
+	}
+
+	std::array<std::atomic<Page*>, PAGES_PER_AXIS * PAGES_PER_AXIS> pages {};
+
+	std::mutex mutex;
+	std::vector<std::unique_ptr<MapSector[]>> chunks;
+	size_t chunkUsed = SECTORS_PER_CHUNK;
+	std::atomic_size_t sectorCount = 0;
+};
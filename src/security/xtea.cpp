@@ -0,0 +1,269 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "security/xtea.hpp"
+
+#if defined(__SSE2__) && defined(__GNUC__) && !defined(__AVX2__)
+	// The AVX2 intrinsics are only declared by default when building for AVX2
+	#include <immintrin.h>
+#endif
+
+#if !defined(__DISABLE_VECTORIZATION__) && (defined(__NEON__) || defined(__ARM_NEON))
+	#include <arm_neon.h>
+	#define XTEA_NEON 1
+#endif
+
+#if defined(__SSE2__) && (defined(__AVX2__) || defined(__GNUC__))
+	#define XTEA_AVX2 1
+#endif
+
+namespace xtea {
+	namespace {
+		constexpr uint32_t delta = 0x61C88647;
+
+		uint32_t load32(const uint8_t* data) {
+			uint32_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		void store32(uint8_t* data, uint32_t value) {
+			std::memcpy(data, &value, sizeof(value));
+		}
+
+		template <bool Encrypt>
+		void transformScalar(uint8_t* data, size_t length, const round_keys_t &keys) {
+			for (size_t pos = 0; pos + 8 <= length; pos += 8) {
+				uint32_t v0 = load32(data + pos);
+				uint32_t v1 = load32(data + pos + 4);
+				if constexpr (Encrypt) {
+					for (size_t i = 0; i < 32; ++i) {
+						v0 += ((v1 << 4 ^ v1 >> 5) + v1) ^ keys[i * 2];
+						v1 += ((v0 << 4 ^ v0 >> 5) + v0) ^ keys[i * 2 + 1];
+					}
+				} else {
+					for (size_t i = 0; i < 32; ++i) {
+						v1 -= ((v0 << 4 ^ v0 >> 5) + v0) ^ keys[i * 2];
+						v0 -= ((v1 << 4 ^ v1 >> 5) + v1) ^ keys[i * 2 + 1];
+					}
+				}
+				store32(data + pos, v0);
+				store32(data + pos + 4, v1);
+			}
+		}
+
+#if defined(__SSE2__)
+		// Swaps the middle words: [v0 v1 v0' v1'] <-> [v0 v0' v1 v1']
+		constexpr int SHUFFLE_DEINTERLEAVE = _MM_SHUFFLE(3, 1, 2, 0);
+
+		inline __m128i mixSSE2(__m128i v) {
+			return _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v, 4), _mm_srli_epi32(v, 5)), v);
+		}
+
+		// 4 blocks per iteration, returns the processed length
+		template <bool Encrypt>
+		size_t transformSSE2(uint8_t* data, size_t length, const round_keys_t &keys) {
+			size_t pos = 0;
+			for (; pos + 32 <= length; pos += 32) {
+				const auto a = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos)), SHUFFLE_DEINTERLEAVE);
+				const auto b = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 16)), SHUFFLE_DEINTERLEAVE);
+				auto v0 = _mm_unpacklo_epi64(a, b);
+				auto v1 = _mm_unpackhi_epi64(a, b);
+				if constexpr (Encrypt) {
+					for (size_t i = 0; i < 32; ++i) {
+						v0 = _mm_add_epi32(v0, _mm_xor_si128(mixSSE2(v1), _mm_set1_epi32(static_cast<int>(keys[i * 2]))));
+						v1 = _mm_add_epi32(v1, _mm_xor_si128(mixSSE2(v0), _mm_set1_epi32(static_cast<int>(keys[i * 2 + 1]))));
+					}
+				} else {
+					for (size_t i = 0; i < 32; ++i) {
+						v1 = _mm_sub_epi32(v1, _mm_xor_si128(mixSSE2(v0), _mm_set1_epi32(static_cast<int>(keys[i * 2]))));
+						v0 = _mm_sub_epi32(v0, _mm_xor_si128(mixSSE2(v1), _mm_set1_epi32(static_cast<int>(keys[i * 2 + 1]))));
+					}
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(data + pos), _mm_shuffle_epi32(_mm_unpacklo_epi64(v0, v1), SHUFFLE_DEINTERLEAVE));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(data + pos + 16), _mm_shuffle_epi32(_mm_unpackhi_epi64(v0, v1), SHUFFLE_DEINTERLEAVE));
+			}
+			return pos;
+		}
+#endif
+
+#if defined(XTEA_AVX2)
+		SIMD_TARGET_AVX2 inline __m256i mixAVX2(__m256i v) {
+			return _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v, 4), _mm256_srli_epi32(v, 5)), v);
+		}
+
+		// 8 blocks per iteration, same layout as SSE2 within each 128 bit lane
+		template <bool Encrypt>
+		SIMD_TARGET_AVX2 size_t transformAVX2(uint8_t* data, size_t length, const round_keys_t &keys) {
+			size_t pos = 0;
+			for (; pos + 64 <= length; pos += 64) {
+				const auto a = _mm256_shuffle_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos)), SHUFFLE_DEINTERLEAVE);
+				const auto b = _mm256_shuffle_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + 32)), SHUFFLE_DEINTERLEAVE);
+				auto v0 = _mm256_unpacklo_epi64(a, b);
+				auto v1 = _mm256_unpackhi_epi64(a, b);
+				if constexpr (Encrypt) {
+					for (size_t i = 0; i < 32; ++i) {
+						v0 = _mm256_add_epi32(v0, _mm256_xor_si256(mixAVX2(v1), _mm256_set1_epi32(static_cast<int>(keys[i * 2]))));
+						v1 = _mm256_add_epi32(v1, _mm256_xor_si256(mixAVX2(v0), _mm256_set1_epi32(static_cast<int>(keys[i * 2 + 1]))));
+					}
+				} else {
+					for (size_t i = 0; i < 32; ++i) {
+						v1 = _mm256_sub_epi32(v1, _mm256_xor_si256(mixAVX2(v0), _mm256_set1_epi32(static_cast<int>(keys[i * 2]))));
+						v0 = _mm256_sub_epi32(v0, _mm256_xor_si256(mixAVX2(v1), _mm256_set1_epi32(static_cast<int>(keys[i * 2 + 1]))));
+					}
+				}
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(data + pos), _mm256_shuffle_epi32(_mm256_unpacklo_epi64(v0, v1), SHUFFLE_DEINTERLEAVE));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(data + pos + 32), _mm256_shuffle_epi32(_mm256_unpackhi_epi64(v0, v1), SHUFFLE_DEINTERLEAVE));
+			}
+			return pos;
+		}
+#endif
+
+#if defined(XTEA_NEON)
+		inline uint32x4_t mixNEON(uint32x4_t v) {
+			return vaddq_u32(veorq_u32(vshlq_n_u32(v, 4), vshrq_n_u32(v, 5)), v);
+		}
+
+		// 4 blocks per iteration, vld2 splits the v0 and v1 words by itself
+		template <bool Encrypt>
+		size_t transformNEON(uint8_t* data, size_t length, const round_keys_t &keys) {
+			size_t pos = 0;
+			for (; pos + 32 <= length; pos += 32) {
+				auto v = vld2q_u32(reinterpret_cast<const uint32_t*>(data + pos));
+				if constexpr (Encrypt) {
+					for (size_t i = 0; i < 32; ++i) {
+						v.val[0] = vaddq_u32(v.val[0], veorq_u32(mixNEON(v.val[1]), vdupq_n_u32(keys[i * 2])));
+						v.val[1] = vaddq_u32(v.val[1], veorq_u32(mixNEON(v.val[0]), vdupq_n_u32(keys[i * 2 + 1])));
+					}
+				} else {
+					for (size_t i = 0; i < 32; ++i) {
+						v.val[1] = vsubq_u32(v.val[1], veorq_u32(mixNEON(v.val[0]), vdupq_n_u32(keys[i * 2])));
+						v.val[0] = vsubq_u32(v.val[0], veorq_u32(mixNEON(v.val[1]), vdupq_n_u32(keys[i * 2 + 1])));
+					}
+				}
+				vst2q_u32(reinterpret_cast<uint32_t*>(data + pos), v);
+			}
+			return pos;
+		}
+#endif
+
+		template <bool Encrypt>
+		void transform(Engine engine, uint8_t* data, size_t length, const round_keys_t &keys) {
+			size_t done = 0;
+			switch (engine) {
+#if defined(XTEA_AVX2)
+				case Engine::AVX2:
+					done = transformAVX2<Encrypt>(data, length, keys);
+					// The remaining 1-7 blocks still get the 4 lanes path
+					done += transformSSE2<Encrypt>(data + done, length - done, keys);
+					break;
+#endif
+#if defined(__SSE2__)
+				case Engine::SSE2:
+					done = transformSSE2<Encrypt>(data, length, keys);
+					break;
+#endif
+#if defined(XTEA_NEON)
+				case Engine::NEON:
+					done = transformNEON<Encrypt>(data, length, keys);
+					break;
+#endif
+				default:
+					break;
+			}
+			transformScalar<Encrypt>(data + done, length - done, keys);
+		}
+
+		Engine selectedEngine() {
+			static const Engine engine = getBestEngine();
+			return engine;
+		}
+	}
+
+	round_keys_t expandEncryptKey(const key_t &key) {
+		round_keys_t keys;
+		uint32_t sum = 0;
+		for (size_t i = 0; i < 32; ++i) {
+			keys[i * 2] = sum + key[sum & 3];
+			sum -= delta;
+			keys[i * 2 + 1] = sum + key[(sum >> 11) & 3];
+		}
+		return keys;
+	}
+
+	round_keys_t expandDecryptKey(const key_t &key) {
+		round_keys_t keys;
+		uint32_t sum = 0xC6EF3720;
+		for (size_t i = 0; i < 32; ++i) {
+			keys[i * 2] = sum + key[(sum >> 11) & 3];
+			sum += delta;
+			keys[i * 2 + 1] = sum + key[sum & 3];
+		}
+		return keys;
+	}
+
+	void encrypt(uint8_t* data, size_t length, const round_keys_t &keys) {
+		transform<true>(selectedEngine(), data, length, keys);
+	}
+
+	void decrypt(uint8_t* data, size_t length, const round_keys_t &keys) {
+		transform<false>(selectedEngine(), data, length, keys);
+	}
+
+	void encrypt(Engine engine, uint8_t* data, size_t length, const round_keys_t &keys) {
+		transform<true>(isSupported(engine) ? engine : Engine::Scalar, data, length, keys);
+	}
+
+	void decrypt(Engine engine, uint8_t* data, size_t length, const round_keys_t &keys) {
+		transform<false>(isSupported(engine) ? engine : Engine::Scalar, data, length, keys);
+	}
+
+	bool isSupported(Engine engine) {
+		switch (engine) {
+			case Engine::Scalar:
+				return true;
+#if defined(__SSE2__)
+			case Engine::SSE2:
+				return true;
+#endif
+#if defined(XTEA_AVX2)
+			case Engine::AVX2:
+				return simd::hasAVX2();
+#endif
+#if defined(XTEA_NEON)
+			case Engine::NEON:
+				return true;
+#endif
+			default:
+				return false;
+		}
+	}
+
+	Engine getBestEngine() {
+		for (const auto engine : { Engine::AVX2, Engine::SSE2, Engine::NEON }) {
+			if (isSupported(engine)) {
+				return engine;
+			}
+		}
+		return Engine::Scalar;
+	}
+
+	std::string_view getEngineName(Engine engine) {
+		switch (engine) {
+			case Engine::SSE2:
+				return "SSE2";
+			case Engine::AVX2:
+				return "AVX2";
+			case Engine::NEON:
+				return "NEON";
+			default:
+				return "scalar";
+		}
+	}
+}
@@ -0,0 +1,42 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+// XTEA in the client's variant (32 cycles, little endian blocks).
+// Blocks are independent (ECB), so several of them are transformed at once
+// in SIMD lanes: 8 with AVX2, 4 with SSE2 or NEON, the tail in scalar code.
+// The AVX2 engine is picked at runtime, since the release builds target plain x86-64.
+namespace xtea {
+	using key_t = std::array<uint32_t, 4>;
+	// Key schedule: the key words already added to the round sums, two per cycle
+	using round_keys_t = std::array<uint32_t, 64>;
+
+	enum class Engine : uint8_t {
+		Scalar,
+		SSE2,
+		AVX2,
+		NEON,
+	};
+
+	round_keys_t expandEncryptKey(const key_t &key);
+	round_keys_t expandDecryptKey(const key_t &key);
+
+	// The length must be a multiple of 8, the data is transformed in place
+	void encrypt(uint8_t* data, size_t length, const round_keys_t &keys);
+	void decrypt(uint8_t* data, size_t length, const round_keys_t &keys);
+
+	// Same as above with an explicit engine, for tests and benchmarks
+	void encrypt(Engine engine, uint8_t* data, size_t length, const round_keys_t &keys);
+	void decrypt(Engine engine, uint8_t* data, size_t length, const round_keys_t &keys);
+
+	bool isSupported(Engine engine);
+	Engine getBestEngine();
+	std::string_view getEngineName(Engine engine);
+}
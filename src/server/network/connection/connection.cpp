@@ -14,11 +14,17 @@
 #include "server/network/message/outputmessage.hpp"
 #include "server/network/protocol/protocol.hpp"
 #include "game/scheduling/dispatcher.hpp"
+#include "server/network/connection/packet_recorder.hpp"
 #include "server/network/message/networkmessage.hpp"
 #include "server/network/protocol/protocolgame.hpp"
 #include "server/server.hpp"
 #include "utils/tools.hpp"
 
+// Asio sends at most 64 buffers per writev call
+constexpr size_t MAX_MESSAGES_PER_WRITE = 64;
+// Upper bounds of the queue depth buckets, the last one takes everything above
+constexpr std::array<size_t, 5> QUEUE_DEPTH_BUCKETS = { 4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024 };
+
 ConnectionManager &ConnectionManager::getInstance() {
 	return inject<ConnectionManager>();
 }
@@ -51,11 +57,68 @@ void ConnectionManager::closeAll() {
 	connections.clear();
 }
 
+ConnectionStats ConnectionManager::getStats() const {
+	ConnectionStats stats {
+		writes.load(std::memory_order_relaxed),
+		writtenMessages.load(std::memory_order_relaxed),
+		writtenBytes.load(std::memory_order_relaxed),
+	};
+
+	for (size_t i = 0; i < queueDepth.size(); ++i) {
+		stats.queueDepth[i] = queueDepth[i].load(std::memory_order_relaxed);
+	}
+	stats.congestions = congestions.load(std::memory_order_relaxed);
+	stats.coalescedUpdates = coalescedUpdates.load(std::memory_order_relaxed);
+	stats.slowDisconnects = slowDisconnects.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void ConnectionManager::addQueueSample(size_t queuedBytes) {
+	const auto bucket = std::ranges::lower_bound(QUEUE_DEPTH_BUCKETS, queuedBytes) - QUEUE_DEPTH_BUCKETS.begin();
+	queueDepth[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void ConnectionManager::reloadSendQueueLimits() {
+	const auto kilobytes = [](ConfigKey_t key) {
+		return static_cast<size_t>(std::max(g_configManager().getNumber(key), 0)) * 1024;
+	};
+
+	setSendQueueLimits({
+		kilobytes(SEND_QUEUE_HIGH_WATERMARK),
+		kilobytes(SEND_QUEUE_LOW_WATERMARK),
+		kilobytes(SEND_QUEUE_MAX_SIZE),
+		std::chrono::seconds(std::max(g_configManager().getNumber(SEND_QUEUE_SLOW_TIMEOUT), 0)),
+	});
+}
+
+void ConnectionManager::setSendQueueLimits(const SendQueueLimits &limits) {
+	highWatermark.store(limits.highWatermark, std::memory_order_relaxed);
+	// Congestion has to end before the queue is empty again, or it never would on a busy connection
+	lowWatermark.store(std::min(limits.lowWatermark, limits.highWatermark), std::memory_order_relaxed);
+	maxQueueSize.store(limits.maxSize, std::memory_order_relaxed);
+	slowTimeoutMs.store(limits.slowTimeout.count(), std::memory_order_relaxed);
+	sendQueueLimitsLoaded.store(true, std::memory_order_release);
+}
+
+SendQueueLimits ConnectionManager::getSendQueueLimits() {
+	if (!sendQueueLimitsLoaded.load(std::memory_order_acquire)) {
+		reloadSendQueueLimits();
+	}
+
+	return {
+		highWatermark.load(std::memory_order_relaxed),
+		lowWatermark.load(std::memory_order_relaxed),
+		maxQueueSize.load(std::memory_order_relaxed),
+		std::chrono::milliseconds(slowTimeoutMs.load(std::memory_order_relaxed)),
+	};
+}
+
 Connection::Connection(asio::io_service &initIoService, ConstServicePort_ptr initservicePort) :
-	readTimer(initIoService),
-	writeTimer(initIoService),
+	strand(asio::make_strand(initIoService)),
+	readTimer(strand),
+	writeTimer(strand),
 	service_port(std::move(initservicePort)),
-	socket(initIoService), m_msg() {
+	socket(strand), m_msg() {
 }
 
 void Connection::close(bool force) {
@@ -69,11 +132,15 @@ void Connection::close(bool force) {
 	}
 	connectionState = CONNECTION_STATE_CLOSED;
 
+	if (recordSession != 0) {
+		g_packetRecorder().record(recordSession, nullptr, 0);
+	}
+
 	if (protocol) {
 		g_dispatcher().addEvent([protocol = protocol] { protocol->release(); }, __FUNCTION__, std::chrono::milliseconds(CONNECTION_WRITE_TIMEOUT * 1000).count());
 	}
 
-	if (messageQueue.empty() || force) {
+	if ((messageQueue.empty() && writeBatch.empty()) || force) {
 		closeSocket();
 	}
 }
@@ -300,6 +367,18 @@ void Connection::parsePacket(const std::error_code &error) {
 	}
 }
 
+void Connection::recordPacket(const uint8_t* data, size_t size) {
+	if (!g_packetRecorder().isRecording() || size == 0) {
+		return;
+	}
+
+	// Called from parsePacket, under the connection lock
+	if (recordSession == 0) {
+		recordSession = g_packetRecorder().newSession();
+	}
+	g_packetRecorder().record(recordSession, data, size);
+}
+
 void Connection::resumeWork() {
 	readTimer.expires_from_now(std::chrono::seconds(CONNECTION_READ_TIMEOUT));
 	readTimer.async_wait([self = std::weak_ptr<Connection>(shared_from_this())](const std::error_code &error) { Connection::handleTimeout(self, error); });
@@ -318,9 +397,15 @@ void Connection::send(const OutputMessage_ptr &outputMessage) {
 		return;
 	}
 
-	bool noPendingWrite = messageQueue.empty();
+	bool noPendingWrite = messageQueue.empty() && writeBatch.empty();
+	queuedBytes += outputMessage->getLength();
 	messageQueue.emplace_back(outputMessage);
 
+	if (!checkSendQueue()) {
+		close(FORCE_CLOSE);
+		return;
+	}
+
 	if (noPendingWrite) {
 		if (socket.is_open()) {
 			try {
@@ -336,6 +421,36 @@ void Connection::send(const OutputMessage_ptr &outputMessage) {
 	}
 }
 
+bool Connection::checkSendQueue() {
+	auto &manager = ConnectionManager::getInstance();
+	manager.addQueueSample(queuedBytes);
+
+	const auto limits = manager.getSendQueueLimits();
+	const auto now = std::chrono::steady_clock::now();
+	if (!isCongested()) {
+		if (limits.highWatermark == 0 || queuedBytes <= limits.highWatermark) {
+			return true;
+		}
+		congested.store(true, std::memory_order_relaxed);
+		congestedSince = now;
+		manager.addCongestion();
+	}
+
+	const bool overSize = limits.maxSize > 0 && queuedBytes > limits.maxSize;
+	const bool tooSlow = limits.slowTimeout.count() > 0 && now - congestedSince > limits.slowTimeout;
+	if (!overSize && !tooSlow) {
+		return true;
+	}
+
+	g_logger().warn("[Connection::checkSendQueue] - Disconnecting slow client {}, {} KB waiting to be sent for {} ms", convertIPToString(getIP()), queuedBytes / 1024, std::chrono::duration_cast<std::chrono::milliseconds>(now - congestedSince).count());
+	manager.addSlowDisconnect();
+
+	// Nothing queued is worth sending anymore, only the write in progress has to complete
+	messageQueue.clear();
+	queuedBytes = writeBatchBytes;
+	return false;
+}
+
 void Connection::internalWorker() {
 	std::unique_lock lock(connectionLock);
 	if (messageQueue.empty()) {
@@ -345,12 +460,7 @@ void Connection::internalWorker() {
 		return;
 	}
 
-	const auto &outputMessage = messageQueue.front();
-	lock.unlock();
-	protocol->onSendMessage(outputMessage);
-	lock.lock();
-
-	internalSend(outputMessage);
+	internalSend(lock);
 }
 
 uint32_t Connection::getIP() {
@@ -369,37 +479,70 @@ uint32_t Connection::getIP() {
 	return ip;
 }
 
-void Connection::internalSend(const OutputMessage_ptr &outputMessage) {
+void Connection::internalSend(std::unique_lock<std::recursive_mutex> &lock) {
+	// Everything queued while the previous write was in flight goes out in one gather write
+	while (!messageQueue.empty() && writeBatch.size() < MAX_MESSAGES_PER_WRITE) {
+		writeBatchBytes += messageQueue.front()->getLength();
+		writeBatch.emplace_back(std::move(messageQueue.front()));
+		messageQueue.pop_front();
+	}
+	lock.unlock();
+
+	finalizeBatch();
+	internalWrite();
+}
+
+void Connection::finalizeBatch() {
+	// Compression and encryption run on the strand of the connection, outside the lock, so the
+	// network threads finalize different connections in parallel. Only one batch is in flight
+	// per connection, which keeps its messages and sequence numbers in order.
+	for (const auto &outputMessage : writeBatch) {
+		protocol->onSendMessage(outputMessage);
+	}
+}
+
+void Connection::internalWrite() {
+	std::scoped_lock lock(connectionLock);
+	writeBuffers.clear();
+	for (const auto &outputMessage : writeBatch) {
+		writeBuffers.emplace_back(outputMessage->getOutputBuffer(), outputMessage->getLength());
+	}
+
 	writeTimer.expires_from_now(std::chrono::seconds(CONNECTION_WRITE_TIMEOUT));
 	writeTimer.async_wait([self = std::weak_ptr<Connection>(shared_from_this())](const std::error_code &error) { Connection::handleTimeout(self, error); });
 
 	try {
-		asio::async_write(socket, asio::buffer(outputMessage->getOutputBuffer(), outputMessage->getLength()), [self = shared_from_this()](const std::error_code &error, std::size_t N) { self->onWriteOperation(error); });
+		asio::async_write(socket, writeBuffers, [self = shared_from_this()](const std::error_code &error, std::size_t bytesTransferred) { self->onWriteOperation(error, bytesTransferred); });
 	} catch (const std::system_error &e) {
-		g_logger().error("[Connection::internalSend] - Exception in async_write: {}", e.what());
+		g_logger().error("[Connection::internalWrite] - Exception in async_write: {}", e.what());
 		close(FORCE_CLOSE);
 	}
 }
 
-void Connection::onWriteOperation(const std::error_code &error) {
+void Connection::onWriteOperation(const std::error_code &error, size_t bytesTransferred) {
 	std::unique_lock lock(connectionLock);
 	writeTimer.cancel();
 
 	if (error) {
 		g_logger().error("[Connection::onWriteOperation] - Write error: {}", error.message());
+		writeBatch.clear();
 		messageQueue.clear();
+		queuedBytes = writeBatchBytes = 0;
 		close(FORCE_CLOSE);
 		return;
 	}
 
-	messageQueue.pop_front();
+	ConnectionManager::getInstance().addWrite(writeBatch.size(), bytesTransferred);
+	writeBatch.clear();
+	queuedBytes -= writeBatchBytes;
+	writeBatchBytes = 0;
+
+	if (isCongested() && queuedBytes <= ConnectionManager::getInstance().getSendQueueLimits().lowWatermark) {
+		congested.store(false, std::memory_order_relaxed);
+	}
 
 	if (!messageQueue.empty()) {
-		const auto &outputMessage = messageQueue.front();
-		lock.unlock();
-		protocol->onSendMessage(outputMessage);
-		lock.lock();
-		internalSend(outputMessage);
+		internalSend(lock);
 	} else if (connectionState == CONNECTION_STATE_CLOSED) {
 		closeSocket();
 	}
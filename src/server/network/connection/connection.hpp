@@ -12,6 +12,7 @@
 #include "declarations.hpp"
 // TODO: Remove circular includes (maybe shared_ptr?)
 #include "server/network/message/networkmessage.hpp"
+#include "utils/ringbuffer.hpp"
 
 static constexpr int32_t CONNECTION_WRITE_TIMEOUT = 30;
 static constexpr int32_t CONNECTION_READ_TIMEOUT = 30;
@@ -32,6 +33,30 @@ using ServicePort_ptr = std::shared_ptr<ServicePort>;
 using ConstServicePort_ptr = std::shared_ptr<const ServicePort>;
 class NetworkMessage;
 
+struct ConnectionStats {
+	// async_write calls, each one sends every message queued at the time in a single gather write
+	uint64_t writes = 0;
+	uint64_t messages = 0;
+	uint64_t bytes = 0;
+
+	// Bytes queued on a connection each time a message is added to it: up to 4, 16, 64, 256 and 1024 KB, then above
+	std::array<uint64_t, 6> queueDepth {};
+	// Connections going over the send queue high watermark
+	uint64_t congestions = 0;
+	// Health and light updates merged while their connection was congested
+	uint64_t coalescedUpdates = 0;
+	uint64_t slowDisconnects = 0;
+};
+
+struct SendQueueLimits {
+	// Bytes, 0 disables the limit
+	size_t highWatermark = 0;
+	size_t lowWatermark = 0;
+	size_t maxSize = 0;
+	// Time a connection may stay congested before it is dropped, 0 disables it
+	std::chrono::milliseconds slowTimeout {};
+};
+
 class ConnectionManager {
 public:
 	ConnectionManager() = default;
@@ -42,8 +67,53 @@ public:
 	void releaseConnection(const Connection_ptr &connection);
 	void closeAll();
 
+	void addWrite(size_t messages, size_t bytes) {
+		writes.fetch_add(1, std::memory_order_relaxed);
+		writtenMessages.fetch_add(messages, std::memory_order_relaxed);
+		writtenBytes.fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+	void addQueueSample(size_t queuedBytes);
+
+	void addCongestion() {
+		congestions.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void addCoalescedUpdate() {
+		coalescedUpdates.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void addSlowDisconnect() {
+		slowDisconnects.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Totals since startup, callers derive rates from the difference between two calls.
+	 */
+	ConnectionStats getStats() const;
+
+	// Reads the sendQueue* options, called again on config reload
+	void reloadSendQueueLimits();
+	void setSendQueueLimits(const SendQueueLimits &limits);
+	SendQueueLimits getSendQueueLimits();
+
 private:
 	phmap::parallel_flat_hash_set_m<Connection_ptr> connections;
+
+	std::atomic_uint64_t writes = 0;
+	std::atomic_uint64_t writtenMessages = 0;
+	std::atomic_uint64_t writtenBytes = 0;
+
+	std::array<std::atomic_uint64_t, 6> queueDepth {};
+	std::atomic_uint64_t congestions = 0;
+	std::atomic_uint64_t coalescedUpdates = 0;
+	std::atomic_uint64_t slowDisconnects = 0;
+
+	std::atomic_bool sendQueueLimitsLoaded = false;
+	std::atomic_size_t highWatermark = 0;
+	std::atomic_size_t lowWatermark = 0;
+	std::atomic_size_t maxQueueSize = 0;
+	std::atomic_int64_t slowTimeoutMs = 0;
 };
 
 class Connection : public std::enable_shared_from_this<Connection> {
@@ -68,6 +138,14 @@ public:
 
 	void send(const OutputMessage_ptr &outputMessage);
 
+	// Over the send queue high watermark and not yet drained below the low one
+	bool isCongested() const {
+		return congested.load(std::memory_order_relaxed);
+	}
+
+	// Hands a decrypted game packet to the packet recorder, when it is running
+	void recordPacket(const uint8_t* data, size_t size);
+
 	uint32_t getIP();
 
 private:
@@ -75,24 +153,39 @@ private:
 	void parseHeader(const std::error_code &error);
 	void parsePacket(const std::error_code &error);
 
-	void onWriteOperation(const std::error_code &error);
+	void onWriteOperation(const std::error_code &error, size_t bytesTransferred);
 
 	static void handleTimeout(ConnectionWeak_ptr connectionWeak, const std::error_code &error);
 
 	void closeSocket();
+	// Updates the congestion state after a message was queued, false when the client is too slow to keep
+	bool checkSendQueue();
 	void internalWorker();
-	void internalSend(const OutputMessage_ptr &outputMessage);
+	void internalSend(std::unique_lock<std::recursive_mutex> &lock);
+	void finalizeBatch();
+	void internalWrite();
 
 	asio::ip::tcp::socket &getSocket() {
 		return socket;
 	}
 
+	// The socket, the timers and the posted work all go through it, so the handlers of
+	// a connection never run concurrently whatever the number of network threads
+	asio::strand<asio::io_service::executor_type> strand;
 	asio::high_resolution_timer readTimer;
 	asio::high_resolution_timer writeTimer;
 
 	std::recursive_mutex connectionLock;
 
-	std::list<OutputMessage_ptr> messageQueue;
+	stdext::ringbuffer<OutputMessage_ptr> messageQueue;
+	// Messages of the write in progress, sent with a single gather write
+	std::vector<OutputMessage_ptr> writeBatch;
+	std::vector<asio::const_buffer> writeBuffers;
+	// Bytes of the queued messages and of the write in progress, before compression and encryption
+	size_t queuedBytes = 0;
+	size_t writeBatchBytes = 0;
+	std::chrono::steady_clock::time_point congestedSince;
+	std::atomic_bool congested = false;
 
 	ConstServicePort_ptr service_port;
 	Protocol_ptr protocol;
@@ -104,6 +197,8 @@ private:
 	std::time_t timeConnected = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
 	uint32_t packetsSent = 0;
 	uint32_t ip = 1;
+	// Session of this connection in the packet recording, 0 until its first recorded packet
+	uint32_t recordSession = 0;
 
 	std::underlying_type_t<ConnectionState_t> connectionState = CONNECTION_STATE_OPEN;
 	bool receivedFirst = false;
@@ -0,0 +1,114 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "server/network/connection/packet_recorder.hpp"
+
+#include "lib/di/container.hpp"
+
+namespace {
+	template <typename T>
+	void writeValue(std::ostream &stream, T value) {
+		std::array<char, sizeof(T)> bytes;
+		for (size_t i = 0; i < sizeof(T); ++i) {
+			bytes[i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+		}
+		stream.write(bytes.data(), bytes.size());
+	}
+
+	template <typename T>
+	bool readValue(std::istream &stream, T &value) {
+		std::array<unsigned char, sizeof(T)> bytes;
+		if (!stream.read(reinterpret_cast<char*>(bytes.data()), bytes.size())) {
+			return false;
+		}
+
+		value = 0;
+		for (size_t i = 0; i < sizeof(T); ++i) {
+			value |= static_cast<T>(bytes[i]) << (i * 8);
+		}
+		return true;
+	}
+}
+
+PacketRecorder::~PacketRecorder() {
+	stop();
+}
+
+PacketRecorder &PacketRecorder::getInstance() {
+	return inject<PacketRecorder>();
+}
+
+bool PacketRecorder::start(const std::string &path) {
+	std::scoped_lock lock(fileMutex);
+	if (file.is_open()) {
+		file.close();
+	}
+
+	file.open(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		g_logger().error("[PacketRecorder::start] - Failed to open {}", path);
+		recording.store(false, std::memory_order_relaxed);
+		return false;
+	}
+
+	file.write(MAGIC.data(), MAGIC.size());
+	startTime = std::chrono::steady_clock::now();
+	recording.store(true, std::memory_order_relaxed);
+	g_logger().warn("Recording the game sessions to {}, disable packetRecorderFile once done", path);
+	return true;
+}
+
+void PacketRecorder::stop() {
+	std::scoped_lock lock(fileMutex);
+	recording.store(false, std::memory_order_relaxed);
+	if (file.is_open()) {
+		file.close();
+	}
+}
+
+void PacketRecorder::record(uint32_t session, const uint8_t* data, size_t size) {
+	if (size > std::numeric_limits<uint16_t>::max()) {
+		return;
+	}
+
+	std::scoped_lock lock(fileMutex);
+	if (!file.is_open()) {
+		return;
+	}
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+	writeValue<uint32_t>(file, session);
+	writeValue<uint32_t>(file, static_cast<uint32_t>(elapsed));
+	writeValue<uint16_t>(file, data ? static_cast<uint16_t>(size) : 0);
+	if (data && size > 0) {
+		file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+	}
+}
+
+std::vector<RecordedPacket> PacketRecorder::load(const std::string &path) {
+	std::vector<RecordedPacket> packets;
+	std::ifstream stream(path, std::ios::binary);
+	std::array<char, MAGIC.size()> magic {};
+	if (!stream.read(magic.data(), magic.size()) || magic != MAGIC) {
+		g_logger().error("[PacketRecorder::load] - {} is not a packet recording", path);
+		return packets;
+	}
+
+	RecordedPacket packet;
+	uint16_t size = 0;
+	while (readValue(stream, packet.session) && readValue(stream, packet.time) && readValue(stream, size)) {
+		packet.data.resize(size);
+		if (size > 0 && !stream.read(packet.data.data(), size)) {
+			g_logger().warn("[PacketRecorder::load] - {} ends in the middle of a packet", path);
+			break;
+		}
+		packets.emplace_back(packet);
+	}
+	return packets;
+}
@@ -0,0 +1,68 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+struct RecordedPacket {
+	uint32_t session = 0;
+	// Milliseconds since the recording started
+	uint32_t time = 0;
+	// Decrypted game packet, starting with its opcode. Empty when the session ended.
+	std::string data;
+};
+
+/**
+ * Captures the game packets received by every connection into a file, so the
+ * sessions can be replayed later by the canary_loadtest tool.
+ *
+ * Only what comes after the login is recorded, the login packet carries the
+ * account credentials. Enabled with packetRecorderFile in config.lua.
+ *
+ * File layout, little endian: the 4 bytes magic, then one record per packet
+ * made of u32 session, u32 time, u16 size and the packet bytes.
+ */
+class PacketRecorder {
+public:
+	static constexpr std::array<char, 4> MAGIC = { 'C', 'P', 'R', '1' };
+
+	PacketRecorder() = default;
+	~PacketRecorder();
+
+	// Singleton - ensures we don't accidentally copy it
+	PacketRecorder(const PacketRecorder &) = delete;
+	void operator=(const PacketRecorder &) = delete;
+
+	static PacketRecorder &getInstance();
+
+	bool start(const std::string &path);
+	void stop();
+
+	bool isRecording() const {
+		return recording.load(std::memory_order_relaxed);
+	}
+
+	uint32_t newSession() {
+		return lastSession.fetch_add(1, std::memory_order_relaxed) + 1;
+	}
+
+	// A null data marks the end of the session
+	void record(uint32_t session, const uint8_t* data, size_t size);
+
+	static std::vector<RecordedPacket> load(const std::string &path);
+
+private:
+	std::mutex fileMutex;
+	std::ofstream file;
+	std::chrono::steady_clock::time_point startTime;
+
+	std::atomic_bool recording = false;
+	std::atomic_uint32_t lastSession = 0;
+};
+
+constexpr auto g_packetRecorder = PacketRecorder::getInstance;
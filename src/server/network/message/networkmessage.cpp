@@ -89,6 +89,10 @@ uint8_t NetworkMessage::getPreviousByte() {
 }
 
 std::string NetworkMessage::getString(uint16_t stringLen /* = 0*/, const std::source_location &location) {
+	return std::string(getStringView(stringLen, location));
+}
+
+std::string_view NetworkMessage::getStringView(uint16_t stringLen /* = 0*/, const std::source_location &location) {
 	if (stringLen == 0) {
 		stringLen = get<uint16_t>();
 	}
@@ -98,15 +102,14 @@ std::string NetworkMessage::getString(uint16_t stringLen /* = 0*/, const std::so
 		return {};
 	}
 
-	if (stringLen > NETWORKMESSAGE_MAXSIZE) {
-		g_logger().error("[{}] exceded NetworkMessage max size: {}, actually size: {}.  Called line '{}:{}' in '{}'", __FUNCTION__, NETWORKMESSAGE_MAXSIZE, stringLen, location.line(), location.column(), location.function_name());
+	if (info.position + stringLen > buffer.size()) {
+		g_logger().error("[{}] exceded NetworkMessage max size: {}, string ends at: {}.  Called line '{}:{}' in '{}'", __FUNCTION__, NETWORKMESSAGE_MAXSIZE, info.position + stringLen, location.line(), location.column(), location.function_name());
 		return {};
 	}
 
 	g_logger().trace("[{}] called line '{}:{}' in '{}'", __FUNCTION__, location.line(), location.column(), location.function_name());
 
-	// Copy the string from the buffer
-	std::string result(buffer.begin() + info.position, buffer.begin() + info.position + stringLen);
+	const std::string_view result(reinterpret_cast<const char*>(buffer.data()) + info.position, stringLen);
 	info.position += stringLen;
 	return result;
 }
@@ -124,7 +127,7 @@ void NetworkMessage::skipBytes(int16_t count) {
 	info.position += count;
 }
 
-void NetworkMessage::addString(const std::string &value, const std::source_location &location /*= std::source_location::current()*/, const std::string &function /* = ""*/) {
+void NetworkMessage::addString(std::string_view value, const std::source_location &location /*= std::source_location::current()*/, const std::string &function /* = ""*/) {
 	size_t stringLen = value.length();
 	if (value.empty()) {
 		if (!function.empty()) {
@@ -44,22 +44,28 @@ public:
 	T get() {
 		static_assert(!std::is_same_v<T, double>, "Error: get<double>() is not allowed. Use getDouble() instead.");
 		static_assert(std::is_trivially_copyable_v<T>, "Type T must be trivially copyable");
-		if (!canRead(sizeof(T))) {
+		if (!canRead(sizeof(T)) || info.position + sizeof(T) > buffer.size()) {
 			return T();
 		}
 
-		// Create a temporary byte array to store the value read from the buffer.
-		std::array<unsigned char, sizeof(T)> tempBuffer;
-		// Copy data from the buffer to the temporary array
-		std::span<const unsigned char> sourceSpan(buffer.data() + info.position, sizeof(T));
-		std::ranges::copy(sourceSpan, tempBuffer.begin());
-		// Update the read position in the buffer
+		// Unaligned load straight from the buffer, compilers turn it into a single move
+		T value;
+		std::memcpy(&value, buffer.data() + info.position, sizeof(T));
 		info.position += sizeof(T);
-		// Convert the byte array to type T using std::bit_cast and return the result
-		return std::bit_cast<T>(tempBuffer);
+		return value;
 	}
 
 	std::string getString(uint16_t stringLen = 0, const std::source_location &location = std::source_location::current());
+
+	/**
+	 * Reads a string without copying it out of the message.
+	 *
+	 * The view points into this message's buffer, so it must not outlive the packet being parsed.
+	 * Incoming messages stay untouched until Protocol::parsePacket returns on the dispatcher,
+	 * since the connection only reads the next packet from Connection::resumeWork.
+	 * Returns an empty view, without moving the position, when the string does not fit in the message.
+	 */
+	std::string_view getStringView(uint16_t stringLen = 0, const std::source_location &location = std::source_location::current());
 	Position getPosition();
 
 	// skips count unknown/unused bytes in an incoming message
@@ -137,7 +143,7 @@ public:
 	 * that log messages accurately reflect the Lua context. When invoking from C++, omitting the `function`
 	 * parameter allows `std::source_location` to automatically capture the C++ context.
 	 */
-	void addString(const std::string &value, const std::source_location &location = std::source_location::current(), const std::string &function = "");
+	void addString(std::string_view value, const std::source_location &location = std::source_location::current(), const std::string &function = "");
 
 	void addDouble(double value, uint8_t precision = 4);
 	double getDouble();
@@ -30,6 +30,7 @@ void OutputMessagePool::scheduleSendAll() {
 void OutputMessagePool::sendAll() {
 	// dispatcher thread
 	for (const auto &protocol : bufferedProtocols) {
+		protocol->flushDeferredUpdates();
 		auto &msg = protocol->getCurrentBuffer();
 		if (msg) {
 			protocol->send(std::move(msg));
@@ -61,3 +62,7 @@ void OutputMessagePool::removeProtocolFromAutosend(const Protocol_ptr &protocol)
 OutputMessage_ptr OutputMessagePool::getOutputMessage() {
 	return std::allocate_shared<OutputMessage>(LockfreePoolingAllocator<OutputMessage, OUTPUTMESSAGE_FREE_LIST_CAPACITY>());
 }
+
+SharedMessage_ptr OutputMessagePool::getSharedMessage(const NetworkMessage &msg) {
+	return std::make_shared<const SharedMessage>(msg);
+}
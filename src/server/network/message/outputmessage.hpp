@@ -14,6 +14,36 @@
 
 class Protocol;
 
+// A byte that differs per recipient, written over the shared payload while it is appended
+struct SharedMessagePatch {
+	uint16_t offset = 0;
+	uint8_t value = 0;
+};
+
+/**
+ * A payload serialized once and appended to the output buffer of many
+ * recipients. Only the written bytes are kept, so the same event sent to
+ * hundreds of spectators costs one serialization and a small copy each.
+ */
+class SharedMessage {
+public:
+	explicit SharedMessage(const NetworkMessage &msg) :
+		bytes(msg.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION, msg.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION + msg.getLength()) { }
+
+	std::span<const uint8_t> data() const {
+		return bytes;
+	}
+
+	NetworkMessage::MsgSize_t getLength() const {
+		return static_cast<NetworkMessage::MsgSize_t>(bytes.size());
+	}
+
+private:
+	std::vector<uint8_t> bytes;
+};
+
+using SharedMessage_ptr = std::shared_ptr<const SharedMessage>;
+
 class OutputMessage : public NetworkMessage {
 public:
 	OutputMessage() = default;
@@ -63,6 +93,18 @@ public:
 		info.position += msgLen;
 	}
 
+	void append(const SharedMessage &msg, std::span<const SharedMessagePatch> patches = {}) {
+		const auto msgLen = msg.getLength();
+		std::ranges::copy(msg.data(), buffer.begin() + info.position);
+		for (const auto &[offset, value] : patches) {
+			if (offset < msgLen) {
+				buffer[info.position + offset] = value;
+			}
+		}
+		info.length += msgLen;
+		info.position += msgLen;
+	}
+
 private:
 	template <typename T>
 	void add_header(T addHeader) {
@@ -105,6 +147,7 @@ public:
 	void scheduleSendAll();
 
 	static OutputMessage_ptr getOutputMessage();
+	static SharedMessage_ptr getSharedMessage(const NetworkMessage &msg);
 
 	void addProtocolToAutosend(const Protocol_ptr &protocol);
 	void removeProtocolFromAutosend(const Protocol_ptr &protocol);
@@ -0,0 +1,123 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "server/network/protocol/compression_policy.hpp"
+
+#include "config/configmanager.hpp"
+#include "lib/di/container.hpp"
+
+namespace {
+	// Opcode ratios need this much data before they are trusted, and are halved past the upper bound to follow changes
+	constexpr uint64_t OPCODE_MIN_SAMPLE = 64 * 1024;
+	constexpr uint64_t OPCODE_MAX_SAMPLE = 16 * 1024 * 1024;
+	// Weight of the last message in the connection ratio
+	constexpr double CONNECTION_RATIO_WEIGHT = 1.0 / 8;
+
+	int64_t nowUs() {
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+CompressionPolicy &CompressionPolicy::getInstance() {
+	return inject<CompressionPolicy>();
+}
+
+void CompressionPolicy::reload() {
+	setLimits(g_configManager().getNumber(COMPRESSION_LEVEL), g_configManager().getNumber(COMPRESSION_CPU_BUDGET));
+}
+
+void CompressionPolicy::setLimits(int32_t level, int32_t cpuBudgetMs) {
+	configuredLevel.store(std::clamp(level, 0, 9), std::memory_order_relaxed);
+	cpuBudgetUs.store(static_cast<uint64_t>(std::max(cpuBudgetMs, 0)) * 1000, std::memory_order_relaxed);
+}
+
+int32_t CompressionPolicy::getLevel() {
+	if (configuredLevel.load(std::memory_order_relaxed) < 0) {
+		reload();
+	}
+	return currentLevel();
+}
+
+int32_t CompressionPolicy::currentLevel() const {
+	const auto level = std::max(configuredLevel.load(std::memory_order_relaxed), 0);
+	return underPressure.load(std::memory_order_relaxed) ? std::min(level, 1) : level;
+}
+
+bool CompressionPolicy::shouldCompress(ConnectionState &state, uint8_t opcode, size_t size) {
+	if (size < MIN_MESSAGE_SIZE || getLevel() == 0) {
+		return false;
+	}
+
+	messages.fetch_add(1, std::memory_order_relaxed);
+	const bool incompressible = state.ratio > SKIP_RATIO || getOpcodeRatio(opcode) > SKIP_RATIO;
+	if (incompressible && ++state.skipped < PROBE_INTERVAL) {
+		skipped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	state.skipped = 0;
+	return true;
+}
+
+void CompressionPolicy::onCompressed(ConnectionState &state, uint8_t opcode, size_t size, size_t compressedSize, uint64_t elapsedUs) {
+	const double ratio = static_cast<double>(compressedSize) / size;
+	state.ratio = state.ratio == 0 ? ratio : state.ratio + (ratio - state.ratio) * CONNECTION_RATIO_WEIGHT;
+
+	auto &opcodeStats = opcodes[opcode];
+	if (opcodeStats.bytesIn.fetch_add(size, std::memory_order_relaxed) + size > OPCODE_MAX_SAMPLE) {
+		// Racy on purpose, a lost update only skews an estimate
+		opcodeStats.bytesIn.store(opcodeStats.bytesIn.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+		opcodeStats.bytesOut.store(opcodeStats.bytesOut.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+	}
+	opcodeStats.bytesOut.fetch_add(compressedSize, std::memory_order_relaxed);
+
+	compressed.fetch_add(1, std::memory_order_relaxed);
+	bytesIn.fetch_add(size, std::memory_order_relaxed);
+	bytesOut.fetch_add(compressedSize, std::memory_order_relaxed);
+	cpuTimeUs.fetch_add(elapsedUs, std::memory_order_relaxed);
+	updateCpuWindow(elapsedUs);
+}
+
+double CompressionPolicy::getOpcodeRatio(uint8_t opcode) const {
+	const auto &opcodeStats = opcodes[opcode];
+	const auto in = opcodeStats.bytesIn.load(std::memory_order_relaxed);
+	if (in < OPCODE_MIN_SAMPLE) {
+		return 0;
+	}
+	return static_cast<double>(opcodeStats.bytesOut.load(std::memory_order_relaxed)) / in;
+}
+
+void CompressionPolicy::updateCpuWindow(uint64_t elapsedUs) {
+	const auto windowCpu = windowCpuUs.fetch_add(elapsedUs, std::memory_order_relaxed) + elapsedUs;
+	const auto now = nowUs();
+	auto start = windowStart.load(std::memory_order_relaxed);
+	if (now - start < 1'000'000 || !windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+		return;
+	}
+
+	// One thread per second gets here
+	windowCpuUs.store(0, std::memory_order_relaxed);
+	const auto budget = cpuBudgetUs.load(std::memory_order_relaxed);
+	const bool pressure = budget > 0 && windowCpu > budget;
+	if (pressure != underPressure.exchange(pressure, std::memory_order_relaxed)) {
+		g_logger().info("[CompressionPolicy] - {} ms of compression in the last second, {} compression level {}", windowCpu / 1000, pressure ? "lowering" : "restoring", currentLevel());
+	}
+}
+
+CompressionStats CompressionPolicy::getStats() const {
+	return {
+		messages.load(std::memory_order_relaxed),
+		compressed.load(std::memory_order_relaxed),
+		skipped.load(std::memory_order_relaxed),
+		bytesIn.load(std::memory_order_relaxed),
+		bytesOut.load(std::memory_order_relaxed),
+		cpuTimeUs.load(std::memory_order_relaxed),
+		currentLevel(),
+	};
+}
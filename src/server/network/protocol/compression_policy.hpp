@@ -0,0 +1,94 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+struct CompressionStats {
+	// Messages large enough to be compressed, then how they went
+	uint64_t messages = 0;
+	uint64_t compressed = 0;
+	uint64_t skipped = 0;
+	// Sizes before and after deflate, of the compressed messages only
+	uint64_t bytesIn = 0;
+	uint64_t bytesOut = 0;
+	uint64_t cpuTimeUs = 0;
+	int32_t level = 0;
+};
+
+/**
+ * Decides which outgoing messages go through deflate and at which level.
+ *
+ * The compressed/original ratio is tracked per connection and per opcode
+ * (the first packet of the message). Payloads that do not shrink enough are
+ * sent as they are, with a probe every few messages in case the traffic
+ * changed. When the compression time of the last second goes over
+ * packetCompressionCpuBudget, the fastest level is used until it is back under.
+ */
+class CompressionPolicy {
+public:
+	static constexpr size_t MIN_MESSAGE_SIZE = 128;
+	// Compressed sizes above this share of the original are not worth the CPU
+	static constexpr double SKIP_RATIO = 0.9;
+	// Messages skipped in a row before compressing one anyway to refresh the ratios
+	static constexpr uint16_t PROBE_INTERVAL = 32;
+
+	// Kept by each protocol, only touched by the thread finalizing its messages
+	struct ConnectionState {
+		// Moving average of compressed/original, 0 until the first message
+		double ratio = 0;
+		uint16_t skipped = 0;
+	};
+
+	CompressionPolicy() = default;
+
+	// Singleton - ensures we don't accidentally copy it
+	CompressionPolicy(const CompressionPolicy &) = delete;
+	void operator=(const CompressionPolicy &) = delete;
+
+	static CompressionPolicy &getInstance();
+
+	bool shouldCompress(ConnectionState &state, uint8_t opcode, size_t size);
+	void onCompressed(ConnectionState &state, uint8_t opcode, size_t size, size_t compressedSize, uint64_t elapsedUs);
+
+	// 0 when compression is disabled
+	int32_t getLevel();
+
+	// Reads packetCompressionLevel and packetCompressionCpuBudget, called again on config reload
+	void reload();
+	void setLimits(int32_t level, int32_t cpuBudgetMs);
+
+	CompressionStats getStats() const;
+
+private:
+	struct OpcodeStats {
+		std::atomic_uint64_t bytesIn = 0;
+		std::atomic_uint64_t bytesOut = 0;
+	};
+
+	int32_t currentLevel() const;
+	double getOpcodeRatio(uint8_t opcode) const;
+	void updateCpuWindow(uint64_t elapsedUs);
+
+	std::array<OpcodeStats, 256> opcodes;
+
+	std::atomic_uint64_t messages = 0;
+	std::atomic_uint64_t compressed = 0;
+	std::atomic_uint64_t skipped = 0;
+	std::atomic_uint64_t bytesIn = 0;
+	std::atomic_uint64_t bytesOut = 0;
+	std::atomic_uint64_t cpuTimeUs = 0;
+
+	std::atomic_int32_t configuredLevel = -1;
+	std::atomic_uint64_t cpuBudgetUs = 0;
+	std::atomic_int64_t windowStart = 0;
+	std::atomic_uint64_t windowCpuUs = 0;
+	std::atomic_bool underPressure = false;
+};
+
+constexpr auto g_compressionPolicy = CompressionPolicy::getInstance;
@@ -0,0 +1,71 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "server/network/protocol/known_creatures.hpp"
+
+KnownCreatures::KnownCreatures(size_t capacity) :
+	capacity(std::max<size_t>(capacity, 1)) { }
+
+void KnownCreatures::clear() {
+	slots.clear();
+	index.clear();
+	head = tail = freeSlots = NONE;
+}
+
+uint32_t KnownCreatures::allocate(uint32_t id) {
+	uint32_t slot;
+	if (freeSlots != NONE) {
+		slot = freeSlots;
+		freeSlots = slots[slot].next;
+	} else {
+		slot = static_cast<uint32_t>(slots.size());
+		slots.emplace_back();
+	}
+	slots[slot] = { id, NONE, NONE };
+	return slot;
+}
+
+void KnownCreatures::release(uint32_t slot) {
+	slots[slot] = { 0, NONE, freeSlots };
+	freeSlots = slot;
+}
+
+void KnownCreatures::linkFront(uint32_t slot) {
+	slots[slot].prev = NONE;
+	slots[slot].next = head;
+	if (head != NONE) {
+		slots[head].prev = slot;
+	} else {
+		tail = slot;
+	}
+	head = slot;
+}
+
+void KnownCreatures::unlink(uint32_t slot) {
+	auto &entry = slots[slot];
+	if (entry.prev != NONE) {
+		slots[entry.prev].next = entry.next;
+	} else {
+		head = entry.next;
+	}
+	if (entry.next != NONE) {
+		slots[entry.next].prev = entry.prev;
+	} else {
+		tail = entry.prev;
+	}
+	entry.prev = entry.next = NONE;
+}
+
+void KnownCreatures::moveToFront(uint32_t slot) {
+	if (slot == head) {
+		return;
+	}
+	unlink(slot);
+	linkFront(slot);
+}
@@ -0,0 +1,101 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+/**
+ * The creatures a client has been sent, so the next time they are
+ * described by id only.
+ *
+ * The slots form a list ordered by the last time each creature was seen,
+ * the id -> slot index makes lookups, touches and evictions O(1). Once the
+ * client limit is reached the least recently seen creature goes, skipping the
+ * few ones the caller still wants to keep (visible or in the party).
+ */
+class KnownCreatures {
+public:
+	// What the client keeps before asking the server to replace an entry
+	static constexpr size_t CAPACITY = 1300;
+	// Creatures refused by the eviction predicate before the oldest one is removed anyway
+	static constexpr size_t MAX_EVICTION_ATTEMPTS = 32;
+
+	explicit KnownCreatures(size_t capacity = CAPACITY);
+
+	bool contains(uint32_t id) const {
+		return index.contains(id);
+	}
+
+	size_t size() const {
+		return index.size();
+	}
+
+	/**
+	 * @brief Marks the creature as seen now, adding it when unknown.
+	 * @param canEvict Called with the least recently seen ids until one of them can be forgotten.
+	 * @return Whether it was already known, and the id forgotten to make room for it (0 for none).
+	 */
+	template <typename Predicate>
+	std::pair<bool, uint32_t> insert(uint32_t id, Predicate &&canEvict) {
+		if (const auto it = index.find(id); it != index.end()) {
+			moveToFront(it->second);
+			return { true, 0 };
+		}
+
+		uint32_t removed = 0;
+		if (index.size() >= capacity) {
+			removed = evict(std::forward<Predicate>(canEvict));
+		}
+
+		const auto slot = allocate(id);
+		index.emplace(id, slot);
+		linkFront(slot);
+		return { false, removed };
+	}
+
+	void clear();
+
+private:
+	static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+	struct Slot {
+		uint32_t id = 0;
+		uint32_t prev = NONE;
+		uint32_t next = NONE;
+	};
+
+	template <typename Predicate>
+	uint32_t evict(Predicate &&canEvict) {
+		// Refused creatures are being seen right now, they move to the front like any other
+		for (size_t attempt = 0; attempt < MAX_EVICTION_ATTEMPTS && !canEvict(slots[tail].id); ++attempt) {
+			moveToFront(tail);
+		}
+
+		const auto slot = tail;
+		const auto id = slots[slot].id;
+		unlink(slot);
+		index.erase(id);
+		release(slot);
+		return id;
+	}
+
+	uint32_t allocate(uint32_t id);
+	void release(uint32_t slot);
+	void linkFront(uint32_t slot);
+	void unlink(uint32_t slot);
+	void moveToFront(uint32_t slot);
+
+	const size_t capacity;
+	std::vector<Slot> slots;
+	phmap::flat_hash_map<uint32_t, uint32_t> index;
+	// Most and least recently seen
+	uint32_t head = NONE;
+	uint32_t tail = NONE;
+	// Released slots, chained through next
+	uint32_t freeSlots = NONE;
+};
@@ -9,8 +9,8 @@
 
 #include "server/network/protocol/protocol.hpp"
 
-#include "config/configmanager.hpp"
 #include "server/network/connection/connection.hpp"
+#include "server/network/connection/packet_recorder.hpp"
 #include "server/network/message/outputmessage.hpp"
 #include "security/rsa.hpp"
 #include "game/scheduling/dispatcher.hpp"
@@ -21,7 +21,7 @@ Protocol::Protocol(const Connection_ptr &initConnection) :
 
 void Protocol::onSendMessage(const OutputMessage_ptr &msg) {
 	if (!rawMessages) {
-		const uint32_t sendMessageChecksum = msg->getLength() >= 128 && compression(*msg) ? (1U << 31) : 0;
+		const uint32_t sendMessageChecksum = compression(*msg) ? (1U << 31) : 0;
 
 		if (!encryptionEnabled) {
 			msg->writeMessageLength();
@@ -50,6 +50,13 @@ bool Protocol::sendRecvMessageCallback(NetworkMessage &msg) {
 		return false;
 	}
 
+	if (encryptionEnabled && g_packetRecorder().isRecording() && msg.getLength() > 1) {
+		if (const auto &protocolConnection = getConnection()) {
+			// The length still counts the padding size byte read by XTEA_decrypt
+			protocolConnection->recordPacket(msg.getBuffer() + msg.getBufferPosition(), msg.getLength() - 1);
+		}
+	}
+
 	g_dispatcher().addEvent(
 		[&msg, protocolWeak = std::weak_ptr<Protocol>(shared_from_this())]() {
 			if (const auto &protocol = protocolWeak.lock()) {
@@ -120,69 +127,16 @@ void Protocol::send(OutputMessage_ptr msg) const {
 	}
 }
 
-void Protocol::disconnect() const {
+bool Protocol::isCongested() const {
 	if (const auto connection = getConnection()) {
-		connection->close();
+		return connection->isCongested();
 	}
+	return false;
 }
 
-void Protocol::XTEA_transform(uint8_t* buffer, size_t messageLength, bool encrypt) const {
-	constexpr uint32_t delta = 0x61C88647;
-	size_t readPos = 0;
-	const std::array<uint32_t, 4> newKey = key;
-
-	std::array<std::array<uint32_t, 2>, 32> precachedControlSum;
-	uint32_t sum = encrypt ? 0 : 0xC6EF3720;
-
-	// Precompute control sums
-	if (encrypt) {
-		for (size_t i = 0; i < 32; ++i) {
-			precachedControlSum[i][0] = sum + newKey[sum & 3];
-			sum -= delta;
-			precachedControlSum[i][1] = sum + newKey[(sum >> 11) & 3];
-		}
-	} else {
-		for (size_t i = 0; i < 32; ++i) {
-			precachedControlSum[i][0] = sum + newKey[(sum >> 11) & 3];
-			sum += delta;
-			precachedControlSum[i][1] = sum + newKey[sum & 3];
-		}
-	}
-
-	while (readPos < messageLength) {
-		std::array<uint8_t, 8> tempBuffer;
-		std::ranges::copy_n(buffer + readPos, 8, tempBuffer.begin());
-
-		// Convert bytes to uint32_t considering little-endian order
-		std::array<uint8_t, 4> bytes0;
-		std::array<uint8_t, 4> bytes1;
-		std::copy_n(tempBuffer.begin(), 4, bytes0.begin());
-		std::copy_n(tempBuffer.begin() + 4, 4, bytes1.begin());
-
-		uint32_t vData0 = std::bit_cast<uint32_t>(bytes0);
-		uint32_t vData1 = std::bit_cast<uint32_t>(bytes1);
-
-		if (encrypt) {
-			for (size_t i = 0; i < 32; ++i) {
-				vData0 += ((vData1 << 4 ^ vData1 >> 5) + vData1) ^ precachedControlSum[i][0];
-				vData1 += ((vData0 << 4 ^ vData0 >> 5) + vData0) ^ precachedControlSum[i][1];
-			}
-		} else {
-			for (size_t i = 0; i < 32; ++i) {
-				vData1 -= ((vData0 << 4 ^ vData0 >> 5) + vData0) ^ precachedControlSum[i][0];
-				vData0 -= ((vData1 << 4 ^ vData1 >> 5) + vData1) ^ precachedControlSum[i][1];
-			}
-		}
-
-		// Convert vData back to bytes
-		bytes0 = std::bit_cast<std::array<uint8_t, 4>>(vData0);
-		bytes1 = std::bit_cast<std::array<uint8_t, 4>>(vData1);
-
-		// Copy transformed bytes back to buffer
-		std::copy_n(bytes0.begin(), 4, buffer + readPos);
-		std::copy_n(bytes1.begin(), 4, buffer + readPos + 4);
-
-		readPos += 8;
+void Protocol::disconnect() const {
+	if (const auto connection = getConnection()) {
+		connection->close();
 	}
 }
 
@@ -196,7 +150,7 @@ void Protocol::XTEA_encrypt(OutputMessage &outputMessage) const {
 	uint8_t* buffer = outputMessage.getOutputBuffer();
 	size_t messageLength = outputMessage.getLength();
 
-	XTEA_transform(buffer, messageLength, true);
+	xtea::encrypt(buffer, messageLength, encryptKeys);
 }
 
 bool Protocol::XTEA_decrypt(NetworkMessage &msg) const {
@@ -213,7 +167,7 @@ bool Protocol::XTEA_decrypt(NetworkMessage &msg) const {
 
 	size_t messageLength = msgLength;
 
-	XTEA_transform(buffer, messageLength, false);
+	xtea::decrypt(buffer, messageLength, decryptKeys);
 
 	uint8_t paddingSize = msg.getByte();
 	uint16_t innerLength = messageLength - paddingSize;
@@ -253,7 +207,7 @@ uint32_t Protocol::getIP() const {
 	return 0;
 }
 
-bool Protocol::compression(OutputMessage &outputMessage) const {
+bool Protocol::compression(OutputMessage &outputMessage) {
 	if (checksumMethod != CHECKSUM_METHOD_SEQUENCE) {
 		return false;
 	}
@@ -271,6 +225,18 @@ bool Protocol::compression(OutputMessage &outputMessage) const {
 		return false;
 	}
 
+	const uint8_t opcode = outputMessageSize > 0 ? outputMessage.getOutputBuffer()[0] : 0;
+	if (!g_compressionPolicy().shouldCompress(compressionState, opcode, outputMessageSize)) {
+		return false;
+	}
+
+	const int32_t level = g_compressionPolicy().getLevel();
+	if (level != compress->level && deflateParams(compress->stream.get(), level, Z_DEFAULT_STRATEGY) == Z_OK) {
+		compress->level = level;
+	}
+
+	const auto startTime = std::chrono::steady_clock::now();
+
 	compress->stream->next_in = outputMessage.getOutputBuffer();
 	compress->stream->avail_in = outputMessageSize;
 	compress->stream->next_out = reinterpret_cast<Bytef*>(compress->buffer.data());
@@ -288,15 +254,18 @@ bool Protocol::compression(OutputMessage &outputMessage) const {
 		return false;
 	}
 
+	const auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+	g_compressionPolicy().onCompressed(compressionState, opcode, outputMessageSize, totalSize, static_cast<uint64_t>(elapsedUs));
+
 	outputMessage.reset();
 	outputMessage.addBytes(compress->buffer.data(), totalSize);
 
 	return true;
 }
 
-Protocol::ZStream::ZStream() noexcept {
-	const int32_t compressionLevel = g_configManager().getNumber(COMPRESSION_LEVEL);
-	if (compressionLevel <= 0) {
+Protocol::ZStream::ZStream() noexcept :
+	level(g_compressionPolicy().getLevel()) {
+	if (level <= 0) {
 		return;
 	}
 
@@ -305,8 +274,8 @@ Protocol::ZStream::ZStream() noexcept {
 	stream->zfree = nullptr;
 	stream->opaque = nullptr;
 
-	if (deflateInit2(stream.get(), compressionLevel, Z_DEFLATED, -15, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
-		stream.reset();
+	if (deflateInit2(stream.get(), level, Z_DEFLATED, -15, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
 		g_logger().error("[Protocol::enableCompression()] - Zlib deflateInit2 error: {}", (stream->msg ? stream->msg : " unknown error"));
+		stream.reset();
 	}
 }
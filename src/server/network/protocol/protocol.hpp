@@ -10,9 +10,14 @@
 #pragma once
 
 #include "server/server_definitions.hpp"
+#include "security/xtea.hpp"
+#include "server/network/protocol/compression_policy.hpp"
 
 class OutputMessage;
 using OutputMessage_ptr = std::shared_ptr<OutputMessage>;
+class SharedMessage;
+struct SharedMessagePatch;
+using SharedMessage_ptr = std::shared_ptr<const SharedMessage>;
 class Connection;
 using Connection_ptr = std::shared_ptr<Connection>;
 using ConnectionWeak_ptr = std::weak_ptr<Connection>;
@@ -52,14 +57,23 @@ public:
 
 	void send(OutputMessage_ptr msg) const;
 
+	// Called by the autosend before the current buffer goes out, to write the updates held back while congested
+	virtual void flushDeferredUpdates() { }
+
 protected:
+	// The client does not read its messages as fast as they are produced, see Connection::isCongested
+	bool isCongested() const;
+
 	void disconnect() const;
 
 	void enableXTEAEncryption() {
 		encryptionEnabled = true;
 	}
 	void setXTEAKey(const uint32_t* newKey) {
-		std::ranges::copy(newKey, newKey + 4, this->key.begin());
+		xtea::key_t key;
+		std::ranges::copy(newKey, newKey + 4, key.begin());
+		encryptKeys = xtea::expandEncryptKey(key);
+		decryptKeys = xtea::expandDecryptKey(key);
 	}
 
 	void setChecksumMethod(ChecksumMethods_t method) {
@@ -84,19 +98,21 @@ private:
 
 		std::unique_ptr<z_stream> stream;
 		std::array<char, NETWORKMESSAGE_MAXSIZE> buffer {};
+		int32_t level = 0;
 	};
 
-	void XTEA_transform(uint8_t* buffer, size_t messageLength, bool encrypt) const;
 	void XTEA_encrypt(OutputMessage &msg) const;
 	bool XTEA_decrypt(NetworkMessage &msg) const;
-	bool compression(OutputMessage &msg) const;
+	bool compression(OutputMessage &msg);
 
 	OutputMessage_ptr outputBuffer;
 
 	const ConnectionWeak_ptr connectionPtr;
-	std::array<uint32_t, 4> key = {};
+	xtea::round_keys_t encryptKeys = {};
+	xtea::round_keys_t decryptKeys = {};
 	uint32_t serverSequenceNumber = 0;
 	uint32_t clientSequenceNumber = 0;
+	CompressionPolicy::ConnectionState compressionState;
 	std::underlying_type_t<ChecksumMethods_t> checksumMethod = CHECKSUM_METHOD_NONE;
 	bool encryptionEnabled = false;
 	bool rawMessages = false;
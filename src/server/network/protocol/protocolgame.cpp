@@ -42,6 +42,7 @@
 #include "items/weapons/weapons.hpp"
 #include "lua/creature/creatureevent.hpp"
 #include "lua/modules/modules.hpp"
+#include "server/network/connection/connection.hpp"
 #include "server/network/message/outputmessage.hpp"
 #include "utils/tools.hpp"
 #include "creatures/players/vocations/vocation.hpp"
@@ -58,9 +59,15 @@
  * Do not use functions only in the .cpp scope without having a namespace, it may conflict with functions in other files of the same name
  */
 
-// This "getIteration" function will allow us to get the total number of iterations that run within a specific map
-// Very useful to send the total amount in certain bytes in the ProtocolGame class
 namespace {
+	// Counters of ProtocolGame::getStatusUpdateStats
+	std::atomic_uint64_t statusRequested = 0;
+	std::atomic_uint64_t statusCoalesced = 0;
+	std::atomic_uint64_t statusUnchanged = 0;
+	std::atomic_uint64_t statusSent = 0;
+
+	// This "getIteration" function will allow us to get the total number of iterations that run within a specific map
+	// Very useful to send the total amount in certain bytes in the ProtocolGame class
 	template <typename T>
 	uint16_t getVectorIterationIncreaseCount(T &vector) {
 		uint16_t totalIterationCount = 0;
@@ -288,6 +295,26 @@ namespace {
 		msg.addDouble(skillWheel / 10000.);
 		msg.addDouble(0.00);
 	}
+
+	// A tile description holds at most 10 things: the top items stop at 10 (9 on
+	// the viewer's own tile), then the down items fill what creatures left over
+	constexpr uint8_t MAX_TILE_THINGS = 10;
+	constexpr uint8_t MAX_ENCODED_TILE_ITEMS = MAX_TILE_THINGS + 1;
+
+	// Header of the encoding kept in Tile::getDescriptionCache, followed by the item bytes
+	struct TileItemsEncoding {
+		uint8_t variant = 0;
+		uint8_t items = 0;
+		// Ground included
+		uint8_t topItems = 0;
+		std::array<uint16_t, MAX_ENCODED_TILE_ITEMS> ends {};
+	};
+
+	// Items whose bytes depend on the clock or on attributes changed without a tile update
+	bool canCacheItemEncoding(const std::shared_ptr<Item> &item) {
+		const ItemType &it = Item::items[item->getID()];
+		return !it.isPodium && !it.isWrapKit && !it.wearOut && !it.expire && !it.expireStop && !it.clockExpire && it.upgradeClassification == 0;
+	}
 } // namespace
 
 ProtocolGame::ProtocolGame(const Connection_ptr &initConnection) :
@@ -527,6 +554,104 @@ void ProtocolGame::release() {
 	Protocol::release();
 }
 
+bool ProtocolGame::deferWhileCongested(std::unordered_set<uint32_t> &updates, const std::shared_ptr<Creature> &creature) {
+	if (!isCongested()) {
+		return false;
+	}
+
+	updates.emplace(creature->getID());
+	ConnectionManager::getInstance().addCoalescedUpdate();
+	return true;
+}
+
+StatusUpdateStats ProtocolGame::getStatusUpdateStats() {
+	return {
+		statusRequested.load(std::memory_order_relaxed),
+		statusCoalesced.load(std::memory_order_relaxed),
+		statusUnchanged.load(std::memory_order_relaxed),
+		statusSent.load(std::memory_order_relaxed),
+	};
+}
+
+void ProtocolGame::requestStatusBlock(StatusBlock_t block) {
+	if (g_dispatcher().context().isAsync()) {
+		g_dispatcher().addEvent([self = getThis(), block] { self->requestStatusBlock(block); }, __FUNCTION__);
+		return;
+	}
+
+	statusRequested.fetch_add(1, std::memory_order_relaxed);
+	const auto flag = static_cast<uint8_t>(1 << block);
+	if (pendingStatusBlocks & flag) {
+		statusCoalesced.fetch_add(1, std::memory_order_relaxed);
+	}
+	pendingStatusBlocks |= flag;
+}
+
+void ProtocolGame::flushStatusBlocks() {
+	// dispatcher thread
+	const auto pending = std::exchange(pendingStatusBlocks, 0);
+	if (pending & (1 << STATUS_BLOCK_STATS)) {
+		NetworkMessage msg;
+		AddPlayerStats(msg);
+		writeStatusBlock(STATUS_BLOCK_STATS, msg);
+	}
+	if (pending & (1 << STATUS_BLOCK_SKILLS)) {
+		NetworkMessage msg;
+		AddPlayerSkills(msg);
+		writeStatusBlock(STATUS_BLOCK_SKILLS, msg);
+	}
+	if (pending & (1 << STATUS_BLOCK_ICONS)) {
+		NetworkMessage msg;
+		msg.addBytes(pendingIcons.data(), pendingIcons.size());
+		pendingIcons.clear();
+		writeStatusBlock(STATUS_BLOCK_ICONS, msg);
+	}
+}
+
+void ProtocolGame::writeStatusBlock(StatusBlock_t block, NetworkMessage &msg) {
+	const std::string_view bytes(reinterpret_cast<const char*>(msg.getBuffer()) + NetworkMessage::INITIAL_BUFFER_POSITION, msg.getLength());
+	auto &sent = sentStatusBlocks[block];
+	if (bytes == sent) {
+		statusUnchanged.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	sent.assign(bytes);
+	statusSent.fetch_add(1, std::memory_order_relaxed);
+	writeToOutputBuffer(msg);
+}
+
+void ProtocolGame::flushDeferredUpdates() {
+	// dispatcher thread
+	if (!player) {
+		return;
+	}
+
+	if (pendingStatusBlocks != 0) {
+		flushStatusBlocks();
+	}
+
+	if ((deferredHealth.empty() && deferredLight.empty()) || isCongested()) {
+		return;
+	}
+
+	// Swapped out first, the sends below defer again if the connection gets congested meanwhile
+	const auto health = std::exchange(deferredHealth, {});
+	const auto light = std::exchange(deferredLight, {});
+	for (const auto id : health) {
+		const auto &creature = g_game().getCreatureByID(id);
+		if (creature && knownCreatures.contains(id)) {
+			sendCreatureHealth(creature);
+		}
+	}
+	for (const auto id : light) {
+		const auto &creature = g_game().getCreatureByID(id);
+		if (creature && knownCreatures.contains(id)) {
+			sendCreatureLight(creature);
+		}
+	}
+}
+
 void ProtocolGame::login(const std::string &name, uint32_t accountId, OperatingSystem_t operatingSystem) {
 	// OTCV8 features
 	if (otclientV8 > 0) {
@@ -840,8 +965,8 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage &msg) {
 
 	if (!oldProtocol && operatingSystem == CLIENTOS_NEW_LINUX) {
 		// TODO: check what new info for linux is send
-		msg.getString();
-		msg.getString();
+		msg.getStringView();
+		msg.getStringView();
 	}
 
 	std::string characterName = msg.getString();
@@ -871,7 +996,7 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage &msg) {
 
 	// OTCv8 version detection
 	auto otcV8StringLength = msg.get<uint16_t>();
-	if (otcV8StringLength == 5 && msg.getString(5) == "OTCv8") {
+	if (otcV8StringLength == 5 && msg.getStringView(5) == "OTCv8") {
 		otclientV8 = msg.get<uint16_t>(); // 253, 260, 261, ...
 	}
 
@@ -978,6 +1103,31 @@ void ProtocolGame::writeToOutputBuffer(NetworkMessage &msg) {
 	}
 }
 
+void ProtocolGame::writeToOutputBuffer(const SharedMessage_ptr &msg, std::span<const SharedMessagePatch> patches) {
+	if (g_dispatcher().context().isAsync()) {
+		g_dispatcher().addEvent([self = getThis(), msg, patches = std::vector(patches.begin(), patches.end())] {
+			self->getOutputBuffer(msg->getLength())->append(*msg, patches);
+		},
+		                        __FUNCTION__);
+	} else {
+		getOutputBuffer(msg->getLength())->append(*msg, patches);
+	}
+}
+
+const SharedMessage_ptr &ProtocolBroadcast::getMessage(bool oldProtocol) {
+	auto &message = messages[oldProtocol ? 1 : 0];
+	if (!message) {
+		NetworkMessage msg;
+		writer(msg, oldProtocol);
+		message = OutputMessagePool::getSharedMessage(msg);
+	}
+	return message;
+}
+
+void ProtocolGame::sendBroadcast(ProtocolBroadcast &broadcast) {
+	writeToOutputBuffer(broadcast.getMessage(oldProtocol));
+}
+
 void ProtocolGame::parsePacket(NetworkMessage &msg) {
 	if (!acceptPackets || g_game().getGameState() == GAME_STATE_SHUTDOWN || msg.getLength() <= 0) {
 		return;
@@ -1474,27 +1624,25 @@ void ProtocolGame::GetTileDescription(const std::shared_ptr<Tile> &tile, Network
 		msg.add<uint16_t>(0x00); // Env effects
 	}
 
-	int32_t count;
-	std::shared_ptr<Item> ground = tile->getGround();
-	if (ground) {
-		AddItem(msg, ground);
-		count = 1;
-	} else {
-		count = 0;
-	}
-
-	const TileItemVector* items = tile->getItemList();
-	if (items) {
-		for (auto it = items->getBeginTopItem(), end = items->getEndTopItem(); it != end; ++it) {
-			AddItem(msg, *it);
+	std::unique_ptr<uint8_t[]> uncached;
+	const uint8_t* encoding = getTileItemsEncoding(tile, uncached);
+	TileItemsEncoding header;
+	std::memcpy(&header, encoding, sizeof(header));
+	const auto addItems = [&msg, &header, bytes = reinterpret_cast<const char*>(encoding + sizeof(header))](uint8_t first, uint8_t last) {
+		const uint16_t begin = first == 0 ? 0 : header.ends[first - 1];
+		msg.addBytes(bytes + begin, header.ends[last - 1] - begin);
+	};
 
-			count++;
-			if (count == 9 && tile->getPosition() == player->getPosition()) {
-				break;
-			} else if (count == 10) {
-				return;
-			}
-		}
+	const bool isViewerTile = tile->getPosition() == player->getPosition();
+	int32_t count = header.topItems;
+	if (isViewerTile && count >= MAX_TILE_THINGS - 1) {
+		count = MAX_TILE_THINGS - 1;
+	}
+	if (count > 0) {
+		addItems(0, static_cast<uint8_t>(count));
+	}
+	if (count == MAX_TILE_THINGS) {
+		return;
 	}
 
 	const CreatureVector* creatures = tile->getCreatures();
@@ -1505,7 +1653,7 @@ void ProtocolGame::GetTileDescription(const std::shared_ptr<Tile> &tile, Network
 				continue;
 			}
 
-			if (tile->getPosition() == player->getPosition() && count == 9 && !playerAdded) {
+			if (isViewerTile && count == 9 && !playerAdded) {
 				creature = player;
 			}
 
@@ -1518,21 +1666,67 @@ void ProtocolGame::GetTileDescription(const std::shared_ptr<Tile> &tile, Network
 			checkCreatureAsKnown(creature->getID(), known, removedKnown);
 			AddCreature(msg, creature, known, removedKnown);
 
-			if (++count == 10) {
+			if (++count == MAX_TILE_THINGS) {
 				return;
 			}
 		}
 	}
 
+	const auto downItems = std::min<int32_t>(header.items - header.topItems, MAX_TILE_THINGS - count);
+	if (downItems > 0) {
+		addItems(header.topItems, static_cast<uint8_t>(header.topItems + downItems));
+	}
+}
+
+const uint8_t* ProtocolGame::getTileItemsEncoding(const std::shared_ptr<Tile> &tile, std::unique_ptr<uint8_t[]> &uncached) {
+	// AddItem differs between old protocol and OTC clients only
+	const uint8_t variant = (oldProtocol ? 1 : 0) | (isOTCR ? 2 : 0);
+	if (const uint8_t* cache = tile->getDescriptionCache(); cache && cache[offsetof(TileItemsEncoding, variant)] == variant) {
+		return cache;
+	}
+
+	static thread_local NetworkMessage scratch;
+	scratch.reset();
+
+	TileItemsEncoding header;
+	header.variant = variant;
+	bool cacheable = true;
+	const auto addItem = [&](const std::shared_ptr<Item> &item) {
+		cacheable = cacheable && canCacheItemEncoding(item);
+		AddItem(scratch, item);
+		header.ends[header.items++] = scratch.getLength();
+	};
+
+	if (const auto &ground = tile->getGround()) {
+		addItem(ground);
+	}
+
+	const TileItemVector* items = tile->getItemList();
 	if (items) {
-		for (auto it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end; ++it) {
-			AddItem(msg, *it);
+		for (auto it = items->getBeginTopItem(), end = items->getEndTopItem(); it != end && header.items < MAX_TILE_THINGS; ++it) {
+			addItem(*it);
+		}
+	}
+	header.topItems = header.items;
 
-			if (++count == 10) {
-				return;
-			}
+	if (items) {
+		const uint8_t maxItems = header.topItems + MAX_TILE_THINGS - std::min<uint8_t>(header.topItems, MAX_TILE_THINGS - 1);
+		for (auto it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end && header.items < maxItems; ++it) {
+			addItem(*it);
 		}
 	}
+
+	auto encoding = std::make_unique<uint8_t[]>(sizeof(header) + scratch.getLength());
+	std::memcpy(encoding.get(), &header, sizeof(header));
+	std::memcpy(encoding.get() + sizeof(header), scratch.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION, scratch.getLength());
+
+	const uint8_t* data = encoding.get();
+	if (cacheable) {
+		tile->setDescriptionCache(std::move(encoding));
+	} else {
+		uncached = std::move(encoding);
+	}
+	return data;
 }
 
 void ProtocolGame::GetMapDescription(int32_t x, int32_t y, int32_t z, int32_t width, int32_t height, NetworkMessage &msg) {
@@ -1583,45 +1777,15 @@ void ProtocolGame::GetFloorDescription(NetworkMessage &msg, int32_t x, int32_t y
 }
 
 void ProtocolGame::checkCreatureAsKnown(uint32_t id, bool &known, uint32_t &removedKnown) {
-	if (auto [creatureKnown, creatureInserted] = knownCreatureSet.insert(id);
-	    !creatureInserted) {
-		known = true;
-		return;
-	}
-	known = false;
-	if (knownCreatureSet.size() > 1300) {
-		// Look for a creature to remove
-		for (auto it = knownCreatureSet.begin(), end = knownCreatureSet.end(); it != end; ++it) {
-			if (*it == id) {
-				continue;
-			}
-			// We need to protect party players from removing
-			const auto &creature = g_game().getCreatureByID(*it);
-			const auto &checkPlayer = creature ? creature->getPlayer() : nullptr;
-			if (checkPlayer) {
-				if (player->getParty() != checkPlayer->getParty() && !canSee(creature)) {
-					removedKnown = *it;
-					knownCreatureSet.erase(it);
-					return;
-				}
-			} else if (!canSee(creature)) {
-				removedKnown = *it;
-				knownCreatureSet.erase(it);
-				return;
-			}
-		}
-
-		// Bad situation. Let's just remove anyone.
-		auto it = knownCreatureSet.begin();
-		if (*it == id) {
-			++it;
+	std::tie(known, removedKnown) = knownCreatures.insert(id, [this](uint32_t knownId) {
+		const auto &creature = g_game().getCreatureByID(knownId);
+		// We need to protect party players from removing
+		const auto &checkPlayer = creature ? creature->getPlayer() : nullptr;
+		if (checkPlayer && player->getParty() && player->getParty() == checkPlayer->getParty()) {
+			return false;
 		}
-
-		removedKnown = *it;
-		knownCreatureSet.erase(it);
-	} else {
-		removedKnown = 0;
-	}
+		return !canSee(creature);
+	});
 }
 
 bool ProtocolGame::canSee(const std::shared_ptr<Creature> &c) const {
@@ -1976,14 +2140,14 @@ void ProtocolGame::parseQuickLootBlackWhitelist(NetworkMessage &msg) {
 }
 
 void ProtocolGame::parseSay(NetworkMessage &msg) {
-	std::string receiver;
+	std::string_view receiver;
 	uint16_t channelId {};
 
 	auto type = static_cast<SpeakClasses>(msg.getByte());
 	switch (type) {
 		case TALKTYPE_PRIVATE_TO:
 		case TALKTYPE_PRIVATE_RED_TO:
-			receiver = msg.getString();
+			receiver = msg.getStringView();
 			channelId = 0;
 			break;
 
@@ -1997,7 +2161,7 @@ void ProtocolGame::parseSay(NetworkMessage &msg) {
 			break;
 	}
 
-	const std::string text = msg.getString();
+	const auto text = msg.getStringView();
 	if (text.length() > 255) {
 		return;
 	}
@@ -3080,7 +3244,7 @@ void ProtocolGame::parseBestiarySendCreatures(NetworkMessage &msg) {
 
 	if (search == 1) {
 		auto monsterAmount = msg.get<uint16_t>();
-		std::map<uint16_t, std::string> mtype_list = g_game().getBestiaryList();
+		const auto &mtype_list = g_game().getBestiaryList();
 		for (uint16_t monsterCount = 1; monsterCount <= monsterAmount; monsterCount++) {
 			auto raceid = msg.get<uint16_t>();
 			if (player->getBestiaryKillCount(raceid) > 0) {
@@ -3091,7 +3255,7 @@ void ProtocolGame::parseBestiarySendCreatures(NetworkMessage &msg) {
 			}
 		}
 	} else {
-		std::string raceName = msg.getString();
+		const auto raceName = msg.getStringView();
 		race = g_iobestiary().findRaceByName(raceName);
 
 		if (race.empty()) {
@@ -3383,7 +3547,7 @@ void ProtocolGame::sendCreatureOutfit(const std::shared_ptr<Creature> &creature,
 }
 
 void ProtocolGame::sendCreatureLight(const std::shared_ptr<Creature> &creature) {
-	if (!canSee(creature)) {
+	if (!canSee(creature) || deferWhileCongested(deferredLight, creature)) {
 		return;
 	}
 
@@ -4508,9 +4672,14 @@ void ProtocolGame::sendReLoginWindow(uint8_t unfairFightReduction) {
 }
 
 void ProtocolGame::sendStats() {
+	if (loggedIn) {
+		requestStatusBlock(STATUS_BLOCK_STATS);
+		return;
+	}
+
 	NetworkMessage msg;
 	AddPlayerStats(msg);
-	writeToOutputBuffer(msg);
+	writeStatusBlock(STATUS_BLOCK_STATS, msg);
 }
 
 void ProtocolGame::sendBasicData() {
@@ -4901,7 +5070,7 @@ void ProtocolGame::sendIcons(const std::unordered_set<PlayerIcon> &iconSet, cons
 		msg.addByte(enumToValue(iconBakragore)); // Icons Bakragore
 	}
 
-	writeToOutputBuffer(msg);
+	writeIcons(msg);
 }
 
 void ProtocolGame::sendIconBakragore(const IconBakragore icon) {
@@ -4909,7 +5078,28 @@ void ProtocolGame::sendIconBakragore(const IconBakragore icon) {
 	msg.addByte(0xA2);
 	msg.add<uint64_t>(0); // Send empty normal icons
 	msg.addByte(enumToValue(icon));
-	writeToOutputBuffer(msg);
+	writeIcons(msg);
+}
+
+void ProtocolGame::writeIcons(NetworkMessage &msg) {
+	if (!loggedIn) {
+		writeStatusBlock(STATUS_BLOCK_ICONS, msg);
+		return;
+	}
+
+	// Only the last icons packet of the cycle matters, whoever sent it
+	std::string icons(reinterpret_cast<const char*>(msg.getBuffer()) + NetworkMessage::INITIAL_BUFFER_POSITION, msg.getLength());
+	if (g_dispatcher().context().isAsync()) {
+		g_dispatcher().addEvent([self = getThis(), icons = std::move(icons)]() mutable {
+			self->pendingIcons = std::move(icons);
+			self->requestStatusBlock(STATUS_BLOCK_ICONS);
+		},
+		                        __FUNCTION__);
+		return;
+	}
+
+	pendingIcons = std::move(icons);
+	requestStatusBlock(STATUS_BLOCK_ICONS);
 }
 
 void ProtocolGame::sendUnjustifiedPoints(const uint8_t &dayProgress, const uint8_t &dayLeft, const uint8_t &weekProgress, const uint8_t &weekLeft, const uint8_t &monthProgress, const uint8_t &monthLeft, const uint8_t &skullDuration) {
@@ -6513,7 +6703,37 @@ void ProtocolGame::sendCreatureTurn(const std::shared_ptr<Creature> &creature, u
 	writeToOutputBuffer(msg);
 }
 
-void ProtocolGame::sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos /* = nullptr*/) {
+namespace {
+	// Offsets of the viewer dependent bytes of the creature turn packet: opcode, position, stackpos, 0x63, id, direction, walkthrough
+	constexpr uint16_t CREATURE_TURN_STACKPOS_OFFSET = 1 + 5;
+	constexpr uint16_t CREATURE_TURN_WALKTHROUGH_OFFSET = CREATURE_TURN_STACKPOS_OFFSET + 1 + 2 + 4 + 1;
+}
+
+ProtocolBroadcast ProtocolGame::broadcastCreatureTurn(const std::shared_ptr<Creature> &creature) {
+	return ProtocolBroadcast([creature](NetworkMessage &msg, bool) {
+		msg.addByte(0x6B);
+		msg.addPosition(creature->getPosition());
+		msg.addByte(0x00); // stackpos, patched per viewer
+		msg.add<uint16_t>(0x63);
+		msg.add<uint32_t>(creature->getID());
+		msg.addByte(creature->getDirection());
+		msg.addByte(0x01); // walkthrough, patched per viewer
+	});
+}
+
+void ProtocolGame::sendCreatureTurn(const std::shared_ptr<Creature> &creature, uint32_t stackPos, ProtocolBroadcast &broadcast) {
+	if (!canSee(creature)) {
+		return;
+	}
+
+	const std::array<SharedMessagePatch, 2> patches {
+		SharedMessagePatch { CREATURE_TURN_STACKPOS_OFFSET, static_cast<uint8_t>(stackPos) },
+		SharedMessagePatch { CREATURE_TURN_WALKTHROUGH_OFFSET, static_cast<uint8_t>(player->canWalkthroughEx(creature) ? 0x00 : 0x01) },
+	};
+	writeToOutputBuffer(broadcast.getMessage(oldProtocol), patches);
+}
+
+void ProtocolGame::sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, std::string_view text, const Position* pos /* = nullptr*/) {
 	NetworkMessage msg;
 	msg.addByte(0xAA);
 
@@ -6549,7 +6769,7 @@ void ProtocolGame::sendCreatureSay(const std::shared_ptr<Creature> &creature, Sp
 	writeToOutputBuffer(msg);
 }
 
-void ProtocolGame::sendToChannel(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, uint16_t channelId) {
+void ProtocolGame::sendToChannel(const std::shared_ptr<Creature> &creature, SpeakClasses type, std::string_view text, uint16_t channelId) {
 	NetworkMessage msg;
 	msg.addByte(0xAA);
 
@@ -6591,7 +6811,7 @@ void ProtocolGame::sendToChannel(const std::shared_ptr<Creature> &creature, Spea
 	writeToOutputBuffer(msg);
 }
 
-void ProtocolGame::sendPrivateMessage(const std::shared_ptr<Player> &speaker, SpeakClasses type, const std::string &text) {
+void ProtocolGame::sendPrivateMessage(const std::shared_ptr<Player> &speaker, SpeakClasses type, std::string_view text) {
 	NetworkMessage msg;
 	msg.addByte(0xAA);
 	static uint32_t statementId = 0;
@@ -6628,11 +6848,21 @@ void ProtocolGame::sendCancelTarget() {
 
 void ProtocolGame::sendChangeSpeed(const std::shared_ptr<Creature> &creature, uint16_t speed) {
 	NetworkMessage msg;
+	AddChangeSpeed(msg, creature, speed);
+	writeToOutputBuffer(msg);
+}
+
+ProtocolBroadcast ProtocolGame::broadcastChangeSpeed(const std::shared_ptr<Creature> &creature, uint16_t speed) {
+	return ProtocolBroadcast([creature, speed](NetworkMessage &msg, bool) {
+		AddChangeSpeed(msg, creature, speed);
+	});
+}
+
+void ProtocolGame::AddChangeSpeed(NetworkMessage &msg, const std::shared_ptr<Creature> &creature, uint16_t speed) {
 	msg.addByte(0x8F);
 	msg.add<uint32_t>(creature->getID());
 	msg.add<uint16_t>(creature->getBaseSpeed());
 	msg.add<uint16_t>(speed);
-	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendCancelWalk() {
@@ -6645,9 +6875,14 @@ void ProtocolGame::sendCancelWalk() {
 }
 
 void ProtocolGame::sendSkills() {
+	if (loggedIn) {
+		requestStatusBlock(STATUS_BLOCK_SKILLS);
+		return;
+	}
+
 	NetworkMessage msg;
 	AddPlayerSkills(msg);
-	writeToOutputBuffer(msg);
+	writeStatusBlock(STATUS_BLOCK_SKILLS, msg);
 }
 
 void ProtocolGame::sendPing() {
@@ -6669,6 +6904,24 @@ void ProtocolGame::sendDistanceShoot(const Position &from, const Position &to, u
 		return;
 	}
 	NetworkMessage msg;
+	AddDistanceShoot(msg, from, to, type, oldProtocol);
+	writeToOutputBuffer(msg);
+}
+
+ProtocolBroadcast ProtocolGame::broadcastDistanceShoot(const Position &from, const Position &to, uint16_t type) {
+	return ProtocolBroadcast([from, to, type](NetworkMessage &msg, bool oldProtocol) {
+		AddDistanceShoot(msg, from, to, type, oldProtocol);
+	});
+}
+
+void ProtocolGame::sendDistanceShoot(const Position &from, const Position &to, uint16_t type, ProtocolBroadcast &broadcast) {
+	if (oldProtocol && type > 0xFF) {
+		return;
+	}
+	writeToOutputBuffer(broadcast.getMessage(oldProtocol));
+}
+
+void ProtocolGame::AddDistanceShoot(NetworkMessage &msg, const Position &from, const Position &to, uint16_t type, bool oldProtocol) {
 	if (oldProtocol) {
 		msg.addByte(0x85);
 		msg.addPosition(from);
@@ -6683,7 +6936,6 @@ void ProtocolGame::sendDistanceShoot(const Position &from, const Position &to, u
 		msg.addByte(static_cast<uint8_t>(static_cast<int8_t>(static_cast<int32_t>(to.y) - static_cast<int32_t>(from.y))));
 		msg.addByte(MAGIC_EFFECTS_END_LOOP);
 	}
-	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendRestingStatus(uint8_t protection) {
@@ -6737,6 +6989,24 @@ void ProtocolGame::sendMagicEffect(const Position &pos, uint16_t type) {
 	}
 
 	NetworkMessage msg;
+	AddMagicEffect(msg, pos, type, oldProtocol);
+	writeToOutputBuffer(msg);
+}
+
+ProtocolBroadcast ProtocolGame::broadcastMagicEffect(const Position &pos, uint16_t type) {
+	return ProtocolBroadcast([pos, type](NetworkMessage &msg, bool oldProtocol) {
+		AddMagicEffect(msg, pos, type, oldProtocol);
+	});
+}
+
+void ProtocolGame::sendMagicEffect(const Position &pos, uint16_t type, ProtocolBroadcast &broadcast) {
+	if (!canSee(pos) || (oldProtocol && type > 0xFF)) {
+		return;
+	}
+	writeToOutputBuffer(broadcast.getMessage(oldProtocol));
+}
+
+void ProtocolGame::AddMagicEffect(NetworkMessage &msg, const Position &pos, uint16_t type, bool oldProtocol) {
 	if (oldProtocol) {
 		msg.addByte(0x83);
 		msg.addPosition(pos);
@@ -6748,7 +7018,6 @@ void ProtocolGame::sendMagicEffect(const Position &pos, uint16_t type) {
 		msg.add<uint16_t>(type);
 		msg.addByte(MAGIC_EFFECTS_END_LOOP);
 	}
-	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::removeMagicEffect(const Position &pos, uint16_t type) {
@@ -6767,11 +7036,29 @@ void ProtocolGame::removeMagicEffect(const Position &pos, uint16_t type) {
 }
 
 void ProtocolGame::sendCreatureHealth(const std::shared_ptr<Creature> &creature) {
-	if (creature->isHealthHidden()) {
+	if (creature->isHealthHidden() || deferWhileCongested(deferredHealth, creature)) {
 		return;
 	}
 
 	NetworkMessage msg;
+	AddCreatureHealth(msg, creature);
+	writeToOutputBuffer(msg);
+}
+
+ProtocolBroadcast ProtocolGame::broadcastCreatureHealth(const std::shared_ptr<Creature> &creature) {
+	return ProtocolBroadcast([creature](NetworkMessage &msg, bool) {
+		AddCreatureHealth(msg, creature);
+	});
+}
+
+void ProtocolGame::sendCreatureHealth(const std::shared_ptr<Creature> &creature, ProtocolBroadcast &broadcast) {
+	if (creature->isHealthHidden() || deferWhileCongested(deferredHealth, creature)) {
+		return;
+	}
+	writeToOutputBuffer(broadcast.getMessage(oldProtocol));
+}
+
+void ProtocolGame::AddCreatureHealth(NetworkMessage &msg, const std::shared_ptr<Creature> &creature) {
 	msg.addByte(0x8C);
 	msg.add<uint32_t>(creature->getID());
 	if (creature->isHealthHidden()) {
@@ -6779,8 +7066,6 @@ void ProtocolGame::sendCreatureHealth(const std::shared_ptr<Creature> &creature)
 	} else {
 		msg.addByte(static_cast<uint8_t>(std::min<double>(100, std::ceil((static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) * 100))));
 	}
-
-	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendPartyCreatureUpdate(const std::shared_ptr<Creature> &target) {
@@ -6803,7 +7088,7 @@ void ProtocolGame::sendPartyCreatureUpdate(const std::shared_ptr<Creature> &targ
 
 void ProtocolGame::sendPartyCreatureShield(const std::shared_ptr<Creature> &target) {
 	uint32_t cid = target->getID();
-	if (!knownCreatureSet.contains(cid)) {
+	if (!knownCreatures.contains(cid)) {
 		sendPartyCreatureUpdate(target);
 		return;
 	}
@@ -6821,7 +7106,7 @@ void ProtocolGame::sendPartyCreatureSkull(const std::shared_ptr<Creature> &targe
 	}
 
 	uint32_t cid = target->getID();
-	if (!knownCreatureSet.contains(cid)) {
+	if (!knownCreatures.contains(cid)) {
 		sendPartyCreatureUpdate(target);
 		return;
 	}
@@ -6835,7 +7120,7 @@ void ProtocolGame::sendPartyCreatureSkull(const std::shared_ptr<Creature> &targe
 
 void ProtocolGame::sendPartyCreatureHealth(const std::shared_ptr<Creature> &target, uint8_t healthPercent) {
 	uint32_t cid = target->getID();
-	if (!knownCreatureSet.contains(cid)) {
+	if (!knownCreatures.contains(cid)) {
 		sendPartyCreatureUpdate(target);
 		return;
 	}
@@ -6849,7 +7134,7 @@ void ProtocolGame::sendPartyCreatureHealth(const std::shared_ptr<Creature> &targ
 
 void ProtocolGame::sendPartyPlayerMana(const std::shared_ptr<Player> &target, uint8_t manaPercent) {
 	uint32_t cid = target->getID();
-	if (!knownCreatureSet.contains(cid)) {
+	if (!knownCreatures.contains(cid)) {
 		sendPartyCreatureUpdate(target);
 	}
 
@@ -6867,7 +7152,7 @@ void ProtocolGame::sendPartyPlayerMana(const std::shared_ptr<Player> &target, ui
 
 void ProtocolGame::sendPartyCreatureShowStatus(const std::shared_ptr<Creature> &target, bool showStatus) {
 	uint32_t cid = target->getID();
-	if (!knownCreatureSet.contains(cid)) {
+	if (!knownCreatures.contains(cid)) {
 		sendPartyCreatureUpdate(target);
 	}
 
@@ -6889,7 +7174,7 @@ void ProtocolGame::sendPartyPlayerVocation(const std::shared_ptr<Player> &target
 	}
 
 	uint32_t cid = target->getID();
-	if (!knownCreatureSet.contains(cid)) {
+	if (!knownCreatures.contains(cid)) {
 		sendPartyCreatureUpdate(target);
 		return;
 	}
@@ -8825,7 +9110,7 @@ void ProtocolGame::AddShopItem(NetworkMessage &msg, const ShopBlock &shopBlock)
 
 void ProtocolGame::parseExtendedOpcode(NetworkMessage &msg) {
 	uint8_t opcode = msg.getByte();
-	const std::string &buffer = msg.getString();
+	const auto buffer = msg.getStringView();
 
 	// process additional opcodes via lua script event
 	g_game().parsePlayerExtendedOpcode(player->getID(), opcode, buffer);
@@ -8994,7 +9279,7 @@ void ProtocolGame::reloadCreature(const std::shared_ptr<Creature> &creature) {
 
 	NetworkMessage msg;
 
-	if (knownCreatureSet.contains(creature->getID())) {
+	if (knownCreatures.contains(creature->getID())) {
 		msg.addByte(0x6B);
 		msg.addPosition(creature->getPosition());
 		msg.addByte(static_cast<uint8_t>(stackpos));
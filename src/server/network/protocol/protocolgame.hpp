@@ -10,6 +10,7 @@
 #pragma once
 
 #include "server/network/protocol/protocol.hpp"
+#include "server/network/protocol/known_creatures.hpp"
 #include "game/movement/position.hpp"
 #include "utils/utils_definitions.hpp"
 
@@ -88,6 +89,36 @@ struct TextMessage {
 	} primary, secondary;
 };
 
+struct StatusUpdateStats {
+	// sendStats, sendSkills and sendIcons calls once logged in, the ones of the login are written right away
+	uint64_t requested = 0;
+	// Merged with another request of the same autosend
+	uint64_t coalesced = 0;
+	// Identical to what the client already had
+	uint64_t unchanged = 0;
+	uint64_t sent = 0;
+};
+
+/**
+ * Packet sent to every spectator of an event. It is serialized on first use,
+ * at most once per protocol version, and then only appended to the output
+ * buffer of each viewer. Bytes that depend on the viewer are patched while
+ * appending.
+ */
+class ProtocolBroadcast {
+public:
+	using Writer = std::function<void(NetworkMessage &msg, bool oldProtocol)>;
+
+	explicit ProtocolBroadcast(Writer writer) :
+		writer(std::move(writer)) { }
+
+	const SharedMessage_ptr &getMessage(bool oldProtocol);
+
+private:
+	Writer writer;
+	std::array<SharedMessage_ptr, 2> messages;
+};
+
 class ProtocolGame final : public Protocol {
 public:
 	// Static protocol information.
@@ -112,6 +143,15 @@ public:
 		return version;
 	}
 
+	// Viewer independent packets, built once and sent to many spectators
+	static ProtocolBroadcast broadcastMagicEffect(const Position &pos, uint16_t type);
+	static ProtocolBroadcast broadcastDistanceShoot(const Position &from, const Position &to, uint16_t type);
+	static ProtocolBroadcast broadcastCreatureHealth(const std::shared_ptr<Creature> &creature);
+	static ProtocolBroadcast broadcastChangeSpeed(const std::shared_ptr<Creature> &creature, uint16_t speed);
+	static ProtocolBroadcast broadcastCreatureTurn(const std::shared_ptr<Creature> &creature);
+
+	static StatusUpdateStats getStatusUpdateStats();
+
 private:
 	ProtocolGame_ptr getThis() {
 		return std::static_pointer_cast<ProtocolGame>(shared_from_this());
@@ -119,9 +159,30 @@ private:
 	void connect(const std::string &playerName, OperatingSystem_t operatingSystem);
 	void disconnectClient(const std::string &message) const;
 	void writeToOutputBuffer(NetworkMessage &msg);
+	void writeToOutputBuffer(const SharedMessage_ptr &msg, std::span<const SharedMessagePatch> patches = {});
 
 	void release() override;
 
+	// Status blocks requested between two autosends are written once, right before the buffer is sent.
+	// The window is the autosend delay rather than one dispatcher cycle: nothing reaches the client
+	// earlier, and a block changed over several cycles of the window still goes out once.
+	enum StatusBlock_t : uint8_t {
+		STATUS_BLOCK_STATS,
+		STATUS_BLOCK_SKILLS,
+		STATUS_BLOCK_ICONS,
+
+		STATUS_BLOCK_COUNT
+	};
+
+	void flushDeferredUpdates() override;
+	void requestStatusBlock(StatusBlock_t block);
+	void flushStatusBlocks();
+	// Skipped when the client already has the same bytes
+	void writeStatusBlock(StatusBlock_t block, NetworkMessage &msg);
+	void writeIcons(NetworkMessage &msg);
+	// Holds back a health or light update while the connection is congested, the latest value is sent once it drains
+	bool deferWhileCongested(std::unordered_set<uint32_t> &updates, const std::shared_ptr<Creature> &creature);
+
 	void checkCreatureAsKnown(uint32_t id, bool &known, uint32_t &removedKnown);
 
 	bool canSee(int32_t x, int32_t y, int32_t z) const;
@@ -273,8 +334,8 @@ private:
 	void sendChannel(uint16_t channelId, const std::string &channelName, const UsersMap* channelUsers, const InvitedMap* invitedUsers);
 	void sendOpenPrivateChannel(const std::string &receiver);
 	void sendExperienceTracker(int64_t rawExp, int64_t finalExp);
-	void sendToChannel(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, uint16_t channelId);
-	void sendPrivateMessage(const std::shared_ptr<Player> &speaker, SpeakClasses type, const std::string &text);
+	void sendToChannel(const std::shared_ptr<Creature> &creature, SpeakClasses type, std::string_view text, uint16_t channelId);
+	void sendPrivateMessage(const std::shared_ptr<Player> &speaker, SpeakClasses type, std::string_view text);
 	void sendIcons(const std::unordered_set<PlayerIcon> &iconSet, const IconBakragore iconBakragore);
 	void sendIconBakragore(const IconBakragore icon);
 	void sendFYIBox(const std::string &message);
@@ -309,11 +370,15 @@ private:
 	void sendBosstiaryEntryChanged(uint32_t bossid);
 
 	void sendAllowBugReport();
+	void sendBroadcast(ProtocolBroadcast &broadcast);
 	void sendDistanceShoot(const Position &from, const Position &to, uint16_t type);
+	void sendDistanceShoot(const Position &from, const Position &to, uint16_t type, ProtocolBroadcast &broadcast);
 	void sendMagicEffect(const Position &pos, uint16_t type);
+	void sendMagicEffect(const Position &pos, uint16_t type, ProtocolBroadcast &broadcast);
 	void removeMagicEffect(const Position &pos, uint16_t type);
 	void sendRestingStatus(uint8_t protection);
 	void sendCreatureHealth(const std::shared_ptr<Creature> &creature);
+	void sendCreatureHealth(const std::shared_ptr<Creature> &creature, ProtocolBroadcast &broadcast);
 	void sendPartyCreatureUpdate(const std::shared_ptr<Creature> &target);
 	void sendPartyCreatureShield(const std::shared_ptr<Creature> &target);
 	void sendPartyCreatureSkull(const std::shared_ptr<Creature> &target);
@@ -326,7 +391,8 @@ private:
 	void sendPing();
 	void sendPingBack();
 	void sendCreatureTurn(const std::shared_ptr<Creature> &creature, uint32_t stackpos);
-	void sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos = nullptr);
+	void sendCreatureTurn(const std::shared_ptr<Creature> &creature, uint32_t stackpos, ProtocolBroadcast &broadcast);
+	void sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, std::string_view text, const Position* pos = nullptr);
 
 	// Unjust Panel
 	void sendUnjustifiedPoints(const uint8_t &dayProgress, const uint8_t &dayLeft, const uint8_t &weekProgress, const uint8_t &weekLeft, const uint8_t &monthProgress, const uint8_t &monthLeft, const uint8_t &skullDuration);
@@ -468,6 +534,8 @@ private:
 	// Help functions
 	// translate a tile to clientreadable format
 	void GetTileDescription(const std::shared_ptr<Tile> &tile, NetworkMessage &msg);
+	// encoded items of a tile for this client variant, kept in the tile while they stay valid
+	const uint8_t* getTileItemsEncoding(const std::shared_ptr<Tile> &tile, std::unique_ptr<uint8_t[]> &uncached);
 
 	// translate a floor to clientreadable format
 	void GetFloorDescription(NetworkMessage &msg, int32_t x, int32_t y, int32_t z, int32_t width, int32_t height, int32_t offset, int32_t &skip);
@@ -476,6 +544,10 @@ private:
 	void GetMapDescription(int32_t x, int32_t y, int32_t z, int32_t width, int32_t height, NetworkMessage &msg);
 
 	void AddCreature(NetworkMessage &msg, const std::shared_ptr<Creature> &creature, bool known, uint32_t remove);
+	static void AddMagicEffect(NetworkMessage &msg, const Position &pos, uint16_t type, bool oldProtocol);
+	static void AddDistanceShoot(NetworkMessage &msg, const Position &from, const Position &to, uint16_t type, bool oldProtocol);
+	static void AddCreatureHealth(NetworkMessage &msg, const std::shared_ptr<Creature> &creature);
+	static void AddChangeSpeed(NetworkMessage &msg, const std::shared_ptr<Creature> &creature, uint16_t speed);
 	void AddPlayerStats(NetworkMessage &msg);
 	void AddOutfit(NetworkMessage &msg, const Outfit_t &outfit, bool addMount = true);
 	void AddPlayerSkills(NetworkMessage &msg);
@@ -535,7 +607,13 @@ private:
 	friend class PlayerVIP;
 	friend class PlayerAttachedEffects;
 
-	std::unordered_set<uint32_t> knownCreatureSet;
+	KnownCreatures knownCreatures;
+	std::unordered_set<uint32_t> deferredHealth;
+	std::unordered_set<uint32_t> deferredLight;
+	std::array<std::string, STATUS_BLOCK_COUNT> sentStatusBlocks;
+	// Icons are computed by the player, the body of the latest packet waits here
+	std::string pendingIcons;
+	uint8_t pendingStatusBlocks = 0;
 	std::shared_ptr<Player> player = nullptr;
 
 	uint32_t eventConnect = 0;
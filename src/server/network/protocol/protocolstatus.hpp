@@ -38,4 +38,6 @@ public:
 
 private:
 	static std::map<uint32_t, int64_t> ipConnectMap;
+	// Status requests may arrive on several network threads at once
+	static std::mutex ipConnectMapMutex;
 };
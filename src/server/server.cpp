@@ -34,7 +34,25 @@ void ServiceManager::run() {
 
 	assert(!running);
 	running = true;
+
+	// Every connection runs its handlers through its own strand, so any of these threads can serve it
+	auto threadCount = g_configManager().getNumber(NETWORK_THREADS);
+	if (threadCount <= 0) {
+		threadCount = static_cast<int32_t>(std::max<uint32_t>(std::thread::hardware_concurrency(), 1));
+	}
+	g_logger().info("Network running with {} threads.", threadCount);
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+	for (int32_t i = 1; i < threadCount; ++i) {
+		threads.emplace_back([this] { io_service.run(); });
+	}
+
 	io_service.run();
+
+	for (auto &thread : threads) {
+		thread.join();
+	}
 }
 
 void ServiceManager::stop() {
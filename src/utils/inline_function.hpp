@@ -0,0 +1,207 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include "utils/lockfree.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Block used by InlineFunction for captures that do not fit its inline buffer.
+ */
+struct alignas(std::max_align_t) InlineFunctionBlock {
+	static constexpr size_t SIZE = 256;
+	static constexpr size_t POOL_CAPACITY = 4096;
+
+	std::byte data[SIZE];
+
+	/**
+	 * @brief Number of times a callable had to go to the general heap
+	 * (pool exhausted or capture bigger than a block).
+	 */
+	static uint64_t heapAllocations() {
+		return allocations.load(std::memory_order_relaxed);
+	}
+
+	static void* allocate() {
+		InlineFunctionBlock* block;
+		if (LockfreeFreeList<InlineFunctionBlock, POOL_CAPACITY>::get().try_pop(block)) {
+			return block;
+		}
+
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		return ::operator new(sizeof(InlineFunctionBlock));
+	}
+
+	static void deallocate(void* p) {
+		if (LockfreeFreeList<InlineFunctionBlock, POOL_CAPACITY>::get().try_push(static_cast<InlineFunctionBlock*>(p))) {
+			return;
+		}
+		::operator delete(p);
+	}
+
+	static inline std::atomic_uint64_t allocations = 0;
+};
+
+template <typename Signature, size_t Capacity = 64>
+class InlineFunction;
+
+template <typename T>
+struct is_std_function : std::false_type { };
+
+template <typename Signature>
+struct is_std_function<std::function<Signature>> : std::true_type { };
+
+/**
+ * @brief Move-only replacement for std::function with small buffer storage.
+ *
+ * Callables up to `Capacity` bytes are constructed in place, bigger ones use a
+ * pooled InlineFunctionBlock and only go to the heap when the pool is empty or
+ * the capture does not fit a block, so moving tasks around the dispatcher does
+ * not allocate in steady state.
+ */
+template <typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity> {
+public:
+	InlineFunction() noexcept = default;
+	InlineFunction(std::nullptr_t) noexcept { }
+
+	template <typename F, typename Fn = std::decay_t<F>>
+		requires(!std::is_same_v<Fn, InlineFunction> && std::is_invocable_r_v<R, Fn &, Args...>)
+	InlineFunction(F &&f) {
+		// Keeps empty std::function and null function pointers empty
+		if constexpr (std::is_pointer_v<Fn> || std::is_member_pointer_v<Fn> || is_std_function<Fn>::value) {
+			if (f == nullptr) {
+				return;
+			}
+		}
+
+		if constexpr (isInline<Fn>()) {
+			std::construct_at(reinterpret_cast<Fn*>(storage), std::forward<F>(f));
+			vtable = &inlineVTable<Fn>;
+		} else {
+			void* memory;
+			if constexpr (sizeof(Fn) <= InlineFunctionBlock::SIZE && alignof(Fn) <= alignof(InlineFunctionBlock)) {
+				memory = InlineFunctionBlock::allocate();
+			} else {
+				InlineFunctionBlock::allocations.fetch_add(1, std::memory_order_relaxed);
+				memory = ::operator new(sizeof(Fn), std::align_val_t { alignof(Fn) });
+			}
+			*reinterpret_cast<Fn**>(storage) = std::construct_at(static_cast<Fn*>(memory), std::forward<F>(f));
+			vtable = &outlineVTable<Fn>;
+		}
+	}
+
+	InlineFunction(InlineFunction &&other) noexcept {
+		moveFrom(other);
+	}
+
+	InlineFunction &operator=(InlineFunction &&other) noexcept {
+		if (this != &other) {
+			reset();
+			moveFrom(other);
+		}
+		return *this;
+	}
+
+	InlineFunction &operator=(std::nullptr_t) noexcept {
+		reset();
+		return *this;
+	}
+
+	// Ensures that we don't accidentally copy it
+	InlineFunction(const InlineFunction &) = delete;
+	InlineFunction &operator=(const InlineFunction &) = delete;
+
+	~InlineFunction() {
+		reset();
+	}
+
+	explicit operator bool() const noexcept {
+		return vtable != nullptr;
+	}
+
+	bool operator==(std::nullptr_t) const noexcept {
+		return vtable == nullptr;
+	}
+
+	R operator()(Args... args) const {
+		return vtable->invoke(storage, std::forward<Args>(args)...);
+	}
+
+private:
+	struct VTable {
+		R (*invoke)(void*, Args &&...);
+		// Move constructs into dst and destroys src
+		void (*relocate)(void* dst, void* src) noexcept;
+		void (*destroy)(void*) noexcept;
+	};
+
+	template <typename Fn>
+	static constexpr bool isInline() {
+		return sizeof(Fn) <= Capacity && alignof(Fn) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<Fn>;
+	}
+
+	template <typename Fn>
+	static constexpr VTable inlineVTable {
+		[](void* s, Args &&... args) -> R {
+			return std::invoke(*std::launder(reinterpret_cast<Fn*>(s)), std::forward<Args>(args)...);
+		},
+		[](void* dst, void* src) noexcept {
+			auto* fn = std::launder(reinterpret_cast<Fn*>(src));
+			std::construct_at(reinterpret_cast<Fn*>(dst), std::move(*fn));
+			std::destroy_at(fn);
+		},
+		[](void* s) noexcept {
+			std::destroy_at(std::launder(reinterpret_cast<Fn*>(s)));
+		}
+	};
+
+	template <typename Fn>
+	static constexpr VTable outlineVTable {
+		[](void* s, Args &&... args) -> R {
+			return std::invoke(**reinterpret_cast<Fn**>(s), std::forward<Args>(args)...);
+		},
+		[](void* dst, void* src) noexcept {
+			*reinterpret_cast<Fn**>(dst) = *reinterpret_cast<Fn**>(src);
+		},
+		[](void* s) noexcept {
+			auto* fn = *reinterpret_cast<Fn**>(s);
+			std::destroy_at(fn);
+			if constexpr (sizeof(Fn) <= InlineFunctionBlock::SIZE && alignof(Fn) <= alignof(InlineFunctionBlock)) {
+				InlineFunctionBlock::deallocate(fn);
+			} else {
+				::operator delete(fn, std::align_val_t { alignof(Fn) });
+			}
+		}
+	};
+
+	void moveFrom(InlineFunction &other) noexcept {
+		if (other.vtable) {
+			other.vtable->relocate(storage, other.storage);
+			vtable = std::exchange(other.vtable, nullptr);
+		}
+	}
+
+	void reset() noexcept {
+		if (vtable) {
+			std::exchange(vtable, nullptr)->destroy(storage);
+		}
+	}
+
+	alignas(std::max_align_t) mutable std::byte storage[Capacity];
+	const VTable* vtable = nullptr;
+};
@@ -0,0 +1,107 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include <bit>
+#include <memory>
+
+// FIFO queue over a power of two circular array, growing when full.
+// Unlike std::list it does not allocate per element and keeps the
+// elements contiguous, unlike std::deque it reuses its storage forever.
+
+namespace stdext {
+	template <typename T>
+	class ringbuffer {
+	public:
+		ringbuffer() = default;
+
+		explicit ringbuffer(size_t reserveSize) {
+			reserve(reserveSize);
+		}
+
+		void push_back(T &&value) {
+			if (count == capacity) {
+				reserve(capacity == 0 ? 16 : capacity * 2);
+			}
+			data[(head + count) & (capacity - 1)] = std::move(value);
+			++count;
+		}
+
+		void push_back(const T &value) {
+			T copy = value;
+			push_back(std::move(copy));
+		}
+
+		template <class... _Valty>
+		void emplace_back(_Valty &&... v) {
+			push_back(T(std::forward<_Valty>(v)...));
+		}
+
+		T &front() {
+			return data[head];
+		}
+
+		const T &front() const {
+			return data[head];
+		}
+
+		void pop_front() {
+			data[head] = T();
+			head = (head + 1) & (capacity - 1);
+			--count;
+		}
+
+		// Index relative to the front
+		T &operator[](size_t index) {
+			return data[(head + index) & (capacity - 1)];
+		}
+
+		const T &operator[](size_t index) const {
+			return data[(head + index) & (capacity - 1)];
+		}
+
+		void reserve(size_t newCapacity) {
+			newCapacity = std::bit_ceil(newCapacity);
+			if (newCapacity <= capacity) {
+				return;
+			}
+
+			auto newData = std::make_unique<T[]>(newCapacity);
+			for (size_t i = 0; i < count; ++i) {
+				newData[i] = std::move((*this)[i]);
+			}
+
+			data = std::move(newData);
+			capacity = newCapacity;
+			head = 0;
+		}
+
+		void clear() {
+			while (count > 0) {
+				pop_front();
+			}
+			head = 0;
+		}
+
+		size_t size() const noexcept {
+			return count;
+		}
+
+		bool empty() const noexcept {
+			return count == 0;
+		}
+
+	private:
+		std::unique_ptr<T[]> data;
+		size_t capacity = 0;
+		size_t head = 0;
+		size_t count = 0;
+	};
+}
@@ -64,3 +64,43 @@ __forceinline unsigned int mm_ctz(unsigned int value) {
 #else
 	#define mm_ctz __builtin_ctz
 #endif
+
+// Runtime CPU feature detection, for code paths built for a wider instruction set
+// than the binary baseline (-march=x86-64 only guarantees SSE2)
+#if defined(__GNUC__) && !defined(_MSC_VER) && (defined(__x86_64__) || defined(__i386__))
+	#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define SIMD_TARGET_AVX2
+#endif
+
+namespace simd {
+	inline bool hasAVX2() {
+#if defined(__DISABLE_VECTORIZATION__) || !defined(__SSE2__)
+		return false;
+#elif defined(_MSC_VER)
+		static const bool supported = [] {
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7) {
+				return false;
+			}
+			__cpuid(info, 1);
+			// OSXSAVE and AVX, then the OS must save the YMM state
+			if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 0x6) != 0x6) {
+				return false;
+			}
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+		}();
+		return supported;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+		static const bool supported = [] {
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") != 0;
+		}();
+		return supported;
+#else
+		return false;
+#endif
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Counts every global operator new done by the benchmark binary,
+ * the replacement operators are defined in main.cpp.
+ */
+struct AllocationCounter {
+	static uint64_t get() {
+		return allocations.load(std::memory_order_relaxed);
+	}
+
+	static inline std::atomic_uint64_t allocations = 0;
+};
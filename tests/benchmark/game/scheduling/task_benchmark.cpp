@@ -0,0 +1,84 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "allocation_counter.hpp"
+#include "game/scheduling/task.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr size_t ROUNDS = 50;
+	constexpr size_t TASKS_PER_ROUND = 20'000;
+
+	// The previous Task layout: type erased through std::function and owning its context name
+	struct LegacyTask {
+		LegacyTask(std::function<void(void)> &&f, std::string_view context, uint32_t, bool, bool) :
+			func(std::move(f)), context(context) { }
+
+		bool execute() const {
+			func();
+			return true;
+		}
+
+		std::function<void(void)> func;
+		std::string context;
+	};
+
+	struct Payload {
+		std::shared_ptr<int> owner = std::make_shared<int>(0);
+		uint32_t creatureId = 0x10000001;
+		uint32_t playerId = 0x10000002;
+		uint16_t x = 32000;
+		uint16_t y = 32000;
+		uint8_t z = 7;
+	};
+
+	// Same shape as Dispatcher::addEvent + executeSerialEvents: fill a reserved per-tick vector, run it and clear it
+	template <typename T>
+	std::pair<double, uint64_t> run(size_t &executed) {
+		std::vector<T> tasks;
+		tasks.reserve(TASKS_PER_ROUND);
+		const Payload payload;
+
+		const auto allocationsBefore = AllocationCounter::get();
+		Benchmark bm;
+		for (size_t round = 0; round < ROUNDS; ++round) {
+			for (size_t i = 0; i < TASKS_PER_ROUND; ++i) {
+				tasks.emplace_back(
+					[payload, &executed] { executed += payload.creatureId != 0; }, "ProtocolGame::parsePacketFromDispatcher", 0, false, false
+				);
+			}
+
+			for (const auto &task : tasks) {
+				task.execute();
+			}
+			tasks.clear();
+		}
+
+		return { bm.duration(), AllocationCounter::get() - allocationsBefore };
+	}
+}
+
+suite<"task_benchmark"> taskBenchmark = [] {
+	test("steady state task creation does not touch the heap") = [] {
+		size_t legacyExecuted = 0;
+		const auto [legacyTime, legacyAllocations] = run<LegacyTask>(legacyExecuted);
+
+		// Warm up the context interning and the callable pool
+		size_t executed = 0;
+		run<Task>(executed);
+
+		const auto poolMissesBefore = InlineFunctionBlock::heapAllocations();
+		const auto [taskTime, taskAllocations] = run<Task>(executed);
+
+		fmt::print(
+			"[task] {} tasks, std::function + std::string: {:.2f} ms / {} allocations, TaskFunction + interned context: {:.2f} ms / {} allocations\n",
+			ROUNDS * TASKS_PER_ROUND, legacyTime, legacyAllocations, taskTime, taskAllocations
+		);
+
+		expect(eq(legacyExecuted * 2, executed));
+		expect(eq(taskAllocations, 0U));
+		expect(eq(InlineFunctionBlock::heapAllocations(), poolMissesBefore));
+	};
+};
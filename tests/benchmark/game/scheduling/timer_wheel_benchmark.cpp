@@ -0,0 +1,128 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "game/scheduling/task.hpp"
+#include "game/scheduling/timer_wheel.hpp"
+#include "utils/tools.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr size_t TASKS = 2'000'000;
+	constexpr int64_t TICK = 50;
+
+	// Mix of walk/condition/decay/spawn like delays
+	std::vector<uint32_t> generateDelays() {
+		std::mt19937 rng(42);
+		std::vector<uint32_t> delays;
+		delays.reserve(TASKS);
+		for (size_t i = 0; i < TASKS; ++i) {
+			switch (rng() % 4) {
+				case 0:
+					delays.emplace_back(50 + rng() % 450);
+					break;
+				case 1:
+					delays.emplace_back(1000 + rng() % 2000);
+					break;
+				case 2:
+					delays.emplace_back(10000 + rng() % 600000);
+					break;
+				default:
+					delays.emplace_back(60000 + rng() % 3600000);
+					break;
+			}
+		}
+		return delays;
+	}
+
+	struct LegacyCompare {
+		bool operator()(const std::shared_ptr<Task> &a, const std::shared_ptr<Task> &b) const {
+			return a->getTime() < b->getTime();
+		}
+	};
+
+	// The previous Dispatcher storage: ordered multiset of shared tasks + id index
+	double runLegacy(const std::vector<uint32_t> &delays, size_t &executed) {
+		phmap::btree_multiset<std::shared_ptr<Task>, LegacyCompare> scheduledTasks;
+		phmap::parallel_flat_hash_map_m<uint64_t, std::shared_ptr<Task>> scheduledTasksRef;
+		std::vector<uint64_t> ids;
+		ids.reserve(delays.size());
+
+		Benchmark bm;
+		for (const auto delay : delays) {
+			auto task = std::make_shared<Task>([&executed] { ++executed; }, "Benchmark::legacy", delay, false, false);
+			ids.emplace_back(scheduledTasksRef.emplace(task->getId(), task).first->first);
+			scheduledTasks.insert(std::move(task));
+		}
+
+		for (size_t i = 0; i < ids.size(); i += 2) {
+			const auto it = scheduledTasksRef.find(ids[i]);
+			if (it != scheduledTasksRef.end()) {
+				it->second->cancel();
+				scheduledTasksRef.erase(it);
+			}
+		}
+
+		for (int64_t now = OTSYS_TIME(); !scheduledTasks.empty(); now += TICK) {
+			auto it = scheduledTasks.begin();
+			while (it != scheduledTasks.end() && (*it)->getTime() <= now) {
+				(*it)->execute();
+				scheduledTasksRef.erase((*it)->getId());
+				++it;
+			}
+			scheduledTasks.erase(scheduledTasks.begin(), it);
+		}
+
+		return bm.duration();
+	}
+
+	double runTimerWheel(const std::vector<uint32_t> &delays, size_t &executed) {
+		TimerWheel<Task> scheduledTasks(OTSYS_TIME());
+		phmap::flat_hash_map<uint64_t, uint32_t> scheduledTasksRef;
+		std::vector<uint64_t> ids;
+		ids.reserve(delays.size());
+
+		Benchmark bm;
+		for (const auto delay : delays) {
+			Task task([&executed] { ++executed; }, "Benchmark::timerWheel", delay, false, false);
+			const auto eventId = task.getId();
+			const auto time = task.getTime();
+			scheduledTasksRef.emplace(eventId, scheduledTasks.insert(time, std::move(task)));
+			ids.emplace_back(eventId);
+		}
+
+		for (size_t i = 0; i < ids.size(); i += 2) {
+			const auto it = scheduledTasksRef.find(ids[i]);
+			if (it != scheduledTasksRef.end()) {
+				scheduledTasks.erase(it->second);
+				scheduledTasksRef.erase(it);
+			}
+		}
+
+		for (int64_t now = OTSYS_TIME(); !scheduledTasks.empty(); now += TICK) {
+			scheduledTasks.advance(now, [&scheduledTasksRef](Task &task, uint32_t) -> int64_t {
+				task.execute();
+				scheduledTasksRef.erase(task.getId());
+				return -1;
+			});
+		}
+
+		return bm.duration();
+	}
+}
+
+suite<"timer_wheel_benchmark"> timerWheelBenchmark = [] {
+	test("schedule, cancel half and fire 2M tasks: btree_multiset vs timer wheel") = [] {
+		const auto delays = generateDelays();
+
+		size_t legacyExecuted = 0;
+		const auto legacy = runLegacy(delays, legacyExecuted);
+
+		size_t wheelExecuted = 0;
+		const auto wheel = runTimerWheel(delays, wheelExecuted);
+
+		fmt::print("[timer_wheel] {} tasks, btree_multiset: {:.2f} ms, timer wheel: {:.2f} ms ({:.2f}x)\n", delays.size(), legacy, wheel, legacy / wheel);
+		expect(eq(legacyExecuted, wheelExecuted));
+	};
+};
@@ -0,0 +1,117 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+#include <latch>
+
+#include "kv/in_memory_kv.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr size_t KEYS_PER_SCOPE = 1000;
+	constexpr size_t OPERATIONS_PER_THREAD = 500'000;
+	// One set every SET_EVERY operations, the rest are gets
+	constexpr size_t SET_EVERY = 10;
+
+	// The previous store: one mutex, a std::list LRU moved on every get and a key built per scoped access
+	class LegacyKV {
+	public:
+		void set(const std::string &key, const ValueWrapper &value) {
+			std::scoped_lock lock(mutex);
+			const auto it = store.find(key);
+			if (it != store.end()) {
+				it->second.first = value;
+				lruQueue.splice(lruQueue.begin(), lruQueue, it->second.second);
+				return;
+			}
+			lruQueue.push_front(key);
+			store.try_emplace(key, value, lruQueue.begin());
+		}
+
+		std::optional<ValueWrapper> get(const std::string &key) {
+			std::scoped_lock lock(mutex);
+			const auto it = store.find(key);
+			if (it == store.end()) {
+				return std::nullopt;
+			}
+			lruQueue.splice(lruQueue.begin(), lruQueue, it->second.second);
+			return it->second.first;
+		}
+
+	private:
+		phmap::parallel_flat_hash_map<std::string, std::pair<ValueWrapper, std::list<std::string>::iterator>> store;
+		std::list<std::string> lruQueue;
+		std::mutex mutex;
+	};
+
+	// Each thread works on its own player scope, as scripts do through player:kv()
+	template <typename Operation>
+	double measure(size_t threadCount, Operation &&operation) {
+		std::atomic_size_t found = 0;
+		std::latch start(threadCount + 1);
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount);
+		for (size_t t = 0; t < threadCount; ++t) {
+			threads.emplace_back([&, t] {
+				std::vector<std::string> keys;
+				keys.reserve(KEYS_PER_SCOPE);
+				for (size_t key = 0; key < KEYS_PER_SCOPE; ++key) {
+					keys.emplace_back(fmt::format("storage-{}", key));
+				}
+
+				std::mt19937 rng(static_cast<uint32_t>(t));
+				size_t localFound = 0;
+				start.arrive_and_wait();
+				for (size_t i = 0; i < OPERATIONS_PER_THREAD; ++i) {
+					localFound += operation(t, keys[rng() % KEYS_PER_SCOPE], i % SET_EVERY == 0);
+				}
+				found.fetch_add(localFound, std::memory_order_relaxed);
+			});
+		}
+
+		Benchmark bm;
+		start.arrive_and_wait();
+		for (auto &thread : threads) {
+			thread.join();
+		}
+		const auto time = bm.duration();
+
+		expect(gt(found.load(), 0_ul));
+		return threadCount * OPERATIONS_PER_THREAD / time / 1000.0;
+	}
+}
+
+suite<"kv_store_benchmark"> kvStoreBenchmark = [] {
+	test("Scoped KV throughput from N threads: single lock LRU vs sharded clock") = [] {
+		const auto maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		for (size_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+			LegacyKV legacy;
+			const auto legacyRate = measure(threadCount, [&legacy](size_t thread, const std::string &key, bool write) {
+				const auto fullKey = fmt::format("player.{}.{}", thread, key);
+				if (write) {
+					legacy.set(fullKey, static_cast<int>(thread));
+					return true;
+				}
+				return legacy.get(fullKey).has_value();
+			});
+
+			KVMemory kv(g_logger());
+			std::vector<std::shared_ptr<KV>> scopes;
+			for (size_t t = 0; t < threadCount; ++t) {
+				scopes.emplace_back(kv.scoped("player")->scoped(fmt::format("{}", t)));
+			}
+			const auto rate = measure(threadCount, [&scopes](size_t thread, const std::string &key, bool write) {
+				if (write) {
+					scopes[thread]->set(key, static_cast<int>(thread));
+					return true;
+				}
+				return scopes[thread]->get(key).has_value();
+			});
+
+			fmt::print(
+				"[kv] {} thread(s), single lock LRU: {:.2f} M ops/s, sharded clock: {:.2f} M ops/s ({:.2f}x)\n",
+				threadCount, legacyRate, rate, rate / legacyRate
+			);
+		}
+	};
+};
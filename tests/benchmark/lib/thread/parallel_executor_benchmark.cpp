@@ -0,0 +1,114 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "lib/thread/parallel_executor.hpp"
+#include "lib/thread/thread_pool.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr size_t THREADS = 8;
+	constexpr size_t TICKS = 100;
+	constexpr size_t CREATURES = 10'000;
+
+	// Idle creatures are cheap, a few bosses casting spells are not, and they are not spread evenly
+	// (a raid or a boss room fills a contiguous range of the creature list)
+	std::vector<std::chrono::nanoseconds> generateCosts() {
+		std::mt19937 rng(42);
+		std::vector<std::chrono::nanoseconds> costs;
+		costs.reserve(CREATURES);
+		for (size_t i = 0; i < CREATURES; ++i) {
+			const bool boss = i < CREATURES / 20 ? rng() % 10 == 0 : rng() % 1000 == 0;
+			costs.emplace_back(boss ? 150'000 + rng() % 100'000 : 500 + rng() % 1'500);
+		}
+		return costs;
+	}
+
+	void spin(std::chrono::nanoseconds cost) {
+		const auto until = std::chrono::steady_clock::now() + cost;
+		while (std::chrono::steady_clock::now() < until) { }
+	}
+
+	struct TickTimes {
+		double average = 0;
+		double p99 = 0;
+		double max = 0;
+	};
+
+	template <typename F>
+	TickTimes measure(F &&tick) {
+		std::vector<double> times;
+		times.reserve(TICKS);
+		for (size_t i = 0; i < TICKS; ++i) {
+			Benchmark bm;
+			tick();
+			times.emplace_back(bm.duration());
+		}
+
+		std::ranges::sort(times);
+		return {
+			std::accumulate(times.begin(), times.end(), 0.0) / times.size(),
+			times[times.size() * 99 / 100],
+			times.back(),
+		};
+	}
+
+	// The previous Dispatcher::asyncWait: one equal block per thread through submit_loop
+	void legacyAsyncWait(ThreadPool &threadPool, size_t size, const std::function<void(size_t)> &f) {
+		const auto blockSize = static_cast<size_t>(std::ceil(size / static_cast<float>(threadPool.get_thread_count())));
+		auto future = threadPool.submit_loop(blockSize, size, [&f](const unsigned int i) { f(i); });
+		for (size_t i = 0; i < blockSize; ++i) {
+			f(i);
+		}
+		future.wait();
+	}
+}
+
+suite<"parallel_executor_benchmark"> parallelExecutorBenchmark = [] {
+	test("skewed creature think: equal partitions vs work stealing") = [] {
+		const auto costs = generateCosts();
+		ThreadPool threadPool(g_logger(), THREADS);
+		ParallelExecutor executor(threadPool);
+
+		std::atomic_size_t legacyExecuted = 0;
+		const auto legacy = measure([&] {
+			legacyAsyncWait(threadPool, costs.size(), [&](size_t i) {
+				spin(costs[i]);
+				legacyExecuted.fetch_add(1, std::memory_order_relaxed);
+			});
+		});
+
+		std::atomic_size_t executed = 0;
+		const auto stealing = measure([&] {
+			executor.parallelFor(costs.size(), [&](size_t i) {
+				spin(costs[i]);
+				executed.fetch_add(1, std::memory_order_relaxed);
+			});
+		});
+
+		const auto stats = executor.getStats();
+		fmt::print(
+			"[parallel_executor] {} ticks of {} creatures on {} threads, equal partitions: avg {:.2f} ms / p99 {:.2f} ms / max {:.2f} ms, "
+			"work stealing: avg {:.2f} ms / p99 {:.2f} ms / max {:.2f} ms ({} chunks, {} steals)\n",
+			TICKS, CREATURES, THREADS, legacy.average, legacy.p99, legacy.max, stealing.average, stealing.p99, stealing.max, stats.chunks, stats.steals
+		);
+
+		expect(eq(legacyExecuted.load(), TICKS * CREATURES));
+		expect(eq(executed.load(), TICKS * CREATURES));
+	};
+
+	test("nested loops make progress with every thread busy") = [] {
+		ThreadPool threadPool(g_logger(), THREADS);
+		ParallelExecutor executor(threadPool);
+
+		std::atomic_size_t executed = 0;
+		executor.parallelFor(THREADS * 4, [&](size_t) {
+			executor.parallelFor(1'000, [&](size_t) {
+				executed.fetch_add(1, std::memory_order_relaxed);
+			});
+		});
+
+		expect(eq(executed.load(), THREADS * 4 * 1'000));
+	};
+};
@@ -0,0 +1,62 @@
+#include <boost/ut.hpp>
+#include "allocation_counter.hpp"
+#include "lib/di/container.hpp"
+#include "lib/logging/in_memory_logger.hpp"
+#include "utils/tools.hpp"
+
+#include <cstdlib>
+#include <new>
+
+using namespace boost::ut;
+
+void* operator new(std::size_t size) {
+	AllocationCounter::allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(size == 0 ? 1 : size)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	AllocationCounter::allocations.fetch_add(1, std::memory_order_relaxed);
+	const auto align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+	if (void* p = _aligned_malloc(size, align)) {
+#else
+	if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+#endif
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+#ifdef _WIN32
+	_aligned_free(p);
+#else
+	std::free(p);
+#endif
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept {
+	operator delete(p, alignment);
+}
+
+int main() {
+	di::extension::injector<> injector {};
+	InMemoryLogger::install(injector);
+	DI::setTestContainer(&injector);
+
+	UPDATE_OTSYS_TIME();
+	(void)g_logger();
+
+	return cfg<>.run();
+}
@@ -0,0 +1,131 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "creatures/players/player.hpp"
+#include "game/game.hpp"
+#include "items/tile.hpp"
+#include "map/spectators.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr uint16_t CITY_X = 32000;
+	constexpr uint16_t CITY_Y = 32000;
+	constexpr uint16_t CITY_SIZE = 256;
+	constexpr size_t QUERIES = 20'000;
+
+	Position randomCityPosition(std::mt19937 &rng) {
+		// Most creatures on the street level, some upstairs and underground
+		const auto floor = rng() % 10;
+		return { static_cast<uint16_t>(CITY_X + rng() % CITY_SIZE), static_cast<uint16_t>(CITY_Y + rng() % CITY_SIZE), static_cast<uint8_t>(floor < 8 ? 7 : floor == 8 ? 6 : 8) };
+	}
+
+	// The previous sector layout: a vector of creature pointers, reading each creature position
+	struct LegacySectors {
+		phmap::flat_hash_map<uint32_t, CreatureVector> sectors;
+
+		static uint32_t index(uint32_t x, uint32_t y) {
+			return x / SECTOR_SIZE | y / SECTOR_SIZE << 16;
+		}
+
+		size_t find(const Position &centerPos) const {
+			const int32_t min_x = centerPos.x - MAP_MAX_VIEW_PORT_X;
+			const int32_t max_x = centerPos.x + MAP_MAX_VIEW_PORT_X;
+			const int32_t min_y = centerPos.y - MAP_MAX_VIEW_PORT_Y;
+			const int32_t max_y = centerPos.y + MAP_MAX_VIEW_PORT_Y;
+			// Same floors as Spectators::getSpectators with multifloor
+			uint8_t minRangeZ = 0;
+			uint8_t maxRangeZ = MAP_INIT_SURFACE_LAYER;
+			if (centerPos.z > MAP_INIT_SURFACE_LAYER) {
+				minRangeZ = static_cast<uint8_t>(std::max<int8_t>(centerPos.z - MAP_LAYER_VIEW_LIMIT, 0u));
+				maxRangeZ = static_cast<uint8_t>(std::min<int8_t>(centerPos.z + MAP_LAYER_VIEW_LIMIT, MAP_MAX_LAYERS - 1));
+			} else if (centerPos.z >= MAP_INIT_SURFACE_LAYER - 1) {
+				maxRangeZ = centerPos.z + MAP_LAYER_VIEW_LIMIT;
+			}
+			const auto width = static_cast<uint32_t>(max_x - min_x);
+			const auto height = static_cast<uint32_t>(max_y - min_y);
+			const auto depth = static_cast<uint32_t>(maxRangeZ - minRangeZ);
+
+			const int32_t x1 = min_x + centerPos.z - maxRangeZ;
+			const int32_t y1 = min_y + centerPos.z - maxRangeZ;
+			const int32_t x2 = max_x + centerPos.z - minRangeZ;
+			const int32_t y2 = max_y + centerPos.z - minRangeZ;
+
+			CreatureVector spectators;
+			for (int32_t ny = y1 - (y1 & SECTOR_MASK); ny <= y2; ny += SECTOR_SIZE) {
+				for (int32_t nx = x1 - (x1 & SECTOR_MASK); nx <= x2; nx += SECTOR_SIZE) {
+					const auto it = sectors.find(index(nx, ny));
+					if (it == sectors.end()) {
+						continue;
+					}
+
+					for (const auto &creature : it->second) {
+						const auto &cpos = creature->getPosition();
+						if (static_cast<uint32_t>(static_cast<int32_t>(cpos.z) - minRangeZ) <= depth) {
+							const int_fast16_t offsetZ = Position::getOffsetZ(centerPos, cpos);
+							if (static_cast<uint32_t>(cpos.x - offsetZ - min_x) <= width && static_cast<uint32_t>(cpos.y - offsetZ - min_y) <= height) {
+								spectators.emplace_back(creature);
+							}
+						}
+					}
+				}
+			}
+			return spectators.size();
+		}
+	};
+}
+
+suite<"spectators_benchmark"> spectatorsBenchmark = [] {
+	test("Spectators::find over a crowded city: creature pointers vs packed sector positions") = [] {
+		for (const size_t creatureCount : { 1'000, 10'000, 50'000 }) {
+			std::mt19937 rng(42);
+			std::vector<std::shared_ptr<Tile>> tiles;
+			CreatureVector creatures;
+			LegacySectors legacy;
+			tiles.reserve(creatureCount);
+			creatures.reserve(creatureCount);
+
+			for (size_t i = 0; i < creatureCount; ++i) {
+				const auto position = randomCityPosition(rng);
+				const auto &tile = tiles.emplace_back(std::make_shared<DynamicTile>(position));
+				const auto &creature = creatures.emplace_back(std::make_shared<Player>());
+				creature->setParent(tile);
+
+				g_game().map.getBestMapSector(position.x, position.y)->addCreature(creature, position);
+				legacy.sectors[LegacySectors::index(position.x, position.y)].emplace_back(creature);
+			}
+
+			std::vector<Position> centers;
+			centers.reserve(QUERIES);
+			for (size_t i = 0; i < QUERIES; ++i) {
+				centers.emplace_back(randomCityPosition(rng));
+			}
+
+			size_t legacyFound = 0;
+			Benchmark legacyBm;
+			for (const auto &center : centers) {
+				legacyFound += legacy.find(center);
+			}
+			const auto legacyTime = legacyBm.duration();
+
+			size_t found = 0;
+			Benchmark bm;
+			for (const auto &center : centers) {
+				found += Spectators().find<Creature>(center, true, 0, 0, 0, 0, false).size();
+			}
+			const auto time = bm.duration();
+
+			fmt::print(
+				"[spectators] {} creatures, {} queries ({:.1f} spectators each), creature pointers: {:.2f} ms, packed positions: {:.2f} ms ({:.2f}x)\n",
+				creatureCount, QUERIES, found / static_cast<double>(QUERIES), legacyTime, time, legacyTime / time
+			);
+			expect(eq(found, legacyFound));
+
+			for (const auto &creature : creatures) {
+				const auto &position = creature->getPosition();
+				g_game().map.getMapSector(position.x, position.y)->removeCreature(creature);
+			}
+		}
+	};
+};
@@ -0,0 +1,111 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+#include <latch>
+
+#include "game/game.hpp"
+#include "items/tile.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr uint16_t AREA_X = 33000;
+	constexpr uint16_t AREA_Y = 33000;
+	constexpr uint16_t AREA_SIZE = 512;
+	constexpr uint8_t AREA_Z = 7;
+	constexpr size_t LOOKUPS_PER_THREAD = 2'000'000;
+
+	// The previous tile storage: a shared_mutex per floor and a mutex per sector for the floor lookup
+	struct LegacySector {
+		struct Floor {
+			std::shared_ptr<Tile> getTile(uint16_t x, uint16_t y) const {
+				std::shared_lock<std::shared_mutex> sl(mutex);
+				return tiles[x & SECTOR_MASK][y & SECTOR_MASK];
+			}
+
+			std::shared_ptr<Tile> tiles[SECTOR_SIZE][SECTOR_SIZE] = {};
+			mutable std::shared_mutex mutex;
+		};
+
+		std::shared_ptr<Floor> getFloor(uint8_t z) {
+			std::scoped_lock lock(floorsMutex);
+			return floors[z];
+		}
+
+		std::mutex floorsMutex;
+		std::shared_ptr<Floor> floors[MAP_MAX_LAYERS] = {};
+	};
+
+	// Lookups walk around a random start, as path finding and sight checks do
+	template <typename GetTile>
+	double measure(size_t threadCount, GetTile &&getTile) {
+		std::atomic_size_t found = 0;
+		std::latch start(threadCount + 1);
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount);
+		for (size_t t = 0; t < threadCount; ++t) {
+			threads.emplace_back([&, t] {
+				std::mt19937 rng(static_cast<uint32_t>(t));
+				size_t localFound = 0;
+				start.arrive_and_wait();
+				for (size_t i = 0; i < LOOKUPS_PER_THREAD; i += 64) {
+					const auto originX = static_cast<uint16_t>(AREA_X + 8 + rng() % (AREA_SIZE - 16));
+					const auto originY = static_cast<uint16_t>(AREA_Y + 8 + rng() % (AREA_SIZE - 16));
+					for (uint16_t step = 0; step < 64; ++step) {
+						localFound += getTile(static_cast<uint16_t>(originX + step % 8), static_cast<uint16_t>(originY + step / 8), AREA_Z) != nullptr;
+					}
+				}
+				found.fetch_add(localFound, std::memory_order_relaxed);
+			});
+		}
+
+		Benchmark bm;
+		start.arrive_and_wait();
+		for (auto &thread : threads) {
+			thread.join();
+		}
+		const auto time = bm.duration();
+
+		expect(eq(found.load(), threadCount * LOOKUPS_PER_THREAD));
+		return threadCount * LOOKUPS_PER_THREAD / time / 1000.0;
+	}
+}
+
+suite<"tile_access_benchmark"> tileAccessBenchmark = [] {
+	test("Map::getTile throughput from N threads: locked floors vs lock-free floors") = [] {
+		auto &map = g_game().map;
+		phmap::flat_hash_map<uint32_t, LegacySector> legacy;
+		for (uint16_t x = AREA_X; x < AREA_X + AREA_SIZE; ++x) {
+			for (uint16_t y = AREA_Y; y < AREA_Y + AREA_SIZE; ++y) {
+				const auto tile = std::make_shared<StaticTile>(x, y, AREA_Z);
+				map.setTile(x, y, AREA_Z, tile);
+
+				auto &floor = legacy[x / SECTOR_SIZE | y / SECTOR_SIZE << 16].floors[AREA_Z];
+				if (!floor) {
+					floor = std::make_shared<LegacySector::Floor>();
+				}
+				floor->tiles[x & SECTOR_MASK][y & SECTOR_MASK] = tile;
+			}
+		}
+
+		const auto maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		for (size_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+			const auto legacyRate = measure(threadCount, [&legacy](uint16_t x, uint16_t y, uint8_t z) -> std::shared_ptr<Tile> {
+				const auto it = legacy.find(x / SECTOR_SIZE | y / SECTOR_SIZE << 16);
+				if (it == legacy.end()) {
+					return nullptr;
+				}
+				const auto &floor = it->second.getFloor(z);
+				return floor ? floor->getTile(x, y) : nullptr;
+			});
+			const auto rate = measure(threadCount, [&map](uint16_t x, uint16_t y, uint8_t z) {
+				return map.getTile(x, y, z);
+			});
+
+			fmt::print(
+				"[getTile] {} thread(s), locked floors: {:.1f} M lookups/s, lock-free floors: {:.1f} M lookups/s ({:.2f}x)\n",
+				threadCount, legacyRate, rate, rate / legacyRate
+			);
+		}
+	};
+};
@@ -0,0 +1,53 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "security/xtea.hpp"
+#include "utils/benchmark.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr size_t BYTES_PER_RUN = 64 * 1024 * 1024;
+
+	// Single core throughput in MB/s, over messages of the given size
+	template <typename Transform>
+	double measure(size_t messageSize, Transform &&transform) {
+		std::vector<uint8_t> buffer(messageSize + 1, 0x5A);
+		// Offset by one byte, as the outgoing messages sit after their header
+		uint8_t* data = buffer.data() + 1;
+
+		Benchmark bm;
+		for (size_t done = 0; done < BYTES_PER_RUN; done += messageSize) {
+			transform(data, messageSize);
+		}
+		const auto time = bm.duration();
+
+		expect(neq(buffer[1], static_cast<uint8_t>(0x5A)) or neq(buffer[2], static_cast<uint8_t>(0x5A)));
+		return BYTES_PER_RUN / (1024.0 * 1024.0) / (time / 1000.0);
+	}
+}
+
+suite<"xtea_benchmark"> xteaBenchmark = [] {
+	test("xtea throughput per engine") = [] {
+		const auto encryptKeys = xtea::expandEncryptKey({ 0x01234567, 0x89ABCDEF, 0xFEDCBA98, 0x76543210 });
+		const auto decryptKeys = xtea::expandDecryptKey({ 0x01234567, 0x89ABCDEF, 0xFEDCBA98, 0x76543210 });
+		fmt::print("[xtea] best engine: {}\n", xtea::getEngineName(xtea::getBestEngine()));
+
+		for (const auto engine : { xtea::Engine::Scalar, xtea::Engine::SSE2, xtea::Engine::AVX2, xtea::Engine::NEON }) {
+			if (!xtea::isSupported(engine)) {
+				continue;
+			}
+
+			for (const size_t messageSize : { 64, 512, 4096, 24576 }) {
+				const auto encryptRate = measure(messageSize, [&](uint8_t* data, size_t length) {
+					xtea::encrypt(engine, data, length, encryptKeys);
+				});
+				const auto decryptRate = measure(messageSize, [&](uint8_t* data, size_t length) {
+					xtea::decrypt(engine, data, length, decryptKeys);
+				});
+				fmt::print("[xtea] {}, {} byte messages: encrypt {:.1f} MB/s, decrypt {:.1f} MB/s\n", xtea::getEngineName(engine), messageSize, encryptRate, decryptRate);
+			}
+		}
+	};
+};
@@ -0,0 +1,138 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "allocation_counter.hpp"
+#include "game/movement/position.hpp"
+#include "server/network/message/networkmessage.hpp"
+#include "utils/benchmark.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr size_t PACKETS = 4096;
+	constexpr size_t ROUNDS = 200;
+
+	// Client packets as parsed by ProtocolGame, weighted like a busy server: mostly walking and using items, then chat and module traffic
+	enum class PacketKind : uint8_t {
+		Walk,
+		UseItem,
+		Say,
+		PrivateSay,
+		ExtendedOpcode,
+	};
+
+	std::string randomText(std::mt19937 &rng, size_t minLength, size_t maxLength) {
+		std::uniform_int_distribution<size_t> length(minLength, maxLength);
+		std::uniform_int_distribution<int> letter('a', 'z');
+		std::string text(length(rng), ' ');
+		for (auto &c : text) {
+			c = static_cast<char>(letter(rng));
+		}
+		return text;
+	}
+
+	std::vector<std::pair<PacketKind, std::unique_ptr<NetworkMessage>>> buildPackets() {
+		std::mt19937 rng(20241016);
+		std::discrete_distribution<int> kinds({ 50, 25, 15, 5, 5 });
+		std::vector<std::pair<PacketKind, std::unique_ptr<NetworkMessage>>> packets;
+		packets.reserve(PACKETS);
+		for (size_t i = 0; i < PACKETS; ++i) {
+			auto kind = static_cast<PacketKind>(kinds(rng));
+			auto msg = std::make_unique<NetworkMessage>();
+			switch (kind) {
+				case PacketKind::Walk:
+					msg->addByte(0x65);
+					break;
+				case PacketKind::UseItem:
+					msg->addByte(0x82);
+					msg->addPosition({ 32000, 32000, 7 });
+					msg->add<uint16_t>(3031);
+					msg->addByte(0);
+					msg->addByte(1);
+					break;
+				case PacketKind::Say:
+					msg->addByte(0x96);
+					msg->addByte(1);
+					msg->addString(randomText(rng, 4, 120));
+					break;
+				case PacketKind::PrivateSay:
+					msg->addByte(0x96);
+					msg->addByte(5);
+					msg->addString(randomText(rng, 16, 30));
+					msg->addString(randomText(rng, 4, 120));
+					break;
+				case PacketKind::ExtendedOpcode:
+					msg->addByte(0x32);
+					msg->addByte(1);
+					msg->addString(randomText(rng, 200, 1000));
+					break;
+			}
+			packets.emplace_back(kind, std::move(msg));
+		}
+		return packets;
+	}
+
+	template <bool View>
+	size_t parse(NetworkMessage &msg, PacketKind kind) {
+		msg.setBufferPosition(NetworkMessage::INITIAL_BUFFER_POSITION);
+		size_t consumed = msg.getByte();
+		const auto readString = [&msg] {
+			if constexpr (View) {
+				return msg.getStringView().size();
+			} else {
+				return msg.getString().size();
+			}
+		};
+
+		switch (kind) {
+			case PacketKind::Walk:
+				break;
+			case PacketKind::UseItem:
+				consumed += msg.getPosition().x;
+				consumed += msg.get<uint16_t>();
+				consumed += msg.getByte();
+				consumed += msg.getByte();
+				break;
+			case PacketKind::Say:
+			case PacketKind::ExtendedOpcode:
+				consumed += msg.getByte();
+				consumed += readString();
+				break;
+			case PacketKind::PrivateSay:
+				consumed += msg.getByte();
+				consumed += readString();
+				consumed += readString();
+				break;
+		}
+		return consumed;
+	}
+
+	template <bool View>
+	std::pair<double, uint64_t> run(std::vector<std::pair<PacketKind, std::unique_ptr<NetworkMessage>>> &packets, size_t &consumed) {
+		const auto allocationsBefore = AllocationCounter::get();
+		Benchmark bm;
+		for (size_t round = 0; round < ROUNDS; ++round) {
+			for (auto &[kind, msg] : packets) {
+				consumed += parse<View>(*msg, kind);
+			}
+		}
+		return { bm.duration(), AllocationCounter::get() - allocationsBefore };
+	}
+}
+
+suite<"networkmessage_reader_benchmark"> networkMessageReaderBenchmark = [] {
+	test("string views read a packet mix without allocating") = [] {
+		auto packets = buildPackets();
+
+		size_t copied = 0;
+		const auto [copyTime, copyAllocations] = run<false>(packets, copied);
+		size_t viewed = 0;
+		const auto [viewTime, viewAllocations] = run<true>(packets, viewed);
+
+		fmt::print("[networkmessage_reader] {} packets: getString {:.2f} ms ({} allocations), getStringView {:.2f} ms ({} allocations)\n", PACKETS * ROUNDS, copyTime, copyAllocations, viewTime, viewAllocations);
+
+		expect(eq(copied, viewed));
+		expect(eq(viewAllocations, uint64_t { 0 }));
+	};
+};
@@ -0,0 +1,163 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "server/network/protocol/known_creatures.hpp"
+#include "utils/benchmark.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr size_t CREATURES = 1000;
+	constexpr int32_t SQUARE_SIZE = 30;
+	constexpr size_t TICKS = 20'000;
+	// Creatures logging out and in, and stepping, each tick
+	constexpr size_t CHURN = 10;
+	constexpr size_t STEPS = 50;
+
+	struct SquareCreature {
+		int32_t x = 0;
+		int32_t y = 0;
+		bool player = false;
+	};
+
+	// A city square full of players, the viewer standing in the middle with the usual 8x6 view range
+	struct CitySquare {
+		explicit CitySquare(std::mt19937 &rng) :
+			rng(rng) {
+			for (size_t i = 0; i < CREATURES; ++i) {
+				spawn();
+			}
+		}
+
+		static bool inView(const SquareCreature &creature) {
+			return std::abs(creature.x - SQUARE_SIZE / 2) <= 8 && std::abs(creature.y - SQUARE_SIZE / 2) <= 6;
+		}
+
+		bool canSee(uint32_t id) const {
+			const auto it = creatures.find(id);
+			return it != creatures.end() && inView(it->second);
+		}
+
+		uint32_t spawn() {
+			const auto id = nextId++;
+			creatures.emplace(id, SquareCreature { static_cast<int32_t>(rng() % SQUARE_SIZE), static_cast<int32_t>(rng() % SQUARE_SIZE), rng() % 10 != 0 });
+			ids.emplace_back(id);
+			return id;
+		}
+
+		// Calls seen with every creature the viewer is sent this tick
+		template <typename Seen>
+		void tick(Seen &&seen) {
+			for (size_t i = 0; i < CHURN; ++i) {
+				const auto index = rng() % ids.size();
+				creatures.erase(ids[index]);
+				ids[index] = ids.back();
+				ids.pop_back();
+
+				const auto id = spawn();
+				if (inView(creatures[id])) {
+					seen(id);
+				}
+			}
+
+			for (size_t i = 0; i < STEPS; ++i) {
+				const auto id = ids[rng() % ids.size()];
+				auto &creature = creatures[id];
+				creature.x = std::clamp<int32_t>(creature.x + static_cast<int32_t>(rng() % 3) - 1, 0, SQUARE_SIZE - 1);
+				creature.y = std::clamp<int32_t>(creature.y + static_cast<int32_t>(rng() % 3) - 1, 0, SQUARE_SIZE - 1);
+				if (inView(creature)) {
+					seen(id);
+				}
+			}
+		}
+
+		std::mt19937 &rng;
+		phmap::flat_hash_map<uint32_t, SquareCreature> creatures;
+		std::vector<uint32_t> ids;
+		uint32_t nextId = 0x10000000;
+	};
+
+	// The previous ProtocolGame::checkCreatureAsKnown: players sharing the viewer party (none counts) were
+	// always kept, so in a crowd of players the scan walked the whole set before removing anyone
+	struct LegacyKnownCreatures {
+		uint32_t insert(uint32_t id, const CitySquare &square) {
+			if (!knownCreatureSet.insert(id).second) {
+				return 0;
+			}
+			if (knownCreatureSet.size() <= KnownCreatures::CAPACITY) {
+				return 0;
+			}
+
+			for (auto it = knownCreatureSet.begin(), end = knownCreatureSet.end(); it != end; ++it) {
+				if (*it == id) {
+					continue;
+				}
+				const auto creature = square.creatures.find(*it);
+				const bool isPlayer = creature != square.creatures.end() && creature->second.player;
+				if (!isPlayer && !square.canSee(*it)) {
+					const auto removed = *it;
+					knownCreatureSet.erase(it);
+					return removed;
+				}
+			}
+
+			auto it = knownCreatureSet.begin();
+			if (*it == id) {
+				++it;
+			}
+			const auto removed = *it;
+			knownCreatureSet.erase(it);
+			return removed;
+		}
+
+		std::unordered_set<uint32_t> knownCreatureSet;
+	};
+
+	struct Result {
+		double time = 0;
+		size_t checks = 0;
+		size_t evictions = 0;
+		size_t visibleEvictions = 0;
+	};
+
+	template <typename Insert>
+	Result run(Insert &&insert) {
+		std::mt19937 rng(20241016);
+		CitySquare square(rng);
+		Result result;
+
+		Benchmark bm;
+		for (size_t tick = 0; tick < TICKS; ++tick) {
+			square.tick([&](uint32_t id) {
+				++result.checks;
+				if (const auto removed = insert(id, square)) {
+					++result.evictions;
+					result.visibleEvictions += square.canSee(removed) ? 1 : 0;
+				}
+			});
+		}
+		result.time = bm.duration();
+		return result;
+	}
+}
+
+suite<"known_creatures_benchmark"> knownCreaturesBenchmark = [] {
+	test("known creatures in a 1000 creature city square: linear scan vs LRU") = [] {
+		LegacyKnownCreatures legacy;
+		const auto legacyResult = run([&legacy](uint32_t id, const CitySquare &square) {
+			return legacy.insert(id, square);
+		});
+
+		KnownCreatures known;
+		const auto lruResult = run([&known](uint32_t id, const CitySquare &square) {
+			return known.insert(id, [&square](uint32_t knownId) { return !square.canSee(knownId); }).second;
+		});
+
+		fmt::print("[known_creatures] {} checks: linear scan {:.2f} ms ({} evictions, {} visible), LRU {:.2f} ms ({} evictions, {} visible)\n", lruResult.checks, legacyResult.time, legacyResult.evictions, legacyResult.visibleEvictions, lruResult.time, lruResult.evictions, lruResult.visibleEvictions);
+
+		expect(eq(legacyResult.checks, lruResult.checks));
+		expect(le(known.size(), KnownCreatures::CAPACITY));
+		expect(eq(lruResult.visibleEvictions, size_t { 0 }));
+	};
+};
@@ -0,0 +1,105 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+#include <latch>
+
+#include "server/network/message/outputmessage.hpp"
+#include "server/network/protocol/protocol.hpp"
+#include "utils/benchmark.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr size_t CLIENTS = 2'000;
+	constexpr size_t FLUSHES = 50;
+	constexpr size_t MESSAGE_SIZE = 1'500;
+
+	class BenchmarkProtocol final : public Protocol {
+	public:
+		explicit BenchmarkProtocol(uint32_t seed) :
+			Protocol(nullptr) {
+			const std::array<uint32_t, 4> key = { seed, seed * 3, seed * 5, seed * 7 };
+			setXTEAKey(key.data());
+			setChecksumMethod(CHECKSUM_METHOD_SEQUENCE);
+			enableXTEAEncryption();
+		}
+
+		void onRecvFirstMessage(NetworkMessage &) override { }
+	};
+
+	// One buffered message per client, like OutputMessagePool::sendAll hands over every 10ms
+	std::vector<OutputMessage_ptr> makeFlush(std::mt19937 &rng) {
+		std::vector<OutputMessage_ptr> messages;
+		messages.reserve(CLIENTS);
+		std::array<char, MESSAGE_SIZE> payload;
+		for (size_t i = 0; i < CLIENTS; ++i) {
+			std::ranges::generate(payload, [&rng] { return static_cast<char>(rng() % 16); });
+			auto msg = OutputMessagePool::getOutputMessage();
+			msg->addBytes(payload.data(), payload.size());
+			messages.emplace_back(std::move(msg));
+		}
+		return messages;
+	}
+}
+
+suite<"send_pipeline_benchmark"> sendPipelineBenchmark = [] {
+	test("finalizing a flush of 2000 clients: one network thread vs one per core") = [] {
+		std::vector<std::shared_ptr<BenchmarkProtocol>> protocols;
+		protocols.reserve(CLIENTS);
+		for (size_t i = 0; i < CLIENTS; ++i) {
+			protocols.emplace_back(std::make_shared<BenchmarkProtocol>(static_cast<uint32_t>(i + 1)));
+		}
+
+		// Shaped like ServiceManager with networkThreads = 0: every client finalizes on its own strand
+		asio::io_context ioContext;
+		auto work = asio::make_work_guard(ioContext);
+		std::vector<asio::strand<asio::io_context::executor_type>> strands;
+		strands.reserve(CLIENTS);
+		for (size_t i = 0; i < CLIENTS; ++i) {
+			strands.emplace_back(asio::make_strand(ioContext));
+		}
+		const auto threadCount = std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+		std::vector<std::thread> threads;
+		for (uint32_t i = 0; i < threadCount; ++i) {
+			threads.emplace_back([&ioContext] { ioContext.run(); });
+		}
+
+		std::mt19937 rng(42);
+		Benchmark serial;
+		Benchmark parallel;
+		for (size_t flush = 0; flush < FLUSHES; ++flush) {
+			auto messages = makeFlush(rng);
+			serial.start();
+			for (size_t i = 0; i < CLIENTS; ++i) {
+				protocols[i]->onSendMessage(messages[i]);
+			}
+			serial.end();
+
+			messages = makeFlush(rng);
+			parallel.start();
+			std::latch finalized(CLIENTS);
+			for (size_t i = 0; i < CLIENTS; ++i) {
+				asio::post(strands[i], [&, i] {
+					protocols[i]->onSendMessage(messages[i]);
+					finalized.count_down();
+				});
+			}
+			finalized.wait();
+			parallel.end();
+
+			for (const auto &msg : messages) {
+				expect(eq(msg->getLength() % 8, 6));
+			}
+		}
+
+		work.reset();
+		for (auto &thread : threads) {
+			thread.join();
+		}
+
+		fmt::print(
+			"[send] {} clients, {} byte messages: one network thread {:.2f} ms per flush, {} network threads {:.2f} ms per flush ({:.2f}x)\n",
+			CLIENTS, MESSAGE_SIZE, serial.avg(), threadCount, parallel.avg(), serial.avg() / parallel.avg()
+		);
+	};
+};
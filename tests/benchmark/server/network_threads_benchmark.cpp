@@ -0,0 +1,141 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "security/xtea.hpp"
+#include "utils/benchmark.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr size_t CLIENTS = 256;
+	constexpr size_t ROUND_TRIPS = 200;
+	constexpr size_t PACKET_SIZE = 1024;
+
+	const auto encryptKeys = xtea::expandEncryptKey({ 0x01234567, 0x89ABCDEF, 0xFEDCBA98, 0x76543210 });
+	const auto decryptKeys = xtea::expandDecryptKey({ 0x01234567, 0x89ABCDEF, 0xFEDCBA98, 0x76543210 });
+
+	// Server side, shaped like Connection: one strand per socket, decrypts what it reads and encrypts what it writes
+	class ServerSession : public std::enable_shared_from_this<ServerSession> {
+	public:
+		explicit ServerSession(asio::ip::tcp::socket &&socket) :
+			socket(std::move(socket)) { }
+
+		void read() {
+			asio::async_read(socket, asio::buffer(buffer), [self = shared_from_this()](const std::error_code &error, size_t) {
+				if (error) {
+					return;
+				}
+				xtea::decrypt(self->buffer.data(), PACKET_SIZE, decryptKeys);
+				xtea::encrypt(self->buffer.data(), PACKET_SIZE, encryptKeys);
+				asio::async_write(self->socket, asio::buffer(self->buffer), [self](const std::error_code &writeError, size_t) {
+					if (!writeError) {
+						self->read();
+					}
+				});
+			});
+		}
+
+	private:
+		asio::ip::tcp::socket socket;
+		std::array<uint8_t, PACKET_SIZE> buffer {};
+	};
+
+	void accept(asio::io_context &ioContext, asio::ip::tcp::acceptor &acceptor) {
+		acceptor.async_accept(asio::make_strand(ioContext), [&ioContext, &acceptor](const std::error_code &error, asio::ip::tcp::socket socket) {
+			if (error) {
+				return;
+			}
+			socket.set_option(asio::ip::tcp::no_delay(true));
+			std::make_shared<ServerSession>(std::move(socket))->read();
+			accept(ioContext, acceptor);
+		});
+	}
+
+	// Loopback client: sends a packet and waits for the answer, ROUND_TRIPS times
+	class Client : public std::enable_shared_from_this<Client> {
+	public:
+		Client(asio::io_context &ioContext, std::atomic_size_t &completed) :
+			socket(asio::make_strand(ioContext)), completed(completed) { }
+
+		void start(const asio::ip::tcp::endpoint &endpoint) {
+			socket.async_connect(endpoint, [self = shared_from_this()](const std::error_code &error) {
+				if (!error) {
+					self->socket.set_option(asio::ip::tcp::no_delay(true));
+					self->roundTrip();
+				}
+			});
+		}
+
+	private:
+		void roundTrip() {
+			if (remaining-- == 0) {
+				socket.close();
+				return;
+			}
+			asio::async_write(socket, asio::buffer(buffer), [self = shared_from_this()](const std::error_code &error, size_t) {
+				if (error) {
+					return;
+				}
+				asio::async_read(self->socket, asio::buffer(self->buffer), [self](const std::error_code &readError, size_t) {
+					if (!readError) {
+						self->completed.fetch_add(1, std::memory_order_relaxed);
+						self->roundTrip();
+					}
+				});
+			});
+		}
+
+		asio::ip::tcp::socket socket;
+		std::atomic_size_t &completed;
+		std::array<uint8_t, PACKET_SIZE> buffer {};
+		size_t remaining = ROUND_TRIPS;
+	};
+
+	// Round trips per second with the server io_context run by the given number of threads
+	double measure(size_t serverThreads) {
+		asio::io_context serverContext;
+		asio::ip::tcp::acceptor acceptor(serverContext, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+		accept(serverContext, acceptor);
+		std::vector<std::thread> servers;
+		for (size_t i = 0; i < serverThreads; ++i) {
+			servers.emplace_back([&serverContext] { serverContext.run(); });
+		}
+
+		std::atomic_size_t completed = 0;
+		asio::io_context clientContext;
+		for (size_t i = 0; i < CLIENTS; ++i) {
+			std::make_shared<Client>(clientContext, completed)->start(acceptor.local_endpoint());
+		}
+
+		Benchmark bm;
+		std::vector<std::thread> clients;
+		for (size_t i = 0; i < std::max<size_t>(std::thread::hardware_concurrency() / 2, 1); ++i) {
+			clients.emplace_back([&clientContext] { clientContext.run(); });
+		}
+		for (auto &thread : clients) {
+			thread.join();
+		}
+		const auto time = bm.duration();
+
+		serverContext.stop();
+		for (auto &thread : servers) {
+			thread.join();
+		}
+
+		expect(eq(completed.load(), CLIENTS * ROUND_TRIPS));
+		return completed.load() / (time / 1000.0);
+	}
+}
+
+suite<"network_threads_benchmark"> networkThreadsBenchmark = [] {
+	test("loopback round trips: one network thread vs several") = [] {
+		const auto maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		const auto baseline = measure(1);
+		fmt::print("[network] {} clients, 1 thread: {:.0f} round trips/s\n", CLIENTS, baseline);
+		for (size_t threads = 2; threads <= maxThreads; threads *= 2) {
+			const auto rate = measure(threads);
+			fmt::print("[network] {} clients, {} threads: {:.0f} round trips/s ({:.2f}x)\n", CLIENTS, threads, rate, rate / baseline);
+		}
+	};
+};
@@ -41,8 +41,9 @@ protected:
 	std::optional<ValueWrapper> load(const std::string &key) override {
 		return std::nullopt;
 	}
+	// Nothing to write to, a flush drops the values
 	bool save(const std::string &key, const ValueWrapper &value) override {
-		return false;
+		return true;
 	}
 };
 
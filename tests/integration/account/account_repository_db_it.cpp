@@ -36,7 +36,7 @@ namespace it_account_repo_db {
 	}
 
 	inline void register_loadByID(Database &db) {
-		test("AccountRepositoryDB::loadByID") = databaseTest(db, [&db] {
+		test("AccountRepositoryDB::loadByID") = databaseTest([&db] {
 			AccountRepositoryDB accRepo {};
 			createAccount(db);
 			auto acc = std::make_unique<AccountInfo>();
@@ -47,7 +47,7 @@ namespace it_account_repo_db {
 	}
 
 	inline void register_loadByEmailOrName(Database &db) {
-		test("AccountRepositoryDB::loadByEmailOrName") = databaseTest(db, [&db] {
+		test("AccountRepositoryDB::loadByEmailOrName") = databaseTest([&db] {
 			AccountRepositoryDB accRepo {};
 			createAccount(db);
 			auto acc = std::make_unique<AccountInfo>();
@@ -58,7 +58,7 @@ namespace it_account_repo_db {
 	}
 
 	inline void register_loadBySession(Database &db) {
-		test("AccountRepositoryDB::loadBySession") = databaseTest(db, [&db] {
+		test("AccountRepositoryDB::loadBySession") = databaseTest([&db] {
 			AccountRepositoryDB accRepo {};
 			createAccount(db);
 			auto acc = std::make_unique<AccountInfo>();
@@ -69,7 +69,7 @@ namespace it_account_repo_db {
 	}
 
 	inline void register_premiumPurchasedSync(Database &db) {
-		test("AccountRepositoryDB premiumDaysPurchased sync") = databaseTest(db, [&db] {
+		test("AccountRepositoryDB premiumDaysPurchased sync") = databaseTest([&db] {
 			AccountRepositoryDB accRepo {};
 			auto acc = std::make_unique<AccountInfo>();
 			accRepo.loadByID(1, acc);
@@ -83,7 +83,7 @@ namespace it_account_repo_db {
 	}
 
 	inline void register_getPassword(Database &db) {
-		test("AccountRepositoryDB::getPassword") = databaseTest(db, [&db] {
+		test("AccountRepositoryDB::getPassword") = databaseTest([&db] {
 			AccountRepositoryDB accRepo {};
 			std::string password {};
 			expect(accRepo.getPassword(1, password));
@@ -92,7 +92,7 @@ namespace it_account_repo_db {
 	}
 
 	inline void register_getPassword_logs(Database &db, InMemoryLogger &logger) {
-		test("AccountRepositoryDB::getPassword logs on failure") = databaseTest(db, [&db, &logger] {
+		test("AccountRepositoryDB::getPassword logs on failure") = databaseTest([&db, &logger] {
 			AccountRepositoryDB accRepo {};
 			std::string password {};
 			logger.logs.clear();
@@ -104,7 +104,7 @@ namespace it_account_repo_db {
 	}
 
 	inline void register_save(Database &db) {
-		test("AccountRepositoryDB::save") = databaseTest(db, [&db] {
+		test("AccountRepositoryDB::save") = databaseTest([&db] {
 			AccountRepositoryDB accRepo {};
 			auto acc = std::make_unique<AccountInfo>();
 			acc->id = 1;
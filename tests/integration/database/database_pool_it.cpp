@@ -0,0 +1,213 @@
+#include <boost/ut.hpp>
+
+#include "database/database.hpp"
+#include "test_env.hpp"
+#include "utils/benchmark.hpp"
+
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+
+using namespace boost::ut;
+
+namespace it_database_pool {
+
+	constexpr uint32_t ACCOUNT_ID = 700000000;
+	constexpr uint32_t FIRST_PLAYER_ID = 700000001;
+	constexpr uint32_t PLAYERS = 1000;
+	constexpr uint32_t STORAGES_PER_PLAYER = 20;
+
+	inline uint64_t connectionId(Database &db) {
+		const auto result = db.storeQuery("SELECT CONNECTION_ID() AS `id`");
+		return result ? result->getNumber<uint64_t>("id") : 0;
+	}
+
+	// Shaped after a player save: the player row and a batch of storage values, in one transaction
+	inline bool savePlayer(Database &db, uint32_t playerId, uint32_t round) {
+		return DBTransaction::executeWithinTransaction([&db, playerId, round] {
+			if (!db.executeQuery(fmt::format("UPDATE `players` SET `level` = {}, `experience` = {} WHERE `id` = {}", round + 1, playerId * round, playerId))) {
+				return false;
+			}
+
+			DBInsert storage("INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES");
+			storage.upsert({ "value" });
+			for (uint32_t key = 0; key < STORAGES_PER_PLAYER; ++key) {
+				storage.addRow(fmt::format("{}, {}, {}", playerId, key, round));
+			}
+			return storage.execute();
+		});
+	}
+
+	inline void register_parallelQueries(Database &db) {
+		test("Database pool runs queries from more threads than connections") = [&db] {
+			const auto poolSize = db.getStats().poolSize;
+			std::mutex idsMutex;
+			std::set<uint64_t> ids;
+			std::atomic_uint32_t failures = 0;
+
+			std::vector<std::jthread> threads;
+			for (size_t i = 0; i < poolSize * 4; ++i) {
+				threads.emplace_back([&] {
+					for (int query = 0; query < 20; ++query) {
+						const auto id = connectionId(db);
+						if (id == 0) {
+							++failures;
+							continue;
+						}
+						std::scoped_lock lock(idsMutex);
+						ids.insert(id);
+					}
+				});
+			}
+			threads.clear();
+
+			expect(eq(failures.load(), 0_u));
+			expect(le(ids.size(), poolSize));
+			expect(eq(db.getStats().inUse, 0_ul));
+		};
+	}
+
+	inline void register_transactionAffinity(Database &db) {
+		test("Database transaction keeps its connection while the pool is busy") = [&db] {
+			std::atomic_bool running = true;
+			std::vector<std::jthread> threads;
+			for (size_t i = 0; i < db.getStats().poolSize * 2; ++i) {
+				threads.emplace_back([&] {
+					while (running) {
+						connectionId(db);
+					}
+				});
+			}
+
+			std::vector<uint64_t> ids;
+			DBTransaction::executeWithinTransaction([&] {
+				for (int query = 0; query < 50; ++query) {
+					ids.push_back(connectionId(db));
+				}
+				return false;
+			});
+			running = false;
+			threads.clear();
+
+			expect(eq(ids.size(), 50_ul));
+			expect(std::ranges::all_of(ids, [&ids](uint64_t id) { return id != 0 && id == ids.front(); }));
+		};
+	}
+
+	inline void register_nestedRollback(Database &db) {
+		test("Database rolls back the outer transaction when a nested one is rolled back") = [&db] {
+			bool innerCommitted = true;
+			const bool committed = DBTransaction::executeWithinTransaction([&db, &innerCommitted] {
+				db.executeQuery("INSERT INTO `accounts` (`name`, `password`) VALUES ('pool_it_nested_outer', '')");
+				innerCommitted = DBTransaction::executeWithinTransaction([&db] {
+					db.executeQuery("INSERT INTO `accounts` (`name`, `password`) VALUES ('pool_it_nested_inner', '')");
+					return false;
+				});
+				return true;
+			});
+
+			expect(!innerCommitted);
+			expect(!committed);
+			const auto result = db.storeQuery("SELECT COUNT(*) AS `count` FROM `accounts` WHERE `name` LIKE 'pool_it_nested_%'");
+			expect(result != nullptr);
+			if (result) {
+				expect(eq(result->getNumber<uint32_t>("count"), 0_u));
+			}
+
+			// The next transaction of the thread starts clean
+			expect(DBTransaction::executeWithinTransaction([&db] {
+				return db.executeQuery("DELETE FROM `accounts` WHERE `name` = 'pool_it_nested_outer'");
+			}));
+		};
+	}
+
+	inline void register_lastInsertId(Database &db) {
+		test("Database::getLastInsertId returns the id inserted by the calling thread") = databaseTest([&db] {
+			expect(db.executeQuery("INSERT INTO `accounts` (`name`, `password`) VALUES ('pool_it_insert', '')"));
+			const auto insertedId = db.getLastInsertId();
+
+			// Another thread inserting meanwhile must not change it, it needs a second connection since this test holds one
+			if (db.getStats().poolSize > 1) {
+				std::jthread([&db] {
+					DBTransaction::executeWithinTransaction([&db] {
+						db.executeQuery("INSERT INTO `accounts` (`name`, `password`) VALUES ('pool_it_other', '')");
+						return false;
+					});
+				}).join();
+			}
+
+			const auto result = db.storeQuery("SELECT `id` FROM `accounts` WHERE `name` = 'pool_it_insert'");
+			expect(result != nullptr);
+			expect(eq(db.getLastInsertId(), insertedId));
+			if (result) {
+				expect(eq(result->getNumber<uint64_t>("id"), insertedId));
+			}
+		});
+	}
+
+	inline void register_saveAll(Database &db) {
+		test("Database pool saves 1000 synthetic players") = [&db] {
+			db.executeQuery(fmt::format("INSERT INTO `accounts` (`id`, `name`, `password`) VALUES ({}, 'pool_it', '')", ACCOUNT_ID));
+			std::string players;
+			for (uint32_t i = 0; i < PLAYERS; ++i) {
+				players += fmt::format("{}({}, 'pool_it_{}', {}, '')", i == 0 ? "" : ",", FIRST_PLAYER_ID + i, i, ACCOUNT_ID);
+			}
+			expect(db.executeQuery("INSERT INTO `players` (`id`, `name`, `account_id`, `conditions`) VALUES " + players));
+
+			// One save after the other, as with a single connection
+			std::atomic_uint32_t saved = 0;
+			Benchmark serial;
+			for (uint32_t i = 0; i < PLAYERS; ++i) {
+				saved += savePlayer(db, FIRST_PLAYER_ID + i, 1) ? 1 : 0;
+			}
+			const auto serialTime = serial.duration();
+			expect(eq(saved.load(), PLAYERS));
+
+			// Saves spread over threads as SaveManager::saveAll does, the pool decides how many run at once
+			const auto poolSize = db.getStats().poolSize;
+			const auto threadCount = std::max<size_t>(std::thread::hardware_concurrency(), poolSize);
+			std::atomic_uint32_t next = 0;
+			saved = 0;
+			Benchmark parallel;
+			{
+				std::vector<std::jthread> threads;
+				for (size_t i = 0; i < threadCount; ++i) {
+					threads.emplace_back([&] {
+						for (uint32_t player = next++; player < PLAYERS; player = next++) {
+							saved += savePlayer(db, FIRST_PLAYER_ID + player, 2) ? 1 : 0;
+						}
+					});
+				}
+			}
+			const auto parallelTime = parallel.duration();
+			expect(eq(saved.load(), PLAYERS));
+
+			const auto rows = db.storeQuery(fmt::format("SELECT COUNT(*) AS `count` FROM `player_storage` WHERE `player_id` >= {} AND `value` = 2", FIRST_PLAYER_ID));
+			expect(rows != nullptr);
+			if (rows) {
+				expect(eq(rows->getNumber<uint32_t>("count"), PLAYERS * STORAGES_PER_PLAYER));
+			}
+
+			const auto stats = db.getStats();
+			fmt::print("[database_pool] {} player saves: serial {:.0f} ms, {} threads over {} connections {:.0f} ms ({} waits, {:.2f} ms max wait)\n", PLAYERS, serialTime, threadCount, poolSize, parallelTime, stats.waits, stats.maxWaitTimeUs / 1000.0);
+
+			db.executeQuery(fmt::format("DELETE FROM `player_storage` WHERE `player_id` >= {}", FIRST_PLAYER_ID));
+			db.executeQuery(fmt::format("DELETE FROM `players` WHERE `account_id` = {}", ACCOUNT_ID));
+			db.executeQuery(fmt::format("DELETE FROM `account_vipgroups` WHERE `account_id` = {}", ACCOUNT_ID));
+			db.executeQuery(fmt::format("DELETE FROM `accounts` WHERE `id` = {}", ACCOUNT_ID));
+		};
+	}
+
+	inline suite<"DatabasePool"> suite_all = [] {
+		auto &db = g_database();
+
+		register_parallelQueries(db);
+		register_transactionAffinity(db);
+		register_nestedRollback(db);
+		register_lastInsertId(db);
+		register_saveAll(db);
+	};
+
+} // namespace it_database_pool
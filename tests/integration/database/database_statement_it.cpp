@@ -0,0 +1,59 @@
+#include <boost/ut.hpp>
+
+#include "database/database.hpp"
+#include "test_env.hpp"
+
+#include <limits>
+
+using namespace boost::ut;
+
+namespace it_database_statement {
+
+	inline void register_roundtrip() {
+		test("DBStatement binds and decodes typed values") = databaseTest([] {
+			const std::string blob("\0value\0", 7);
+			DBStatement insert("INSERT INTO `kv_store` (`key_name`, `timestamp`, `value`) VALUES (?, ?, ?)");
+			insert.bind(std::string_view("statement_it"));
+			insert.bind(std::numeric_limits<int64_t>::max());
+			insert.bindBlob(blob.data(), blob.size());
+			expect(insert.execute());
+
+			DBStatement select("SELECT `key_name`, `timestamp`, `value` FROM `kv_store` WHERE `key_name` = ?");
+			select.bind(std::string_view("statement_it"));
+			const auto result = select.store();
+			expect(result != nullptr);
+			if (!result) {
+				return;
+			}
+
+			expect(eq(result->countResults(), 1_ul));
+			expect(eq(result->getString("key_name"), std::string("statement_it")));
+			expect(eq(result->getNumber<int64_t>("timestamp"), std::numeric_limits<int64_t>::max()));
+			expect(eq(std::string(result->getString("value")), blob));
+		});
+	}
+
+	inline void register_nullAndEmpty() {
+		test("DBStatement returns no result when nothing matches") = databaseTest([] {
+			DBStatement select("SELECT `key_name` FROM `kv_store` WHERE `key_name` = ?");
+			select.bind(std::string_view("statement_it_missing"));
+			expect(select.store() == nullptr);
+		});
+
+		test("DBStatement decodes NULL as zero") = databaseTest([] {
+			DBStatement select("SELECT ? AS `value`");
+			select.bindNull();
+			const auto result = select.store();
+			expect(result != nullptr);
+			if (result) {
+				expect(eq(result->getNumber<int32_t>("value"), 0));
+			}
+		});
+	}
+
+	inline suite<"DatabaseStatement"> suite_all = [] {
+		register_roundtrip();
+		register_nullAndEmpty();
+	};
+
+} // namespace it_database_statement
@@ -0,0 +1,89 @@
+#include <boost/ut.hpp>
+
+#include "database/persistence_journal.hpp"
+#include "test_env.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <fmt/format.h>
+
+using namespace boost::ut;
+
+namespace it_persistence_journal {
+
+	const std::string JOURNAL_PATH = "persistence_journal_it.journal";
+
+	inline uint32_t countRows(Database &db, const std::string &key) {
+		const auto result = db.storeQuery(fmt::format("SELECT COUNT(*) AS `count` FROM `kv_store` WHERE `key_name` = {}", db.escapeString(key)));
+		return result ? result->getNumber<uint32_t>("count") : 0;
+	}
+
+	inline void register_writeBehind(Database &db) {
+		test("PersistenceJournal applies a captured save once flushed") = [&db] {
+			PersistenceJournal journal;
+			expect(journal.open(JOURNAL_PATH, true));
+			expect(journal.isEnabled());
+
+			const bool saved = journal.write("journal_it", [&db] {
+				DBStatement insert("INSERT INTO `kv_store` (`key_name`, `timestamp`, `value`) VALUES (?, ?, ?)");
+				insert.bind(std::string_view("journal_it")).bind(uint64_t(1)).bind(std::string_view("it's"));
+				return insert.execute();
+			});
+			expect(saved);
+
+			journal.flush();
+			expect(eq(countRows(db, "journal_it"), 1_u));
+
+			// Stored with the batch, a replay skips the record
+			const auto sequence = db.storeQuery("SELECT `value` FROM `server_config` WHERE `config` = 'persistence_journal_sequence'");
+			expect(sequence != nullptr);
+			expect(sequence && sequence->getNumber<uint64_t>("value") > 0);
+
+			const auto stats = journal.getStats();
+			expect(eq(stats.appended, 1_ull));
+			expect(eq(stats.flushed, 1_ull));
+			expect(eq(stats.pending, 0_ul));
+
+			journal.close();
+			expect(!std::filesystem::exists(JOURNAL_PATH));
+			db.executeQuery("DELETE FROM `kv_store` WHERE `key_name` = 'journal_it'");
+		};
+	}
+
+	inline void register_rollback(Database &db) {
+		test("PersistenceJournal keeps nothing of a rolled back save") = [&db] {
+			PersistenceJournal journal;
+			expect(journal.open(JOURNAL_PATH, true));
+
+			expect(!journal.write("journal_it", [&db] {
+				db.executeQuery("INSERT INTO `kv_store` (`key_name`, `timestamp`, `value`) VALUES ('journal_it_rollback', 0, '')");
+				return false;
+			}));
+			journal.flush();
+
+			expect(eq(journal.getStats().appended, 0_ull));
+			expect(eq(countRows(db, "journal_it_rollback"), 0_u));
+			journal.close();
+		};
+	}
+
+	inline void register_tornRecord() {
+		test("PersistenceJournal ignores a torn record on replay") = [] {
+			std::ofstream(JOURNAL_PATH, std::ios::binary) << "JRNL\x01\x02";
+
+			PersistenceJournal journal;
+			expect(journal.open(JOURNAL_PATH, false));
+			expect(!journal.isEnabled());
+			expect(!std::filesystem::exists(JOURNAL_PATH));
+		};
+	}
+
+	inline suite<"PersistenceJournal"> suite_all = [] {
+		auto &db = g_database();
+
+		register_writeBehind(db);
+		register_rollback(db);
+		register_tornRecord();
+	};
+
+} // namespace it_persistence_journal
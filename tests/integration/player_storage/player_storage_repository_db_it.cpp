@@ -27,7 +27,7 @@ namespace it_player_storage_repo_db {
 	}
 
 	inline void register_load(Database &db) {
-		test("DbPlayerStorageRepository::load") = databaseTest(db, [&db] {
+		test("DbPlayerStorageRepository::load") = databaseTest([&db] {
 			DbPlayerStorageRepository repo {};
 			createPlayer(db);
 			db.executeQuery(fmt::format("INSERT INTO `player_storage` (`player_id`,`key`,`value`) VALUES ({}, 100, 42), ({}, 200, 55)", PLAYER_ID, PLAYER_ID));
@@ -49,7 +49,7 @@ namespace it_player_storage_repo_db {
 	}
 
 	inline void register_deleteKeys(Database &db) {
-		test("DbPlayerStorageRepository::deleteKeys") = databaseTest(db, [&db] {
+		test("DbPlayerStorageRepository::deleteKeys") = databaseTest([&db] {
 			DbPlayerStorageRepository repo {};
 			createPlayer(db);
 			db.executeQuery(fmt::format("INSERT INTO `player_storage` (`player_id`,`key`,`value`) VALUES ({}, 1, 10), ({}, 2, 20), ({}, 3, 30)", PLAYER_ID, PLAYER_ID, PLAYER_ID));
@@ -62,7 +62,7 @@ namespace it_player_storage_repo_db {
 	}
 
 	inline void register_upsert(Database &db) {
-		test("DbPlayerStorageRepository::upsert") = databaseTest(db, [&db] {
+		test("DbPlayerStorageRepository::upsert") = databaseTest([&db] {
 			DbPlayerStorageRepository repo {};
 			createPlayer(db);
 			expect(repo.upsert(PLAYER_ID, { { 1, 10 }, { 2, 20 } }));
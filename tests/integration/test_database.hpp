@@ -104,7 +104,9 @@ public:
 		std::string portStr = get(env, "TEST_DB_PORT", "3306");
 		auto port = static_cast<uint32_t>(std::strtoul(portStr.c_str(), nullptr, 10));
 		std::string sock = get(env, "TEST_DB_SOCKET", "");
+		std::string poolSizeStr = get(env, "TEST_DB_POOL_SIZE", "4");
+		auto poolSize = static_cast<size_t>(std::strtoul(poolSizeStr.c_str(), nullptr, 10));
 
-		g_database().connect(&host, &user, &pass, &database, port, &sock);
+		g_database().connect(&host, &user, &pass, &database, port, &sock, poolSize);
 	}
 };
@@ -1,24 +1,16 @@
 #pragma once
 
-#include <exception>
 #include <functional>
 
 #include "database/database.hpp"
 
-inline auto databaseTest(Database &db, const std::function<void(void)> &load) {
-	return [&db, load] {
-		db.executeQuery("BEGIN");
-
-		std::exception_ptr ep {};
-		try {
+// Runs the test inside a transaction that is always rolled back. The transaction
+// keeps one connection of the pool, so every query of the test sees its own changes.
+inline auto databaseTest(const std::function<void(void)> &load) {
+	return [load] {
+		DBTransaction::executeWithinTransaction([&load] {
 			load();
-		} catch (const DatabaseException &) {
-			ep = std::current_exception();
-		}
-
-		db.executeQuery("ROLLBACK");
-		if (ep) {
-			std::rethrow_exception(ep);
-		}
+			return false;
+		});
 	};
 }
@@ -0,0 +1,489 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "pch.hpp"
+
+#include "bot_client.hpp"
+
+#include "core.hpp"
+#include "creatures/creatures_definitions.hpp"
+#include "utils/utils_definitions.hpp"
+#include "security/rsa.hpp"
+#include "utils/const.hpp"
+#include "utils/tools.hpp"
+
+namespace {
+	constexpr auto LOGIN_TIMEOUT = std::chrono::seconds(10);
+	constexpr size_t RSA_BLOCK_SIZE = 128;
+
+	constexpr std::array<std::string_view, 6> PHRASES = {
+		"hi",
+		"anyone selling a magic plate armor?",
+		"exura",
+		"trade",
+		"where is the temple?",
+		"lf team for the next hunt, knight level 120 here",
+	};
+
+	// Little endian packet body, the way the client writes it
+	class PacketWriter {
+	public:
+		void addByte(uint8_t value) {
+			bytes.emplace_back(value);
+		}
+
+		template <typename T>
+		void add(T value) {
+			for (size_t i = 0; i < sizeof(T); ++i) {
+				bytes.emplace_back(static_cast<uint8_t>(value >> (i * 8)));
+			}
+		}
+
+		void addString(std::string_view value) {
+			add<uint16_t>(static_cast<uint16_t>(value.size()));
+			bytes.insert(bytes.end(), value.begin(), value.end());
+		}
+
+		void addBytes(std::span<const uint8_t> value) {
+			bytes.insert(bytes.end(), value.begin(), value.end());
+		}
+
+		std::vector<uint8_t> bytes;
+	};
+
+	template <typename T>
+	T readValue(const uint8_t* data) {
+		T value = 0;
+		for (size_t i = 0; i < sizeof(T); ++i) {
+			value |= static_cast<T>(data[i]) << (i * 8);
+		}
+		return value;
+	}
+
+	bool inflateBody(std::span<const uint8_t> input, std::vector<uint8_t> &output) {
+		z_stream stream {};
+		if (inflateInit2(&stream, -15) != Z_OK) {
+			return false;
+		}
+
+		output.resize(NETWORKMESSAGE_MAXSIZE);
+		stream.next_in = const_cast<Bytef*>(input.data());
+		stream.avail_in = static_cast<uInt>(input.size());
+		stream.next_out = output.data();
+		stream.avail_out = static_cast<uInt>(output.size());
+
+		const int ret = inflate(&stream, Z_FINISH);
+		output.resize(stream.total_out);
+		inflateEnd(&stream);
+		return ret == Z_STREAM_END;
+	}
+}
+
+BotClient::BotClient(asio::io_context &ioContext, const BotOptions &options, BotAccount account, LoadTestStats &stats) :
+	options(options),
+	account(std::move(account)),
+	stats(stats),
+	strand(asio::make_strand(ioContext)),
+	socket(strand),
+	actionTimer(strand),
+	loginTimer(strand),
+	rng(std::random_device {}()) { }
+
+void BotClient::setReplay(std::vector<RecordedPacket> packets) {
+	replay = std::move(packets);
+}
+
+void BotClient::start() {
+	loginStart = std::chrono::steady_clock::now();
+	loginTimer.expires_after(LOGIN_TIMEOUT);
+	loginTimer.async_wait([self = shared_from_this()](const std::error_code &error) {
+		if (!error && self->state != State::Online && self->state != State::Closed) {
+			self->fail("login timed out");
+		}
+	});
+
+	socket.async_connect(options.endpoint, [self = shared_from_this()](const std::error_code &error) {
+		if (error) {
+			self->fail(error.message());
+			return;
+		}
+
+		std::error_code ignored;
+		self->socket.set_option(asio::ip::tcp::no_delay(true), ignored);
+		self->state = State::Challenge;
+		self->readFrameHeader();
+	});
+}
+
+void BotClient::stop() {
+	asio::post(strand, [self = shared_from_this()] {
+		if (self->state == State::Online) {
+			// Logout, the socket is closed once it is written
+			const std::array<uint8_t, 1> logout = { 0x14 };
+			self->sendPacket(logout, BotAction::Ping);
+			self->pendingAction.reset();
+		}
+		self->close();
+	});
+}
+
+void BotClient::readFrameHeader() {
+	asio::async_read(socket, asio::buffer(frameHeader), [self = shared_from_this()](const std::error_code &error, size_t) {
+		if (error) {
+			self->fail(error.message());
+			return;
+		}
+
+		// Blocks of 8 bytes, plus the checksum
+		self->readFrameBody(readValue<uint16_t>(self->frameHeader.data()) * 8 + 4);
+	});
+}
+
+void BotClient::readFrameBody(size_t size) {
+	frame.resize(size);
+	asio::async_read(socket, asio::buffer(frame), [self = shared_from_this()](const std::error_code &error, size_t) {
+		if (error) {
+			self->fail(error.message());
+			return;
+		}
+
+		self->onFrame();
+		if (self->state != State::Closed) {
+			self->readFrameHeader();
+		}
+	});
+}
+
+void BotClient::onFrame() {
+	const auto now = std::chrono::steady_clock::now();
+	switch (state) {
+		case State::Challenge: {
+			// Checksum, padding size, 0x1F, timestamp and random number
+			if (frame.size() < 11 || frame[5] != 0x1F) {
+				fail("unexpected login challenge");
+				return;
+			}
+			sendLogin(readValue<uint32_t>(frame.data() + 6), frame[10]);
+			break;
+		}
+
+		case State::LoggingIn: {
+			const auto checksum = readValue<uint32_t>(frame.data());
+			const std::span<uint8_t> data(frame.data() + 4, frame.size() - 4);
+			xtea::decrypt(data.data(), data.size(), decryptKeys);
+			if (data.empty() || static_cast<size_t>(data[0]) + 1 > data.size()) {
+				fail("invalid packet padding");
+				return;
+			}
+
+			const std::span<const uint8_t> body(data.data() + 1, data.size() - 1 - data[0]);
+			if ((checksum & (1U << 31)) == 0) {
+				onLoginFrame(body);
+				break;
+			}
+
+			std::vector<uint8_t> inflated;
+			if (!inflateBody(body, inflated)) {
+				fail("invalid compressed packet");
+				return;
+			}
+			onLoginFrame(inflated);
+			break;
+		}
+
+		case State::Online:
+			if (pendingAction) {
+				stats.addLatency(*pendingAction, now - pendingSince);
+				pendingAction.reset();
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+void BotClient::sendLogin(uint32_t challengeTimestamp, uint8_t challengeRandom) {
+	std::uniform_int_distribution<uint32_t> keyPart;
+	for (auto &part : key) {
+		part = keyPart(rng);
+	}
+	encryptKeys = xtea::expandEncryptKey(key);
+	decryptKeys = xtea::expandDecryptKey(key);
+
+	PacketWriter block;
+	block.addByte(0);
+	for (const auto part : key) {
+		block.add<uint32_t>(part);
+	}
+	block.addByte(0); // gamemaster flag
+	block.addString(fmt::format("{}\n{}", account.account, account.password));
+	block.addString(account.character);
+	block.add<uint32_t>(challengeTimestamp);
+	block.addByte(challengeRandom);
+	if (block.bytes.size() > RSA_BLOCK_SIZE) {
+		fail("account, password and character do not fit in the login block");
+		return;
+	}
+	block.bytes.resize(RSA_BLOCK_SIZE, 0);
+	g_RSA().encrypt(reinterpret_cast<char*>(block.bytes.data()));
+
+	PacketWriter login;
+	// Skipped by the server together with the protocol id
+	login.addByte(0);
+	login.addByte(0x0A);
+	login.add<uint16_t>(CLIENTOS_NEW_WINDOWS);
+	login.add<uint16_t>(CLIENT_VERSION);
+	login.add<uint32_t>(CLIENT_VERSION);
+	login.addString(fmt::format("{}.{:02d}", CLIENT_VERSION_UPPER, CLIENT_VERSION_LOWER));
+	login.addString(""); // assets hash
+	login.addByte(0); // game preview state
+	login.addBytes(block.bytes);
+	login.bytes.resize((login.bytes.size() + 7) / 8 * 8, 0);
+
+	PacketWriter output;
+	output.add<uint16_t>(static_cast<uint16_t>(login.bytes.size() / 8));
+	output.add<uint32_t>(adlerChecksum(login.bytes.data(), login.bytes.size()));
+	output.addBytes(login.bytes);
+
+	state = State::LoggingIn;
+	write(std::move(output.bytes));
+}
+
+void BotClient::onLoginFrame(std::span<const uint8_t> body) {
+	if (body.empty()) {
+		return;
+	}
+
+	switch (body[0]) {
+		case 0x14: {
+			// Login error with its message
+			std::string reason = "login refused";
+			if (body.size() >= 3) {
+				const auto length = std::min<size_t>(readValue<uint16_t>(body.data() + 1), body.size() - 3);
+				reason.assign(reinterpret_cast<const char*>(body.data()) + 3, length);
+			}
+			fail(reason);
+			break;
+		}
+
+		case 0x16:
+			fail("waiting list");
+			break;
+
+		case 0x17:
+			if (body.size() < 5) {
+				fail("invalid login packet");
+				return;
+			}
+
+			playerId = readValue<uint32_t>(body.data() + 1);
+			state = State::Online;
+			loginTimer.cancel();
+			stats.addLatency(BotAction::Login, std::chrono::steady_clock::now() - loginStart);
+			stats.setOnline(playerId);
+
+			if (replay.empty()) {
+				scheduleAction();
+			} else {
+				replayStart = std::chrono::steady_clock::now();
+				scheduleReplay();
+			}
+			break;
+
+		default:
+			// Some other message sent before the login one
+			break;
+	}
+}
+
+void BotClient::scheduleAction() {
+	const auto interval = options.actionInterval.count();
+	actionTimer.expires_after(std::chrono::milliseconds(std::uniform_int_distribution<int64_t>(interval / 2, interval * 3 / 2)(rng)));
+	actionTimer.async_wait([self = shared_from_this()](const std::error_code &error) {
+		if (!error && self->state == State::Online) {
+			self->runAction();
+			self->scheduleAction();
+		}
+	});
+}
+
+void BotClient::runAction() {
+	// Weights of walk, turn, say, attack, container, market and ping
+	static const std::array<double, 7> weights = { 40, 10, 15, 10, 10, 5, 10 };
+	std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+	const auto action = static_cast<BotAction>(pick(rng) + static_cast<size_t>(BotAction::Walk));
+
+	PacketWriter packet;
+	switch (action) {
+		case BotAction::Walk:
+			packet.addByte(static_cast<uint8_t>(0x65 + std::uniform_int_distribution<int>(0, 3)(rng)));
+			break;
+
+		case BotAction::Turn:
+			packet.addByte(static_cast<uint8_t>(0x6F + std::uniform_int_distribution<int>(0, 3)(rng)));
+			break;
+
+		case BotAction::Say:
+			packet.addByte(0x96);
+			packet.addByte(TALKTYPE_SAY);
+			packet.addString(PHRASES[std::uniform_int_distribution<size_t>(0, PHRASES.size() - 1)(rng)]);
+			break;
+
+		case BotAction::Attack: {
+			auto target = stats.getRandomPlayer(rng);
+			if (target == playerId) {
+				target = 0;
+			}
+			packet.addByte(0xA1);
+			packet.add<uint32_t>(target);
+			packet.add<uint32_t>(target);
+			break;
+		}
+
+		case BotAction::OpenContainer:
+			if (containerOpen) {
+				packet.addByte(0x87);
+				packet.addByte(0);
+			} else {
+				packet.addByte(0x82);
+				packet.add<uint16_t>(0xFFFF);
+				packet.add<uint16_t>(CONST_SLOT_BACKPACK);
+				packet.addByte(0);
+				packet.add<uint16_t>(options.containerItemId);
+				packet.addByte(0);
+				packet.addByte(0);
+			}
+			containerOpen = !containerOpen;
+			break;
+
+		case BotAction::Market:
+			packet.addByte(0xF5);
+			packet.addByte(MARKETREQUEST_OWN_OFFERS);
+			break;
+
+		default:
+			packet.addByte(0x1D);
+			break;
+	}
+
+	sendPacket(packet.bytes, action);
+}
+
+void BotClient::scheduleReplay() {
+	if (replayIndex >= replay.size()) {
+		stop();
+		return;
+	}
+
+	const auto offset = std::chrono::duration<double, std::milli>((replay[replayIndex].time - replay.front().time) / options.replaySpeed);
+	actionTimer.expires_at(replayStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset));
+	actionTimer.async_wait([self = shared_from_this()](const std::error_code &error) {
+		if (error || self->state != State::Online) {
+			return;
+		}
+
+		const auto &packet = self->replay[self->replayIndex++];
+		if (packet.data.empty()) {
+			// The recorded session ended here
+			self->stop();
+			return;
+		}
+
+		self->sendPacket({ reinterpret_cast<const uint8_t*>(packet.data.data()), packet.data.size() }, BotAction::Replay);
+		self->scheduleReplay();
+	});
+}
+
+void BotClient::sendPacket(std::span<const uint8_t> body, BotAction action) {
+	// Padding size, body and padding, encrypted in blocks of 8 bytes
+	const size_t padding = (8 - (body.size() + 1) % 8) % 8;
+	const size_t encryptedSize = body.size() + 1 + padding;
+
+	std::vector<uint8_t> output(2 + 4 + encryptedSize, 0);
+	output[0] = static_cast<uint8_t>(encryptedSize / 8);
+	output[1] = static_cast<uint8_t>((encryptedSize / 8) >> 8);
+	const auto checksum = ++sequence;
+	for (size_t i = 0; i < 4; ++i) {
+		output[2 + i] = static_cast<uint8_t>(checksum >> (i * 8));
+	}
+	output[6] = static_cast<uint8_t>(padding);
+	std::ranges::copy(body, output.begin() + 7);
+	xtea::encrypt(output.data() + 6, encryptedSize, encryptKeys);
+
+	if (!pendingAction) {
+		pendingAction = action;
+		pendingSince = std::chrono::steady_clock::now();
+	}
+	write(std::move(output));
+}
+
+void BotClient::write(std::vector<uint8_t> &&output) {
+	writeQueue.emplace_back(std::move(output));
+	if (!writing) {
+		flushWrites();
+	}
+}
+
+void BotClient::flushWrites() {
+	if (writeQueue.empty()) {
+		writing = false;
+		if (state == State::Closed) {
+			std::error_code ignored;
+			socket.close(ignored);
+		}
+		return;
+	}
+
+	writing = true;
+	asio::async_write(socket, asio::buffer(writeQueue.front()), [self = shared_from_this()](const std::error_code &error, size_t) {
+		if (error) {
+			self->writeQueue.clear();
+			self->writing = false;
+			self->fail(error.message());
+			return;
+		}
+
+		self->writeQueue.pop_front();
+		self->flushWrites();
+	});
+}
+
+void BotClient::fail(std::string_view reason) {
+	if (state == State::Closed) {
+		return;
+	}
+
+	if (state == State::Online) {
+		stats.addDisconnect();
+	} else {
+		stats.addLoginFailure(reason);
+	}
+	writeQueue.clear();
+	close();
+}
+
+void BotClient::close() {
+	if (state == State::Closed) {
+		return;
+	}
+
+	if (state == State::Online) {
+		stats.setOffline(playerId);
+	}
+	state = State::Closed;
+	actionTimer.cancel();
+	loginTimer.cancel();
+
+	// Pending writes close the socket once done
+	if (!writing) {
+		std::error_code ignored;
+		socket.close(ignored);
+	}
+}
@@ -0,0 +1,110 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include "load_test_stats.hpp"
+#include "security/xtea.hpp"
+#include "server/network/connection/packet_recorder.hpp"
+
+struct BotAccount {
+	std::string account;
+	std::string password;
+	std::string character;
+};
+
+struct BotOptions {
+	asio::ip::tcp::endpoint endpoint;
+	// Average time between two scripted actions of a bot
+	std::chrono::milliseconds actionInterval { 500 };
+	// Item in the backpack slot, opened and closed by the container action
+	uint16_t containerItemId = 2854;
+	// Recorded sessions are played this many times faster
+	double replaySpeed = 1.0;
+};
+
+/**
+ * A headless game client: logs in with the password authentication, then
+ * either plays scripted actions or replays a recorded session, measuring the
+ * time until the server answers each packet.
+ *
+ * Server frames are not parsed past the login: any frame received after a
+ * packet was sent counts as its answer, so the latency is the server turnaround
+ * including the dispatcher queue and the output flush.
+ */
+class BotClient : public std::enable_shared_from_this<BotClient> {
+public:
+	BotClient(asio::io_context &ioContext, const BotOptions &options, BotAccount account, LoadTestStats &stats);
+
+	// Packets of a recorded session to send instead of the scripted actions
+	void setReplay(std::vector<RecordedPacket> packets);
+
+	void start();
+	void stop();
+
+private:
+	enum class State : uint8_t {
+		Connecting,
+		Challenge,
+		LoggingIn,
+		Online,
+		Closed,
+	};
+
+	void readFrameHeader();
+	void readFrameBody(size_t size);
+	void onFrame();
+
+	void sendLogin(uint32_t challengeTimestamp, uint8_t challengeRandom);
+	void onLoginFrame(std::span<const uint8_t> body);
+
+	void scheduleAction();
+	void runAction();
+	void scheduleReplay();
+
+	void sendPacket(std::span<const uint8_t> body, BotAction action);
+	void write(std::vector<uint8_t> &&frame);
+	void flushWrites();
+
+	void fail(std::string_view reason);
+	void close();
+
+	const BotOptions &options;
+	const BotAccount account;
+	LoadTestStats &stats;
+
+	asio::strand<asio::io_context::executor_type> strand;
+	asio::ip::tcp::socket socket;
+	asio::steady_timer actionTimer;
+	asio::steady_timer loginTimer;
+
+	std::array<uint8_t, 2> frameHeader {};
+	std::vector<uint8_t> frame;
+	std::deque<std::vector<uint8_t>> writeQueue;
+	bool writing = false;
+
+	xtea::key_t key {};
+	xtea::round_keys_t encryptKeys {};
+	xtea::round_keys_t decryptKeys {};
+	uint32_t sequence = 0;
+
+	State state = State::Connecting;
+	uint32_t playerId = 0;
+	std::mt19937 rng;
+
+	// The packet waiting for an answer from the server
+	std::optional<BotAction> pendingAction;
+	std::chrono::steady_clock::time_point pendingSince;
+	std::chrono::steady_clock::time_point loginStart;
+
+	bool containerOpen = false;
+	std::vector<RecordedPacket> replay;
+	size_t replayIndex = 0;
+	std::chrono::steady_clock::time_point replayStart;
+};
@@ -0,0 +1,115 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "pch.hpp"
+
+#include "load_test_stats.hpp"
+
+std::string_view getBotActionName(BotAction action) {
+	switch (action) {
+		case BotAction::Login:
+			return "login";
+		case BotAction::Walk:
+			return "walk";
+		case BotAction::Turn:
+			return "turn";
+		case BotAction::Say:
+			return "say";
+		case BotAction::Attack:
+			return "attack";
+		case BotAction::OpenContainer:
+			return "container";
+		case BotAction::Market:
+			return "market";
+		case BotAction::Ping:
+			return "ping";
+		case BotAction::Replay:
+			return "replay";
+	}
+	return "unknown";
+}
+
+void LoadTestStats::addLatency(BotAction action, std::chrono::steady_clock::duration latency) {
+	const auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+	packets.fetch_add(1, std::memory_order_relaxed);
+
+	std::scoped_lock lock(mutex);
+	latencies[static_cast<size_t>(action)].emplace_back(static_cast<uint32_t>(std::min<int64_t>(us, std::numeric_limits<uint32_t>::max())));
+}
+
+void LoadTestStats::addLoginFailure(std::string_view reason) {
+	std::scoped_lock lock(mutex);
+	const auto it = loginFailures.find(reason);
+	if (it == loginFailures.end()) {
+		loginFailures.emplace(reason, 1);
+	} else {
+		++it->second;
+	}
+}
+
+void LoadTestStats::addDisconnect() {
+	disconnects.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoadTestStats::setOnline(uint32_t playerId) {
+	std::scoped_lock lock(mutex);
+	onlinePlayers.emplace_back(playerId);
+}
+
+void LoadTestStats::setOffline(uint32_t playerId) {
+	std::scoped_lock lock(mutex);
+	std::erase(onlinePlayers, playerId);
+}
+
+uint32_t LoadTestStats::getRandomPlayer(std::mt19937 &rng) const {
+	std::scoped_lock lock(mutex);
+	if (onlinePlayers.empty()) {
+		return 0;
+	}
+	return onlinePlayers[std::uniform_int_distribution<size_t>(0, onlinePlayers.size() - 1)(rng)];
+}
+
+void LoadTestStats::printProgress(std::chrono::steady_clock::duration elapsed) const {
+	size_t online;
+	size_t failures = 0;
+	{
+		std::scoped_lock lock(mutex);
+		online = onlinePlayers.size();
+		for (const auto &[reason, count] : loginFailures) {
+			failures += count;
+		}
+	}
+
+	const auto seconds = std::chrono::duration<double>(elapsed).count();
+	fmt::print("[{:7.1f}s] {} online, {} failed logins, {} disconnects, {} measured packets\n", seconds, online, failures, disconnects.load(std::memory_order_relaxed), packets.load(std::memory_order_relaxed));
+}
+
+void LoadTestStats::printReport(std::chrono::steady_clock::duration elapsed) const {
+	std::scoped_lock lock(mutex);
+	const auto seconds = std::chrono::duration<double>(elapsed).count();
+
+	fmt::print("\n{:<10} {:>9} {:>9} {:>9} {:>9} {:>9} {:>9}\n", "action", "count", "per sec", "p50 ms", "p95 ms", "p99 ms", "max ms");
+	for (size_t i = 0; i < latencies.size(); ++i) {
+		auto sorted = latencies[i];
+		if (sorted.empty()) {
+			continue;
+		}
+
+		std::ranges::sort(sorted);
+		const auto percentile = [&sorted](double p) {
+			return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))] / 1000.0;
+		};
+		fmt::print("{:<10} {:>9} {:>9.1f} {:>9.2f} {:>9.2f} {:>9.2f} {:>9.2f}\n", getBotActionName(static_cast<BotAction>(i)), sorted.size(), sorted.size() / seconds, percentile(0.5), percentile(0.95), percentile(0.99), sorted.back() / 1000.0);
+	}
+
+	for (const auto &[reason, count] : loginFailures) {
+		fmt::print("login failed {} times: {}\n", count, reason);
+	}
+	fmt::print("{} disconnects\n", disconnects.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,59 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+enum class BotAction : uint8_t {
+	Login,
+	Walk,
+	Turn,
+	Say,
+	Attack,
+	OpenContainer,
+	Market,
+	Ping,
+	Replay,
+
+	Last = Replay
+};
+
+std::string_view getBotActionName(BotAction action);
+
+/**
+ * Latencies measured by every bot, from sending a packet to the next frame
+ * received from the server, and the login outcomes.
+ */
+class LoadTestStats {
+public:
+	void addLatency(BotAction action, std::chrono::steady_clock::duration latency);
+	void addLoginFailure(std::string_view reason);
+	void addDisconnect();
+
+	void setOnline(uint32_t playerId);
+	void setOffline(uint32_t playerId);
+	// Another online bot to target, 0 when there is none
+	uint32_t getRandomPlayer(std::mt19937 &rng) const;
+
+	// One line with the totals, printed while the test runs
+	void printProgress(std::chrono::steady_clock::duration elapsed) const;
+	// Percentiles of every action
+	void printReport(std::chrono::steady_clock::duration elapsed) const;
+
+private:
+	static constexpr size_t ACTIONS = static_cast<size_t>(BotAction::Last) + 1;
+
+	mutable std::mutex mutex;
+	// Microseconds
+	std::array<std::vector<uint32_t>, ACTIONS> latencies;
+	std::map<std::string, uint32_t, std::less<>> loginFailures;
+	std::vector<uint32_t> onlinePlayers;
+
+	std::atomic_uint64_t packets = 0;
+	std::atomic_uint32_t disconnects = 0;
+};
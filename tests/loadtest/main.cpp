@@ -0,0 +1,206 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "pch.hpp"
+
+#include "bot_client.hpp"
+#include "security/rsa.hpp"
+
+namespace {
+	constexpr auto PROGRESS_INTERVAL = std::chrono::seconds(5);
+
+	struct LoadTestOptions {
+		std::string host = "127.0.0.1";
+		uint16_t port = 7172;
+		std::string accountsFile;
+		std::string replayFile;
+		uint32_t bots = 100;
+		std::chrono::seconds duration { 60 };
+		// Time between two bots connecting
+		std::chrono::milliseconds ramp { 50 };
+		BotOptions bot;
+	};
+
+	void printUsage() {
+		fmt::print(
+			"Usage: canary_loadtest --accounts <file> [options]\n"
+			"  --accounts <file>     one \"account password character\" per line\n"
+			"  --host <host>         game server host (127.0.0.1)\n"
+			"  --port <port>         game server port (7172)\n"
+			"  --bots <count>        bots to connect, accounts are reused round robin (100)\n"
+			"  --duration <seconds>  time to run after the last bot connected (60)\n"
+			"  --ramp <ms>           time between two bots connecting (50)\n"
+			"  --interval <ms>       average time between two actions of a bot (500)\n"
+			"  --container-id <id>   item in the backpack slot opened by the bots (2854)\n"
+			"  --replay <file>       replay the sessions of a packetRecorderFile instead\n"
+			"  --speed <factor>      replay speed (1.0)\n"
+		);
+	}
+
+	bool parseOptions(int argc, char* argv[], LoadTestOptions &options) {
+		for (int i = 1; i < argc; ++i) {
+			const std::string_view arg = argv[i];
+			if (i + 1 >= argc) {
+				fmt::print(stderr, "Missing value for {}\n", arg);
+				return false;
+			}
+
+			const std::string value = argv[++i];
+			try {
+				if (arg == "--host") {
+					options.host = value;
+				} else if (arg == "--port") {
+					options.port = static_cast<uint16_t>(std::stoul(value));
+				} else if (arg == "--accounts") {
+					options.accountsFile = value;
+				} else if (arg == "--bots") {
+					options.bots = static_cast<uint32_t>(std::stoul(value));
+				} else if (arg == "--duration") {
+					options.duration = std::chrono::seconds(std::stoul(value));
+				} else if (arg == "--ramp") {
+					options.ramp = std::chrono::milliseconds(std::stoul(value));
+				} else if (arg == "--interval") {
+					options.bot.actionInterval = std::chrono::milliseconds(std::max<unsigned long>(std::stoul(value), 2));
+				} else if (arg == "--container-id") {
+					options.bot.containerItemId = static_cast<uint16_t>(std::stoul(value));
+				} else if (arg == "--replay") {
+					options.replayFile = value;
+				} else if (arg == "--speed") {
+					options.bot.replaySpeed = std::max(std::stod(value), 0.01);
+				} else {
+					fmt::print(stderr, "Unknown option {}\n", arg);
+					return false;
+				}
+			} catch (const std::exception &) {
+				fmt::print(stderr, "Invalid value {} for {}\n", value, arg);
+				return false;
+			}
+		}
+		return !options.accountsFile.empty() && options.bots > 0;
+	}
+
+	std::vector<BotAccount> loadAccounts(const std::string &path) {
+		std::vector<BotAccount> accounts;
+		std::ifstream file(path);
+		std::string line;
+		while (std::getline(file, line)) {
+			std::istringstream stream(line);
+			BotAccount account;
+			// Character names may contain spaces, they take the rest of the line
+			if (stream >> account.account >> account.password >> std::ws && std::getline(stream, account.character)) {
+				while (!account.character.empty() && std::isspace(static_cast<unsigned char>(account.character.back()))) {
+					account.character.pop_back();
+				}
+				accounts.emplace_back(std::move(account));
+			}
+		}
+		return accounts;
+	}
+
+	// The recorded packets of every session, in recording order
+	std::vector<std::vector<RecordedPacket>> loadSessions(const std::string &path) {
+		std::map<uint32_t, std::vector<RecordedPacket>> sessions;
+		for (auto &packet : PacketRecorder::load(path)) {
+			sessions[packet.session].emplace_back(std::move(packet));
+		}
+
+		std::vector<std::vector<RecordedPacket>> result;
+		result.reserve(sessions.size());
+		for (auto &packets : sessions | std::views::values) {
+			result.emplace_back(std::move(packets));
+		}
+		return result;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	LoadTestOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	const auto accounts = loadAccounts(options.accountsFile);
+	if (accounts.empty()) {
+		fmt::print(stderr, "No accounts found in {}\n", options.accountsFile);
+		return EXIT_FAILURE;
+	}
+
+	std::vector<std::vector<RecordedPacket>> sessions;
+	if (!options.replayFile.empty()) {
+		sessions = loadSessions(options.replayFile);
+		if (sessions.empty()) {
+			fmt::print(stderr, "No recorded sessions found in {}\n", options.replayFile);
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Same key as the server, key.pem in the working directory or the default one
+	g_RSA().start();
+
+	asio::io_context ioContext;
+	std::error_code error;
+	asio::ip::tcp::resolver resolver(ioContext);
+	const auto endpoints = resolver.resolve(options.host, std::to_string(options.port), error);
+	if (error || endpoints.empty()) {
+		fmt::print(stderr, "Could not resolve {}: {}\n", options.host, error.message());
+		return EXIT_FAILURE;
+	}
+	options.bot.endpoint = endpoints.begin()->endpoint();
+
+	auto work = asio::make_work_guard(ioContext);
+	std::vector<std::jthread> threads;
+	for (uint32_t i = 0, n = std::max(std::thread::hardware_concurrency(), 1U); i < n; ++i) {
+		threads.emplace_back([&ioContext] { ioContext.run(); });
+	}
+
+	LoadTestStats stats;
+	const auto start = std::chrono::steady_clock::now();
+	auto nextProgress = start + PROGRESS_INTERVAL;
+	auto printProgress = [&] {
+		const auto now = std::chrono::steady_clock::now();
+		if (now >= nextProgress) {
+			stats.printProgress(now - start);
+			nextProgress = now + PROGRESS_INTERVAL;
+		}
+	};
+
+	std::vector<std::shared_ptr<BotClient>> bots;
+	bots.reserve(options.bots);
+	for (uint32_t i = 0; i < options.bots; ++i) {
+		auto bot = std::make_shared<BotClient>(ioContext, options.bot, accounts[i % accounts.size()], stats);
+		if (!sessions.empty()) {
+			bot->setReplay(sessions[i % sessions.size()]);
+		}
+		bot->start();
+		bots.emplace_back(std::move(bot));
+
+		std::this_thread::sleep_for(options.ramp);
+		printProgress();
+	}
+
+	const auto end = std::chrono::steady_clock::now() + options.duration;
+	while (std::chrono::steady_clock::now() < end) {
+		std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(std::chrono::milliseconds(100), end - std::chrono::steady_clock::now()));
+		printProgress();
+	}
+
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+	for (const auto &bot : bots) {
+		bot->stop();
+	}
+	work.reset();
+	// Let the logouts go out before tearing the sockets down
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+	ioContext.stop();
+	threads.clear();
+
+	stats.printReport(elapsed);
+	return EXIT_SUCCESS;
+}
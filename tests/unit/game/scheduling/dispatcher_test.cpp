@@ -0,0 +1,59 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "game/scheduling/dispatcher.hpp"
+#include "injection_fixture.hpp"
+#include "lib/thread/thread_pool.hpp"
+
+using namespace boost::ut;
+
+suite<"dispatcher"> dispatcherTest = [] {
+	InjectionFixture injectionFixture {};
+
+	test("Dispatcher::stopEvent from another thread wins over a due event") = [&injectionFixture] {
+		ThreadPool threadPool(injectionFixture.logger(), 2);
+		Dispatcher dispatcher(threadPool);
+		dispatcher.init();
+
+		// Holds the dispatcher inside a tick until the test releases it
+		const auto block = [&dispatcher](std::promise<void> &running, std::shared_future<void> release) {
+			auto task = [&running, release] {
+				running.set_value();
+				release.wait();
+			};
+			dispatcher.addEvent(std::move(task), "DispatcherTest::block");
+		};
+
+		std::promise<void> firstRunning;
+		std::promise<void> firstRelease;
+		block(firstRunning, firstRelease.get_future().share());
+		firstRunning.get_future().wait();
+
+		// Not due yet on the blocked tick, due on the next one
+		std::atomic_bool fired = false;
+		const auto eventId = dispatcher.scheduleEvent(20, [&fired] { fired = true; }, "DispatcherTest::stopped");
+
+		std::promise<void> secondRunning;
+		std::promise<void> secondRelease;
+		block(secondRunning, secondRelease.get_future().share());
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(30));
+		firstRelease.set_value();
+		secondRunning.get_future().wait();
+
+		// The event is due and in the wheel, the tick reaches it as soon as the block returns
+		dispatcher.stopEvent(eventId);
+		secondRelease.set_value();
+
+		std::promise<void> drained;
+		dispatcher.addEvent([&drained] { drained.set_value(); }, "DispatcherTest::drained");
+		drained.get_future().wait();
+		expect(!fired);
+
+		// Wakes the dispatcher loop so it can see the pool stopping
+		dispatcher.cycleEvent(10, [] { }, "DispatcherTest::wakeUp");
+		dispatcher.shutdown();
+		threadPool.shutdown();
+	};
+};
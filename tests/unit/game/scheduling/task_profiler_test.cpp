@@ -0,0 +1,61 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "game/scheduling/task_profiler.hpp"
+#include "lib/thread/thread_pool.hpp"
+
+using namespace boost::ut;
+
+suite<"task_profiler"> taskProfilerTest = [] {
+	test("histogram buckets are log2 of microseconds") = [] {
+		expect(eq(TaskProfiler::getHistogramBucket(0), 0));
+		expect(eq(TaskProfiler::getHistogramBucket(999), 0));
+		expect(eq(TaskProfiler::getHistogramBucket(1'000), 1));
+		expect(eq(TaskProfiler::getHistogramBucket(2'000), 2));
+		expect(eq(TaskProfiler::getHistogramBucket(3'999), 2));
+		expect(eq(TaskProfiler::getHistogramBucket(50'000'000), 16));
+		expect(eq(TaskProfiler::getHistogramBucket(std::numeric_limits<uint64_t>::max()), TASK_PROFILER_HISTOGRAM_BUCKETS - 1));
+	};
+
+	test("contexts are aggregated and sorted by total time") = [] {
+		TaskProfiler profiler(ThreadPool::getThreadId() + 1);
+		const auto fast = Task::internContext("TaskProfilerTest::fast");
+		const auto slow = Task::internContext("TaskProfilerTest::slow");
+		expect(eq(Task::getContextName(fast.id), fast.name));
+
+		const auto now = TaskProfiler::Clock::now();
+		for (int i = 0; i < 3; ++i) {
+			profiler.record(fast.id, now);
+		}
+		profiler.record(slow.id, now - std::chrono::milliseconds(10));
+
+		const auto profiles = profiler.getTopContexts();
+		expect(eq(profiles.size(), 2U) >> fatal);
+		expect(eq(profiles[0].context, slow.name));
+		expect(eq(profiles[0].count, 1U));
+		expect(ge(profiles[0].maxNs, 10'000'000U));
+		expect(eq(profiles[0].histogram[TaskProfiler::getHistogramBucket(profiles[0].maxNs)], 1U));
+		expect(eq(profiles[1].context, fast.name));
+		expect(eq(profiles[1].count, 3U));
+
+		expect(eq(profiler.getTopContexts(1).size(), 1U));
+
+		profiler.reset();
+		expect(profiler.getTopContexts().empty());
+	};
+
+	test("runtime formatted contexts are interned by content") = [] {
+		const auto interned = Task::internContext("TaskProfilerTest::runtime");
+		const auto contexts = Task::getInternedContexts();
+
+		bool sameContext = true;
+		for (int i = 0; i < 2 * Task::MAX_CONTEXTS; ++i) {
+			const auto name = fmt::format("TaskProfilerTest::{}", "runtime");
+			const auto context = Task::internContext(name);
+			sameContext = sameContext && context.id == interned.id && context.name.data() == interned.name.data();
+		}
+		expect(sameContext);
+		expect(eq(Task::getInternedContexts(), contexts));
+	};
+};
@@ -0,0 +1,93 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "game/scheduling/timer_wheel.hpp"
+
+using namespace boost::ut;
+
+suite<"timer_wheel"> timerWheelTest = [] {
+	constexpr int64_t start = 1700000000000;
+
+	test("TimerWheel fires nodes in expiration order") = [] {
+		TimerWheel<int> wheel(start);
+		wheel.insert(start + 300, 3);
+		wheel.insert(start + 10, 1);
+		wheel.insert(start + 70000, 4);
+		wheel.insert(start + 10, 2);
+
+		std::vector<int> fired;
+		const auto collect = [&fired](int &value, uint32_t) -> int64_t {
+			fired.emplace_back(value);
+			return -1;
+		};
+
+		wheel.advance(start + 9, collect);
+		expect(fired.empty());
+
+		wheel.advance(start + 300, collect);
+		expect(eq(fired, std::vector<int> { 1, 2, 3 }));
+
+		wheel.advance(start + 70000, collect);
+		expect(eq(fired.size(), 4U));
+		expect(wheel.empty());
+	};
+
+	test("TimerWheel::erase drops a pending node") = [] {
+		TimerWheel<int> wheel(start);
+		const auto handle = wheel.insert(start + 50, 1);
+		wheel.insert(start + 60, 2);
+
+		expect(wheel.erase(handle));
+		expect(not wheel.erase(handle));
+
+		std::vector<int> fired;
+		wheel.advance(start + 100, [&fired](int &value, uint32_t) -> int64_t {
+			fired.emplace_back(value);
+			return -1;
+		});
+		expect(eq(fired, std::vector<int> { 2 }));
+	};
+
+	test("TimerWheel re-arms a node when the callback returns a new time") = [] {
+		TimerWheel<int> wheel(start);
+		wheel.insert(start + 100, 0);
+
+		int executions = 0;
+		wheel.advance(start + 1000, [&executions](int &, uint32_t) -> int64_t {
+			++executions;
+			return executions < 5 ? start + executions * 100 + 100 : -1;
+		});
+		expect(eq(executions, 5));
+		expect(wheel.empty());
+	};
+
+	test("TimerWheel::nextExpiration never passes the real expiration") = [] {
+		TimerWheel<int> wheel(start);
+		expect(eq(wheel.nextExpiration(), std::numeric_limits<int64_t>::max()));
+
+		wheel.insert(start + 5000, 1);
+		expect(le(wheel.nextExpiration(), start + 5000));
+
+		wheel.insert(start + 20, 2);
+		expect(eq(wheel.nextExpiration(), start + 20));
+	};
+
+	test("TimerWheel handles expirations beyond the wheel range") = [] {
+		TimerWheel<int> wheel(start);
+		const int64_t farAway = start + (1LL << 33);
+		wheel.insert(farAway, 1);
+
+		int64_t firedAt = 0;
+		const auto collect = [&wheel, &firedAt](int &, uint32_t) -> int64_t {
+			firedAt = wheel.getCurrentTime();
+			return -1;
+		};
+
+		wheel.advance(farAway - 1, collect);
+		expect(eq(firedAt, 0));
+
+		wheel.advance(farAway + 10, collect);
+		expect(eq(firedAt, farAway));
+	};
+};
@@ -14,6 +14,55 @@
 #include "utils/tools.hpp"
 #include "injection_fixture.hpp"
 
+namespace {
+	// Store over a plain map that records the write-back batches
+	class WriteBackKV final : public KVStore {
+	public:
+		WriteBackKV(Logger &logger, size_t capacity) :
+			KVStore(logger, capacity) { }
+
+		std::map<std::string, ValueWrapper> saved;
+		std::vector<size_t> batches;
+		size_t loads = 0;
+		bool failing = false;
+		bool rejected = false;
+
+	protected:
+		std::vector<std::string> loadPrefix(const std::string &prefix = "") override {
+			std::vector<std::string> keys;
+			for (const auto &[key, value] : saved) {
+				if (key.starts_with(prefix)) {
+					keys.emplace_back(key.substr(prefix.size()));
+				}
+			}
+			return keys;
+		}
+		std::optional<ValueWrapper> load(const std::string &key) override {
+			++loads;
+			const auto it = saved.find(key);
+			return it != saved.end() ? std::make_optional(it->second) : std::nullopt;
+		}
+		bool save(const std::string &key, const ValueWrapper &value) override {
+			if (value.isDeleted()) {
+				saved.erase(key);
+			} else {
+				saved.insert_or_assign(key, value);
+			}
+			return true;
+		}
+		bool saveBatch(const std::vector<std::pair<std::string, ValueWrapper>> &batch) override {
+			if (failing) {
+				return false;
+			}
+			batches.push_back(batch.size());
+			return KVStore::saveBatch(batch);
+		}
+		bool takeRejectedWrites() override {
+			return std::exchange(rejected, false);
+		}
+	};
+}
+
 suite<"kv"> kvTest = [] {
 	InjectionFixture injectionFixture {};
 
@@ -126,6 +175,109 @@ suite<"kv"> kvTest = [] {
 			  expect(!kv.get("key2").has_value());
 		  };
 
+	test("Write-back saves only the changed keys") = [&injectionFixture] {
+		WriteBackKV kv(injectionFixture.logger(), KVStore::MAX_SIZE);
+		kv.set("key1", 1);
+		kv.scoped("scope")->set("key2", 2);
+		expect(kv.saveAll());
+		expect(eq(kv.batches.size(), 1_ul));
+		expect(eq(kv.batches.back(), 2_ul));
+
+		expect(kv.saveAll());
+		expect(eq(kv.batches.size(), 1_ul));
+
+		kv.set("key1", 3);
+		kv.remove("scope.key2");
+		expect(kv.saveAll());
+		expect(eq(kv.batches.back(), 2_ul));
+		expect(eq(kv.saved.at("key1").get<int>(), 3));
+		expect(!kv.saved.contains("scope.key2"));
+		expect(eq(kv.getStats().dirty, 0_ul));
+	};
+
+	test("Evicted keys are read back before being written") = [&injectionFixture] {
+		// One entry per shard
+		WriteBackKV kv(injectionFixture.logger(), KVStore::SHARDS);
+		for (int i = 0; i < 500; ++i) {
+			kv.set(fmt::format("key{}", i), i);
+		}
+		expect(le(kv.getStats().size, KVStore::SHARDS));
+		for (int i = 0; i < 500; ++i) {
+			expect(eq(kv.get(fmt::format("key{}", i))->get<int>(), i));
+		}
+		expect(eq(kv.loads, 0_ul));
+
+		expect(kv.saveAll());
+		expect(eq(kv.saved.size(), 500_ul));
+		expect(eq(kv.getStats().dirty, 0_ul));
+	};
+
+	test("A failed write-back is retried") = [&injectionFixture] {
+		WriteBackKV kv(injectionFixture.logger(), KVStore::MAX_SIZE);
+		kv.set("key1", 1);
+		kv.failing = true;
+		expect(!kv.saveAll());
+		expect(eq(kv.getStats().dirty, 1_ul));
+
+		kv.failing = false;
+		expect(kv.saveAll());
+		expect(eq(kv.saved.at("key1").get<int>(), 1));
+	};
+
+	test("A rejected write-back writes the cached keys again") = [&injectionFixture] {
+		WriteBackKV kv(injectionFixture.logger(), KVStore::MAX_SIZE);
+		kv.set("key1", 1);
+		kv.set("key2", 2);
+		expect(kv.saveAll());
+		expect(eq(kv.getStats().dirty, 0_ul));
+
+		// Accepted by saveBatch, lost afterwards
+		kv.saved.clear();
+		kv.rejected = true;
+		expect(kv.saveAll());
+		expect(eq(kv.batches.back(), 2_ul));
+		expect(eq(kv.saved.at("key1").get<int>(), 1));
+		expect(eq(kv.saved.at("key2").get<int>(), 2));
+		expect(eq(kv.getStats().dirty, 0_ul));
+	};
+
+	test("A failed flush keeps the changed keys") = [&injectionFixture] {
+		WriteBackKV kv(injectionFixture.logger(), KVStore::MAX_SIZE);
+		kv.set("key1", 1);
+		kv.set("key2", 2);
+		expect(kv.saveAll());
+		kv.set("key1", 3);
+		kv.failing = true;
+		kv.flush();
+		expect(eq(kv.getStats().size, 1_ul));
+		expect(eq(kv.getStats().dirty, 1_ul));
+
+		kv.failing = false;
+		kv.flush();
+		expect(eq(kv.getStats().size, 0_ul));
+		expect(eq(kv.saved.at("key1").get<int>(), 3));
+	};
+
+	test("Keys merge the backend with evicted and cached changes") = [&injectionFixture] {
+		WriteBackKV kv(injectionFixture.logger(), KVStore::SHARDS);
+		for (int i = 0; i < 100; ++i) {
+			kv.set(fmt::format("saved{}", i), i);
+		}
+		expect(kv.saveAll());
+		// Evicts most of them before they are written
+		for (int i = 0; i < 100; ++i) {
+			kv.set(fmt::format("pending{}", i), i);
+		}
+		kv.remove("saved0");
+
+		const auto keys = kv.keys();
+		expect(eq(keys.size(), 199_ul));
+		expect(!keys.contains("saved0"));
+		expect(keys.contains("saved1"));
+		expect(keys.contains("pending0"));
+		expect(keys.contains("pending99"));
+	};
+
 	test("Keys skip deleted entries")
 		= [&injectionFixture] {
 			  auto [kv] = injectionFixture.get<KVStore>();
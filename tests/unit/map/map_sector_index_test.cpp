@@ -0,0 +1,56 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "map/utils/mapsector.hpp"
+
+using namespace boost::ut;
+
+suite<"map"> mapSectorIndexTest = [] {
+	test("MapSectorIndex::find returns nullptr for missing sectors") = [] {
+		MapSectorIndex index;
+		expect(index.find(32000, 32000) == nullptr);
+		expect(index.find(0, 0) == nullptr);
+		expect(index.find(0xFFFF, 0xFFFF) == nullptr);
+		// Neighbour lookups of sector 0 underflow to huge coordinates
+		expect(index.find(static_cast<uint32_t>(-SECTOR_SIZE), 0) == nullptr);
+		expect(eq(index.size(), size_t { 0 }));
+	};
+
+	test("MapSectorIndex::emplace creates one sector per 16x16 tiles") = [] {
+		MapSectorIndex index;
+		const auto [sector, created] = index.emplace(32000, 32000);
+		expect(created);
+		expect(sector != nullptr);
+
+		const auto [sameSector, createdAgain] = index.emplace(32015, 32015);
+		expect(!createdAgain);
+		expect(sameSector == sector);
+		expect(index.find(32001, 32014) == sector);
+		expect(index.find(32016, 32000) == nullptr);
+		expect(index.find(32000, 31999) == nullptr);
+		expect(eq(index.size(), size_t { 1 }));
+	};
+
+	test("MapSectorIndex keeps sectors at stable addresses") = [] {
+		MapSectorIndex index;
+		std::vector<std::pair<Position, MapSector*>> sectors;
+		for (uint32_t x = 0; x <= 0xFFFF; x += 1021) {
+			for (uint32_t y = 0; y <= 0xFFFF; y += 997) {
+				sectors.emplace_back(Position(x, y, 7), index.emplace(x, y).first);
+			}
+		}
+
+		for (const auto &[position, sector] : sectors) {
+			expect(index.find(position.x, position.y) == sector) << position.toString();
+		}
+		expect(eq(index.size(), sectors.size()));
+	};
+
+	test("MapSectorIndex::emplace rejects coordinates out of the map range") = [] {
+		MapSectorIndex index;
+		const auto [sector, created] = index.emplace(0x10000, 0);
+		expect(!created);
+		expect(sector == nullptr);
+	};
+};
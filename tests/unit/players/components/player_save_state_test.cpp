@@ -0,0 +1,131 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "creatures/players/components/player_save_state.hpp"
+
+using namespace boost::ut;
+
+static void reg_nothing_persisted_after_load() {
+	test("no section is known before the first save") = [] {
+		PlayerSaveState state;
+		expect(state.getPersisted(PlayerSaveSection::Items) == nullptr);
+		expect(!state.isUnchanged(PlayerSaveSection::Items, 0));
+	};
+}
+
+static void reg_commit_keeps_staged_snapshot() {
+	test("commit keeps the staged snapshots") = [] {
+		PlayerSaveState state;
+		state.begin();
+		state.report()[PlayerSaveSection::Items] = { true, 2, 1, 64 };
+		state.stage(PlayerSaveSection::Items, { 42, { { 101, 7 }, { 102, 8 } } });
+		state.commit(1.5);
+
+		expect(state.isUnchanged(PlayerSaveSection::Items, 42));
+		expect(!state.isUnchanged(PlayerSaveSection::Items, 43));
+		const auto* persisted = state.getPersisted(PlayerSaveSection::Items);
+		expect(persisted != nullptr && persisted->rows.size() == 2);
+		// Sections not staged during the save stay unknown
+		expect(state.getPersisted(PlayerSaveSection::Stash) == nullptr);
+
+		const auto &report = state.getLastReport();
+		expect(eq(report.rows(), 2u));
+		expect(eq(report.bytes(), size_t { 64 }));
+		expect(eq(report.skipped(), static_cast<uint32_t>(PlayerSaveSection::Count) - 1));
+		expect(eq(report.durationMs, 1.5));
+	};
+}
+
+static void reg_unchanged_section_survives_save() {
+	test("a skipped section keeps its previous snapshot") = [] {
+		PlayerSaveState state;
+		state.begin();
+		state.stage(PlayerSaveSection::Spells, { 7, {} });
+		state.commit(0);
+
+		state.begin();
+		state.stage(PlayerSaveSection::Kills, { 9, {} });
+		state.commit(0);
+
+		expect(state.isUnchanged(PlayerSaveSection::Spells, 7));
+		expect(state.isUnchanged(PlayerSaveSection::Kills, 9));
+	};
+}
+
+static void reg_discard_forgets_everything() {
+	test("a failed save forgets every snapshot") = [] {
+		PlayerSaveState state;
+		state.begin();
+		state.stage(PlayerSaveSection::Items, { 42, {} });
+		state.commit(0);
+
+		state.begin();
+		state.stage(PlayerSaveSection::Stash, { 5, {} });
+		state.discard(0);
+
+		expect(state.getPersisted(PlayerSaveSection::Items) == nullptr);
+		expect(state.getPersisted(PlayerSaveSection::Stash) == nullptr);
+	};
+}
+
+static void reg_front_insert_keeps_sids() {
+	test("an item added in front of a container rewrites one row") = [] {
+		// A backpack in a slot, holding 20 items
+		std::array<int, 22> objects {};
+		std::vector<const void*> items;
+		for (size_t i = 0; i <= 20; ++i) {
+			items.emplace_back(&objects[i]);
+		}
+		const auto first = PlayerSaveState::assignSids(items, { { 0, 1 }, { 1, 21 } }, nullptr);
+		PlayerSaveState::Sids persisted;
+		for (size_t i = 0; i < items.size(); ++i) {
+			persisted.emplace(items[i], first[i]);
+		}
+
+		items.insert(items.begin() + 1, &objects[21]);
+		const auto second = PlayerSaveState::assignSids(items, { { 0, 1 }, { 1, 22 } }, &persisted);
+
+		// A row changes when its sid does, or its pid, which is the sid of the backpack
+		size_t changed = 0;
+		for (size_t i = 0; i < items.size(); ++i) {
+			const auto it = persisted.find(items[i]);
+			changed += it == persisted.end() || it->second != second[i] ? 1 : 0;
+		}
+		expect(eq(changed, size_t { 1 }));
+		expect(eq(second[0], first[0]));
+		// The loader orders the siblings by sid
+		expect(std::ranges::adjacent_find(second.begin() + 1, second.end(), std::ranges::greater_equal {}) == second.end());
+		expect(second[1] >= PlayerSaveState::FIRST_SID);
+	};
+}
+
+static void reg_no_room_numbers_again() {
+	test("sids are numbered again when there is no room between siblings") = [] {
+		std::array<int, 3> objects {};
+		const std::vector<const void*> items { &objects[0], &objects[1], &objects[2] };
+		const PlayerSaveState::Sids persisted { { items[0], 101 }, { items[2], 102 } };
+
+		const auto sids = PlayerSaveState::assignSids(items, { { 0, 3 } }, &persisted);
+		constexpr auto gap = PlayerSaveState::SID_GAP;
+		expect(eq(sids, std::vector<int32_t> { PlayerSaveState::FIRST_SID - 1 + gap, PlayerSaveState::FIRST_SID - 1 + 2 * gap, PlayerSaveState::FIRST_SID - 1 + 3 * gap }));
+	};
+}
+
+suite<"player_save_state"> playerSaveStateTests = [] {
+	reg_nothing_persisted_after_load();
+	reg_commit_keeps_staged_snapshot();
+	reg_unchanged_section_survives_save();
+	reg_discard_forgets_everything();
+	reg_front_insert_keeps_sids();
+	reg_no_room_numbers_again();
+};
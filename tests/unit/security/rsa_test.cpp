@@ -29,4 +29,25 @@ suite<"security"> rsaTest = [] {
 			eq(std::string { "error" }, logger.logs[0].level) and eq(std::string { "File key.pem not found or have problem on loading... Setting standard rsa key\n" }, logger.logs[0].message)
 		);
 	};
+
+	test("RSA::decrypt reverses RSA::encrypt") = [] {
+		di::extension::injector<> injector {};
+		DI::setTestContainer(&InMemoryLogger::install(injector));
+
+		auto &rsa = DI::create<RSA &>();
+		rsa.start();
+
+		// Leading zero like the login block, so the message is below the modulus
+		std::array<char, 128> original {};
+		for (size_t i = 1; i < original.size(); ++i) {
+			original[i] = static_cast<char>(i * 7);
+		}
+
+		auto block = original;
+		rsa.encrypt(block.data());
+		expect(block != original);
+
+		rsa.decrypt(block.data());
+		expect(block == original);
+	};
 };
@@ -0,0 +1,77 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "security/xtea.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	// Textbook XTEA, one little endian block at a time
+	void referenceEncrypt(uint8_t* data, size_t length, const xtea::key_t &key) {
+		for (size_t pos = 0; pos < length; pos += 8) {
+			uint32_t v0;
+			uint32_t v1;
+			std::memcpy(&v0, data + pos, 4);
+			std::memcpy(&v1, data + pos + 4, 4);
+			uint32_t sum = 0;
+			for (size_t i = 0; i < 32; ++i) {
+				v0 += (((v1 << 4) ^ (v1 >> 5)) + v1) ^ (sum + key[sum & 3]);
+				sum += 0x9E3779B9;
+				v1 += (((v0 << 4) ^ (v0 >> 5)) + v0) ^ (sum + key[(sum >> 11) & 3]);
+			}
+			std::memcpy(data + pos, &v0, 4);
+			std::memcpy(data + pos + 4, &v1, 4);
+		}
+	}
+
+	constexpr std::array<xtea::Engine, 4> engines = { xtea::Engine::Scalar, xtea::Engine::SSE2, xtea::Engine::AVX2, xtea::Engine::NEON };
+}
+
+suite<"security"> xteaTest = [] {
+	test("xtea::encrypt matches the published test vector") = [] {
+		const xtea::key_t key = { 0x00010203, 0x04050607, 0x08090A0B, 0x0C0D0E0F };
+		const auto keys = xtea::expandEncryptKey(key);
+		for (const auto engine : engines) {
+			std::array<uint32_t, 2> block = { 0x41424344, 0x45464748 };
+			xtea::encrypt(engine, reinterpret_cast<uint8_t*>(block.data()), 8, keys);
+			expect(eq(0x497DF3D0u, block[0]) and eq(0x72612CB5u, block[1])) << xtea::getEngineName(engine);
+		}
+	};
+
+	test("xtea engines match the reference for every block count") = [] {
+		std::mt19937 rng(7);
+		for (size_t blocks = 0; blocks <= 40; ++blocks) {
+			const xtea::key_t key = { static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng()) };
+			const auto encryptKeys = xtea::expandEncryptKey(key);
+			const auto decryptKeys = xtea::expandDecryptKey(key);
+
+			// One byte of offset, the network buffers are not aligned either
+			std::vector<uint8_t> plain(blocks * 8 + 1);
+			std::ranges::generate(plain, [&rng] { return static_cast<uint8_t>(rng()); });
+			auto expected = plain;
+			referenceEncrypt(expected.data() + 1, blocks * 8, key);
+
+			for (const auto engine : engines) {
+				auto data = plain;
+				xtea::encrypt(engine, data.data() + 1, blocks * 8, encryptKeys);
+				expect(data == expected) << xtea::getEngineName(engine) << blocks << "blocks encrypt";
+				xtea::decrypt(engine, data.data() + 1, blocks * 8, decryptKeys);
+				expect(data == plain) << xtea::getEngineName(engine) << blocks << "blocks decrypt";
+			}
+		}
+	};
+
+	test("xtea picks a supported engine") = [] {
+		expect(xtea::isSupported(xtea::Engine::Scalar));
+		expect(xtea::isSupported(xtea::getBestEngine()));
+	};
+};
@@ -0,0 +1,53 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "lib/logging/in_memory_logger.hpp"
+
+#include "server/network/connection/packet_recorder.hpp"
+
+using namespace boost::ut;
+
+suite<"packet_recorder"> packetRecorderTest = [] {
+	di::extension::injector<> injector {};
+	DI::setTestContainer(&InMemoryLogger::install(injector));
+
+	test("PacketRecorder::load reads back the recorded sessions") = [] {
+		const auto path = (std::filesystem::temp_directory_path() / "canary_packet_recorder_test.bin").string();
+		const std::array<uint8_t, 3> walk = { 0x65, 0x00, 0xFF };
+		const std::array<uint8_t, 1> ping = { 0x1D };
+
+		PacketRecorder recorder;
+		expect(recorder.start(path) >> fatal);
+		const auto first = recorder.newSession();
+		const auto second = recorder.newSession();
+		recorder.record(first, walk.data(), walk.size());
+		recorder.record(second, ping.data(), ping.size());
+		recorder.record(first, nullptr, 0);
+		recorder.stop();
+
+		// Nothing is written once stopped
+		recorder.record(second, ping.data(), ping.size());
+
+		const auto packets = PacketRecorder::load(path);
+		std::filesystem::remove(path);
+
+		expect(eq(packets.size(), size_t { 3 }) >> fatal);
+		expect(first != second);
+		expect(eq(packets[0].session, first));
+		expect(eq(packets[0].data, std::string("\x65\x00\xFF", 3)));
+		expect(eq(packets[1].session, second));
+		expect(eq(packets[1].data, std::string("\x1D", 1)));
+		expect(eq(packets[2].session, first));
+		expect(packets[2].data.empty());
+		expect(packets[0].time <= packets[2].time);
+	};
+
+	test("PacketRecorder::load rejects other files") = [] {
+		const auto path = (std::filesystem::temp_directory_path() / "canary_packet_recorder_invalid.bin").string();
+		std::ofstream(path, std::ios::binary) << "not a recording";
+
+		expect(PacketRecorder::load(path).empty());
+		std::filesystem::remove(path);
+	};
+};
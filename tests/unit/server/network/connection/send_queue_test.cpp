@@ -0,0 +1,50 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "server/network/connection/connection.hpp"
+
+using namespace boost::ut;
+
+suite<"send_queue"> sendQueueTest = [] {
+	test("ConnectionManager::addQueueSample counts the queue depth per bucket") = [] {
+		ConnectionManager manager;
+		manager.addQueueSample(0);
+		manager.addQueueSample(4 * 1024);
+		manager.addQueueSample(4 * 1024 + 1);
+		manager.addQueueSample(300 * 1024);
+		manager.addQueueSample(8 * 1024 * 1024);
+
+		const auto stats = manager.getStats();
+		expect(eq(stats.queueDepth[0], uint64_t { 2 }));
+		expect(eq(stats.queueDepth[1], uint64_t { 1 }));
+		expect(eq(stats.queueDepth[2], uint64_t { 0 }));
+		expect(eq(stats.queueDepth[3], uint64_t { 0 }));
+		expect(eq(stats.queueDepth[4], uint64_t { 1 }));
+		expect(eq(stats.queueDepth[5], uint64_t { 1 }));
+	};
+
+	test("ConnectionManager::setSendQueueLimits keeps the low watermark under the high one") = [] {
+		ConnectionManager manager;
+		manager.setSendQueueLimits({ 64 * 1024, 256 * 1024, 1024 * 1024, std::chrono::seconds(5) });
+
+		const auto limits = manager.getSendQueueLimits();
+		expect(eq(limits.highWatermark, size_t { 64 * 1024 }));
+		expect(eq(limits.lowWatermark, size_t { 64 * 1024 }));
+		expect(eq(limits.maxSize, size_t { 1024 * 1024 }));
+		expect(eq(limits.slowTimeout.count(), int64_t { 5000 }));
+	};
+
+	test("ConnectionManager::getStats reports the send queue events") = [] {
+		ConnectionManager manager;
+		manager.addCongestion();
+		manager.addCoalescedUpdate();
+		manager.addCoalescedUpdate();
+		manager.addSlowDisconnect();
+
+		const auto stats = manager.getStats();
+		expect(eq(stats.congestions, uint64_t { 1 }));
+		expect(eq(stats.coalescedUpdates, uint64_t { 2 }));
+		expect(eq(stats.slowDisconnects, uint64_t { 1 }));
+	};
+};
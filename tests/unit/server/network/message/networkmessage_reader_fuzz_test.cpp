@@ -0,0 +1,128 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "lib/logging/in_memory_logger.hpp"
+
+#include "game/movement/position.hpp"
+#include "server/network/message/networkmessage.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr size_t ITERATIONS = 20'000;
+	constexpr size_t READS_PER_MESSAGE = 32;
+
+	// Fills the message the way Connection does for incoming packets: raw bytes after the header, read from the body
+	void fillRandom(NetworkMessage &msg, std::mt19937 &rng) {
+		std::uniform_int_distribution<int> byte(0, 255);
+		std::uniform_int_distribution<uint16_t> size(0, INPUTMESSAGE_MAXSIZE);
+		const auto length = size(rng);
+		msg.reset();
+		msg.setLength(length + HEADER_LENGTH);
+		auto* body = msg.getBodyBuffer();
+		for (uint16_t i = 0; i < length; ++i) {
+			// Mostly small values so string lengths land inside the message now and then
+			body[i] = static_cast<uint8_t>(i % 2 == 0 ? byte(rng) % 64 : byte(rng) % 4);
+		}
+		msg.setBufferPosition(NetworkMessage::INITIAL_BUFFER_POSITION);
+	}
+}
+
+suite<"networkmessage_reader_fuzz"> networkMessageReaderFuzzTest = [] {
+	di::extension::injector<> injector {};
+	DI::setTestContainer(&InMemoryLogger::install(injector));
+	auto &logger = dynamic_cast<InMemoryLogger &>(injector.create<Logger &>());
+
+	test("NetworkMessage reads stay inside the message on random input") = [&] {
+		std::mt19937 rng(0xC0FFEE);
+		std::uniform_int_distribution<int> operation(0, 6);
+		auto msg = std::make_unique<NetworkMessage>();
+		const auto* bufferBegin = reinterpret_cast<const char*>(msg->getBuffer());
+		const auto* bufferEnd = bufferBegin + NETWORKMESSAGE_MAXSIZE;
+
+		size_t failures = 0;
+		for (size_t iteration = 0; iteration < ITERATIONS; ++iteration) {
+			// Failed reads log an error each, keep the in memory log from growing
+			logger.reset();
+			fillRandom(*msg, rng);
+			const auto readEnd = NetworkMessage::INITIAL_BUFFER_POSITION + msg->getLength();
+
+			for (size_t read = 0; read < READS_PER_MESSAGE; ++read) {
+				const auto before = msg->getBufferPosition();
+				switch (operation(rng)) {
+					case 0:
+						msg->getByte(true);
+						break;
+					case 1:
+						msg->get<uint16_t>();
+						break;
+					case 2:
+						msg->get<uint64_t>();
+						break;
+					case 3:
+						msg->getPosition();
+						break;
+					case 4: {
+						const auto view = msg->getStringView();
+						if (!view.empty() && (view.data() < bufferBegin || view.data() + view.size() > bufferEnd)) {
+							++failures;
+						}
+						break;
+					}
+					case 5: {
+						// Both readers must agree on the same bytes and move the position the same way
+						msg->setBufferPosition(before);
+						const std::string copy = msg->getString();
+						const auto afterCopy = msg->getBufferPosition();
+						msg->setBufferPosition(before);
+						const auto view = msg->getStringView();
+						if (copy != view || afterCopy != msg->getBufferPosition()) {
+							++failures;
+						}
+						break;
+					}
+					case 6: {
+						std::uniform_int_distribution<uint16_t> length(1, std::numeric_limits<uint16_t>::max());
+						const auto view = msg->getStringView(length(rng));
+						if (!view.empty() && view.data() + view.size() > bufferBegin + readEnd) {
+							++failures;
+						}
+						break;
+					}
+				}
+
+				if (msg->getBufferPosition() < before || msg->getBufferPosition() > readEnd) {
+					++failures;
+				}
+			}
+		}
+
+		expect(eq(failures, size_t { 0 }));
+	};
+
+	test("NetworkMessage::getStringView points into the message") = [] {
+		NetworkMessage msg;
+		msg.addString("exura vita");
+		msg.addString("hello");
+		msg.setBufferPosition(NetworkMessage::INITIAL_BUFFER_POSITION);
+
+		const auto spell = msg.getStringView();
+		const auto text = msg.getStringView();
+		expect(eq(spell, std::string_view("exura vita")));
+		expect(eq(text, std::string_view("hello")));
+		expect(spell.data() == reinterpret_cast<const char*>(msg.getBuffer()) + NetworkMessage::INITIAL_BUFFER_POSITION + 2);
+		expect(msg.getStringView().empty());
+	};
+
+	test("NetworkMessage::getStringView rejects lengths past the message") = [] {
+		NetworkMessage msg;
+		msg.add<uint16_t>(100);
+		msg.addByte('a');
+		msg.setBufferPosition(NetworkMessage::INITIAL_BUFFER_POSITION);
+
+		expect(msg.getStringView().empty());
+		expect(eq(msg.getBufferPosition(), NetworkMessage::INITIAL_BUFFER_POSITION + 2));
+		expect(eq(msg.getByte(), uint8_t { 'a' }));
+	};
+};
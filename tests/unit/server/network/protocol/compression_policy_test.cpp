@@ -0,0 +1,73 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "lib/logging/in_memory_logger.hpp"
+
+#include "server/network/protocol/compression_policy.hpp"
+
+using namespace boost::ut;
+
+suite<"compression_policy"> compressionPolicyTest = [] {
+	di::extension::injector<> injector {};
+	DI::setTestContainer(&InMemoryLogger::install(injector));
+
+	test("CompressionPolicy skips small messages and disabled compression") = [] {
+		CompressionPolicy policy;
+		CompressionPolicy::ConnectionState state;
+		policy.setLimits(6, 0);
+		expect(!policy.shouldCompress(state, 0x64, CompressionPolicy::MIN_MESSAGE_SIZE - 1));
+		expect(policy.shouldCompress(state, 0x64, CompressionPolicy::MIN_MESSAGE_SIZE));
+
+		policy.setLimits(0, 0);
+		expect(!policy.shouldCompress(state, 0x64, 1024));
+		expect(eq(policy.getLevel(), 0));
+	};
+
+	test("CompressionPolicy bypasses incompressible connections with periodic probes") = [] {
+		CompressionPolicy policy;
+		CompressionPolicy::ConnectionState state;
+		policy.setLimits(6, 0);
+
+		expect(policy.shouldCompress(state, 0x64, 1000));
+		policy.onCompressed(state, 0x64, 1000, 990, 1);
+		expect(gt(state.ratio, CompressionPolicy::SKIP_RATIO));
+
+		size_t compressed = 0;
+		for (uint16_t i = 0; i < CompressionPolicy::PROBE_INTERVAL * 2; ++i) {
+			compressed += policy.shouldCompress(state, 0x64, 1000) ? 1 : 0;
+		}
+		expect(eq(compressed, size_t { 2 }));
+
+		const auto stats = policy.getStats();
+		expect(eq(stats.compressed, uint64_t { 1 }));
+		expect(eq(stats.skipped, uint64_t { CompressionPolicy::PROBE_INTERVAL * 2 - 2 }));
+		expect(eq(stats.bytesIn, uint64_t { 1000 }));
+		expect(eq(stats.bytesOut, uint64_t { 990 }));
+	};
+
+	test("CompressionPolicy bypasses incompressible opcodes on every connection") = [] {
+		CompressionPolicy policy;
+		CompressionPolicy::ConnectionState state;
+		policy.setLimits(6, 0);
+		for (int i = 0; i < 100; ++i) {
+			policy.onCompressed(state, 0x10, 1000, 995, 1);
+			policy.onCompressed(state, 0x20, 1000, 300, 1);
+		}
+
+		CompressionPolicy::ConnectionState fresh;
+		expect(!policy.shouldCompress(fresh, 0x10, 1000));
+		expect(policy.shouldCompress(fresh, 0x20, 1000));
+	};
+
+	test("CompressionPolicy lowers the level over the CPU budget") = [] {
+		CompressionPolicy policy;
+		CompressionPolicy::ConnectionState state;
+		policy.setLimits(9, 1);
+		expect(eq(policy.getLevel(), 9));
+
+		policy.onCompressed(state, 0x64, 1000, 300, 5000);
+		expect(eq(policy.getLevel(), 1));
+		expect(eq(policy.getStats().level, 1));
+	};
+};
@@ -0,0 +1,70 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "server/network/protocol/known_creatures.hpp"
+
+using namespace boost::ut;
+
+suite<"known_creatures"> knownCreaturesTest = [] {
+	const auto evictAny = [](uint32_t) { return true; };
+
+	test("KnownCreatures::insert reports the creatures already known") = [&] {
+		KnownCreatures known(4);
+		expect(eq(known.insert(1, evictAny), std::pair<bool, uint32_t> { false, 0 }));
+		expect(eq(known.insert(1, evictAny), std::pair<bool, uint32_t> { true, 0 }));
+		expect(known.contains(1));
+		expect(!known.contains(2));
+		expect(eq(known.size(), size_t { 1 }));
+	};
+
+	test("KnownCreatures::insert forgets the least recently seen creature when full") = [&] {
+		KnownCreatures known(3);
+		known.insert(1, evictAny);
+		known.insert(2, evictAny);
+		known.insert(3, evictAny);
+		// Seeing 1 again makes 2 the oldest
+		known.insert(1, evictAny);
+
+		expect(eq(known.insert(4, evictAny).second, uint32_t { 2 }));
+		expect(eq(known.insert(5, evictAny).second, uint32_t { 3 }));
+		expect(eq(known.insert(6, evictAny).second, uint32_t { 1 }));
+		expect(eq(known.size(), size_t { 3 }));
+		expect(known.contains(4) && known.contains(5) && known.contains(6));
+	};
+
+	test("KnownCreatures::insert skips the creatures the caller keeps") = [&] {
+		KnownCreatures known(3);
+		known.insert(1, evictAny);
+		known.insert(2, evictAny);
+		known.insert(3, evictAny);
+
+		const auto [wasKnown, removed] = known.insert(4, [](uint32_t id) { return id != 1 && id != 2; });
+		expect(!wasKnown);
+		expect(eq(removed, uint32_t { 3 }));
+		expect(known.contains(1) && known.contains(2) && known.contains(4));
+	};
+
+	test("KnownCreatures::insert removes the oldest anyway when every creature is kept") = [&] {
+		KnownCreatures known(KnownCreatures::MAX_EVICTION_ATTEMPTS * 2);
+		for (uint32_t id = 1; id <= KnownCreatures::MAX_EVICTION_ATTEMPTS * 2; ++id) {
+			known.insert(id, evictAny);
+		}
+
+		const auto removed = known.insert(1000, [](uint32_t) { return false; }).second;
+		expect(removed != 0);
+		expect(!known.contains(removed));
+		expect(eq(known.size(), KnownCreatures::MAX_EVICTION_ATTEMPTS * 2));
+	};
+
+	test("KnownCreatures::clear forgets everything") = [&] {
+		KnownCreatures known(2);
+		known.insert(1, evictAny);
+		known.insert(2, evictAny);
+		known.clear();
+		expect(eq(known.size(), size_t { 0 }));
+		expect(eq(known.insert(3, evictAny), std::pair<bool, uint32_t> { false, 0 }));
+		expect(eq(known.insert(4, evictAny), std::pair<bool, uint32_t> { false, 0 }));
+		expect(eq(known.insert(5, evictAny).second, uint32_t { 3 }));
+	};
+};
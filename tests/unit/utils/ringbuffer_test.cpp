@@ -0,0 +1,44 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "utils/ringbuffer.hpp"
+
+using namespace boost::ut;
+
+suite<"utils"> ringBufferTest = [] {
+	test("ringbuffer keeps FIFO order while wrapping and growing") = [] {
+		stdext::ringbuffer<std::shared_ptr<int>> ring;
+		int next = 0;
+		int expected = 0;
+		for (int round = 0; round < 100; ++round) {
+			for (int i = 0; i < round % 7 + 3; ++i) {
+				ring.emplace_back(std::make_shared<int>(next++));
+			}
+			for (int i = 0; i < round % 5 + 1 && !ring.empty(); ++i) {
+				expect(eq(*ring.front(), expected++));
+				ring.pop_front();
+			}
+		}
+
+		expect(eq(ring.size(), static_cast<size_t>(next - expected)));
+		for (size_t i = 0; i < ring.size(); ++i) {
+			expect(eq(*ring[i], expected + static_cast<int>(i)));
+		}
+	};
+
+	test("ringbuffer releases popped and cleared elements") = [] {
+		stdext::ringbuffer<std::shared_ptr<int>> ring;
+		const auto value = std::make_shared<int>(1);
+		ring.push_back(value);
+		ring.push_back(value);
+		expect(eq(value.use_count(), 3L));
+
+		ring.pop_front();
+		expect(eq(value.use_count(), 2L));
+
+		ring.clear();
+		expect(ring.empty());
+		expect(eq(value.use_count(), 1L));
+	};
+};